@@ -11,6 +11,8 @@ import nativebuild.sanitizeAbsolutePaths
 import nativebuild.toolchainFingerprint
 import org.gradle.api.JavaVersion
 import org.gradle.api.Task
+import org.gradle.api.file.Directory
+import org.gradle.api.provider.Provider
 import org.gradle.api.tasks.TaskProvider
 import org.gradle.kotlin.dsl.register
 
@@ -41,7 +43,10 @@ internal fun registerHostMpvTasks(context: MpvBuildContext) {
     project.tasks.register("mpvBuildAll") {
         group = "mpv"
         description = "Build mpv for all targets available on the current host OS"
-        dependsOn(project.tasks.matching { it.name.startsWith("mpvAssemble") })
+        // Not the mpvAssembleTest* runtimes, which only the desktop tests need.
+        dependsOn(
+            project.tasks.matching { it.name.startsWith("mpvAssemble") && !it.name.startsWith("mpvAssembleTest") },
+        )
     }
 }
 
@@ -96,7 +101,6 @@ private fun registerMpvTasks(
     val outputDirProvider = project.layout.buildDirectory.dir("mpv-output/${target.name}")
     val configStamp = project.layout.buildDirectory.file("mpv/${target.name}/.config_stamp")
     val buildStamp = project.layout.buildDirectory.file("mpv/${target.name}/.build_stamp")
-    val jniOutputFile = project.layout.buildDirectory.file("mpv/${target.name}/jni/${target.jni.outputFileName}")
     val ffmpegInstallDir = context.ffmpegInstallDir(target.ffmpegTargetName)
     val ffmpegAssembleTaskName = context.ffmpegAssembleTaskName(target.ffmpegTargetName)
     if (!context.ffmpegProject.tasks.names.contains(ffmpegAssembleTaskName)) {
@@ -163,34 +167,41 @@ private fun registerMpvTasks(
         }
     }
 
-    val jniTask = project.tasks.register<MpvJniBuildTask>("mpvBuildJni${target.name}") {
-        group = "mpv"
-        description = "Build the mediamp JNI wrapper for ${target.name}"
-        dependsOn(buildTask)
-        targetName.set(target.name)
-        sourceDir.set(project.layout.projectDirectory.dir("src/cpp"))
-        mpvInstallDir.set(buildTask.flatMap { it.installDir })
-        this.ffmpegInstallDir.set(ffmpegInstallDir)
-        shell.set(target.shell)
-        envVars.set(target.env)
-        hostOsName.set(context.hostOs.name)
-        this.toolchainFingerprint.set(jniToolchainFingerprint)
-        jdkMajorVersion.set(JavaVersion.current().majorVersion)
-        compilerCommand.set(target.jni.compilerCommand)
-        compilerArgs.set(target.jni.compilerArgs)
-        linkerArgs.set(target.jni.linkerArgs)
-        sourceExtensions.set(target.jni.sourceExtensions)
-        useJdkIncludes.set(target.jni.useJdkIncludes)
-        linkLibraryPatterns.set(target.jni.linkLibraryPatterns)
-        outputFile.set(jniOutputFile)
-        if (msys2Dir != null) {
-            this.msys2Dir.set(msys2Dir)
+    fun registerJniTask(name: String, description: String, defines: List<String>, output: String) =
+        project.tasks.register<MpvJniBuildTask>(name) {
+            group = "mpv"
+            this.description = description
+            dependsOn(buildTask)
+            targetName.set(target.name)
+            sourceDir.set(project.layout.projectDirectory.dir("src/cpp"))
+            mpvInstallDir.set(buildTask.flatMap { it.installDir })
+            this.ffmpegInstallDir.set(ffmpegInstallDir)
+            shell.set(target.shell)
+            envVars.set(target.env)
+            hostOsName.set(context.hostOs.name)
+            this.toolchainFingerprint.set(jniToolchainFingerprint)
+            jdkMajorVersion.set(JavaVersion.current().majorVersion)
+            compilerCommand.set(target.jni.compilerCommand)
+            compilerArgs.set(target.jni.compilerArgs)
+            this.defines.set(defines)
+            linkerArgs.set(target.jni.linkerArgs)
+            sourceExtensions.set(target.jni.sourceExtensions)
+            useJdkIncludes.set(target.jni.useJdkIncludes)
+            linkLibraryPatterns.set(target.jni.linkLibraryPatterns)
+            outputFile.set(project.layout.buildDirectory.file(output))
+            if (msys2Dir != null) {
+                this.msys2Dir.set(msys2Dir)
+            }
         }
-    }
 
-    val assembleTask = project.tasks.register<MpvAssembleTask>("mpvAssemble${target.name}") {
+    fun registerAssembleTask(
+        name: String,
+        description: String,
+        jniTask: TaskProvider<MpvJniBuildTask>,
+        outputDir: Provider<Directory>,
+    ) = project.tasks.register<MpvAssembleTask>(name) {
         group = "mpv"
-        description = "Assemble mpv outputs for ${target.name}"
+        this.description = description
         dependsOn(jniTask)
         if (previousTargetTask != null) {
             mustRunAfter(previousTargetTask)
@@ -198,14 +209,14 @@ private fun registerMpvTasks(
         targetName.set(target.name)
         installDir.set(buildTask.flatMap { it.installDir })
         this.ffmpegInstallDir.set(ffmpegInstallDir)
-        jniLibrary.set(jniOutputFile)
+        jniLibrary.set(jniTask.flatMap { it.outputFile })
         runtimeDirName.set(target.runtime.runtimeDirName)
         postProcessing.set(target.runtime.postProcessing.name)
         if (target.runtime.postProcessing == MpvRuntimePostProcessing.LINUX_BUNDLE_ELF_DEPENDENCIES) {
             doNotTrackState("Linux runtime assembly discovers dependency files from the build host")
         }
         target.msysSubsystem?.let { msysSubsystem.set(it) }
-        this.outputDir.set(outputDirProvider)
+        this.outputDir.set(outputDir)
         if (msys2Dir != null) {
             this.msys2Dir.set(msys2Dir)
         }
@@ -214,5 +225,35 @@ private fun registerMpvTasks(
         }
     }
 
+    val jniTask = registerJniTask(
+        "mpvBuildJni${target.name}",
+        "Build the mediamp JNI wrapper for ${target.name}",
+        defines = emptyList(),
+        output = "mpv/${target.name}/jni/${target.jni.outputFileName}",
+    )
+    val assembleTask = registerAssembleTask(
+        "mpvAssemble${target.name}",
+        "Assemble mpv outputs for ${target.name}",
+        jniTask,
+        outputDirProvider,
+    )
+
+    if (target.androidAbi == null) {
+        // The same runtime with a wrapper that also has the desktop tests' entry points
+        // (src/cpp/test_hooks.cpp); what desktopTest loads. Never published.
+        val testJniTask = registerJniTask(
+            "mpvBuildJniTest${target.name}",
+            "Build the mediamp JNI wrapper with test hooks for ${target.name}",
+            defines = listOf("MEDIAMP_TEST_HOOKS"),
+            output = "mpv/${target.name}/jni-test/${target.jni.outputFileName}",
+        )
+        registerAssembleTask(
+            "mpvAssembleTest${target.name}",
+            "Assemble mpv outputs with the test hooks for ${target.name}",
+            testJniTask,
+            project.layout.buildDirectory.dir("mpv-output-test/${target.name}"),
+        )
+    }
+
     return assembleTask
 }
@@ -427,6 +427,10 @@ abstract class MpvJniBuildTask : DefaultTask() {
     @get:Input
     abstract val compilerArgs: ListProperty<String>
 
+    /** Preprocessor macros, passed as `-D<name>`. */
+    @get:Input
+    abstract val defines: ListProperty<String>
+
     @get:Input
     abstract val linkerArgs: ListProperty<String>
 
@@ -483,6 +487,7 @@ abstract class MpvJniBuildTask : DefaultTask() {
         val args = buildList {
             add(compilerCommand.get())
             addAll(compilerArgs.get())
+            defines.get().forEach { add("-D$it") }
             if (useJdkIncludes.get()) {
                 addAll(jniIncludeFlags(windowsMsys))
             }
@@ -158,58 +158,52 @@ public abstract class BufferedSeekableInput(
         require(offset + length <= buffer.size) { "offset + length must be less than or equal to buffer size, but was ${offset + length} > ${buffer.size}" }
         checkClosed()
 
-        if (this.position >= this.size) return -1
-        if (length == 0) return 0
-
-        var read = readFromBuffer(length, buffer, offset)
-        if (read != -1) return read // 已经从 buffer 读了
-
-        fillBuffer()
-        read = readFromBuffer(length, buffer, offset)
-        check(read != -1) { "fillBuffer did not fill for $position" }
-
-        return read
+        val sizeToRead = prepareBufferedRead(length)
+        if (sizeToRead <= 0) return sizeToRead
+
+        val offsetInBuf = (this.position - bufferedOffsetStart).checkToInt()
+        this.buf.copyInto(
+            buffer,
+            destinationOffset = offset,
+            startIndex = offsetInBuf,
+            endIndex = offsetInBuf + sizeToRead,
+        )
+        this.position += sizeToRead
+        return sizeToRead
     }
 
     /**
-     * Returns length read, or `-1` if does not fit in buffer
+     * 保证 [position] 处的数据已经在 [buf] 中, 并返回从 `position - bufferedOffsetStart` 开始可以读取的字节数 (不超过 [length]).
+     *
+     * 不移动 [position], 由调用方复制数据后自行前进. 到达 EOF 时返回 `-1`, [length] 为 0 时返回 `0`.
      */
-    private fun readFromBuffer(length: Int, buffer: ByteArray, offset: Int): Int {
-        val bufStart = bufferedOffsetStart
-        val bufEnd = bufferedOffsetEndExcl
+    protected fun prepareBufferedRead(length: Int): Int {
         val pos = this.position
+        if (pos >= this.size) return -1
+        if (length == 0) return 0
 
-        if (bufStart != -1L) {
-            // 有 buffer
+        if (!isBuffered(pos)) {
+            fillBuffer()
+            check(isBuffered(this.position)) { "fillBuffer did not fill for $position" }
+        }
 
-            if (pos in bufStart..<bufEnd) {
-                // 在 buffer 范围内
-                val sizeToRead = min(length, (bufEnd - pos).coerceToInt())
-                    .coerceAtMost((this.size - pos).coerceToInt())
+        return min(length, (bufferedOffsetEndExcl - pos).coerceToInt())
+            .coerceAtMost((this.size - pos).coerceToInt())
+    }
 
-                val offsetInBuf = pos - bufStart
-                this.buf.copyInto(
-                    buffer,
-                    destinationOffset = offset,
-                    startIndex = offsetInBuf.checkToInt(),
-                    endIndex = (offsetInBuf + sizeToRead).checkToInt(),
-                )
-                this.position += sizeToRead
-                return sizeToRead
-            } else {
-                // 已经超出范围
-            }
-        } else {
-            // 无 buffer, 先填充 buffer
-        }
-        return -1
+    /**
+     * [offset] 是否在当前 [buf] 的范围内
+     */
+    protected fun isBuffered(offset: Long): Boolean {
+        val bufStart = bufferedOffsetStart
+        return bufStart != -1L && offset in bufStart..<bufferedOffsetEndExcl
     }
 
     @Volatile
     @JvmField
     protected var closed: Boolean = false
 
-    private fun checkClosed() {
+    protected fun checkClosed() {
         if (closed) throw IllegalStateException("This BufferedSeekableInput is closed")
     }
 
@@ -101,6 +101,23 @@ public interface SeekableInput : AutoCloseable {
         return read(buffer, 0, buffer.size)
     }
 
+    /**
+     * Makes a [read] or [seekTo] that is blocked waiting for data on another thread give up promptly,
+     * by throwing an [IOException].
+     *
+     * Players call this when they no longer want the bytes being waited for, e.g. on stop or when seeking elsewhere,
+     * so that they do not have to wait for data that may take arbitrarily long to arrive (such as a torrent piece).
+     * The input stays usable: later calls behave normally.
+     * If no call is in progress, implementations may either ignore the request or apply it to the next call.
+     *
+     * Unlike the other functions, this one is called concurrently with [read] and [seekTo],
+     * so it must be thread-safe, and it must not block.
+     *
+     * The default implementation does nothing, for inputs that never block for long.
+     */
+    public fun interrupt() {
+    }
+
     /**
      * Closes this [SeekableInput], and **also** closes the underlying source.
      *
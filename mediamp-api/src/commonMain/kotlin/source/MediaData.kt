@@ -53,6 +53,14 @@ public interface SeekableInputMediaData : MediaData {
      */
     public val uri: String
 
+    /**
+     * Stable identity of the content, e.g. a torrent's info hash and file index, or `null` if there is none.
+     *
+     * Unlike [uri], which may only say where the media is, this must name the same bytes every time: players may use
+     * it to keep data fetched from [createInput] across sessions.
+     */
+    public val contentId: String? get() = null
+
     /**
      * Returns the length of the video file in bytes, or `null` if not known.
      */
@@ -11,6 +11,8 @@ package org.openani.mediamp.io
 import kotlinx.io.IOException
 import java.io.File
 import java.io.RandomAccessFile
+import java.nio.Buffer
+import java.nio.ByteBuffer
 
 
 /**
@@ -25,6 +27,8 @@ import java.io.RandomAccessFile
  * though it is not recommended to close the [RandomAccessFile] directly.
  *
  * The file is not open until first read.
+ *
+ * The returned input also implements [ByteBufferSeekableInput] and, when [onFillBuffer] is `null`, exposes this file through [FileSeekableInput].
  */
 @Throws(IOException::class)
 public fun File.toSeekableInput(
@@ -34,15 +38,48 @@ public fun File.toSeekableInput(
     RandomAccessFile(this, "r"),
     bufferSize,
     onFillBuffer,
+    path = absolutePath,
 )
 
 internal open class BufferedFileInput(
     private val file: RandomAccessFile,
     private val bufferSize: Int = DEFAULT_BUFFER_SIZE,
     private val onFillBuffer: (() -> Unit)? = null,
-) : BufferedSeekableInput(bufferSize) {
+    private val path: String? = null,
+) : BufferedSeekableInput(bufferSize), ByteBufferSeekableInput, FileSeekableInput {
     override val size: Long = file.length()
 
+    // Reading the file elsewhere would bypass onFillBuffer.
+    override val filePath: String? get() = path.takeIf { onFillBuffer == null }
+
+    override fun read(buffer: ByteBuffer): Int {
+        checkClosed()
+        val pos = this.position
+        if (pos >= this.size) return -1
+        val length = buffer.remaining().coerceAtMost((this.size - pos).coerceToInt())
+        if (length == 0) return 0
+
+        if (length >= bufferSize && !isBuffered(pos)) {
+            // 请求的长度已经超过了一次 fillBuffer 的量, 直接从文件读到目标 buffer, 不经过 buf
+            onFillBuffer?.invoke()
+            val limit = buffer.limit()
+            (buffer as Buffer).limit(buffer.position() + length) // 不要读超过 size
+            val read = try {
+                file.channel.read(buffer, pos)
+            } finally {
+                (buffer as Buffer).limit(limit)
+            }
+            if (read > 0) this.position = pos + read
+            return read
+        }
+
+        val sizeToRead = prepareBufferedRead(length)
+        if (sizeToRead <= 0) return sizeToRead
+        buffer.put(buf, (this.position - bufferedOffsetStart).checkToInt(), sizeToRead)
+        this.position += sizeToRead
+        return sizeToRead
+    }
+
     override fun fillBuffer() {
         onFillBuffer?.invoke()
 
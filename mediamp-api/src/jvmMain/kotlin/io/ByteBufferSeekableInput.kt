@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.io
+
+import kotlinx.io.IOException
+import java.nio.ByteBuffer
+
+/**
+ * A [SeekableInput] that can read directly into a [ByteBuffer].
+ *
+ * Native players may hand out a direct [ByteBuffer] that wraps their own memory,
+ * so implementing this interface allows bytes to be written into the player's buffer without an intermediate `ByteArray` copy.
+ * Implementations that are backed by a [java.nio.channels.FileChannel] can even skip the heap entirely.
+ *
+ * Implementing this interface is optional. Consumers fall back to [SeekableInput.read] when it is not implemented.
+ */
+public interface ByteBufferSeekableInput : SeekableInput {
+    /**
+     * Reads up to [ByteBuffer.remaining] bytes into [buffer], starting at [ByteBuffer.position].
+     *
+     * Behaves like [SeekableInput.read]: it may read fewer bytes than requested even if it does not reach the EOF.
+     * On return, the position of [buffer] is advanced by the number of bytes read,
+     * and [the current position][SeekableInput.position] of this input is moved by the same amount.
+     *
+     * @return the number of bytes read, or `-1` if the end of the input source has been reached.
+     * Returns `0` if [buffer] has no remaining space.
+     *
+     * @throws IllegalStateException if the input source is closed.
+     */
+    @Throws(IOException::class)
+    public fun read(buffer: ByteBuffer): Int
+}
@@ -0,0 +1,28 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.io
+
+/**
+ * A [SeekableInput] that reads a file on the local file system.
+ *
+ * Players that can read files natively may open [filePath] themselves instead of calling [read],
+ * which avoids crossing into the JVM for every read.
+ * They still [close] this input when they are done with it.
+ *
+ * Implementing this interface is optional.
+ */
+public interface FileSeekableInput : SeekableInput {
+    /**
+     * Absolute path of the file this input reads, or `null` if reads must go through this input,
+     * for example because it observes them.
+     *
+     * The file must not change while it is being read, as [SeekableInput.size] is not re-checked.
+     */
+    public val filePath: String?
+}
@@ -13,7 +13,9 @@ package org.openani.mediamp.io
 import org.junit.Rule
 import org.junit.rules.TemporaryFolder
 import org.openani.mediamp.internal.TestOnly
+import java.io.ByteArrayOutputStream
 import java.io.File
+import java.nio.ByteBuffer
 import kotlin.math.absoluteValue
 import kotlin.random.Random
 import kotlin.random.nextLong
@@ -22,6 +24,7 @@ import kotlin.test.BeforeTest
 import kotlin.test.Test
 import kotlin.test.assertEquals
 import kotlin.test.assertFailsWith
+import kotlin.test.assertNull
 
 
 class BufferedFileInputTest {
@@ -183,6 +186,67 @@ class BufferedFileInputTest {
         }
     }
 
+    ///////////////////////////////////////////////////////////////////////////
+    // ByteBuffer
+    ///////////////////////////////////////////////////////////////////////////
+
+    @Test
+    fun `read into direct ByteBuffer sequentially`() {
+        val buffer = ByteBuffer.allocateDirect(7)
+        val out = ByteArrayOutputStream()
+        while (true) {
+            buffer.clear()
+            val read = input.read(buffer)
+            if (read == -1) break
+            assertEquals(read, buffer.position())
+            buffer.flip()
+            out.write(ByteArray(read).also { buffer.get(it) })
+        }
+        assertEquals(sampleText, out.toByteArray().decodeToString())
+        assertEquals(input.size, input.position)
+    }
+
+    @Test
+    fun `read into large ByteBuffer bypasses buffer`() {
+        input.seekTo(100)
+        val buffer = ByteBuffer.allocateDirect(bufferSize * 3)
+        assertEquals(bufferSize * 3, input.read(buffer))
+        assertEquals(-1L, input.bufferedOffsetRange.first)
+        assertEquals(100L + bufferSize * 3, input.position)
+        buffer.flip()
+        assertEquals(
+            sampleText.substring(100, 100 + bufferSize * 3),
+            ByteArray(buffer.remaining()).also { buffer.get(it) }.decodeToString(),
+        )
+    }
+
+    @Test
+    fun `read into ByteBuffer does not exceed size`() {
+        input.seekTo(input.size - 5)
+        val buffer = ByteBuffer.allocateDirect(bufferSize * 3)
+        assertEquals(5, input.read(buffer))
+        assertEquals(bufferSize * 3, buffer.limit())
+        assertEquals(-1, input.read(buffer))
+    }
+
+    @Test
+    fun `read into full ByteBuffer returns 0`() {
+        assertEquals(0, input.read(ByteBuffer.allocate(0)))
+        assertEquals(0L, input.position)
+    }
+
+    @Test
+    fun `exposes file path`() {
+        assertEquals(file.absolutePath, input.filePath)
+    }
+
+    @Test
+    fun `hides file path when observing reads`() {
+        file.toSeekableInput(bufferSize, onFillBuffer = {}).use {
+            assertNull((it as FileSeekableInput).filePath)
+        }
+    }
+
     ///////////////////////////////////////////////////////////////////////////
     // Error cases
     ///////////////////////////////////////////////////////////////////////////
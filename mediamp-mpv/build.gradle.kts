@@ -54,6 +54,8 @@ kotlin {
         }
         getByName("desktopTest").dependencies {
             implementation(kotlin("test"))
+            // Skiko natives for the raster surfaces of MpvSurfaceRingTest; apps get them from Compose.
+            runtimeOnly(compose.desktop.currentOs)
         }
     }
 }
@@ -81,7 +83,7 @@ val compileJniDevMacos = tasks.register<Exec>("compileJniDevMacos") {
         buildString {
             append("mkdir -p \"\$(dirname ${outputFile.get().asFile.absolutePath})\" && ")
             append("JAVA_HOME=\"\${JAVA_HOME:-\$(/usr/libexec/java_home)}\" && ")
-            append("clang++ -std=c++17 -fPIC -fobjc-arc -O2 -dynamiclib ")
+            append("clang++ -std=c++17 -fPIC -fobjc-arc -O2 -dynamiclib -DMEDIAMP_TEST_HOOKS ")
             append("-I ${srcDir.asFile.absolutePath}/include ")
             append("-I \"\$JAVA_HOME/include\" -I \"\$JAVA_HOME/include/darwin\" ")
             append("-I $mpvPrefix/include -L $mpvPrefix/lib -lmpv -lavcodec ")
@@ -100,31 +102,34 @@ val hostMpvTargetName = when (getOs()) {
     else -> null
 }
 val hostMpvAssembleTaskName = hostMpvTargetName?.let { "mpvAssemble$it" }
+val hostMpvTestAssembleTaskName = hostMpvTargetName?.let { "mpvAssembleTest$it" }
 
 tasks.withType<Test>().configureEach {
     // Where MpvMediampPlayerSmokeTest loads the native runtime from:
     // - Windows: the assembled meson runtime (no system libmpv exists, and the D3D11
-    //     render API needs our patched build anyway) — mpv-output/<target>/bin.
+    //     render API needs our patched build anyway) — mpv-output-test/<target>/bin.
     // - macOS on a required runner (self-hosted, full environment): the assembled meson
-    //     runtime — mpv-output/<target>/lib, which includes libmediampv.dylib. That
+    //     runtime — mpv-output-test/<target>/lib, which includes libmediampv.dylib. That
     //     runner has no Homebrew libmpv, so the dev fast-path below would skip and, under
     //     required mode, fail; and it is the one place that builds the real runtime, so
-    //     the smoke test should exercise exactly what ships.
+    //     the smoke test should exercise what ships.
     // - macOS local dev: the JNI wrapper compiled against Homebrew libmpv (fast loop,
     //     no full meson build required).
+    // Both assembled runtimes are mpvAssembleTest*'s: what ships, except that the wrapper
+    // is compiled with MEDIAMP_TEST_HOOKS (src/cpp/test_hooks.cpp), as is the dev one.
     val mpvTestRequired = getPropertyOrNull("mediamp.mpv.test.required") == "true"
     val testNativeDir = when {
         getOs() == Os.Windows -> {
             if (mpvTestRequired) {
-                hostMpvAssembleTaskName?.let { dependsOn(it) }
+                hostMpvTestAssembleTaskName?.let { dependsOn(it) }
             }
-            layout.buildDirectory.dir("mpv-output/$hostMpvTargetName/bin").get().asFile
+            layout.buildDirectory.dir("mpv-output-test/$hostMpvTargetName/bin").get().asFile
         }
 
         getOs() == Os.MacOS && mpvTestRequired -> {
             val macosTarget = if (getArch() == Arch.AARCH64) "MacosArm64" else "MacosX64"
-            dependsOn("mpvAssemble$macosTarget")
-            layout.buildDirectory.dir("mpv-output/$macosTarget/lib").get().asFile
+            dependsOn("mpvAssembleTest$macosTarget")
+            layout.buildDirectory.dir("mpv-output-test/$macosTarget/lib").get().asFile
         }
 
         else -> {
@@ -213,6 +218,17 @@ if (hostMpvRuntimeJarTaskName != null && hostMpvRuntimeJarTaskName in tasks.name
     }
 }
 
+// MpvHandleContentionBenchmark, left out of the unit tests for the seconds it takes.
+tasks.register<Test>("contentionBenchmark") {
+    group = "mediamp"
+    description = "Measures property poll throughput of one mpv handle from 1 to 8 threads"
+    val testCompilation = kotlin.targets.getByName("desktop").compilations.getByName("test")
+    testClassesDirs = testCompilation.output.classesDirs
+    classpath = files(testCompilation.output.allOutputs, testCompilation.runtimeDependencyFiles)
+    filter { includeTestsMatching("*ContentionBenchmark*") }
+    systemProperty("mediamp.mpv.benchmark", "true")
+}
+
 mavenPublishing {
     configure(
         KotlinMultiplatform(JavadocJar.Empty(), SourcesJar.Sources(), listOf("debug", "release")),
@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import kotlinx.coroutines.CompletableDeferred
+
+/**
+ * Waits for the reply to one asynchronous request ([MPVHandle.commandAsync], [MPVHandle.setPropertyAsync]).
+ */
+internal fun interface AsyncReplyListener {
+    /**
+     * Called once, from the native event loop, or with an error when the handle is destroyed first.
+     *
+     * @param mpvError the `mpv_error` code of the reply, `>= 0` on success
+     */
+    fun onReply(mpvError: Int)
+}
+
+internal class DeferredReply : AsyncReplyListener {
+    val result = CompletableDeferred<Boolean>()
+
+    override fun onReply(mpvError: Int) {
+        result.complete(mpvError >= 0)
+    }
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2024-2025 OpenAni and contributors.
+ * Copyright (C) 2024-2026 OpenAni and contributors.
  *
  * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
  *
@@ -30,6 +30,36 @@ interface EventListener {
      */
     fun onPropertyChange(name: String, value: String)
 
+    /**
+     * Keyed variant of `onPropertyChange(name)`, called on JVM targets instead of it.
+     *
+     * The keyed variants carry the `replyData` the property was observed with
+     * ([MPVHandle.observeProperty]) as [id], so a listener that gives each property its own ID
+     * can dispatch on a number instead of comparing [name]s. [name] is interned and costs no
+     * allocation. All of them default to the name-keyed callbacks.
+     */
+    fun onPropertyNone(id: Long, name: String) = onPropertyChange(name)
+
+    /**
+     * Keyed variant of `onPropertyChange(name, value: Boolean)`, see [onPropertyNone].
+     */
+    fun onPropertyFlag(id: Long, name: String, value: Boolean) = onPropertyChange(name, value)
+
+    /**
+     * Keyed variant of `onPropertyChange(name, value: Long)`, see [onPropertyNone].
+     */
+    fun onPropertyInt64(id: Long, name: String, value: Long) = onPropertyChange(name, value)
+
+    /**
+     * Keyed variant of `onPropertyChange(name, value: Double)`, see [onPropertyNone].
+     */
+    fun onPropertyDouble(id: Long, name: String, value: Double) = onPropertyChange(name, value)
+
+    /**
+     * Keyed variant of `onPropertyChange(name, value: String)`, see [onPropertyNone].
+     */
+    fun onPropertyString(id: Long, name: String, value: String) = onPropertyChange(name, value)
+
     /**
      * MPV event
      */
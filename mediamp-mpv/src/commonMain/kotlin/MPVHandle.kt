@@ -8,7 +8,9 @@
 
 package org.openani.mediamp.mpv
 
+import kotlinx.coroutines.Deferred
 import org.openani.mediamp.io.SeekableInput
+import org.openani.mediamp.mpv.internal.decodeMpvNode
 import kotlin.concurrent.atomics.AtomicLong
 import kotlin.concurrent.atomics.ExperimentalAtomicApi
 
@@ -34,7 +36,7 @@ class MPVHandle private constructor(ptr: Long) : AutoCloseable {
 
     fun setEventListener(listener: EventListener) {
         eventListener = listener
-        nSetEventListener(ptr, listener)
+        nSetEventListener(ptr, listener.forEventLoop())
     }
 
     internal fun setRenderUpdateListener(listener: RenderUpdateListener?): Boolean {
@@ -46,10 +48,32 @@ class MPVHandle private constructor(ptr: Long) : AutoCloseable {
         return nCommand(ptr, command)
     }
 
+    /**
+     * Queues [command] and returns without waiting for mpv to run it, so that the caller does not block and
+     * several commands can be in flight at once. The result completes, on mpv's event thread, with whether
+     * the command succeeded; right away with `false` if mpv refused to queue it.
+     */
+    fun commandAsync(vararg command: String): Deferred<Boolean> {
+        val reply = DeferredReply()
+        if (!nCommandAsync(ptr, command, reply)) reply.result.complete(false)
+        return reply.result
+    }
+
     fun option(key: String, value: String): Boolean {
         return nOption(ptr, key, value)
     }
 
+    /**
+     * Sets the most verbose level of the native log lines of this handle, its own and mpv's, that reach
+     * [MPVLog]; e.g. [MPVLog.V] for mpv's verbose output, or [MPVLog.NONE] for none. Lines above it are
+     * dropped natively, before they are even formatted, and mpv is asked for its messages up to [level] only.
+     *
+     * A new handle starts at the level set with [setDefaultLogLevel], [MPVLog.INFO] unless changed.
+     */
+    fun setLogLevel(level: Int): Boolean {
+        return nSetLogLevel(ptr, level)
+    }
+
     fun getPropertyInt(name: String): Int {
         return nGetPropertyInt(ptr, name)
     }
@@ -66,6 +90,25 @@ class MPVHandle private constructor(ptr: Long) : AutoCloseable {
         return nGetPropertyString(ptr, name)
     }
 
+    /**
+     * Reads [name] as an `MPV_FORMAT_NODE` tree in one native call, e.g. all of `track-list` at once.
+     *
+     * Nodes are [String], [Boolean], [Long], [Double], [List] or [Map] (with [String] keys) values;
+     * returns `null` when the property is unavailable.
+     */
+    fun getPropertyNode(name: String): Any? {
+        return nGetPropertyNode(ptr, name)?.let(::decodeMpvNode)
+    }
+
+    /**
+     * Reads all properties of [batch] in one native call, under one lock of the handle.
+     */
+    fun getProperties(batch: MPVPropertyBatch): MPVPropertyValues {
+        val values = LongArray(batch.size)
+        val validMask = nGetProperties(ptr, batch.names, batch.formats, values)
+        return MPVPropertyValues(values, validMask)
+    }
+
     fun setPropertyInt(name: String, value: Int): Boolean {
         return nSetPropertyInt(ptr, name, value)
     }
@@ -82,19 +125,103 @@ class MPVHandle private constructor(ptr: Long) : AutoCloseable {
         return nSetPropertyString(ptr, name, value)
     }
 
-    fun observeProperty(name: String, format: MPVFormat, replyData: Long = 0L): Boolean {
-        return nObserveProperty(ptr, name, format.ordinal, replyData)
+    /**
+     * Sets property [name] like [setPropertyBoolean], but asynchronously as [commandAsync] runs commands.
+     */
+    fun setPropertyAsync(name: String, value: Boolean): Deferred<Boolean> =
+        setPropertyAsync(name, MPVFormat.MPV_FORMAT_FLAG, if (value) 1L else 0L, null)
+
+    /**
+     * Sets property [name] like [setPropertyInt], but asynchronously as [commandAsync] runs commands.
+     */
+    fun setPropertyAsync(name: String, value: Long): Deferred<Boolean> =
+        setPropertyAsync(name, MPVFormat.MPV_FORMAT_INT64, value, null)
+
+    /**
+     * Sets property [name] like [setPropertyDouble], but asynchronously as [commandAsync] runs commands.
+     */
+    fun setPropertyAsync(name: String, value: Double): Deferred<Boolean> =
+        setPropertyAsync(name, MPVFormat.MPV_FORMAT_DOUBLE, value.toRawBits(), null)
+
+    /**
+     * Sets property [name] like [setPropertyString], but asynchronously as [commandAsync] runs commands.
+     */
+    fun setPropertyAsync(name: String, value: String): Deferred<Boolean> =
+        setPropertyAsync(name, MPVFormat.MPV_FORMAT_STRING, 0L, value)
+
+    private fun setPropertyAsync(name: String, format: MPVFormat, value: Long, string: String?): Deferred<Boolean> {
+        val reply = DeferredReply()
+        if (!nSetPropertyAsync(ptr, name, format.ordinal, value, string, reply)) reply.result.complete(false)
+        return reply.result
+    }
+
+    /**
+     * Observes property [name]; its changes are delivered to the [EventListener] with [replyData] as their ID.
+     *
+     * @param maxRateHz at most this many changes per second are delivered; changes in between are
+     * coalesced natively, so the listener gets the latest value once the interval ends. `0` is unlimited.
+     * @param epsilon for [MPVFormat.MPV_FORMAT_DOUBLE], changes smaller than this from the last delivered
+     * value are dropped. `0` delivers every change.
+     *
+     * Throttling is keyed by [replyData], so a throttled property must be observed with its own non-zero one.
+     */
+    fun observeProperty(
+        name: String,
+        format: MPVFormat,
+        replyData: Long = 0L,
+        maxRateHz: Double = 0.0,
+        epsilon: Double = 0.0,
+    ): Boolean {
+        require(maxRateHz >= 0.0 && epsilon >= 0.0) { "maxRateHz and epsilon must not be negative" }
+        require(replyData != 0L || (maxRateHz == 0.0 && epsilon == 0.0)) {
+            "a throttled property needs its own non-zero replyData"
+        }
+        val minIntervalNanos = if (maxRateHz > 0.0) (1_000_000_000.0 / maxRateHz).toLong() else 0L
+        return nObserveProperty(ptr, name, format.ordinal, replyData, minIntervalNanos, epsilon)
     }
 
     fun unobserveProperty(replyData: Long): Boolean {
         return nUnobserveProperty(ptr, replyData)
     }
 
-    fun registerSeekableInput(input: SeekableInput, uri: String): String {
+    /**
+     * Registers [input] so that mpv can open it at [uri].
+     *
+     * If [input] is backed by a local file that the native layer can open,
+     * mpv reads that file directly and [input] is only closed when mpv is done with it.
+     *
+     * @param readAheadSize bytes a native prefetch thread keeps buffered ahead of mpv's reads,
+     * so that mpv reads from native memory instead of calling [SeekableInput.read] on its demuxer thread.
+     * `0`, the default, disables read-ahead: [input] is then only read on mpv's thread, as mpv asks for bytes.
+     * [RECOMMENDED_READ_AHEAD_SIZE] suits inputs whose reads may block, like torrents.
+     * Not used when the file is read directly.
+     * @param minReadSize smallest [SeekableInput.read] the native layer makes. mpv issues many small reads
+     * (while probing, and for interleaved subtitle tracks); they are coalesced into reads of at least this size
+     * and served from native memory. With read-ahead, this is the size of each read made by the prefetch thread.
+     * `0` passes mpv's reads through unchanged.
+     * @param contentId stable identity of the content behind [input], e.g. a torrent's info hash and file index.
+     * When read-ahead is on and the disk cache is configured ([configureSeekableInputDiskCache]),
+     * fetched bytes are also kept on disk under this ID and reused by later registrations of the same content,
+     * including in later sessions. `null` keeps nothing on disk.
+     * @param cacheKey identity of the bytes behind [input], e.g. the media's URI. Inputs registered with the same key,
+     * on any handle, share the read-ahead cache, so bytes one of them already fetched are not fetched again by the other.
+     * `null` keeps the cache private to this input. See [setSeekableInputCacheBudget].
+     */
+    fun registerSeekableInput(
+        input: SeekableInput,
+        uri: String,
+        readAheadSize: Long = 0,
+        cacheKey: String? = null,
+        minReadSize: Int = DEFAULT_MIN_READ_SIZE,
+        contentId: String? = null,
+    ): String {
+        require(readAheadSize >= 0) { "readAheadSize must be non-negative, but was $readAheadSize" }
+        require(minReadSize >= 0) { "minReadSize must be non-negative, but was $minReadSize" }
         // On failure the native layer throws a specific IllegalArgumentException /
         // IllegalStateException with the concrete reason, so it normally does not return
         // false; the check remains only as a defensive fallback.
-        if (!nRegisterSeekableInput(ptr, input, uri, input.size)) {
+        val filePath = input.localFilePathOrNull()?.encodeToByteArray()
+        if (!nRegisterSeekableInput(ptr, input, uri, input.size, readAheadSize, minReadSize, cacheKey, contentId, filePath)) {
             error("Failed to register SeekableInput for mpv stream_cb: $uri")
         }
         return uri
@@ -104,6 +231,13 @@ class MPVHandle private constructor(ptr: Long) : AutoCloseable {
         return nUnregisterSeekableInput(ptr, uri)
     }
 
+    /**
+     * Returns the I/O counters of the input registered at [uri], or `null` if there is none.
+     */
+    fun getSeekableInputStats(uri: String): SeekableInputStats? {
+        return nGetSeekableInputStats(ptr, uri)?.let(::SeekableInputStats)
+    }
+
     /**
      * Stop this `mpv_context` instance, which will run into the unrecoverable state.
      *
@@ -117,6 +251,10 @@ class MPVHandle private constructor(ptr: Long) : AutoCloseable {
         return nDestroy(currentPtr)
     }
 
+    /**
+     * Deletes the native instance. Must not run concurrently with other calls on this handle: a call already
+     * past its handle check would use the deleted instance.
+     */
     override fun close() {
         // Claim the pointer atomically; only the caller that observes the non-zero value
         // proceeds to nFinalize, so the native instance is deleted at most once.
@@ -128,6 +266,94 @@ class MPVHandle private constructor(ptr: Long) : AutoCloseable {
     }
 
     public companion object {
+        /**
+         * A `readAheadSize` for [registerSeekableInput] that keeps a few seconds of high-bitrate video ahead of mpv.
+         * Read-ahead is off unless a size is given.
+         */
+        public const val RECOMMENDED_READ_AHEAD_SIZE: Long = 4L * 1024 * 1024
+
+        /**
+         * Default `minReadSize` of [registerSeekableInput].
+         */
+        public const val DEFAULT_MIN_READ_SIZE: Int = 256 * 1024
+
+        /**
+         * Default of [setSeekableInputCacheBudget].
+         */
+        public const val DEFAULT_SEEKABLE_INPUT_CACHE_BUDGET: Long = 64L * 1024 * 1024
+
+        /**
+         * Sets how much native memory the read-ahead caches of all registered inputs may use together.
+         * The least recently used blocks are evicted beyond it; blocks a read is waiting for are always admitted.
+         */
+        public fun setSeekableInputCacheBudget(bytes: Long) {
+            require(bytes >= 0) { "bytes must be non-negative, but was $bytes" }
+            nSetSeekableInputCacheBudget(bytes)
+        }
+
+        /**
+         * Default `budgetBytes` of [configureSeekableInputDiskCache].
+         */
+        public const val DEFAULT_SEEKABLE_INPUT_DISK_CACHE_BUDGET: Long = 2L * 1024 * 1024 * 1024
+
+        /**
+         * Enables the persistent disk cache of inputs registered with a `contentId`, storing it in [directory],
+         * or disables it for inputs registered afterwards when [directory] is `null`.
+         *
+         * When the stored contents exceed [budgetBytes], whole contents are deleted in [policy] order;
+         * contents in use are never deleted.
+         */
+        public fun configureSeekableInputDiskCache(
+            directory: String?,
+            budgetBytes: Long = DEFAULT_SEEKABLE_INPUT_DISK_CACHE_BUDGET,
+            policy: SeekableInputDiskCachePolicy = SeekableInputDiskCachePolicy.LEAST_RECENTLY_USED,
+        ) {
+            require(budgetBytes >= 0) { "budgetBytes must be non-negative, but was $budgetBytes" }
+            nConfigureSeekableInputDiskCache(directory?.encodeToByteArray(), budgetBytes, policy.ordinal)
+        }
+
+        /**
+         * Keeps [size] idle mpv instances, created with [options] and initialized in the background, ready for
+         * [createInitialized] with the same [options]; every one taken is replaced. 0 stops pooling and destroys
+         * the idle instances of [options]. Each distinct list of [options] is pooled separately.
+         *
+         * Off by default. Idle instances have no event listener; what happens to them before they are taken is
+         * not reported. The first [context] given is kept for the lifetime of the process, so on Android pass the
+         * application `Context`.
+         *
+         * An instance that fails to be created is retried right away, without backoff; after three failures in a row
+         * the [options] are no longer pooled until they are configured again. Idle instances are not destroyed when
+         * the process exits.
+         */
+        public fun configurePool(context: Any, options: List<Pair<String, String>>, size: Int) {
+            require(size >= 0) { "size must be non-negative, but was $size" }
+            LibraryLoader.loadLibraries(context)
+            nConfigureHandlePool(context, options.flatten(), size)
+        }
+
+        /**
+         * Returns a handle that has [options] set with [option] and is already [initialize]d: an idle one from the
+         * pool when [configurePool] was called with the same [options] and one is ready, otherwise one created now.
+         */
+        public fun createInitialized(context: Any, options: List<Pair<String, String>>): MPVHandle {
+            LibraryLoader.loadLibraries(context)
+            val pooled = nTakePooledHandle(options.flatten())
+            if (pooled != 0L) return MPVHandle(pooled)
+
+            val handle = MPVHandle(context)
+            try {
+                for ((key, value) in options) handle.option(key, value)
+                handle.initialize()
+            } catch (e: Throwable) {
+                handle.close()
+                throw e
+            }
+            return handle
+        }
+
+        private fun List<Pair<String, String>>.flatten(): Array<String> =
+            Array(size * 2) { if (it % 2 == 0) this[it / 2].first else this[it / 2].second }
+
         private fun createHandle(context: Any): Long {
             LibraryLoader.loadLibraries(context)
             return nMake(context)
@@ -141,6 +367,34 @@ class MPVHandle private constructor(ptr: Long) : AutoCloseable {
             LibraryLoader.useDefaultRuntimeLibraryDirectory()
         }
 
+        /**
+         * Sets the log level of handles created afterwards (see [setLogLevel]) and of native log lines
+         * that belong to no handle.
+         */
+        public fun setDefaultLogLevel(level: Int) {
+            nSetDefaultLogLevel(level)
+        }
+
+        /**
+         * Default `capacityBytes` of [openLogRingFile].
+         */
+        public const val DEFAULT_LOG_RING_FILE_CAPACITY: Long = 1024L * 1024
+
+        /**
+         * Also writes native log lines, as they are logged, into a ring of [capacityBytes] in the file at [path],
+         * which is created or truncated. The file is memory-mapped, so its latest lines survive a native crash or
+         * a process kill; decode it with [MpvLogRingFile.decode], e.g. on the next start before opening it again.
+         *
+         * Lines above the log level of their handle ([setLogLevel]) are not written. Only one file can be opened
+         * per process, and it stays open until the process exits.
+         *
+         * @return `false` if the file could not be opened, or one already is
+         */
+        public fun openLogRingFile(path: String, capacityBytes: Long = DEFAULT_LOG_RING_FILE_CAPACITY): Boolean {
+            require(capacityBytes > 0) { "capacityBytes must be positive, but was $capacityBytes" }
+            return nOpenLogRingFile(path.encodeToByteArray(), capacityBytes)
+        }
+
         public fun setLogHandler(handler: MPVLogHandler?) {
             MPVLog.setHandler(handler)
         }
@@ -192,23 +446,48 @@ object MPVEvent {
 
 private external fun nGlobalInit(): Boolean
 private external fun nMake(context: Any): Long
+private external fun nConfigureHandlePool(context: Any, options: Array<String>, size: Int)
+private external fun nTakePooledHandle(options: Array<String>): Long
 private external fun nInitialize(ptr: Long): Boolean
 private external fun nSetEventListener(ptr: Long, eventListener: EventListener): Boolean
 private external fun nSetRenderUpdateListener(ptr: Long, listener: RenderUpdateListener?): Boolean
 private external fun nCommand(ptr: Long, command: Array<out String>): Boolean
+internal external fun nCommandAsync(ptr: Long, command: Array<out String>, listener: AsyncReplyListener): Boolean
+internal external fun nSetPropertyAsync(ptr: Long, name: String, format: Int, value: Long, string: String?, listener: AsyncReplyListener): Boolean
 private external fun nOption(ptr: Long, key: String, value: String): Boolean
+// Not @FastNative on Android, although they are called per frame: mpv_get_property waits for mpv's core
+// thread, which can be busy for a long time (e.g. opening a file), and a @FastNative call cannot be
+// suspended for GC while it waits, so it would stall every other thread's allocations with it.
 private external fun nGetPropertyInt(ptr: Long, name: String): Int
 private external fun nGetPropertyBoolean(ptr: Long, name: String): Boolean
 private external fun nGetPropertyDouble(ptr: Long, name: String): Double
 private external fun nGetPropertyString(ptr: Long, name: String): String?
+private external fun nGetPropertyNode(ptr: Long, name: String): ByteArray?
+private external fun nGetProperties(ptr: Long, names: Array<String>, formats: IntArray, values: LongArray): Long
 private external fun nSetPropertyInt(ptr: Long, name: String, value: Int): Boolean
 private external fun nSetPropertyBoolean(ptr: Long, name: String, value: Boolean): Boolean
 private external fun nSetPropertyDouble(ptr: Long, name: String, value: Double): Boolean
 private external fun nSetPropertyString(ptr: Long, name: String, value: String): Boolean
-private external fun nObserveProperty(ptr: Long, name: String, format: Int, replyData: Long): Boolean
+private external fun nSetLogLevel(ptr: Long, level: Int): Boolean
+private external fun nSetDefaultLogLevel(level: Int)
+private external fun nOpenLogRingFile(path: ByteArray, capacity: Long): Boolean
+private external fun nObserveProperty(ptr: Long, name: String, format: Int, replyData: Long, minIntervalNanos: Long, epsilon: Double): Boolean
 private external fun nUnobserveProperty(ptr: Long, replyData: Long): Boolean
-private external fun nRegisterSeekableInput(ptr: Long, input: SeekableInput, uri: String, size: Long): Boolean
+private external fun nRegisterSeekableInput(ptr: Long, input: SeekableInput, uri: String, size: Long, readAheadSize: Long, minReadSize: Int, cacheKey: String?, contentId: String?, filePath: ByteArray?): Boolean
 private external fun nUnregisterSeekableInput(ptr: Long, uri: String): Boolean
+private external fun nSetSeekableInputCacheBudget(bytes: Long)
+private external fun nConfigureSeekableInputDiskCache(directory: ByteArray?, budget: Long, policy: Int)
+private external fun nGetSeekableInputStats(ptr: Long, uri: String): LongArray?
+
+/**
+ * Path of the local file [this] reads, if mpv may read that file directly instead of calling [SeekableInput.read].
+ */
+internal expect fun SeekableInput.localFilePathOrNull(): String?
+
+/**
+ * The listener actually registered with the native event loop for [this], e.g. one that receives events in batches.
+ */
+internal expect fun EventListener.forEventLoop(): EventListener
 
 /**
  * Attach render surface to the mpv context.
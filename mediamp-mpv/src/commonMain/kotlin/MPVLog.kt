@@ -41,8 +41,11 @@ public fun interface MPVLogHandler {
  * via [MPVHandle.setLogHandler]) observes everything on one scale.
  *
  * Levels mirror mpv's `mpv_log_level` (client.h): **lower is more severe**.
+ * Native lines are filtered natively first, at the level set with [MPVHandle.setLogLevel].
  */
 public object MPVLog {
+    /** As a log level threshold only ([MPVHandle.setLogLevel]): nothing is logged. */
+    public const val NONE: Int = 0
     public const val FATAL: Int = 10 // critical, aborting errors
     public const val ERROR: Int = 20 // simple errors
     public const val WARN: Int = 30  // possible problems
@@ -99,7 +102,7 @@ public object MPVLog {
     public fun verbose(handle: Long, message: String, throwable: Throwable? = null): Unit = log(handle, V, message, throwable)
 }
 
-@Suppress("unused") // Called from JNI as MPVLogKt.onNativeLog(int, String, String).
+// The native layer delivers its lines in batches (onNativeLogBatch on JVM); kept for callers that forward single lines.
 public fun onNativeLog(instanceHandle: Long, level: Int, prefix: String, message: String) {
     MPVLog.log(instanceHandle, level, message, prefix = prefix)
 }
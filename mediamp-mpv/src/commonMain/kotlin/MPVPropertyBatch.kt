@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+/**
+ * Properties read together with [MPVHandle.getProperties]: one native call and one lock of the handle for all of
+ * them, instead of one each. mpv still reads each of them on its own, so they are not a snapshot: playback can move
+ * on between two of them.
+ *
+ * Immutable; define it once and read it as often as needed, from any thread.
+ *
+ * @param properties names with their formats: [MPVFormat.MPV_FORMAT_FLAG], [MPVFormat.MPV_FORMAT_INT64] or
+ * [MPVFormat.MPV_FORMAT_DOUBLE]. At most [MAX_SIZE].
+ */
+public class MPVPropertyBatch(vararg properties: Pair<String, MPVFormat>) {
+    internal val names: Array<String> = Array(properties.size) { properties[it].first }
+    internal val formats: IntArray = IntArray(properties.size) { properties[it].second.ordinal }
+
+    public val size: Int get() = names.size
+
+    init {
+        require(properties.size <= MAX_SIZE) { "At most $MAX_SIZE properties can be read at once" }
+        require(properties.all { it.second in SUPPORTED_FORMATS }) {
+            "Only MPV_FORMAT_FLAG, MPV_FORMAT_INT64 and MPV_FORMAT_DOUBLE properties can be read at once"
+        }
+    }
+
+    public companion object {
+        public const val MAX_SIZE: Int = 64
+
+        private val SUPPORTED_FORMATS =
+            setOf(MPVFormat.MPV_FORMAT_FLAG, MPVFormat.MPV_FORMAT_INT64, MPVFormat.MPV_FORMAT_DOUBLE)
+    }
+}
+
+/**
+ * Values of an [MPVPropertyBatch], by the index of the property in it. A property that could not be read (e.g.
+ * `width` while nothing is loaded) has no value, and its getter returns `null`.
+ */
+public class MPVPropertyValues internal constructor(
+    private val values: LongArray,
+    private val validMask: Long,
+) {
+    public fun isValid(index: Int): Boolean = ((validMask ushr index) and 1L) != 0L
+
+    public fun getBoolean(index: Int): Boolean? = if (isValid(index)) values[index] != 0L else null
+
+    public fun getLong(index: Int): Long? = if (isValid(index)) values[index] else null
+
+    public fun getInt(index: Int): Int? =
+        getLong(index)?.coerceIn(Int.MIN_VALUE.toLong(), Int.MAX_VALUE.toLong())?.toInt()
+
+    public fun getDouble(index: Int): Double? = if (isValid(index)) Double.fromBits(values[index]) else null
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+/**
+ * A log line read back from a log ring file.
+ *
+ * @property timeEpochNanos when the line was logged, in nanoseconds since the Unix epoch
+ */
+public class MpvLogRecord(
+    public val timeEpochNanos: Long,
+    public val instanceHandle: Long,
+    public val level: Int,
+    public val prefix: String,
+    public val line: String,
+) {
+    override fun toString(): String = "[$prefix] $line"
+}
+
+/**
+ * Decoder of the log ring file written natively once [MPVHandle.openLogRingFile] has been called.
+ *
+ * The file holds the latest native log lines and is written through a memory mapping, so it still holds them
+ * after the process crashed or was killed, when lines on their way to [MPVLog] are lost. Read it before the
+ * next [MPVHandle.openLogRingFile] with the same path, which truncates it; e.g. rename it aside on start.
+ * The layout is documented in `log_ring_file.h`.
+ */
+public object MpvLogRingFile {
+    /**
+     * Returns the complete records in [bytes], the contents of a log ring file, oldest first.
+     * Records that were being written when the process died are skipped.
+     *
+     * @throws IllegalArgumentException if [bytes] is not a log ring file
+     */
+    public fun decode(bytes: ByteArray): List<MpvLogRecord> {
+        require(bytes.size >= HEADER_SIZE && MAGIC.indices.all { bytes[it] == MAGIC[it] }) { "Not an mpv log ring file" }
+        require(bytes.int(8) == VERSION) { "Unsupported mpv log ring file version ${bytes.int(8)}" }
+        val dataOffset = bytes.int(12)
+        val capacity = bytes.long(16)
+        val writePosition = bytes.long(24)
+        val prefixEntries = bytes.int(32)
+        val prefixTableOffset = bytes.int(36)
+        require(capacity > 0 && (capacity and (capacity - 1)) == 0L && dataOffset + capacity <= bytes.size) {
+            "Truncated mpv log ring file"
+        }
+
+        val prefixes = arrayOfNulls<String>(prefixEntries)
+        for (i in 0 until prefixEntries) {
+            val entry = prefixTableOffset + i * PREFIX_ENTRY_SIZE
+            if (bytes.int(entry) != PREFIX_READY) continue
+            var end = entry + 4
+            while (end < entry + PREFIX_ENTRY_SIZE && bytes[end] != 0.toByte()) end++
+            prefixes[i] = bytes.decodeToString(entry + 4, end)
+        }
+
+        val records = ArrayList<MpvLogRecord>()
+        val mask = capacity - 1
+        fun copy(position: Long, size: Int) =
+            ByteArray(size) { bytes[dataOffset + ((position + it) and mask).toInt()] }
+
+        var position = maxOf(0L, writePosition - capacity)
+        while (position + RECORD_HEADER_SIZE <= writePosition) {
+            val header = copy(position, RECORD_HEADER_SIZE)
+            val size = header.int(8)
+            // A record is complete when it carries its own position; anything else is a torn or an
+            // overwritten record, and the next one starts at some later 8-byte boundary.
+            if (header.long(0) != position || size !in RECORD_HEADER_SIZE..MAX_RECORD_SIZE || size % 8 != 0 ||
+                position + size > writePosition
+            ) {
+                position += 8
+                continue
+            }
+            val record = copy(position, size)
+            val prefixId = record.short(32)
+            val textLength = record.short(34)
+            records += MpvLogRecord(
+                timeEpochNanos = record.long(16),
+                instanceHandle = record.long(24),
+                level = record.int(12),
+                prefix = prefixes.getOrNull(prefixId) ?: "?",
+                line = record.decodeToString(RECORD_HEADER_SIZE, minOf(size, RECORD_HEADER_SIZE + textLength))
+                    .trimEnd('\r', '\n'),
+            )
+            position += size
+        }
+        return records
+    }
+
+    private fun ByteArray.short(offset: Int): Int =
+        (this[offset].toInt() and 0xff) or ((this[offset + 1].toInt() and 0xff) shl 8)
+
+    private fun ByteArray.int(offset: Int): Int {
+        var value = 0
+        for (i in 0 until 4) value = value or ((this[offset + i].toInt() and 0xff) shl (8 * i))
+        return value
+    }
+
+    private fun ByteArray.long(offset: Int): Long {
+        var value = 0L
+        for (i in 0 until 8) value = value or ((this[offset + i].toLong() and 0xff) shl (8 * i))
+        return value
+    }
+
+    // Shared with log_ring_file.h.
+    private val MAGIC = "MPVLOGR1".encodeToByteArray()
+    private const val VERSION = 1
+    private const val HEADER_SIZE = 64
+    private const val PREFIX_ENTRY_SIZE = 32
+    private const val PREFIX_READY = 2
+    private const val RECORD_HEADER_SIZE = 40
+    private const val MAX_RECORD_SIZE = RECORD_HEADER_SIZE + 1024
+}
@@ -36,13 +36,13 @@ internal class MpvAudioLevelController(private val handle: MPVHandle) : AudioLev
     override val maxVolume: Float = 2f
 
     override fun setMute(mute: Boolean) {
-        handle.setPropertyBoolean("mute", mute)
+        handle.setPropertyAsync("mute", mute)
         isMute.value = mute
     }
 
     override fun setVolume(volume: Float) {
         val coerced = volume.coerceIn(0f, maxVolume)
-        handle.setPropertyDouble("volume", (coerced * 100f).toDouble())
+        handle.setPropertyAsync("volume", (coerced * 100f).toDouble())
         this.volume.value = coerced
     }
 
@@ -149,18 +149,20 @@ internal class MpvMediaMetadata(private val handle: MPVHandle) : MediaMetadata {
 
     /** Re-reads mpv's "track-list". Called from the mpv event thread on change notification. */
     fun refreshTracks() {
-        val count = handle.getPropertyInt("track-list/count")
+        // One native read of the whole list instead of one per track field.
+        val list = handle.getPropertyNode("track-list") as? List<*> ?: emptyList<Any?>()
         val audio = mutableListOf<AudioTrack>()
         val subtitles = mutableListOf<SubtitleTrack>()
         var selectedAudio: AudioTrack? = null
         var selectedSubtitle: SubtitleTrack? = null
 
-        for (i in 0 until count) {
-            val type = handle.getPropertyString("track-list/$i/type") ?: continue
-            val id = handle.getPropertyInt("track-list/$i/id")
-            val title = handle.getPropertyString("track-list/$i/title")
-            val lang = handle.getPropertyString("track-list/$i/lang")
-            val isSelected = handle.getPropertyBoolean("track-list/$i/selected")
+        for (node in list) {
+            val entry = node as? Map<*, *> ?: continue
+            val type = entry["type"] as? String ?: continue
+            val id = (entry["id"] as? Long)?.toInt() ?: 0
+            val title = entry["title"] as? String
+            val lang = entry["lang"] as? String
+            val isSelected = entry["selected"] as? Boolean ?: false
             val label = title ?: lang ?: "#$id"
 
             when (type) {
@@ -194,15 +196,16 @@ internal class MpvMediaMetadata(private val handle: MPVHandle) : MediaMetadata {
 
     /** Re-reads mpv's "chapter-list". Called from the mpv event thread on change notification. */
     fun refreshChapters() {
-        val count = handle.getPropertyInt("chapter-list/count")
-        if (count <= 0) {
+        val list = handle.getPropertyNode("chapter-list") as? List<*>
+        if (list.isNullOrEmpty()) {
             chapters.value = emptyList()
             return
         }
         val durationMillis = (handle.getPropertyDouble("duration") * 1000).toLong()
-        val offsets = (0 until count).map { i ->
-            val title = handle.getPropertyString("chapter-list/$i/title") ?: "Chapter ${i + 1}"
-            val offsetMillis = (handle.getPropertyDouble("chapter-list/$i/time") * 1000).toLong()
+        val offsets = list.mapIndexed { i, node ->
+            val entry = node as? Map<*, *>
+            val title = entry?.get("title") as? String ?: "Chapter ${i + 1}"
+            val offsetMillis = (((entry?.get("time") as? Number)?.toDouble() ?: 0.0) * 1000).toLong()
             title to offsetMillis
         }
         chapters.value = offsets.mapIndexed { i, (title, offsetMillis) ->
@@ -0,0 +1,26 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+/**
+ * Which contents [MPVHandle.configureSeekableInputDiskCache] deletes first when over budget.
+ */
+enum class SeekableInputDiskCachePolicy {
+    // Ordinals must match disk_eviction_policy in disk_cache.h.
+
+    /**
+     * Contents not used for the longest time.
+     */
+    LEAST_RECENTLY_USED,
+
+    /**
+     * Contents first cached the longest time ago.
+     */
+    OLDEST_FIRST,
+}
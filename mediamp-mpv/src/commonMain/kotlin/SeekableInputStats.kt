@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+/**
+ * I/O counters of a [SeekableInput][org.openani.mediamp.io.SeekableInput] registered with [MPVHandle.registerSeekableInput].
+ *
+ * A snapshot taken by [MPVHandle.getSeekableInputStats]; it does not update.
+ * Counters accumulate from registration; diff two snapshots to look at an interval.
+ *
+ * To tell where a stutter comes from:
+ * - demuxer starvation shows as a high [readLatencyP99Micros] with most of the time in [inputBlockedNanos];
+ * - JNI overhead shows as many [inputReads], or a growing [jniAttaches];
+ * - contention on the stream lock shows as [lockWaitNanos].
+ */
+class SeekableInputStats internal constructor(
+    private val values: LongArray,
+) {
+    /**
+     * mpv reads served by the read-ahead cache without waiting.
+     */
+    val cacheHits: Long get() = values[INDEX_CACHE_HITS]
+
+    /**
+     * mpv reads that had to wait for the read-ahead thread to fetch their bytes.
+     */
+    val cacheMisses: Long get() = values[INDEX_CACHE_MISSES]
+
+    /**
+     * Read-ahead blocks loaded from the disk cache instead of being read from the input.
+     */
+    val diskBlocksLoaded: Long get() = values[INDEX_DISK_BLOCKS_LOADED]
+
+    /**
+     * Read calls made by mpv.
+     */
+    val readCalls: Long get() = values[INDEX_READ_CALLS]
+
+    /**
+     * Bytes returned to mpv.
+     */
+    val readBytes: Long get() = values[INDEX_READ_BYTES]
+
+    /**
+     * mpv reads that failed.
+     */
+    val readErrors: Long get() = values[INDEX_READ_ERRORS]
+
+    /**
+     * Seek calls made by mpv.
+     */
+    val seekCalls: Long get() = values[INDEX_SEEK_CALLS]
+
+    /**
+     * [SeekableInput.read][org.openani.mediamp.io.SeekableInput.read] calls, i.e. upcalls into the input.
+     * Lower than [readCalls] when small reads are coalesced or served by the read-ahead cache.
+     */
+    val inputReads: Long get() = values[INDEX_INPUT_READS]
+
+    /**
+     * [SeekableInput.seekTo][org.openani.mediamp.io.SeekableInput.seekTo] calls that reached the input.
+     */
+    val inputSeeks: Long get() = values[INDEX_INPUT_SEEKS]
+
+    /**
+     * mpv seeks that never reached the input, because the bytes were cached or the input was already there.
+     */
+    val elidedSeeks: Long get() = values[INDEX_ELIDED_SEEKS]
+
+    /**
+     * Times a native thread had to be attached to the JVM to call the input.
+     */
+    val jniAttaches: Long get() = values[INDEX_JNI_ATTACHES]
+
+    /**
+     * Median duration of mpv's read calls, in microseconds, rounded up to a power of two.
+     */
+    val readLatencyP50Micros: Long get() = values[INDEX_READ_LATENCY_P50]
+
+    /**
+     * 99th percentile duration of mpv's read calls, in microseconds, rounded up to a power of two.
+     */
+    val readLatencyP99Micros: Long get() = values[INDEX_READ_LATENCY_P99]
+
+    /**
+     * Slowest read call made by mpv, in microseconds.
+     */
+    val readLatencyMaxMicros: Long get() = values[INDEX_READ_LATENCY_MAX]
+
+    /**
+     * Time spent inside [SeekableInput.read][org.openani.mediamp.io.SeekableInput.read] and `seekTo`,
+     * on mpv's thread and on the read-ahead thread.
+     */
+    val inputBlockedNanos: Long get() = values[INDEX_INPUT_BLOCKED_NANOS]
+
+    /**
+     * Time spent copying bytes from the JVM into native memory.
+     */
+    val copyNanos: Long get() = values[INDEX_COPY_NANOS]
+
+    /**
+     * Time spent waiting for the lock that serializes access to the input.
+     */
+    val lockWaitNanos: Long get() = values[INDEX_LOCK_WAIT_NANOS]
+
+    override fun toString(): String {
+        return "SeekableInputStats(cacheHits=$cacheHits, cacheMisses=$cacheMisses, " +
+                "readCalls=$readCalls, readBytes=$readBytes, readErrors=$readErrors, inputReads=$inputReads, " +
+                "seekCalls=$seekCalls, inputSeeks=$inputSeeks, elidedSeeks=$elidedSeeks, jniAttaches=$jniAttaches, " +
+                "readLatencyP50Micros=$readLatencyP50Micros, readLatencyP99Micros=$readLatencyP99Micros, " +
+                "readLatencyMaxMicros=$readLatencyMaxMicros, inputBlockedNanos=$inputBlockedNanos, " +
+                "copyNanos=$copyNanos, lockWaitNanos=$lockWaitNanos, diskBlocksLoaded=$diskBlocksLoaded)"
+    }
+
+    private companion object {
+        // Must match the order in mpv_handle_t::get_seekable_input_stats and stream_io_stats::append_to.
+        const val INDEX_CACHE_HITS = 0
+        const val INDEX_CACHE_MISSES = 1
+        const val INDEX_READ_CALLS = 2
+        const val INDEX_READ_BYTES = 3
+        const val INDEX_READ_ERRORS = 4
+        const val INDEX_SEEK_CALLS = 5
+        const val INDEX_INPUT_SEEKS = 6
+        const val INDEX_ELIDED_SEEKS = 7
+        const val INDEX_JNI_ATTACHES = 8
+        const val INDEX_READ_LATENCY_P50 = 9
+        const val INDEX_READ_LATENCY_P99 = 10
+        const val INDEX_READ_LATENCY_MAX = 11
+        const val INDEX_INPUT_BLOCKED_NANOS = 12
+        const val INDEX_COPY_NANOS = 13
+        const val INDEX_LOCK_WAIT_NANOS = 14
+        const val INDEX_INPUT_READS = 15
+        const val INDEX_DISK_BLOCKS_LOADED = 16
+    }
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv.internal
+
+/**
+ * Decodes a flattened `mpv_node` tree, as written by `node_codec.cpp`, in one pass.
+ *
+ * Nodes become [String], [Boolean], [Long], [Double], [List], [Map] (with [String] keys, in mpv's order)
+ * or [ByteArray]; `MPV_FORMAT_NONE` becomes `null`.
+ */
+internal fun decodeMpvNode(bytes: ByteArray): Any? = MpvNodeReader(bytes).readNode()
+
+private class MpvNodeReader(private val bytes: ByteArray) {
+    private var position = 0
+
+    fun readNode(): Any? = when (val tag = bytes[position++].toInt()) {
+        FORMAT_NONE -> null
+        FORMAT_STRING -> readString()
+        FORMAT_FLAG -> bytes[position++].toInt() != 0
+        FORMAT_INT64 -> readLong()
+        FORMAT_DOUBLE -> Double.fromBits(readLong())
+        FORMAT_NODE_ARRAY -> List(readInt()) { readNode() }
+        FORMAT_NODE_MAP -> {
+            val count = readInt()
+            LinkedHashMap<String, Any?>(count).apply {
+                repeat(count) {
+                    val key = readString()
+                    put(key, readNode())
+                }
+            }
+        }
+
+        FORMAT_BYTE_ARRAY -> {
+            val length = readInt()
+            bytes.copyOfRange(position, position + length).also { position += length }
+        }
+
+        else -> error("Unknown mpv node format $tag at offset ${position - 1}")
+    }
+
+    private fun readString(): String {
+        val length = readInt()
+        return bytes.decodeToString(position, position + length).also { position += length }
+    }
+
+    private fun readInt(): Int {
+        var value = 0
+        for (i in 0 until 4) value = value or ((bytes[position + i].toInt() and 0xff) shl (8 * i))
+        position += 4
+        return value
+    }
+
+    private fun readLong(): Long {
+        var value = 0L
+        for (i in 0 until 8) value = value or ((bytes[position + i].toLong() and 0xff) shl (8 * i))
+        position += 8
+        return value
+    }
+
+    private companion object {
+        // mpv_format
+        const val FORMAT_NONE = 0
+        const val FORMAT_STRING = 1
+        const val FORMAT_FLAG = 3
+        const val FORMAT_INT64 = 4
+        const val FORMAT_DOUBLE = 5
+        const val FORMAT_NODE_ARRAY = 7
+        const val FORMAT_NODE_MAP = 8
+        const val FORMAT_BYTE_ARRAY = 9
+    }
+}
@@ -0,0 +1,752 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <unordered_map>
+#include "disk_cache.h"
+#include "log.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#include <winioctl.h>
+#else
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__ANDROID__) && !defined(__LP64__)
+// 32-bit bionic has a 32-bit off_t; use the explicit 64-bit variants so files over 2 GiB work.
+#define MEDIAMP_PREAD pread64
+#define MEDIAMP_PWRITE pwrite64
+#define MEDIAMP_FTRUNCATE ftruncate64
+#define MEDIAMP_OFF_T off64_t
+#else
+#define MEDIAMP_PREAD pread
+#define MEDIAMP_PWRITE pwrite
+#define MEDIAMP_FTRUNCATE ftruncate
+#define MEDIAMP_OFF_T off_t
+#endif
+#endif
+
+namespace mediampv {
+
+namespace {
+
+constexpr char kMagic[8] = {'M', 'D', 'M', 'P', 'D', 'I', 'S', 'K'};
+constexpr uint32_t kVersion = 2;
+constexpr const char *kBlocksSuffix = ".blocks";
+constexpr const char *kIndexSuffix = ".index";
+
+// At the start of every `.index` file, followed by the content ID, the bitmap and the
+// block checksums.
+struct index_header final {
+    char magic[8];
+    uint32_t version;
+    uint32_t id_length;
+    int64_t size;
+    int64_t block_size;
+    int64_t created_ms;
+    int64_t last_access_ms;
+};
+
+int64_t now_millis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// File names must not depend on what the content ID looks like (URIs, slashes, length),
+// so they are a 64-bit FNV-1a hash of it; the ID itself is kept in the index to detect
+// collisions.
+std::string stem_of(const std::string &content_id) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : content_id) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    static constexpr char kDigits[] = "0123456789abcdef";
+    std::string stem(16, '0');
+    for (int i = 15; i >= 0; --i) {
+        stem[static_cast<size_t>(i)] = kDigits[hash & 0xF];
+        hash >>= 4;
+    }
+    return stem;
+}
+
+int64_t block_count_of(int64_t size, int64_t block_size) {
+    return (size + block_size - 1) / block_size;
+}
+
+size_t bitmap_bytes_of(int64_t size, int64_t block_size) {
+    return static_cast<size_t>((size / block_size + 8) / 8);
+}
+
+// Checksum of a stored block, kept in the index next to its bit. Not cryptographic: it
+// only has to catch a block that did not reach the disk whole.
+uint32_t checksum_of(const char *data, int64_t length) {
+    uint64_t hash = 14695981039346656037ull;
+    int64_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+    for (; i < length; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 1099511628211ull;
+    }
+    return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+// Bytes of block `index`: `block_size`, except for the last block, which holds the rest.
+int64_t block_length_of(int64_t index, int64_t size, int64_t block_size) {
+    return std::min(block_size, size - index * block_size);
+}
+
+// Bytes of the blocks set in `bitmap`, counted the way writes reserve them.
+int64_t stored_bytes_of(const std::vector<uint8_t> &bitmap, int64_t size, int64_t block_size) {
+    const int64_t blocks = block_count_of(size, block_size);
+    int64_t bytes = 0;
+    for (int64_t index = 0; index < blocks; ++index) {
+        if (bitmap[static_cast<size_t>(index / 8)] & (1u << (index % 8))) {
+            bytes += block_length_of(index, size, block_size);
+        }
+    }
+    return bytes;
+}
+
+// Whether `name` looks like what `stem_of` makes. Anything else in the directory is not
+// ours and is left alone.
+template<typename Char>
+bool is_stem(const Char *name, size_t length) {
+    if (length != 16) {
+        return false;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        const Char c = name[i];
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+
+std::wstring to_wide(const std::string &path) {
+    const int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    if (length <= 0) {
+        return std::wstring();
+    }
+    std::wstring wide(static_cast<size_t>(length), L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wide[0], length);
+    wide.resize(static_cast<size_t>(length - 1));
+    return wide;
+}
+
+void make_directory(const std::string &path) {
+    CreateDirectoryW(to_wide(path).c_str(), nullptr);
+}
+
+void remove_file(const std::string &path) {
+    DeleteFileW(to_wide(path).c_str());
+}
+
+// Stems of the contents stored in `directory`, skipping files that are not ours.
+std::vector<std::string> list_stems(const std::string &directory) {
+    std::vector<std::string> stems;
+    WIN32_FIND_DATAW data;
+    HANDLE find = FindFirstFileW(to_wide(directory + "\\*" + kIndexSuffix).c_str(), &data);
+    if (find == INVALID_HANDLE_VALUE) {
+        return stems;
+    }
+    do {
+        std::wstring name(data.cFileName);
+        const size_t dot = name.rfind(L'.');
+        if (dot != std::wstring::npos && is_stem(name.c_str(), dot)) {
+            stems.emplace_back(name.begin(), name.begin() + static_cast<std::ptrdiff_t>(dot));
+        }
+    } while (FindNextFileW(find, &data));
+    FindClose(find);
+    return stems;
+}
+
+constexpr char kPathSeparator = '\\';
+
+#else
+
+void make_directory(const std::string &path) {
+    mkdir(path.c_str(), 0700);
+}
+
+void remove_file(const std::string &path) {
+    unlink(path.c_str());
+}
+
+// Stems of the contents stored in `directory`, skipping files that are not ours.
+std::vector<std::string> list_stems(const std::string &directory) {
+    std::vector<std::string> stems;
+    DIR *dir = opendir(directory.c_str());
+    if (!dir) {
+        return stems;
+    }
+    const size_t suffix_length = std::strlen(kIndexSuffix);
+    while (const dirent *entry = readdir(dir)) {
+        const std::string name(entry->d_name);
+        if (name.size() > suffix_length &&
+            name.compare(name.size() - suffix_length, suffix_length, kIndexSuffix) == 0 &&
+            is_stem(name.c_str(), name.size() - suffix_length)) {
+            stems.push_back(name.substr(0, name.size() - suffix_length));
+        }
+    }
+    closedir(dir);
+    return stems;
+}
+
+constexpr char kPathSeparator = '/';
+
+#endif
+
+} // namespace
+
+// A read-write file with exact positional reads and writes.
+struct disk_cache::file final {
+#if defined(_WIN32) || defined(_WIN64)
+    explicit file(HANDLE handle) : handle(handle) {}
+
+    ~file() {
+        CloseHandle(handle);
+    }
+
+    static std::unique_ptr<file> open(const std::string &path, bool sparse) {
+        HANDLE handle = CreateFileW(
+                to_wide(path).c_str(),
+                GENERIC_READ | GENERIC_WRITE,
+                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                nullptr,
+                OPEN_ALWAYS,
+                FILE_ATTRIBUTE_NORMAL,
+                nullptr);
+        if (handle == INVALID_HANDLE_VALUE) {
+            return nullptr;
+        }
+        if (sparse) {
+            // NTFS zero-fills the gap before a write past the end unless the file is sparse.
+            DWORD returned = 0;
+            DeviceIoControl(handle, FSCTL_SET_SPARSE, nullptr, 0, nullptr, 0, &returned, nullptr);
+        }
+        std::unique_ptr<file> result(new (std::nothrow) file(handle));
+        if (!result) {
+            CloseHandle(handle);
+        }
+        return result;
+    }
+
+    bool read_at(int64_t offset, void *buffer, int64_t length) {
+        auto *destination = static_cast<char *>(buffer);
+        while (length > 0) {
+            OVERLAPPED overlapped{};
+            overlapped.Offset = static_cast<DWORD>(static_cast<uint64_t>(offset) & 0xFFFFFFFFu);
+            overlapped.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(offset) >> 32);
+            DWORD done = 0;
+            const auto chunk = static_cast<DWORD>(std::min<int64_t>(length, std::numeric_limits<DWORD>::max()));
+            if (!ReadFile(handle, destination, chunk, &done, &overlapped) || done == 0) {
+                return false;
+            }
+            destination += done;
+            offset += done;
+            length -= done;
+        }
+        return true;
+    }
+
+    bool write_at(int64_t offset, const void *buffer, int64_t length) {
+        const auto *source = static_cast<const char *>(buffer);
+        while (length > 0) {
+            OVERLAPPED overlapped{};
+            overlapped.Offset = static_cast<DWORD>(static_cast<uint64_t>(offset) & 0xFFFFFFFFu);
+            overlapped.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(offset) >> 32);
+            DWORD done = 0;
+            const auto chunk = static_cast<DWORD>(std::min<int64_t>(length, std::numeric_limits<DWORD>::max()));
+            if (!WriteFile(handle, source, chunk, &done, &overlapped) || done == 0) {
+                return false;
+            }
+            source += done;
+            offset += done;
+            length -= done;
+        }
+        return true;
+    }
+
+    bool truncate(int64_t size) {
+        LARGE_INTEGER position;
+        position.QuadPart = size;
+        return SetFilePointerEx(handle, position, nullptr, FILE_BEGIN) && SetEndOfFile(handle);
+    }
+
+    HANDLE handle;
+#else
+    explicit file(int fd) : fd(fd) {}
+
+    ~file() {
+        close(fd);
+    }
+
+    static std::unique_ptr<file> open(const std::string &path, bool /* sparse */) {
+        int fd;
+        do {
+            fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        } while (fd < 0 && errno == EINTR);
+        if (fd < 0) {
+            return nullptr;
+        }
+        std::unique_ptr<file> result(new (std::nothrow) file(fd));
+        if (!result) {
+            close(fd);
+        }
+        return result;
+    }
+
+    bool read_at(int64_t offset, void *buffer, int64_t length) {
+        auto *destination = static_cast<char *>(buffer);
+        while (length > 0) {
+            const ssize_t done = MEDIAMP_PREAD(fd, destination, static_cast<size_t>(length), static_cast<MEDIAMP_OFF_T>(offset));
+            if (done < 0 && errno == EINTR) {
+                continue;
+            }
+            if (done <= 0) {
+                return false;
+            }
+            destination += done;
+            offset += done;
+            length -= done;
+        }
+        return true;
+    }
+
+    bool write_at(int64_t offset, const void *buffer, int64_t length) {
+        const auto *source = static_cast<const char *>(buffer);
+        while (length > 0) {
+            const ssize_t done = MEDIAMP_PWRITE(fd, source, static_cast<size_t>(length), static_cast<MEDIAMP_OFF_T>(offset));
+            if (done < 0 && errno == EINTR) {
+                continue;
+            }
+            if (done <= 0) {
+                return false;
+            }
+            source += done;
+            offset += done;
+            length -= done;
+        }
+        return true;
+    }
+
+    bool truncate(int64_t size) {
+        return MEDIAMP_FTRUNCATE(fd, static_cast<MEDIAMP_OFF_T>(size)) == 0;
+    }
+
+    int fd;
+#endif
+};
+
+// Process-wide state of the tier: configuration, the caches currently open, and how many
+// bytes all stored contents take.
+class disk_cache::registry final {
+public:
+    static registry &instance() {
+        // Leaked on purpose, like read_ahead_cache's store: caches may outlive static
+        // destructors at exit.
+        static auto *instance = new registry();
+        return *instance;
+    }
+
+    std::mutex mutex;
+    std::string directory;
+    int64_t budget = 0;
+    disk_eviction_policy policy = disk_eviction_policy::least_recently_used;
+    // Bytes of all stored blocks and of the blocks being written; only meaningful once the
+    // directory has been scanned.
+    int64_t usage = 0;
+    bool scanned = false;
+    // Bytes reserved by writes still in flight, which a rescan of the directory cannot see
+    // yet. A write that has set its bit but not settled is briefly counted twice.
+    int64_t pending = 0;
+    // Set when eviction could not make room; cleared when a content is closed, since only
+    // closed contents can be evicted.
+    bool exhausted = false;
+    std::unordered_map<std::string, std::weak_ptr<disk_cache>> caches;
+
+    std::string path_of(const std::string &stem, const char *suffix) const {
+        return directory + kPathSeparator + stem + suffix;
+    }
+
+    // Reads the header, ID, bitmap and, when `checksums` is given, the checksums of an
+    // index file. Returns false when it is not a valid index.
+    static bool read_index(
+            file &index,
+            index_header &header,
+            std::string &content_id,
+            std::vector<uint8_t> &bitmap,
+            std::vector<uint32_t> *checksums) {
+        if (!index.read_at(0, &header, sizeof(header)) ||
+            std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+            header.version != kVersion ||
+            header.size <= 0 || header.block_size <= 0 ||
+            header.id_length > 64 * 1024) {
+            return false;
+        }
+        content_id.assign(header.id_length, '\0');
+        if (header.id_length > 0 && !index.read_at(sizeof(header), &content_id[0], header.id_length)) {
+            return false;
+        }
+        bitmap.assign(bitmap_bytes_of(header.size, header.block_size), 0);
+        const int64_t bitmap_offset = sizeof(header) + header.id_length;
+        if (!index.read_at(bitmap_offset, bitmap.data(), static_cast<int64_t>(bitmap.size()))) {
+            return false;
+        }
+        if (!checksums) {
+            return true;
+        }
+        checksums->assign(static_cast<size_t>(block_count_of(header.size, header.block_size)), 0);
+        return index.read_at(
+                bitmap_offset + static_cast<int64_t>(bitmap.size()),
+                checksums->data(),
+                static_cast<int64_t>(checksums->size() * sizeof(uint32_t)));
+    }
+
+    // Makes room for `bytes` more, evicting closed contents. A successful reservation must
+    // be settled once the write is done. Must be called with `mutex` held.
+    bool reserve(int64_t bytes, const void *instance_handle) {
+        if (!scanned) {
+            evict(0, instance_handle);
+        }
+        if (usage + bytes <= budget) {
+            usage += bytes;
+            pending += bytes;
+            return true;
+        }
+        if (exhausted) {
+            return false;
+        }
+        evict(bytes, instance_handle);
+        if (usage + bytes <= budget) {
+            usage += bytes;
+            pending += bytes;
+            return true;
+        }
+        LOG(instance_handle, LOG_LEVEL_INFO,
+            "disk cache: budget of %lld bytes is taken by open contents, not storing new blocks",
+            static_cast<long long>(budget));
+        exhausted = true;
+        return false;
+    }
+
+    // Settles a reservation: the bytes stay counted only if they were `stored`. Must be
+    // called with `mutex` held.
+    void settle(int64_t bytes, bool stored) {
+        pending -= bytes;
+        if (!stored) {
+            release(bytes);
+        }
+    }
+
+    // Stored bytes that are gone. Must be called with `mutex` held.
+    void release(int64_t bytes) {
+        usage = std::max<int64_t>(0, usage - bytes);
+    }
+
+    // Rescans the directory, recomputing `usage`, and deletes closed contents in policy
+    // order until `needed` more bytes fit in the budget. Must be called with `mutex` held.
+    void evict(int64_t needed, const void *instance_handle) {
+        struct candidate final {
+            std::string stem;
+            int64_t bytes;
+            int64_t order;
+        };
+        std::vector<candidate> candidates;
+        usage = pending;
+        scanned = true;
+        for (const auto &stem : list_stems(directory)) {
+            auto index = file::open(path_of(stem, kIndexSuffix), false);
+            index_header header{};
+            std::string content_id;
+            std::vector<uint8_t> bitmap;
+            if (!index || !read_index(*index, header, content_id, bitmap, nullptr)) {
+                // Named like ours but torn; take it out of the way.
+                index.reset();
+                remove_content(stem);
+                continue;
+            }
+            const int64_t bytes = stored_bytes_of(bitmap, header.size, header.block_size);
+            usage += bytes;
+            auto open = caches.find(stem);
+            if (open == caches.end() || open->second.expired()) {
+                const int64_t order = policy == disk_eviction_policy::oldest_first
+                                      ? header.created_ms
+                                      : header.last_access_ms;
+                candidates.push_back({stem, bytes, order});
+            }
+        }
+
+        std::sort(candidates.begin(), candidates.end(), [](const candidate &a, const candidate &b) {
+            return a.order < b.order;
+        });
+        for (const auto &victim : candidates) {
+            if (usage + needed <= budget) {
+                break;
+            }
+            remove_content(victim.stem);
+            usage -= victim.bytes;
+            LOG(instance_handle, LOG_LEVEL_DEBUG,
+                "disk cache: evicted %s (%lld bytes)", victim.stem.c_str(), static_cast<long long>(victim.bytes));
+        }
+    }
+
+    void remove_content(const std::string &stem) {
+        remove_file(path_of(stem, kIndexSuffix));
+        remove_file(path_of(stem, kBlocksSuffix));
+    }
+};
+
+void disk_cache::configure(
+        const char *directory,
+        int64_t budget,
+        disk_eviction_policy policy,
+        const void *instance_handle) {
+    auto &registry = registry::instance();
+    std::lock_guard<std::mutex> guard(registry.mutex);
+    registry.directory = directory ? directory : "";
+    while (registry.directory.size() > 1 &&
+           (registry.directory.back() == '/' || registry.directory.back() == kPathSeparator)) {
+        registry.directory.pop_back();
+    }
+    registry.budget = std::max<int64_t>(budget, 0);
+    registry.policy = policy;
+    registry.scanned = false;
+    registry.exhausted = false;
+    if (registry.directory.empty()) {
+        return;
+    }
+
+    make_directory(registry.directory);
+    registry.evict(0, instance_handle);
+}
+
+std::shared_ptr<disk_cache> disk_cache::open(
+        const std::string &content_id,
+        int64_t size,
+        int64_t block_size,
+        const void *instance_handle) {
+    if (content_id.empty() || size <= 0 || block_size <= 0) {
+        return nullptr;
+    }
+
+    // Declared before the guard: if it turns out to be the last reference, its destructor
+    // takes the registry lock and must run after the guard is gone.
+    std::shared_ptr<disk_cache> existing;
+    auto &registry = registry::instance();
+    std::lock_guard<std::mutex> guard(registry.mutex);
+    if (registry.directory.empty() || registry.budget <= 0) {
+        return nullptr;
+    }
+
+    const std::string stem = stem_of(content_id);
+    auto open = registry.caches.find(stem);
+    if (open != registry.caches.end() && (existing = open->second.lock())) {
+        if (existing->content_id_ == content_id && existing->size_ == size && existing->block_size_ == block_size) {
+            return existing;
+        }
+        LOG(instance_handle, LOG_LEVEL_WARN,
+            "disk cache: %s collides with an open content, not caching it", content_id.c_str());
+        return nullptr;
+    }
+
+    auto blocks = file::open(registry.path_of(stem, kBlocksSuffix), true);
+    auto index = file::open(registry.path_of(stem, kIndexSuffix), false);
+    if (!blocks || !index) {
+        LOG(instance_handle, LOG_LEVEL_WARN,
+            "disk cache: cannot open the files of %s in %s", content_id.c_str(), registry.directory.c_str());
+        return nullptr;
+    }
+
+    index_header header{};
+    std::string stored_id;
+    std::vector<uint8_t> bitmap;
+    std::vector<uint32_t> checksums;
+    const bool readable = registry::read_index(*index, header, stored_id, bitmap, &checksums);
+    const int64_t now = now_millis();
+    if (!readable || stored_id != content_id || header.size != size || header.block_size != block_size) {
+        // New content, a hash collision, or the content changed: start over.
+        if (readable && registry.scanned) {
+            registry.release(stored_bytes_of(bitmap, header.size, header.block_size));
+        }
+        header = index_header{};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.id_length = static_cast<uint32_t>(content_id.size());
+        header.size = size;
+        header.block_size = block_size;
+        header.created_ms = now;
+        bitmap.assign(bitmap_bytes_of(size, block_size), 0);
+        checksums.assign(static_cast<size_t>(block_count_of(size, block_size)), 0);
+        const int64_t bitmap_offset = static_cast<int64_t>(sizeof(header) + content_id.size());
+        if (!blocks->truncate(0) || !index->truncate(0) ||
+            !index->write_at(sizeof(header), content_id.data(), static_cast<int64_t>(content_id.size())) ||
+            !index->write_at(bitmap_offset, bitmap.data(), static_cast<int64_t>(bitmap.size())) ||
+            !index->write_at(
+                    bitmap_offset + static_cast<int64_t>(bitmap.size()),
+                    checksums.data(),
+                    static_cast<int64_t>(checksums.size() * sizeof(uint32_t)))) {
+            LOG(instance_handle, LOG_LEVEL_WARN, "disk cache: cannot initialize the files of %s", content_id.c_str());
+            return nullptr;
+        }
+    }
+    header.last_access_ms = now;
+    // Written last: an index whose header is torn fails validation and is started over.
+    if (!index->write_at(0, &header, sizeof(header))) {
+        LOG(instance_handle, LOG_LEVEL_WARN, "disk cache: cannot update the index of %s", content_id.c_str());
+        return nullptr;
+    }
+
+    std::shared_ptr<disk_cache> cache(new (std::nothrow) disk_cache(
+            registry, stem, content_id, std::move(blocks), std::move(index),
+            static_cast<int64_t>(sizeof(header) + content_id.size()), std::move(bitmap), std::move(checksums),
+            size, block_size, instance_handle));
+    if (cache) {
+        registry.caches[stem] = cache;
+    }
+    return cache;
+}
+
+disk_cache::disk_cache(
+        registry &registry,
+        std::string stem,
+        std::string content_id,
+        std::unique_ptr<file> blocks,
+        std::unique_ptr<file> index,
+        int64_t bitmap_offset,
+        std::vector<uint8_t> bitmap,
+        std::vector<uint32_t> checksums,
+        int64_t size,
+        int64_t block_size,
+        const void *instance_handle)
+        : registry_(registry),
+          stem_(std::move(stem)),
+          content_id_(std::move(content_id)),
+          blocks_(std::move(blocks)),
+          index_(std::move(index)),
+          bitmap_offset_(bitmap_offset),
+          checksums_offset_(bitmap_offset + static_cast<int64_t>(bitmap.size())),
+          size_(size),
+          block_size_(block_size),
+          instance_handle_(instance_handle),
+          bitmap_(std::move(bitmap)),
+          checksums_(std::move(checksums)) {}
+
+disk_cache::~disk_cache() {
+    // In use until now: with least_recently_used, a content watched for an hour must not go
+    // before one only opened after it was.
+    const int64_t now = now_millis();
+    index_->write_at(offsetof(index_header, last_access_ms), &now, sizeof(now));
+
+    std::lock_guard<std::mutex> guard(registry_.mutex);
+    auto open = registry_.caches.find(stem_);
+    if (open != registry_.caches.end() && open->second.expired()) {
+        registry_.caches.erase(open);
+    }
+    // This content can be evicted now.
+    registry_.exhausted = false;
+}
+
+bool disk_cache::has_block(int64_t index) const {
+    const auto byte = static_cast<size_t>(index / 8);
+    return index >= 0 && byte < bitmap_.size() && (bitmap_[byte] & (1u << (index % 8))) != 0;
+}
+
+bool disk_cache::read_block(int64_t index, char *buffer, int64_t length) {
+    uint32_t checksum;
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (!has_block(index)) {
+            return false;
+        }
+        checksum = checksums_[static_cast<size_t>(index)];
+    }
+    if (!blocks_->read_at(index * block_size_, buffer, length)) {
+        drop_block(index, "cannot read");
+        return false;
+    }
+    if (checksum_of(buffer, length) != checksum) {
+        drop_block(index, "checksum mismatch in");
+        return false;
+    }
+    return true;
+}
+
+void disk_cache::drop_block(int64_t index, const char *reason) {
+    LOG(instance_handle_, LOG_LEVEL_WARN,
+        "disk cache: %s block %lld of %s, fetching it again", reason, static_cast<long long>(index), stem_.c_str());
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (!has_block(index)) {
+            return;
+        }
+        const auto byte = static_cast<size_t>(index / 8);
+        bitmap_[byte] = static_cast<uint8_t>(bitmap_[byte] & ~(1u << (index % 8)));
+        index_->write_at(bitmap_offset_ + static_cast<int64_t>(byte), &bitmap_[byte], 1);
+    }
+    std::lock_guard<std::mutex> guard(registry_.mutex);
+    registry_.release(block_length_of(index, size_, block_size_));
+}
+
+void disk_cache::write_block(int64_t index, const char *buffer, int64_t length) {
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        // Only whole blocks are stored, so that what a write reserves is what a rescan of
+        // the directory counts.
+        if (index < 0 || index >= static_cast<int64_t>(checksums_.size()) || has_block(index) ||
+            length != block_length_of(index, size_, block_size_) || !writing_.insert(index).second) {
+            return;
+        }
+    }
+    bool reserved;
+    {
+        std::lock_guard<std::mutex> guard(registry_.mutex);
+        reserved = registry_.reserve(length, instance_handle_);
+    }
+
+    bool stored = false;
+    if (reserved) {
+        if (blocks_->write_at(index * block_size_, buffer, length)) {
+            stored = true;
+        } else {
+            LOG(instance_handle_, LOG_LEVEL_WARN,
+                "disk cache: cannot write block %lld of %s", static_cast<long long>(index), stem_.c_str());
+        }
+    }
+    const uint32_t checksum = stored ? checksum_of(buffer, length) : 0;
+
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        writing_.erase(index);
+        // The checksum goes in before the bit: a set bit always comes with the checksum
+        // of what was written, whether or not the data itself made it to the disk.
+        if (stored && index_->write_at(
+                checksums_offset_ + index * static_cast<int64_t>(sizeof(uint32_t)), &checksum, sizeof(checksum))) {
+            checksums_[static_cast<size_t>(index)] = checksum;
+            const auto byte = static_cast<size_t>(index / 8);
+            bitmap_[byte] = static_cast<uint8_t>(bitmap_[byte] | (1u << (index % 8)));
+            index_->write_at(bitmap_offset_ + static_cast<int64_t>(byte), &bitmap_[byte], 1);
+        } else {
+            stored = false;
+        }
+    }
+    if (reserved) {
+        std::lock_guard<std::mutex> guard(registry_.mutex);
+        registry_.settle(length, stored);
+    }
+}
+
+} // namespace mediampv
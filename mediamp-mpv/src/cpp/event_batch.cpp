@@ -0,0 +1,198 @@
+#include <cstring>
+#include "event_batch.h"
+#include "log.h"
+#include "method_cache.h"
+#include "native_util.h"
+
+namespace mediampv {
+
+namespace {
+
+constexpr size_t kInitialCapacity = 16 * 1024;
+
+} // namespace
+
+event_batch::event_batch(JNIEnv *env, const void *instance_handle)
+    : env_(env), instance_handle_(instance_handle) {}
+
+event_batch::~event_batch() {
+    if (env_ && byte_buffer_) {
+        env_->DeleteGlobalRef(byte_buffer_);
+    }
+}
+
+void event_batch::append(const mpv_event *event, jobject dispatcher) {
+    append_records(event);
+    if (size_ >= kFlushThreshold) {
+        flush(dispatcher);
+    }
+}
+
+void event_batch::append_records(const mpv_event *event) {
+    if (!event) {
+        return;
+    }
+
+    switch (event->event_id) {
+        case MPV_EVENT_LOG_MESSAGE:
+            return;
+        case MPV_EVENT_PROPERTY_CHANGE: {
+            auto *prop = static_cast<const mpv_event_property *>(event->data);
+            if (!prop || !prop->name) {
+                return;
+            }
+            int64_t value = 0;
+            const char *string = nullptr;
+            switch (prop->format) {
+                case MPV_FORMAT_NONE:
+                    break;
+                case MPV_FORMAT_FLAG:
+                    if (!prop->data) return;
+                    value = *static_cast<const int *>(prop->data) != 0 ? 1 : 0;
+                    break;
+                case MPV_FORMAT_INT64:
+                    if (!prop->data) return;
+                    value = *static_cast<const int64_t *>(prop->data);
+                    break;
+                case MPV_FORMAT_DOUBLE:
+                    if (!prop->data) return;
+                    std::memcpy(&value, prop->data, sizeof(double));
+                    break;
+                case MPV_FORMAT_STRING:
+                    if (!prop->data || !*static_cast<const char *const *>(prop->data)) return;
+                    string = *static_cast<const char *const *>(prop->data);
+                    value = static_cast<int64_t>(std::strlen(string));
+                    break;
+                default:
+                    LOG(instance_handle_, LOG_LEVEL_DEBUG,
+                        "event_batch: unhandled property format %d for %s", prop->format, prop->name);
+                    return;
+            }
+            const int32_t name_id = intern(prop->name);
+            write_record(kind_property, name_id, prop->format, value,
+                         static_cast<int64_t>(event->reply_userdata),
+                         string, string ? static_cast<size_t>(value) : 0);
+            return;
+        }
+        default:
+            break;
+    }
+
+    write_record(kind_event, event->event_id, 0, 0, 0, nullptr, 0);
+    if (event->event_id == MPV_EVENT_START_FILE) {
+        // playlist_entry_id exists since libmpv API 1.108 (mpv 0.33); data may be null on
+        // older cores — forward 0 ("unknown") then.
+        auto *start_file = static_cast<const mpv_event_start_file *>(event->data);
+        write_record(kind_start_file, 0, 0, start_file ? start_file->playlist_entry_id : 0, 0, nullptr, 0);
+    } else if (event->event_id == MPV_EVENT_END_FILE) {
+        auto *end_file = static_cast<const mpv_event_end_file *>(event->data);
+        if (end_file) {
+            write_record(kind_end_file, end_file->reason, end_file->error, end_file->playlist_entry_id, 0,
+                         nullptr, 0);
+        }
+    }
+}
+
+void event_batch::flush(jobject dispatcher) {
+    if (size_ == 0) {
+        return;
+    }
+    const size_t size = size_;
+    size_ = 0;
+    if (!env_ || !dispatcher || !jni_mediamp_method_EventBatchDispatcher_dispatch || !ensure_byte_buffer()) {
+        // Names interned in the dropped records were never seen by Kotlin.
+        reset_names();
+        return;
+    }
+
+    env_->CallVoidMethod(dispatcher, jni_mediamp_method_EventBatchDispatcher_dispatch,
+                         byte_buffer_, static_cast<jint>(size));
+    clear_jni_exception(env_, instance_handle_, "EventBatchDispatcher.dispatch");
+}
+
+void event_batch::reset_names() {
+    names_.clear();
+}
+
+void event_batch::discard() {
+    size_ = 0;
+    reset_names();
+}
+
+char *event_batch::reserve(size_t length) {
+    if (size_ + length > capacity_) {
+        size_t capacity = capacity_ ? capacity_ : kInitialCapacity;
+        while (capacity < size_ + length) {
+            capacity *= 2;
+        }
+        std::unique_ptr<char[]> data(new char[capacity]);
+        if (size_ > 0) {
+            std::memcpy(data.get(), data_.get(), size_);
+        }
+        data_ = std::move(data);
+        capacity_ = capacity;
+    }
+    char *record = data_.get() + size_;
+    size_ += length;
+    return record;
+}
+
+void event_batch::write_record(
+        int32_t kind,
+        int32_t a,
+        int32_t b,
+        int64_t c,
+        int64_t d,
+        const char *bytes,
+        size_t length) {
+    const size_t record_size = align8(kHeaderSize + length);
+    char *record = reserve(record_size);
+    const auto size = static_cast<int32_t>(record_size);
+    std::memcpy(record, &kind, 4);
+    std::memcpy(record + 4, &size, 4);
+    std::memcpy(record + 8, &a, 4);
+    std::memcpy(record + 12, &b, 4);
+    std::memcpy(record + 16, &c, 8);
+    std::memcpy(record + 24, &d, 8);
+    if (length > 0) {
+        std::memcpy(record + kHeaderSize, bytes, length);
+    }
+}
+
+int32_t event_batch::intern(const char *name) {
+    auto it = names_.find(name);
+    if (it != names_.end()) {
+        return it->second;
+    }
+    const auto id = static_cast<int32_t>(names_.size());
+    names_.emplace(name, id);
+    const size_t length = std::strlen(name);
+    write_record(kind_name, id, static_cast<int32_t>(length), 0, 0, name, length);
+    return id;
+}
+
+bool event_batch::ensure_byte_buffer() {
+    if (byte_buffer_ && byte_buffer_capacity_ == capacity_) {
+        return true;
+    }
+    if (byte_buffer_) {
+        env_->DeleteGlobalRef(byte_buffer_);
+        byte_buffer_ = nullptr;
+        byte_buffer_capacity_ = 0;
+    }
+
+    jobject local = env_->NewDirectByteBuffer(data_.get(), static_cast<jlong>(capacity_));
+    if (clear_jni_exception(env_, instance_handle_, "NewDirectByteBuffer(event batch)") || !local) {
+        return false;
+    }
+    byte_buffer_ = env_->NewGlobalRef(local);
+    env_->DeleteLocalRef(local);
+    if (clear_jni_exception(env_, instance_handle_, "NewGlobalRef(event batch)") || !byte_buffer_) {
+        byte_buffer_ = nullptr;
+        return false;
+    }
+    byte_buffer_capacity_ = capacity_;
+    return true;
+}
+
+} // namespace mediampv
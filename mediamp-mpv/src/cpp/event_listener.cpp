@@ -1,5 +1,7 @@
 #include "mpv_handle_t.h"
+#include "event_batch.h"
 #include "method_cache.h"
+#include "native_util.h"
 
 namespace mediampv {
 
@@ -40,61 +42,55 @@ private:
     bool attached = false;
 };
 
-bool clear_jni_exception(JNIEnv *env, const void *instance_handle, const char *context) {
-    if (!env || !env->ExceptionCheck()) {
-        return false;
-    }
-
-    // Describe + clear first, then log: logging goes through the JNI dispatcher, which
-    // cannot run while an exception is pending. This surfaces the failure to the Kotlin
-    // sink instead of silently swallowing it.
-    env->ExceptionDescribe();
-    env->ExceptionClear();
-    LOG(instance_handle, LOG_LEVEL_ERROR, "JNI exception in %s", context);
-    return true;
-}
-
 } // namespace
 
+// Calls the keyed callback (EventListener.onPropertyNone etc.) for `prop`, with the ID it
+// was observed with, as event_batch does for an EventBatchDispatcher.
 static void emit_property_change(
         JNIEnv *env,
         mpv_handle_t *instance,
         mpv_event_property *prop,
+        uint64_t reply_userdata,
         jobject event_listener) {
     // jni_cache_classes is all-or-nothing, so a non-null class implies all the
-    // onPropertyChange method IDs are non-null; checking it here keeps the CallVoidMethod
+    // onProperty* method IDs are non-null; checking it here keeps the CallVoidMethod
     // calls below from ever passing a null jmethodID (which would abort).
     if (!env || !prop || !prop->name || !event_listener || !jni_mediamp_clazz_EventListener) {
         return;
     }
 
+    const auto id = static_cast<jlong>(reply_userdata);
     jstring prop_name = env->NewStringUTF(prop->name);
     jstring value = nullptr;
 
     switch (prop->format) {
         case MPV_FORMAT_NONE:
             env->CallVoidMethod(event_listener,
-                                jni_mediamp_method_EventListener_onPropertyChange_NONE,
+                                jni_mediamp_method_EventListener_onPropertyNone,
+                                id,
                                 prop_name);
             break;
         case MPV_FORMAT_FLAG:
             if (!prop->data) break;
             env->CallVoidMethod(event_listener,
-                                jni_mediamp_method_EventListener_onPropertyChange_FLAG,
+                                jni_mediamp_method_EventListener_onPropertyFlag,
+                                id,
                                 prop_name,
                                 (jboolean) (*(int *) prop->data != 0));
             break;
         case MPV_FORMAT_INT64:
             if (!prop->data) break;
             env->CallVoidMethod(event_listener,
-                                jni_mediamp_method_EventListener_onPropertyChange_INT64,
+                                jni_mediamp_method_EventListener_onPropertyInt64,
+                                id,
                                 prop_name,
-                               (jlong) *(int64_t *) prop->data);
+                                (jlong) *(int64_t *) prop->data);
             break;
         case MPV_FORMAT_DOUBLE:
             if (!prop->data) break;
             env->CallVoidMethod(event_listener,
-                                jni_mediamp_method_EventListener_onPropertyChange_DOUBLE,
+                                jni_mediamp_method_EventListener_onPropertyDouble,
+                                id,
                                 prop_name,
                                 (jdouble) *(double *) prop->data);
             break;
@@ -102,7 +98,8 @@ static void emit_property_change(
             if (!prop->data || !*(const char **) prop->data) break;
             value = env->NewStringUTF(*(const char **) prop->data);
             env->CallVoidMethod(event_listener,
-                                jni_mediamp_method_EventListener_onPropertyChange_STRING,
+                                jni_mediamp_method_EventListener_onPropertyString,
+                                id,
                                 prop_name,
                                 value);
             break;
@@ -111,7 +108,7 @@ static void emit_property_change(
                 "emit_property_change: unhandled property format %d for %s", prop->format, prop->name);
             break;
     }
-    clear_jni_exception(env, instance, "EventListener.onPropertyChange");
+    clear_jni_exception(env, instance, "EventListener.onProperty*");
 
     if (prop_name) env->DeleteLocalRef(prop_name);
     if (value) env->DeleteLocalRef(value);
@@ -129,6 +126,53 @@ static void emit_log_message(mpv_handle_t *instance, mpv_event_log_message *mess
                 message->text ? message->text : "");
 }
 
+// Delivers one event through the EventListener methods, for listeners that are not an
+// EventBatchDispatcher. Log messages are handled by the caller.
+static void emit_event(JNIEnv *env, mpv_handle_t *instance, const mpv_event *event, jobject event_listener) {
+    if (!env || !event_listener || !jni_mediamp_clazz_EventListener) {
+        return;
+    }
+
+    if (event->event_id != MPV_EVENT_PROPERTY_CHANGE) {
+        env->CallVoidMethod(
+                event_listener,
+                jni_mediamp_method_EventListener_onEvent,
+                static_cast<jint>(event->event_id));
+        clear_jni_exception(env, instance, "EventListener.onEvent");
+    }
+
+    switch (event->event_id) {
+        case MPV_EVENT_PROPERTY_CHANGE:
+            emit_property_change(env, instance, (mpv_event_property *) event->data, event->reply_userdata,
+                                 event_listener);
+            break;
+        case MPV_EVENT_START_FILE: {
+            // playlist_entry_id exists since libmpv API 1.108 (mpv 0.33); data may be
+            // null on older cores — forward 0 ("unknown") then.
+            auto *start_file = (mpv_event_start_file *) event->data;
+            env->CallVoidMethod(
+                    event_listener,
+                    jni_mediamp_method_EventListener_onStartFile,
+                    static_cast<jlong>(start_file ? start_file->playlist_entry_id : 0));
+            clear_jni_exception(env, instance, "EventListener.onStartFile");
+            break;
+        }
+        case MPV_EVENT_END_FILE: {
+            auto *end_file = (mpv_event_end_file *) event->data;
+            env->CallVoidMethod(
+                    event_listener,
+                    jni_mediamp_method_EventListener_onEndFile,
+                    static_cast<jint>(end_file->reason),
+                    static_cast<jint>(end_file->error),
+                    static_cast<jlong>(end_file->playlist_entry_id));
+            clear_jni_exception(env, instance, "EventListener.onEndFile");
+            break;
+        }
+        default:
+            break;
+    }
+}
+
 void *(mpv_handle_t::event_loop)(void *arg) {
     if (!jvm_ || !handle_) {
         LOG(this, LOG_LEVEL_ERROR,
@@ -145,6 +189,28 @@ void *(mpv_handle_t::event_loop)(void *arg) {
     }
     jni_cache_classes(env, this);
 
+    event_batch batch(env, this);
+    // The loop's copy of the listener pair, taken as one under event_listener_lock and
+    // held through a reference of its own: set_event_listener can then neither delete the
+    // listener mid-upcall nor hand a new dispatcher names interned for the previous one.
+    jobject listener = nullptr;
+    bool batched = false;
+    uint32_t listener_generation = 0;
+    const auto drop_listener = [&] {
+        if (listener) {
+            env->DeleteGlobalRef(listener);
+            listener = nullptr;
+        }
+    };
+    const auto take_listener = [&] {
+        LOCK(event_listener_lock);
+        drop_listener();
+        listener = event_listener_ ? env->NewGlobalRef(event_listener_) : nullptr;
+        batched = listener && event_listener_batched_;
+        listener_generation = event_listener_generation_.load(std::memory_order_relaxed);
+    };
+    take_listener();
+
     LOG(this, LOG_LEVEL_V, "[event_loop] started");
     while (!event_loop_request_exit.load(std::memory_order_acquire)) {
         if (!handle_) {
@@ -152,78 +218,93 @@ void *(mpv_handle_t::event_loop)(void *arg) {
             break;
         }
 
-        mpv_event *event;
-        mpv_event_property *event_property = nullptr;
-        mpv_event_log_message *log_message = nullptr;
-
-        // 不处理 NONE 事件
-        if ((event = mpv_wait_event(handle_, -1.0))->event_id == MPV_EVENT_NONE) {
-            continue;
-        }
-
-        if (event_listener_ &&
-            event->event_id != MPV_EVENT_PROPERTY_CHANGE &&
-            event->event_id != MPV_EVENT_LOG_MESSAGE &&
-            jni_mediamp_method_EventListener_onEvent
-        ) {
-            env->CallVoidMethod(
-                    event_listener_,
-                    jni_mediamp_method_EventListener_onEvent,
-                    static_cast<jint>(event->event_id));
-            clear_jni_exception(env, this, "EventListener.onEvent");
+        // Wakes up in time to deliver the changes the property throttle is holding back.
+        mpv_event *event = mpv_wait_event(
+                handle_, property_throttle_.wait_timeout(property_throttle::clock::now()));
+        // Read once per wakeup: every flush below goes to the listener the batch was
+        // built for.
+        if (event_listener_generation_.load(std::memory_order_acquire) != listener_generation) {
+            take_listener();
+            batch.discard();
         }
 
-        switch (event->event_id) {
-            case MPV_EVENT_PROPERTY_CHANGE:
-                event_property = (mpv_event_property *) event->data;
-                emit_property_change(env, this, event_property, event_listener_);
-                break;
-            case MPV_EVENT_LOG_MESSAGE:
-                log_message = (mpv_event_log_message *) event->data;
-                emit_log_message(this, log_message);
-                break;
-            case MPV_EVENT_IDLE:
-                break;
-            case MPV_EVENT_START_FILE: {
-                // playlist_entry_id exists since libmpv API 1.108 (mpv 0.33); data may be
-                // null on older cores — forward 0 ("unknown") then.
-                auto *start_file = (mpv_event_start_file *) event->data;
-                if (event_listener_ && jni_mediamp_method_EventListener_onStartFile) {
-                    env->CallVoidMethod(
-                        event_listener_,
-                        jni_mediamp_method_EventListener_onStartFile,
-                        static_cast<jlong>(start_file ? start_file->playlist_entry_id : 0));
-                    clear_jni_exception(env, this, "EventListener.onStartFile");
-                }
-                break;
+        // Drain everything already queued before going back to Kotlin, so a burst (e.g. the
+        // dozens of property changes of a file load) costs one upcall instead of one each.
+        bool shutdown = false;
+        mediampv::event_ring *ring = event_ring();
+        const auto deliver = [&](const mpv_event &change) {
+            if (ring) {
+                // Poll mode: the consumer picks the record up; no upcall from here.
+                ring->push(change);
+            } else if (!listener) {
+                // No one to tell.
+            } else if (batched) {
+                batch.append(&change, listener);
+            } else {
+                emit_event(env, this, &change, listener);
             }
-            case MPV_EVENT_END_FILE: {
-                auto *end_file = (mpv_event_end_file *) event->data;
-                // reason != EOF/STOP with a non-zero error is a real playback failure.
-                const int level = end_file->error != 0 ? LOG_LEVEL_WARN : LOG_LEVEL_INFO;
-                LOG(this, level, "[event_loop] end-file: reason=%d error=%s entry_id=%lld",
-                    end_file->reason, mpv_error_string(end_file->error),
-                    static_cast<long long>(end_file->playlist_entry_id));
-                if (event_listener_ && jni_mediamp_method_EventListener_onEndFile) {
-                    env->CallVoidMethod(
-                        event_listener_,
-                        jni_mediamp_method_EventListener_onEndFile,
-                        static_cast<jint>(end_file->reason),
-                        static_cast<jint>(end_file->error),
-                        static_cast<jlong>(end_file->playlist_entry_id));
-                    clear_jni_exception(env, this, "EventListener.onEndFile");
+        };
+        for (; event->event_id != MPV_EVENT_NONE; event = mpv_wait_event(handle_, 0)) {
+            if (event->event_id == MPV_EVENT_START_FILE || event->event_id == MPV_EVENT_END_FILE) {
+                // Held-back changes are of the file before: not to be delivered after it ended.
+                property_throttle_.drop_pending();
+            } else if (event->event_id != MPV_EVENT_PROPERTY_CHANGE && event->event_id != MPV_EVENT_LOG_MESSAGE) {
+                // Held-back changes were queued before this event and go first, so that a
+                // position from before a seek does not arrive after its PLAYBACK_RESTART.
+                property_throttle_.flush_pending(property_throttle::clock::now(), deliver);
+            }
+            switch (event->event_id) {
+                case MPV_EVENT_LOG_MESSAGE:
+                    emit_log_message(this, (mpv_event_log_message *) event->data);
+                    continue;
+                case MPV_EVENT_END_FILE: {
+                    auto *end_file = (mpv_event_end_file *) event->data;
+                    // reason != EOF/STOP with a non-zero error is a real playback failure.
+                    const int level = end_file->error != 0 ? LOG_LEVEL_WARN : LOG_LEVEL_INFO;
+                    LOG(this, level, "[event_loop] end-file: reason=%d error=%s entry_id=%lld",
+                        end_file->reason, mpv_error_string(end_file->error),
+                        static_cast<long long>(end_file->playlist_entry_id));
+                    break;
                 }
-                break;
+                case MPV_EVENT_PROPERTY_CHANGE:
+                    // A throttled property changing too soon is held back, replacing any
+                    // earlier held-back value, and delivered by flush_due below or before
+                    // the next other event.
+                    if (!property_throttle_.admit(*event, property_throttle::clock::now())) {
+                        continue;
+                    }
+                    break;
+                case MPV_EVENT_COMMAND_REPLY:
+                case MPV_EVENT_SET_PROPERTY_REPLY:
+                    // Completes the request that asked for it instead of going to the listener.
+                    // What mpv queued before the reply is delivered first.
+                    batch.flush(listener);
+                    complete_reply(env, event->reply_userdata, event->error);
+                    continue;
+                case MPV_EVENT_SHUTDOWN:
+                    shutdown = true;
+                    break;
+                default:
+                    break;
             }
-            case MPV_EVENT_SHUTDOWN:
-                LOG(this, LOG_LEVEL_V, "[event_loop] shutdown");
-                return nullptr;
-            default:
-                LOG(this, LOG_LEVEL_TRACE, "[event_loop] unhandled event: %d", event->event_id);
+
+            deliver(*event);
+            if (shutdown) {
                 break;
+            }
         }
+        if (!shutdown) {
+            property_throttle_.flush_due(property_throttle::clock::now(), deliver);
+        }
+        batch.flush(listener);
 
+        if (shutdown) {
+            LOG(this, LOG_LEVEL_V, "[event_loop] shutdown");
+            drop_listener();
+            return nullptr;
+        }
     }
+    drop_listener();
     LOG(this, LOG_LEVEL_V, "[event_loop] stopped");
     return nullptr;
 }
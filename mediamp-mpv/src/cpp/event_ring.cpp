@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include "event_batch.h"
+#include "event_ring.h"
+
+namespace mediampv {
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t) && std::atomic<uint64_t>::is_always_lock_free,
+              "the ring indices are read as plain int64s from Kotlin");
+
+event_ring::event_ring(char *memory, uint32_t capacity) : capacity_(capacity), memory_(memory) {
+    write_index_ = new (memory_) std::atomic<uint64_t>(0);
+    read_index_ = new (memory_ + 64) std::atomic<uint64_t>(0);
+    dropped_ = new (memory_ + 128) std::atomic<uint64_t>(0);
+}
+
+int64_t event_ring::monotonic_nanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool event_ring::push(const mpv_event &event) {
+    if (event.event_id == MPV_EVENT_LOG_MESSAGE) {
+        return true;
+    }
+
+    int32_t kind = event_batch::kind_event;
+    int32_t a = event.event_id;
+    int32_t b = 0;
+    int64_t c = 0;
+    int64_t d = 0;
+    const char *name = nullptr;
+    const char *string = nullptr;
+    switch (event.event_id) {
+        case MPV_EVENT_PROPERTY_CHANGE: {
+            auto *prop = static_cast<const mpv_event_property *>(event.data);
+            if (!prop || !prop->name) {
+                return true;
+            }
+            kind = event_batch::kind_property;
+            a = prop->format;
+            d = static_cast<int64_t>(event.reply_userdata);
+            name = prop->name;
+            switch (prop->format) {
+                case MPV_FORMAT_NONE:
+                    break;
+                case MPV_FORMAT_FLAG:
+                    if (!prop->data) return true;
+                    c = *static_cast<const int *>(prop->data) != 0 ? 1 : 0;
+                    break;
+                case MPV_FORMAT_INT64:
+                    if (!prop->data) return true;
+                    c = *static_cast<const int64_t *>(prop->data);
+                    break;
+                case MPV_FORMAT_DOUBLE:
+                    if (!prop->data) return true;
+                    std::memcpy(&c, prop->data, sizeof(double));
+                    break;
+                case MPV_FORMAT_STRING:
+                    if (!prop->data || !*static_cast<const char *const *>(prop->data)) return true;
+                    string = *static_cast<const char *const *>(prop->data);
+                    break;
+                default:
+                    return true;
+            }
+            break;
+        }
+        case MPV_EVENT_START_FILE: {
+            // playlist_entry_id exists since libmpv API 1.108 (mpv 0.33); data may be null
+            // on older cores: 0 ("unknown") then.
+            auto *start_file = static_cast<const mpv_event_start_file *>(event.data);
+            kind = event_batch::kind_start_file;
+            c = start_file ? start_file->playlist_entry_id : 0;
+            break;
+        }
+        case MPV_EVENT_END_FILE: {
+            auto *end_file = static_cast<const mpv_event_end_file *>(event.data);
+            if (end_file) {
+                kind = event_batch::kind_end_file;
+                a = end_file->reason;
+                b = end_file->error;
+                c = end_file->playlist_entry_id;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return write(kind, a, b, c, d, name, string);
+}
+
+bool event_ring::write(
+        int32_t kind,
+        int32_t a,
+        int32_t b,
+        int64_t c,
+        int64_t d,
+        const char *name,
+        const char *string) {
+    const uint64_t write_index = write_index_->load(std::memory_order_relaxed);
+    if (write_index - cached_read_index_ >= capacity_) {
+        cached_read_index_ = read_index_->load(std::memory_order_acquire);
+        if (write_index - cached_read_index_ >= capacity_) {
+            dropped_->fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    char *record = slot(write_index);
+    int32_t flags = 0;
+    const size_t payload = kSlotSize - kPayloadOffset;
+    const size_t name_length = name ? std::min(std::strlen(name), payload) : 0;
+    size_t value_length = string ? std::strlen(string) : 0;
+    if (value_length > payload - name_length) {
+        value_length = payload - name_length;
+        flags |= kFlagTruncated;
+    }
+    if (string) {
+        c = static_cast<int64_t>(value_length);
+    }
+    const int64_t now = monotonic_nanos();
+    const auto name_length32 = static_cast<int32_t>(name_length);
+    const auto value_length32 = static_cast<int32_t>(value_length);
+    std::memcpy(record, &kind, 4);
+    std::memcpy(record + 4, &a, 4);
+    std::memcpy(record + 8, &b, 4);
+    std::memcpy(record + 12, &flags, 4);
+    std::memcpy(record + 16, &c, 8);
+    std::memcpy(record + 24, &d, 8);
+    std::memcpy(record + 32, &now, 8);
+    std::memcpy(record + 40, &name_length32, 4);
+    std::memcpy(record + 44, &value_length32, 4);
+    if (name_length > 0) {
+        std::memcpy(record + kPayloadOffset, name, name_length);
+    }
+    if (value_length > 0) {
+        std::memcpy(record + kPayloadOffset + name_length, string, value_length);
+    }
+    // Publishes the record: the consumer's acquire load of the index sees its bytes.
+    write_index_->store(write_index + 1, std::memory_order_release);
+    return true;
+}
+
+uint64_t event_ring::advance(uint64_t consumed) {
+    const uint64_t write_index = write_index_->load(std::memory_order_acquire);
+    if (consumed > write_index) {
+        consumed = write_index;
+    }
+    if (consumed > read_index_->load(std::memory_order_relaxed)) {
+        read_index_->store(consumed, std::memory_order_release);
+    }
+    return write_index;
+}
+
+} // namespace mediampv
@@ -0,0 +1,162 @@
+#include "handle_pool.h"
+
+#include <exception>
+#include <thread>
+#include <utility>
+
+#include "log.h"
+#include "method_cache.h"
+#include "mpv_handle_t.h"
+
+namespace mediampv {
+
+namespace {
+
+constexpr int kMaxFailures = 3;
+
+} // namespace
+
+handle_pool &handle_pool::instance() {
+    // Leaked on purpose: the fill thread never exits and uses it until the process does.
+    static auto *instance = new handle_pool();
+    return *instance;
+}
+
+void handle_pool::configure(JNIEnv *env, jobject app_context, std::vector<std::string> options, size_t size) {
+    // Destroyed after the lock is released: destroying an instance joins mpv's threads.
+    std::vector<std::unique_ptr<mpv_handle_t>> discarded;
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (!app_context_ && env && app_context) {
+            app_context_ = env->NewGlobalRef(app_context);
+        }
+        auto it = profiles_.find(options);
+        if (size == 0) {
+            if (it != profiles_.end()) {
+                discarded = std::move(it->second.idle);
+                profiles_.erase(it);
+            }
+        } else {
+            profile &target = profiles_[std::move(options)];
+            target.size = size;
+            target.failures = 0;
+            while (target.idle.size() > size) {
+                discarded.push_back(std::move(target.idle.back()));
+                target.idle.pop_back();
+            }
+            if (!thread_started_) {
+                thread_started_ = true;
+                std::thread([this] { fill_loop(); }).detach();
+            }
+        }
+    }
+    changed_.notify_all();
+}
+
+mpv_handle_t *handle_pool::take(const std::vector<std::string> &options) {
+    std::unique_ptr<mpv_handle_t> handle;
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        auto it = profiles_.find(options);
+        if (it == profiles_.end() || it->second.idle.empty()) {
+            return nullptr;
+        }
+        handle = std::move(it->second.idle.back());
+        it->second.idle.pop_back();
+    }
+    changed_.notify_all();
+    return handle.release();
+}
+
+std::vector<const mpv_handle_t *> handle_pool::idle(const std::vector<std::string> &options) {
+    std::vector<const mpv_handle_t *> result;
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = profiles_.find(options);
+    if (it != profiles_.end()) {
+        for (const auto &handle : it->second.idle) {
+            result.push_back(handle.get());
+        }
+    }
+    return result;
+}
+
+int handle_pool::failures(const std::vector<std::string> &options) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = profiles_.find(options);
+    return it == profiles_.end() ? 0 : it->second.failures;
+}
+
+bool handle_pool::next_to_fill(std::vector<std::string> &options) {
+    for (const auto &entry : profiles_) {
+        if (entry.second.idle.size() < entry.second.size && entry.second.failures < kMaxFailures) {
+            options = entry.first;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::unique_ptr<mpv_handle_t> handle_pool::create(JNIEnv *env, const std::vector<std::string> &options) {
+    try {
+        std::unique_ptr<mpv_handle_t> handle(new mpv_handle_t(env, app_context_));
+        for (size_t i = 0; i + 1 < options.size(); i += 2) {
+            // Like MPVHandle.option, a rejected option is logged by set_option and skipped.
+            handle->set_option(options[i].c_str(), options[i + 1].c_str());
+        }
+        handle->initialize();
+        return handle;
+    } catch (const std::exception &e) {
+        LOGW("handle pool: cannot create an mpv instance: %s", e.what());
+    }
+    if (env->ExceptionCheck()) {
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+    }
+    return nullptr;
+}
+
+void handle_pool::fill_loop() {
+    JNIEnv *env = nullptr;
+    JavaVMAttachArgs args{JNI_VERSION_1_6, const_cast<char *>("mediampv-pool"), nullptr};
+    // As a daemon: this thread never exits and must not keep the JVM alive.
+#if defined(__ANDROID__)
+    const bool attached = global_jvm && global_jvm->AttachCurrentThreadAsDaemon(&env, &args) == JNI_OK;
+#else
+    const bool attached = global_jvm &&
+            global_jvm->AttachCurrentThreadAsDaemon(reinterpret_cast<void **>(&env), &args) == JNI_OK;
+#endif
+    if (!attached || !env) {
+        LOGE("handle pool: the fill thread cannot attach to the JVM; no instances will be pooled");
+        return;
+    }
+
+    std::vector<std::string> options;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            changed_.wait(lock, [&] { return next_to_fill(options); });
+        }
+
+        // Created outside the lock, so that take() never waits for mpv_initialize.
+        std::unique_ptr<mpv_handle_t> handle = create(env, options);
+        std::unique_ptr<mpv_handle_t> discarded;
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            auto it = profiles_.find(options);
+            if (it == profiles_.end()) {
+                discarded = std::move(handle);
+            } else if (!handle) {
+                if (++it->second.failures == kMaxFailures) {
+                    LOGW("handle pool: giving up on a profile after %d failed attempts", kMaxFailures);
+                }
+            } else if (it->second.idle.size() < it->second.size) {
+                it->second.failures = 0;
+                it->second.idle.push_back(std::move(handle));
+            } else {
+                discarded = std::move(handle);
+            }
+        }
+    }
+}
+
+} // namespace mediampv
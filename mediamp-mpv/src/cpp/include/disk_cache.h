@@ -0,0 +1,112 @@
+#pragma once
+
+#ifndef MEDIAMP_DISK_CACHE_H
+#define MEDIAMP_DISK_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace mediampv {
+
+// Order in which disk_cache evicts contents when over budget. Values are shared with
+// SeekableInputDiskCachePolicy on the Kotlin side.
+enum class disk_eviction_policy : int {
+    // Contents not used for the longest time go first.
+    least_recently_used = 0,
+    // Contents first stored the longest time ago go first.
+    oldest_first = 1,
+};
+
+// Persistent second tier under read_ahead_cache: the blocks of a stream are kept on disk,
+// keyed by a stable content ID, so re-watching or seeking back into media fetched in an
+// earlier session reads local disk instead of going through the SeekableInput again.
+//
+// Disabled until configure() is given a directory. Each content has two files in it,
+// named after a hash of its ID:
+// - `<hash>.blocks`, a sparse file holding block i at offset i * block_size;
+// - `<hash>.index`, a header (content ID, size, block size, timestamps) followed by a
+//   bitmap of the blocks present and a checksum of each.
+// A block's checksum and bit are written only after its data, and the checksum is checked
+// on every read. Nothing is fsynced: a block torn by a crash or a power loss, or cut short
+// by a truncated file, fails the check, is forgotten and is fetched and stored again.
+//
+// When the stored blocks of all contents exceed the budget, whole contents are evicted in
+// the configured order. Open contents are never evicted; when only open ones remain, new
+// blocks are simply not stored.
+class disk_cache final {
+public:
+    // Sets the directory (null or empty disables the tier for contents opened afterwards),
+    // the budget in bytes and the eviction policy, and evicts down to the new budget.
+    static void configure(
+            const char *directory,
+            int64_t budget,
+            disk_eviction_policy policy,
+            const void *instance_handle);
+
+    // Returns the cache of `content_id`, shared by every stream of that content in the
+    // process. A content previously stored with another size or block size starts over.
+    // Returns null when the tier is disabled or the files cannot be opened.
+    static std::shared_ptr<disk_cache> open(
+            const std::string &content_id,
+            int64_t size,
+            int64_t block_size,
+            const void *instance_handle);
+
+    ~disk_cache();
+
+    disk_cache(const disk_cache &) = delete;
+    disk_cache &operator=(const disk_cache &) = delete;
+
+    // Reads block `index` (`length` bytes) into `buffer`. Returns false when the block has
+    // not been stored or cannot be read.
+    bool read_block(int64_t index, char *buffer, int64_t length);
+    // Stores block `index` unless it is already stored or there is no room for it.
+    void write_block(int64_t index, const char *buffer, int64_t length);
+
+    struct file;
+    class registry;
+
+private:
+    disk_cache(
+            registry &registry,
+            std::string stem,
+            std::string content_id,
+            std::unique_ptr<file> blocks,
+            std::unique_ptr<file> index,
+            int64_t bitmap_offset,
+            std::vector<uint8_t> bitmap,
+            std::vector<uint32_t> checksums,
+            int64_t size,
+            int64_t block_size,
+            const void *instance_handle);
+
+    bool has_block(int64_t index) const;
+    // Forgets a stored block that could not be read back intact.
+    void drop_block(int64_t index, const char *reason);
+
+    registry &registry_;
+    const std::string stem_;
+    const std::string content_id_;
+    const std::unique_ptr<file> blocks_;
+    const std::unique_ptr<file> index_;
+    const int64_t bitmap_offset_;
+    const int64_t checksums_offset_;
+    const int64_t size_;
+    const int64_t block_size_;
+    const void *instance_handle_;
+
+    // Guarded by mutex_.
+    std::mutex mutex_;
+    std::vector<uint8_t> bitmap_;
+    std::vector<uint32_t> checksums_;
+    // Blocks being written, so that two streams of the content do not both store one.
+    std::unordered_set<int64_t> writing_;
+};
+
+} // namespace mediampv
+
+#endif // MEDIAMP_DISK_CACHE_H
@@ -0,0 +1,94 @@
+#pragma once
+
+#ifndef MEDIAMP_EVENT_BATCH_H
+#define MEDIAMP_EVENT_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <jni.h>
+#include <mpv/client.h>
+
+namespace mediampv {
+
+// Events drained from mpv in one wakeup of the event loop, packed into a reusable native
+// buffer that Kotlin reads through a direct ByteBuffer (EventBatchDispatcher), so a burst
+// of property changes costs one upcall instead of one per event.
+//
+// Records are in native byte order and 8-byte aligned; each starts with a fixed header
+//   int32 kind, int32 size (of the whole record), int32 a, int32 b, int64 c, int64 d
+// optionally followed by UTF-8 bytes (not NUL-terminated):
+// - kind_event: a = mpv_event_id; sent for every event but property changes and logs;
+// - kind_start_file: c = playlist_entry_id;
+// - kind_end_file: a = reason, b = error, c = playlist_entry_id;
+// - kind_name: a = name ID, b = byte length, then the name; precedes the first property
+//   change of that name;
+// - kind_property: a = name ID, b = mpv_format, c = the value (flag 0/1, int64, the bits
+//   of a double, or the byte length of a string, whose bytes follow), d = the
+//   reply_userdata the property was observed with, so Kotlin can dispatch on it instead
+//   of comparing names.
+// Property names are interned: each crosses JNI once per dispatcher, after which a change
+// carries only its ID.
+//
+// Thread-confined to the event loop; `env` must stay attached for the batch's lifetime.
+class event_batch final {
+public:
+    enum kind : int32_t {
+        kind_event = 0,
+        kind_start_file = 1,
+        kind_end_file = 2,
+        kind_name = 3,
+        kind_property = 4,
+    };
+    static constexpr size_t kHeaderSize = 32;
+    // A batch is flushed early by append once it holds this many bytes, so one wakeup with
+    // a long backlog does not grow the buffer without bound.
+    static constexpr size_t kFlushThreshold = 64 * 1024;
+
+    event_batch(JNIEnv *env, const void *instance_handle);
+    ~event_batch();
+
+    event_batch(const event_batch &) = delete;
+    event_batch &operator=(const event_batch &) = delete;
+
+    // Appends the records of `event`, flushing them to `dispatcher` once the batch reaches
+    // kFlushThreshold. Log messages are not batched (they go to the log sink directly) and
+    // are ignored here.
+    void append(const mpv_event *event, jobject dispatcher);
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+
+    // Hands the records to `dispatcher` (an EventBatchDispatcher) in one upcall and
+    // empties the batch. With a null dispatcher the records are dropped.
+    void flush(jobject dispatcher);
+
+    // Forgets the interned names, e.g. because the dispatcher that knew them was replaced.
+    void reset_names();
+
+    // Drops the records not flushed yet along with the interned names, for when the
+    // dispatcher they were meant for was replaced.
+    void discard();
+
+private:
+    JNIEnv *env_;
+    const void *instance_handle_;
+    std::unique_ptr<char[]> data_;
+    size_t capacity_ = 0;
+    size_t size_ = 0;
+    // Direct ByteBuffer over data_, recreated when data_ is reallocated.
+    jobject byte_buffer_ = nullptr;
+    size_t byte_buffer_capacity_ = 0;
+    std::unordered_map<std::string, int32_t> names_;
+
+    void append_records(const mpv_event *event);
+    char *reserve(size_t length);
+    void write_record(int32_t kind, int32_t a, int32_t b, int64_t c, int64_t d, const char *bytes, size_t length);
+    int32_t intern(const char *name);
+    bool ensure_byte_buffer();
+};
+
+} // namespace mediampv
+
+#endif // MEDIAMP_EVENT_BATCH_H
@@ -0,0 +1,87 @@
+#pragma once
+
+#ifndef MEDIAMP_EVENT_RING_H
+#define MEDIAMP_EVENT_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mpv/client.h>
+
+namespace mediampv {
+
+// Poll-based alternative to pushing events to an EventListener: the event loop (the single
+// producer) writes fixed-size records into a lock-free ring in native memory, and Kotlin
+// (the single consumer, MpvEventRing) reads them through a direct ByteBuffer whenever it
+// likes, e.g. once per UI frame. The event thread then makes no JNI upcalls at all.
+//
+// The memory is a direct ByteBuffer that MpvEventRing allocates and owns, so it stays
+// valid for as long as Kotlin can read it, even after the handle is gone; mpv_handle_t
+// holds a reference to it while the ring is open.
+//
+// Memory layout, native byte order:
+//   0   uint64 write index (producer; the consumer reads it through advance())
+//   64  uint64 read index (consumer; written through advance())
+//   128 uint64 records dropped because the ring was full
+//   192 capacity slots of kSlotSize bytes; record i lives in slot i % capacity
+// Indices only grow. Each event is one record, and each slot holds
+//   0  int32 kind (event_batch::kind, except kind_name); kind_start_file and kind_end_file
+//      stand for MPV_EVENT_START_FILE and MPV_EVENT_END_FILE with their details
+//   4  int32 a: mpv_event_id (kind_event), reason (kind_end_file) or mpv_format (kind_property)
+//   8  int32 b: error (kind_end_file)
+//   12 int32 flags: kFlagTruncated when a string value did not fit
+//   16 int64 c: playlist_entry_id, or the property value as in event_batch.h
+//   24 int64 d: reply_userdata (kind_property)
+//   32 int64 time the record was written, in monotonic_nanos()
+//   40 int32 name length, 44 int32 string value length
+//   48 the property name, then the string value (UTF-8, not NUL-terminated)
+class event_ring final {
+public:
+    static constexpr size_t kControlSize = 192;
+    static constexpr size_t kSlotSize = 256;
+    static constexpr size_t kPayloadOffset = 48;
+    static constexpr int32_t kFlagTruncated = 1;
+    static constexpr uint32_t kMinCapacity = 16;
+    static constexpr uint32_t kMaxCapacity = 1u << 16;
+
+    // Lays the ring out over `memory`: kControlSize + capacity * kSlotSize zeroed bytes,
+    // 8-byte aligned, that outlive the ring. `capacity` is a power of two within
+    // [kMinCapacity, kMaxCapacity] (valid_capacity).
+    event_ring(char *memory, uint32_t capacity);
+
+    static bool valid_capacity(uint32_t capacity) {
+        return capacity >= kMinCapacity && capacity <= kMaxCapacity && (capacity & (capacity - 1)) == 0;
+    }
+
+    event_ring(const event_ring &) = delete;
+    event_ring &operator=(const event_ring &) = delete;
+
+    // Producer: writes `event` (not log messages). Returns false, and counts the record as
+    // dropped, when the ring is full.
+    bool push(const mpv_event &event);
+
+    // Consumer: marks every record before `consumed` as read, freeing its slot, and returns
+    // the write index. Records up to it are fully written (acquire).
+    uint64_t advance(uint64_t consumed);
+
+    uint32_t capacity() const { return capacity_; }
+
+    // The clock of the record timestamps.
+    static int64_t monotonic_nanos();
+
+private:
+    const uint32_t capacity_;
+    char *const memory_;
+    std::atomic<uint64_t> *write_index_;
+    std::atomic<uint64_t> *read_index_;
+    std::atomic<uint64_t> *dropped_;
+    // Producer's cached copy of read_index_, refreshed only when the ring looks full.
+    uint64_t cached_read_index_ = 0;
+
+    bool write(int32_t kind, int32_t a, int32_t b, int64_t c, int64_t d, const char *name, const char *string);
+    char *slot(uint64_t index) { return memory_ + kControlSize + (index & (capacity_ - 1)) * kSlotSize; }
+};
+
+} // namespace mediampv
+
+#endif // MEDIAMP_EVENT_RING_H
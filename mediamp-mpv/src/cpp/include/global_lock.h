@@ -5,17 +5,18 @@
 #ifndef MEDIAMP_GLOBAL_LOCK_H
 #define MEDIAMP_GLOBAL_LOCK_H
 
+// Plain mutex: not recursive, so a lock taken again on the thread that holds it deadlocks
+// instead of silently letting the inner caller see half-updated state.
 #if defined(_WIN32) || defined(_WIN64)
 #include <windows.h>
 
 class CompatibleLock {
 public:
-    CompatibleLock() { InitializeCriticalSection(&cs_); }
-    ~CompatibleLock() { DeleteCriticalSection(&cs_); }
-    void lock() { EnterCriticalSection(&cs_); }
-    void unlock() { LeaveCriticalSection(&cs_); }
+    CompatibleLock() { InitializeSRWLock(&srw_); }
+    void lock() { AcquireSRWLockExclusive(&srw_); }
+    void unlock() { ReleaseSRWLockExclusive(&srw_); }
 private:
-    CRITICAL_SECTION cs_;
+    SRWLOCK srw_;
 };
 
 // RAII
@@ -33,9 +34,17 @@ private:
 #else
 #include <mutex>
 
-#define CREATE_LOCK(lock_name) std::recursive_mutex lock_name
-#define LOCK(lock_name) std::lock_guard<std::recursive_mutex> guard_##lock_name(lock_name)
+#define CREATE_LOCK(lock_name) std::mutex lock_name
+#define LOCK(lock_name) std::lock_guard<std::mutex> guard_##lock_name(lock_name)
 
 #endif
 
+// Reader/writer lock, the same on every platform: SHARED_LOCK for calls that may run
+// concurrently with each other, EXCLUSIVE_LOCK for one that must run alone. Not recursive.
+#include <shared_mutex>
+
+#define CREATE_SHARED_LOCK(lock_name) std::shared_mutex lock_name
+#define SHARED_LOCK(lock_name) std::shared_lock<std::shared_mutex> shared_guard_##lock_name(lock_name)
+#define EXCLUSIVE_LOCK(lock_name) std::unique_lock<std::shared_mutex> exclusive_guard_##lock_name(lock_name)
+
 #endif //MEDIAMP_GLOBAL_LOCK_H
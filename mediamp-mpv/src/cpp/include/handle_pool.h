@@ -0,0 +1,77 @@
+#pragma once
+
+#ifndef MEDIAMP_HANDLE_POOL_H
+#define MEDIAMP_HANDLE_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <jni.h>
+
+namespace mediampv {
+
+class mpv_handle_t;
+
+// Opt-in pool of mpv instances created, configured and initialized ahead of time, so that
+// creating a player or a frame-preview decoder takes a ready instance instead of running
+// mpv_create, its options and mpv_initialize on the path to the first frame.
+//
+// Instances are pooled per profile: the flat key/value list of options they were created
+// with, applied with set_option before initialize(). A background thread, attached to the
+// JVM for its lifetime, keeps `size` idle instances of each configured profile and
+// replaces every one taken. Idle instances have no event listener, so their events until
+// they are taken are dropped.
+//
+// A profile whose instances fail to be created is retried right away, with no backoff,
+// and given up after kMaxFailures consecutive failures. Idle instances are never
+// destroyed at exit: the pool is leaked with the process, and mpv's threads end with it.
+class handle_pool final {
+public:
+    static handle_pool &instance();
+
+    // Keeps `size` idle instances created with `options`; 0 disables the profile and
+    // destroys its idle instances. `app_context` is what instances are created with
+    // (mpv_handle_t::create); the first one given is kept for the process lifetime.
+    void configure(JNIEnv *env, jobject app_context, std::vector<std::string> options, size_t size);
+
+    // Takes an idle instance of the profile `options`, or returns null when there is none.
+    mpv_handle_t *take(const std::vector<std::string> &options);
+
+    // The idle instances of the profile `options`, and its consecutive failures to create
+    // one; none and 0 when it is not configured. For tests.
+    std::vector<const mpv_handle_t *> idle(const std::vector<std::string> &options);
+    int failures(const std::vector<std::string> &options);
+
+    handle_pool(const handle_pool &) = delete;
+    handle_pool &operator=(const handle_pool &) = delete;
+
+private:
+    struct profile final {
+        size_t size = 0;
+        std::vector<std::unique_ptr<mpv_handle_t>> idle;
+        // Consecutive failures to create an instance; the profile is not refilled while
+        // it is at kMaxFailures, until configure() is called for it again.
+        int failures = 0;
+    };
+
+    handle_pool() = default;
+
+    void fill_loop();
+    // Returns the options of a profile that is short of idle instances, or false.
+    bool next_to_fill(std::vector<std::string> &options);
+    std::unique_ptr<mpv_handle_t> create(JNIEnv *env, const std::vector<std::string> &options);
+
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::map<std::vector<std::string>, profile> profiles_;
+    jobject app_context_ = nullptr;
+    bool thread_started_ = false;
+};
+
+} // namespace mediampv
+
+#endif //MEDIAMP_HANDLE_POOL_H
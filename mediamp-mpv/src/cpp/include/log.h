@@ -3,12 +3,15 @@
 #ifndef MEDIAMP_LOG_H
 #define MEDIAMP_LOG_H
 
+#include <cstdint>
+
 namespace mediampv {
 
 // Log levels mirror mpv's mpv_log_level scale (client.h): lower value == more severe.
 // mediamp's own native logs, mpv's MPV_EVENT_LOG_MESSAGE lines, and the Kotlin logs all
 // share this one scale so a single MPVLogHandler on the Kotlin side can filter uniformly.
 enum log_level {
+    LOG_LEVEL_NONE = 0,   // as a threshold only: nothing is logged
     LOG_LEVEL_FATAL = 10, // critical, aborting errors
     LOG_LEVEL_ERROR = 20, // simple errors
     LOG_LEVEL_WARN = 30,  // possible problems
@@ -18,11 +21,15 @@ enum log_level {
     LOG_LEVEL_TRACE = 70, // extremely noisy
 };
 
-// Formats a mediamp native log line (prefix "mediampv") and dispatches it to the Kotlin
-// MPVLog sink via JNI (MPVLogKt.onNativeLog). Safe to call from any thread and at any
-// time: it attaches the calling thread if needed and falls back to stderr when the JVM /
-// JNI cache is not ready, when a JNI exception is already pending, or when the dispatch
-// itself fails. It never throws and never leaves a JNI exception pending.
+// Formats a mediamp native log line (prefix "mediampv") and queues it for the Kotlin MPVLog
+// sink. Safe to call from any thread and at any time, and cheap enough for the render
+// thread: the line is formatted into a slot of a bounded lock-free queue (log_queue.h),
+// and a single drain thread hands queued lines to Kotlin in batches
+// (NativeLogBatchKt.onNativeLogBatch). The caller never makes a JNI call, never blocks,
+// and never allocates; when the queue is full the line is dropped and counted
+// (log_dropped_count), and the drain thread reports the count as a warning. Before the
+// first handle has captured the JVM, lines go to stderr synchronously instead. It never
+// throws and never touches a pending JNI exception.
 void log_print(int level, const char *format, ...)
 #if defined(__GNUC__) || defined(__clang__)
         __attribute__((format(printf, 2, 3)))
@@ -30,7 +37,7 @@ void log_print(int level, const char *format, ...)
         ;
 
 // Instance-aware overload. instance_handle is the address of the owning mpv_handle_t;
-// Kotlin receives the same address as onNativeLog(instanceHandle, ...). A null handle is
+// Kotlin receives the same address as MPVLogMessage.instanceHandle. A null handle is
 // reported as 0L and is reserved for process-wide logs that do not belong to one instance.
 void log_print(const void *instance_handle, int level, const char *format, ...)
 #if defined(__GNUC__) || defined(__clang__)
@@ -39,10 +46,32 @@ void log_print(const void *instance_handle, int level, const char *format, ...)
         ;
 
 // Forwards an already-formatted line that carries its own prefix (used for mpv's own log
-// messages from MPV_EVENT_LOG_MESSAGE). Same dispatch and fallback behaviour as log_print.
+// messages from MPV_EVENT_LOG_MESSAGE). Same queueing and fallback behaviour as log_print.
 void log_forward(int level, const char *prefix, const char *text);
 void log_forward(const void *instance_handle, int level, const char *prefix, const char *text);
 
+// Also writes every line that passes its threshold, at the call site, into a ring in the
+// memory-mapped file at `path` (log_ring_file.h), where the latest lines survive a crash of
+// the process. The file is created or truncated, and stays open for the life of the
+// process; only one can be opened. Returns false, after logging why, on failure.
+bool log_open_ring_file(const char *path, uint64_t capacity);
+
+// Lines dropped so far because the log queue was full.
+uint64_t log_dropped_count();
+
+// Log thresholds: a line is logged only when its level is at most the threshold of its
+// instance handle, and a filtered line is dropped before it is formatted. Handles without a
+// threshold of their own, and process-wide lines (null handle), use the default threshold,
+// initially LOG_LEVEL_INFO. Checking a threshold is lock-free.
+int log_threshold(const void *instance_handle);
+// A null handle sets the default threshold.
+void log_set_threshold(const void *instance_handle, int level);
+void log_clear_threshold(const void *instance_handle);
+bool log_enabled(const void *instance_handle, int level);
+
+// The mpv_request_log_messages() level name for a threshold: "no", "fatal", ... "trace".
+const char *log_level_name(int level);
+
 } // namespace mediampv
 
 // Canonical forms, selected by the overloaded log_print function:
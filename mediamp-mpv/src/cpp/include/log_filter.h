@@ -0,0 +1,73 @@
+#pragma once
+
+#ifndef MEDIAMP_LOG_FILTER_H
+#define MEDIAMP_LOG_FILTER_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+
+namespace mediampv {
+
+// Keeps a line that floods the log from costing a Kotlin dispatch each time. Applied by the
+// log drain thread (log.cpp) to every line it takes from the queue, per prefix (mpv's
+// module, e.g. "ffmpeg/demuxer", or "mediampv"):
+// - a line equal to the previous one of its prefix (same instance, level and text hash) is
+//   counted instead of passed on, and "last message repeated N times" is emitted when a
+//   different line arrives or at the latest kSummaryDelay after the first repeat;
+// - lines are admitted from a token bucket of kBurst lines refilled at kLinesPerSecond;
+//   lines beyond it are counted, and the count is emitted once lines are admitted again.
+// Fatal lines are always passed on.
+//
+// Thread-confined to the drain thread.
+class log_filter final {
+public:
+    using clock = std::chrono::steady_clock;
+    // Receives the summaries. Strings are valid only during the call.
+    using emit_fn = std::function<void(const void *instance_handle, int level, const char *prefix, const char *text)>;
+
+    static constexpr double kLinesPerSecond = 100;
+    static constexpr double kBurst = 500;
+    static constexpr auto kSummaryDelay = std::chrono::seconds(1);
+
+    // Returns true when the line should be passed on, after any summaries `emit` received.
+    bool admit(const void *instance_handle, int level, const char *prefix, const char *text, size_t text_length,
+               clock::time_point now, const emit_fn &emit);
+
+    // Emits the summaries that are due, for a prefix that has gone quiet.
+    void flush_due(clock::time_point now, const emit_fn &emit);
+
+    // When flush_due next has a summary to emit, or clock::time_point::max() when the
+    // filter holds none: the drain thread only has to wake up on its own until then.
+    clock::time_point next_due() const;
+
+private:
+    // Prefixes tracked at most; lines of further prefixes are passed on unfiltered.
+    static constexpr size_t kMaxSources = 256;
+
+    struct source final {
+        bool has_last = false;
+        uint64_t last_hash = 0;
+        int last_level = 0;
+        const void *last_instance_handle = nullptr;
+        uint64_t repeats = 0;
+        clock::time_point first_repeat;
+
+        double tokens = kBurst;
+        clock::time_point refilled;
+        uint64_t rate_limited = 0;
+        int rate_limited_level = 0;
+    };
+
+    std::unordered_map<std::string, source> sources_;
+
+    static void emit_repeats(const std::string &prefix, source &source, const emit_fn &emit);
+    static void emit_rate_limited(const std::string &prefix, source &source, const emit_fn &emit);
+    static void refill(source &source, clock::time_point now);
+};
+
+} // namespace mediampv
+
+#endif // MEDIAMP_LOG_FILTER_H
@@ -0,0 +1,66 @@
+#pragma once
+
+#ifndef MEDIAMP_LOG_QUEUE_H
+#define MEDIAMP_LOG_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace mediampv {
+
+// Bounded multi-producer/single-consumer queue of log lines between the threads that log
+// (render thread, event loop, mpv's stream callbacks, JNI downcalls) and the log drain
+// thread (log.cpp), which hands them to Kotlin in batches.
+//
+// Producers never block and never allocate: a line is formatted straight into a claimed
+// slot, and when every slot is taken the line is dropped and counted instead. Slots carry
+// a sequence number (Vyukov's bounded queue), so claiming is one CAS and publishing one
+// release store; the consumer only ever touches the slot at its own position.
+class log_queue final {
+public:
+    static constexpr size_t kCapacity = 1024; // power of two
+    static constexpr size_t kPrefixSize = 32;
+    static constexpr size_t kTextSize = 960;
+
+    struct entry final {
+        std::atomic<uint64_t> sequence{0};
+        uint64_t position = 0;
+        const void *instance_handle = nullptr;
+        int32_t level = 0;
+        uint32_t prefix_length = 0;
+        uint32_t text_length = 0;
+        char prefix[kPrefixSize];
+        char text[kTextSize]; // NUL-terminated; longer lines are truncated
+    };
+
+    log_queue();
+
+    log_queue(const log_queue &) = delete;
+    log_queue &operator=(const log_queue &) = delete;
+
+    // Producer side, any thread. Returns a slot to fill and hand to publish(), or null
+    // (after counting the line as dropped) when the queue is full.
+    entry *claim();
+    void publish(entry *entry);
+
+    // Consumer side, the drain thread only. front() returns the oldest published slot or
+    // null; pop() releases it to producers.
+    entry *front();
+    void pop(entry *entry);
+
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint64_t kMask = kCapacity - 1;
+
+    std::unique_ptr<entry[]> entries_;
+    alignas(64) std::atomic<uint64_t> enqueue_position_{0};
+    alignas(64) uint64_t dequeue_position_ = 0; // consumer only
+    std::atomic<uint64_t> dropped_{0};
+};
+
+} // namespace mediampv
+
+#endif // MEDIAMP_LOG_QUEUE_H
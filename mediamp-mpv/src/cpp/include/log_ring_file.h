@@ -0,0 +1,85 @@
+#pragma once
+
+#ifndef MEDIAMP_LOG_RING_FILE_H
+#define MEDIAMP_LOG_RING_FILE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#endif
+
+namespace mediampv {
+
+// Log lines written as binary records into a ring in a memory-mapped file, so that the most
+// recent ones survive a native crash, an abort or a wedged JVM: the pages belong to the
+// file, not to the process, and are in the file as soon as they are written. Decoded by
+// MpvLogRingFile on the Kotlin side, typically on the next start.
+//
+// Writing a line is a reservation (one fetch_add) and a memcpy at the logging call site;
+// any thread may write at any time.
+//
+// Layout, little-endian (as are all targets):
+//   header, kHeaderSize bytes:
+//     0  char[8] kMagic          16 uint64 data capacity     32 uint32 prefix table entries
+//     8  uint32 version          24 uint64 write position    36 uint32 prefix table offset
+//     12 uint32 data offset                                  40 int64 opened at (unix ns)
+//   prefix table: kPrefixEntries entries of kPrefixEntrySize bytes,
+//     uint32 state (2 once the name is complete), then the name, NUL-padded;
+//   data: a ring of `capacity` bytes holding 8-byte aligned records,
+//     0  uint64 position: the record's own offset in the stream, written last
+//     8  uint32 size of the record     24 uint64 instance handle
+//     12 int32 level                   32 uint16 prefix ID, uint16 text length
+//     16 int64 time (unix ns)          40 the text, UTF-8
+// The write position counts bytes reserved since the file was opened; a record at stream
+// offset p is at p % capacity in the ring, wrapping at its end. A record is complete when
+// its position field equals its offset, so a reader scans the last `capacity` bytes for
+// such records and skips torn or overwritten ones.
+class log_ring_file final {
+public:
+    static constexpr char kMagic[8] = {'M', 'P', 'V', 'L', 'O', 'G', 'R', '1'};
+    static constexpr uint32_t kVersion = 1;
+    static constexpr size_t kHeaderSize = 64;
+    static constexpr size_t kPrefixEntries = 256;
+    static constexpr size_t kPrefixEntrySize = 32;
+    static constexpr size_t kRecordHeaderSize = 40;
+    static constexpr size_t kMaxTextLength = 1024;
+    static constexpr uint16_t kUnknownPrefix = 0xFFFF;
+
+    // Creates or truncates the file at `path` (UTF-8) with a ring of `capacity` bytes,
+    // rounded to a power of two in [64 KiB, 64 MiB]. Returns null, after logging why, on
+    // failure.
+    static std::unique_ptr<log_ring_file> open(const char *path, uint64_t capacity);
+    ~log_ring_file();
+
+    log_ring_file(const log_ring_file &) = delete;
+    log_ring_file &operator=(const log_ring_file &) = delete;
+
+    void write(const void *instance_handle, int level, const char *prefix, const char *text, size_t text_length);
+
+private:
+    log_ring_file(char *mapping, size_t mapping_size, uint64_t capacity);
+
+    uint16_t prefix_id(const char *prefix);
+    std::atomic<uint64_t> &write_position();
+    void copy_in(uint64_t position, const void *source, size_t length);
+
+    char *mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+    char *prefixes_ = nullptr;
+    char *data_ = nullptr;
+    uint64_t capacity_ = 0;
+#if defined(_WIN32) || defined(_WIN64)
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE file_mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+} // namespace mediampv
+
+#endif // MEDIAMP_LOG_RING_FILE_H
@@ -11,33 +11,42 @@ namespace mediampv {
 #define UTIL_EXTERN extern
 #endif
 
-// The process-wide JavaVM, captured in mpv_handle_t::create(). Null until the first handle
-// is created; the log dispatcher reads it and falls back to stderr while it is null. Plain
+// The process-wide JavaVM, captured in JNI_OnLoad (or, failing that, when the first handle
+// is created); the log dispatcher reads it and falls back to stderr while it is null. Plain
 // `extern` (not UTIL_EXTERN): the single definition lives in mpv_handle_t.cpp.
 extern JavaVM *global_jvm;
 
 UTIL_EXTERN jclass jni_mediamp_clazz_EventListener;
-UTIL_EXTERN jmethodID jni_mediamp_method_EventListener_onPropertyChange_NONE;
-UTIL_EXTERN jmethodID jni_mediamp_method_EventListener_onPropertyChange_FLAG;
-UTIL_EXTERN jmethodID jni_mediamp_method_EventListener_onPropertyChange_INT64;
-UTIL_EXTERN jmethodID jni_mediamp_method_EventListener_onPropertyChange_DOUBLE;
-UTIL_EXTERN jmethodID jni_mediamp_method_EventListener_onPropertyChange_STRING;
+UTIL_EXTERN jmethodID jni_mediamp_method_EventListener_onPropertyNone;
+UTIL_EXTERN jmethodID jni_mediamp_method_EventListener_onPropertyFlag;
+UTIL_EXTERN jmethodID jni_mediamp_method_EventListener_onPropertyInt64;
+UTIL_EXTERN jmethodID jni_mediamp_method_EventListener_onPropertyDouble;
+UTIL_EXTERN jmethodID jni_mediamp_method_EventListener_onPropertyString;
 UTIL_EXTERN jmethodID jni_mediamp_method_EventListener_onEvent;
 UTIL_EXTERN jmethodID jni_mediamp_method_EventListener_onStartFile;
 UTIL_EXTERN jmethodID jni_mediamp_method_EventListener_onEndFile;
+UTIL_EXTERN jclass jni_mediamp_clazz_EventBatchDispatcher;
+UTIL_EXTERN jmethodID jni_mediamp_method_EventBatchDispatcher_dispatch;
 UTIL_EXTERN jclass jni_mediamp_clazz_RenderUpdateListener;
 UTIL_EXTERN jmethodID jni_mediamp_method_RenderUpdateListener_onRenderUpdate;
-UTIL_EXTERN jclass jni_mediamp_clazz_MPVLogKt;
-UTIL_EXTERN jmethodID jni_mediamp_method_MPVLogKt_onNativeLog;
+UTIL_EXTERN jclass jni_mediamp_clazz_AsyncReplyListener;
+UTIL_EXTERN jmethodID jni_mediamp_method_AsyncReplyListener_onReply;
+UTIL_EXTERN jclass jni_mediamp_clazz_NativeLogBatchKt;
+UTIL_EXTERN jmethodID jni_mediamp_method_NativeLogBatchKt_onNativeLogBatch;
 UTIL_EXTERN jclass jni_mediamp_clazz_SeekableInput;
 UTIL_EXTERN jmethodID jni_mediamp_method_SeekableInput_read;
 UTIL_EXTERN jmethodID jni_mediamp_method_SeekableInput_seekTo;
+UTIL_EXTERN jmethodID jni_mediamp_method_SeekableInput_getPosition;
 UTIL_EXTERN jmethodID jni_mediamp_method_SeekableInput_close;
+UTIL_EXTERN jmethodID jni_mediamp_method_SeekableInput_interrupt;
+UTIL_EXTERN jclass jni_mediamp_clazz_ByteBufferSeekableInput;
+UTIL_EXTERN jmethodID jni_mediamp_method_ByteBufferSeekableInput_read;
 #ifdef __ANDROID__
 UTIL_EXTERN jclass jni_mediamp_clazz_android_Surface;
 #endif
 
-// Resolves and caches every JNI class/method the native<->Kotlin bridge dispatches to.
+// Resolves and caches every JNI class/method the native<->Kotlin bridge dispatches to. Done
+// once in JNI_OnLoad; the later calls (nMake, the event loop) are then a lock-free flag check.
 // All-or-nothing: returns true when the cache is populated (possibly by an earlier call),
 // false when any class or method failed to resolve — e.g. the Kotlin mediamp-mpv artifact
 // on the classpath does not match the version this native library was built against.
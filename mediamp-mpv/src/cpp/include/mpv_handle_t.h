@@ -17,6 +17,8 @@
 #include <mpv/client.h>
 #include <mpv/render_gl.h>
 #include <mpv/stream_cb.h>
+#include "event_ring.h"
+#include "property_throttle.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -53,13 +55,66 @@ public:
     bool destroy(JNIEnv *env);
 
     bool command(const char **args);
+    // Asynchronous command and property set: queued with mpv_command_node_async /
+    // mpv_set_property_async without waiting for mpv's core. Each request gets an ID, the
+    // reply_userdata of its MPV_EVENT_COMMAND_REPLY / MPV_EVENT_SET_PROPERTY_REPLY, under
+    // which `listener` (an AsyncReplyListener) waits; the event loop calls it with the
+    // reply's mpv error code (>= 0 on success), or destroy() does with
+    // MPV_ERROR_UNINITIALIZED when the handle goes away first. Returns false, without ever
+    // calling `listener`, when mpv refuses to queue the request.
+    bool command_async(JNIEnv *env, const char **args, jobject listener);
+    bool set_property_async(JNIEnv *env, const char *name, mpv_format format, void *in_value, jobject listener);
     bool set_option(const char *key, const char *value);
+    // Sets this instance's log threshold (log.h): native lines above it are dropped before
+    // they are formatted, and mpv is asked for its messages up to the same level only.
+    bool set_log_level(int level);
     bool get_property(const char *name, mpv_format format, void *out_result);
+    // Reads `count` (at most 64) properties under one acquisition of handle_lock, property i
+    // as formats[i] into out[i]: MPV_FORMAT_FLAG as 0 or 1, MPV_FORMAT_INT64 as is and
+    // MPV_FORMAT_DOUBLE as its bits; other formats and null names are not read. Returns a
+    // mask with bit i set when property i was read.
+    uint64_t get_properties(const char *const *names, const mpv_format *formats, int64_t *out, size_t count);
     bool set_property(const char *name, mpv_format format, void *in_value);
-    bool observe_property(const char *property, mpv_format format, uint64_t reply_data);
+    // min_interval_nanos / epsilon: see property_throttle.h; both 0 delivers every change.
+    // Throttling is keyed by reply_data, so a throttled property needs its own.
+    bool observe_property(
+            const char *property,
+            mpv_format format,
+            uint64_t reply_data,
+            int64_t min_interval_nanos = 0,
+            double epsilon = 0);
     bool unobserve_property(uint64_t reply_data);
-    bool register_seekable_input(JNIEnv *env, jobject seekable_input, const char *uri, int64_t size);
+    // Switches event delivery to the poll-based ring (event_ring.h) laid out over `buffer`,
+    // a direct ByteBuffer owned by `ring`, the MpvEventRing: from then on the event loop
+    // stops calling the EventListener. Returns a local reference to the MpvEventRing that
+    // is open, which is the one opened before when there is one; `ring` may then be null.
+    // Null on failure. The ring stays open until destroy().
+    jobject open_event_ring(JNIEnv *env, jobject ring, jobject buffer);
+    mediampv::event_ring *event_ring() const { return event_ring_.load(std::memory_order_acquire); }
+    // read_ahead_size: bytes the native prefetch thread keeps buffered ahead of mpv's
+    // reads (read_ahead_cache.h); 0 disables read-ahead and every read calls into Kotlin.
+    // min_read_size: smallest read made on the input. mpv's smaller reads are coalesced
+    // into one read of this size and served from native memory; 0 passes them through.
+    // cache_key: identity of the bytes behind the input, or null. Inputs registered with
+    // the same key, on any handle, share one read-ahead block cache.
+    // content_id: stable identity of the content, or null. With read-ahead and a
+    // configured disk tier (disk_cache.h), fetched blocks are kept on disk under it.
+    // file_path: UTF-8 path of the local file the input reads, or null. When it can be
+    // opened, mpv reads the file natively (native_file.h) instead of through the input.
+    bool register_seekable_input(
+            JNIEnv *env,
+            jobject seekable_input,
+            const char *uri,
+            int64_t size,
+            int64_t read_ahead_size,
+            int32_t min_read_size,
+            const char *cache_key,
+            const char *content_id,
+            const char *file_path);
     bool unregister_seekable_input(const char *uri);
+    // Fills out_stats with the counters of the input registered at `uri`, in the order
+    // SeekableInputStats decodes them. Returns false when no such input is registered.
+    bool get_seekable_input_stats(const char *uri, std::vector<int64_t> &out_stats);
 
     bool attach_android_surface(JNIEnv *env, jobject surface);
     bool detach_android_surface(JNIEnv *env);
@@ -180,6 +235,9 @@ public:
     bool set_surface_config(int width, int height, int64_t ignored_device_ptr = 0);
     uint64_t get_frame_state();
     int64_t get_buffer_texture(int index); // GLuint texture name, not an FBO.
+    // Makes the GL context current on the calling thread (Skiko's context A) wait, on the
+    // GPU, for the producer's writes to buffer `index`. Call before sampling its texture.
+    bool wait_buffer_fence(int index);
     bool ack_retired_buffers();
     bool has_opengl_surface();
     bool save_surface_png(const char *path);
@@ -192,16 +250,35 @@ public:
 private:
     JavaVM *jvm_ = nullptr;
     mpv_handle *handle_ = nullptr;
-    // Serializes the simple hot methods (command/set_option/get/set/observe/unobserve
-    // property) that read handle_ and call mpv_* against destroy()'s
-    // mpv_terminate_destroy + handle_=nullptr, closing the TOCTOU/use-after-free window
-    // when teardown races an in-flight native call. Recursive (CREATE_LOCK), but never
-    // nested with another lock in those methods to avoid lock-order inversions (the
-    // seekable-stream methods intentionally do NOT take it — they are ordered under
-    // stream_registry_lock instead).
-    CREATE_LOCK(handle_lock);
-
+    // Held shared by the simple hot methods (command/set_option/get/set/observe/unobserve
+    // property and their async forms) that read handle_ and call mpv_*, which libmpv lets
+    // run concurrently, and exclusively by destroy()'s mpv_terminate_destroy +
+    // handle_=nullptr, closing the TOCTOU/use-after-free window when teardown races an
+    // in-flight native call. Not recursive: those methods never call each other, and never
+    // nest it with another lock to avoid lock-order inversions (the seekable-stream methods
+    // intentionally do NOT take it — they are ordered under stream_registry_lock instead).
+    CREATE_SHARED_LOCK(handle_lock);
+    // Set by destroy() before it takes handle_lock; the hot methods then fail instead of
+    // taking it shared, so that destroy() is not starved by them.
+    std::atomic_bool destroying_{false};
+
+    // The listener, and whether it is an EventBatchDispatcher (the event loop then hands it
+    // packed batches, event_batch.h, instead of calling the EventListener methods once per
+    // event). Replaced together under event_listener_lock, and bumping the generation.
+    CREATE_LOCK(event_listener_lock);
     jobject event_listener_ = nullptr;
+    bool event_listener_batched_ = false;
+    // Lets the event loop tell without the lock that its copy of the pair is stale.
+    std::atomic<uint32_t> event_listener_generation_{0};
+    mediampv::property_throttle property_throttle_;
+    // The open ring, with global references to the MpvEventRing and the buffer it lives in;
+    // guarded by handle_lock.
+    std::unique_ptr<mediampv::event_ring> event_ring_owner_;
+    jobject event_ring_object_ = nullptr;
+    jobject event_ring_buffer_ = nullptr;
+    std::atomic<mediampv::event_ring *> event_ring_{nullptr};
+    // Guarded by render_update_listener_lock, which is also held while the listener is
+    // called: the listener must not set or clear itself.
     jobject render_update_listener_ = nullptr;
     CREATE_LOCK(render_update_listener_lock);
 
@@ -368,6 +445,9 @@ private:
     struct opengl_buffer {
         uint32_t texture = 0; // GL_TEXTURE_2D / GL_RGBA8
         uint32_t fbo = 0;
+        // GLsync signalled when the last frame rendered into this buffer completes. Replaced
+        // and deleted under render_mutex_, which wait_buffer_fence() holds while queueing a wait on it.
+        void *fence = nullptr;
     };
     opengl_buffer buffers_[kOpenGLBufferCount];
     opengl_buffer retired_buffers_[kOpenGLBufferCount];
@@ -415,7 +495,7 @@ private:
     bool allocate_buffer(opengl_buffer &buffer, int width, int height);
     void destroy_buffer_ring(opengl_buffer *ring);
     void publish_state_locked();
-    bool render_into(const opengl_buffer &buffer);
+    bool render_into(const opengl_buffer &buffer, void *&out_fence);
     void drain_one_frame();
     bool write_surface_png_on_render_thread(const char *path);
     bool read_surface_pixels_on_render_thread(
@@ -428,13 +508,28 @@ private:
     CREATE_LOCK(stream_registry_lock);
     std::unordered_map<std::string, std::shared_ptr<seekable_stream_entry>> seekable_streams_;
 
+    // Async requests in flight: request ID -> global ref of the AsyncReplyListener. A leaf
+    // lock: command_async/set_property_async take it under handle_lock, and nothing is
+    // acquired while holding it.
+    std::mutex pending_replies_lock;
+    std::unordered_map<uint64_t, jobject> pending_replies_;
+    uint64_t next_request_id_ = 1; // guarded by pending_replies_lock
+
     void *event_loop(void *arg);
+    // Registers `listener` under a new request ID; 0 on failure.
+    uint64_t add_pending_reply(JNIEnv *env, jobject listener);
+    // Removes the request and returns its listener (a global ref now owned by the caller),
+    // or null when it is not pending (anymore).
+    jobject take_pending_reply(uint64_t request_id);
+    void complete_reply(JNIEnv *env, uint64_t request_id, int error);
+    void fail_pending_replies(JNIEnv *env);
     bool ensure_stream_protocol_registered();
     int open_seekable_stream(const char *uri, mpv_stream_cb_info *info);
     static int open_seekable_stream(void *user_data, char *uri, mpv_stream_cb_info *info);
     static void on_render_update(void *context);
     void clear_event_listener(JNIEnv *env);
     void clear_render_update_listener(JNIEnv *env);
+    void close_event_ring(JNIEnv *env);
     void notify_render_update();
     void clear_seekable_streams();
 #ifdef __ANDROID__
@@ -0,0 +1,63 @@
+#pragma once
+
+#ifndef MEDIAMP_NATIVE_FILE_H
+#define MEDIAMP_NATIVE_FILE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#endif
+
+namespace mediampv {
+
+// A local file read with positional reads (pread / ReadFile at an offset), used instead
+// of the Kotlin SeekableInput when the input is backed by a plain file: mpv's reads then
+// go from the page cache into mpv's buffer without JNI or a JVM-side buffer.
+//
+// Read-ahead is left to the OS: the file is opened with a sequential-access hint and the
+// window ahead of each read is announced with posix_fadvise(WILLNEED) (F_RDADVISE on
+// Apple platforms). Positional reads keep no cursor, so one instance may serve several
+// readers at once.
+class native_file final {
+public:
+    // Opens `path` (UTF-8) for reading. Returns null, after logging why, when the file
+    // cannot be opened; the caller is expected to fall back to the SeekableInput.
+    static std::unique_ptr<native_file> open(const char *path, const void *instance_handle);
+    ~native_file();
+
+    native_file(const native_file &) = delete;
+    native_file &operator=(const native_file &) = delete;
+
+    // Reads up to `length` bytes at `offset`. Returns the number of bytes read, 0 at end of
+    // file, or -1 on error.
+    int64_t read_at(int64_t offset, char *buffer, int64_t length);
+
+private:
+    // How far ahead of a read the OS is asked to prefetch.
+    static constexpr int64_t kAdviseWindow = 8 * 1024 * 1024;
+
+#if defined(_WIN32) || defined(_WIN64)
+    explicit native_file(HANDLE handle, const void *instance_handle)
+            : handle_(handle), instance_handle_(instance_handle) {}
+
+    HANDLE handle_ = INVALID_HANDLE_VALUE;
+#else
+    explicit native_file(int fd, const void *instance_handle)
+            : fd_(fd), instance_handle_(instance_handle) {}
+
+    void advise(int64_t offset);
+
+    int fd_ = -1;
+    // End of the range last announced to the OS; racy by design, a stale value only costs
+    // a redundant or a skipped hint.
+    std::atomic<int64_t> advised_end_{0};
+#endif
+    const void *instance_handle_ = nullptr;
+};
+
+} // namespace mediampv
+
+#endif // MEDIAMP_NATIVE_FILE_H
@@ -0,0 +1,35 @@
+#pragma once
+
+#ifndef MEDIAMP_NATIVE_UTIL_H
+#define MEDIAMP_NATIVE_UTIL_H
+
+#include <cstddef>
+#include <jni.h>
+#include "log.h"
+
+namespace mediampv {
+
+// Rounds `length` up to a multiple of 8, the alignment of the records in the buffers
+// shared with Kotlin (event batches, log batches) and in the log ring file.
+inline size_t align8(size_t length) {
+    return (length + 7) & ~static_cast<size_t>(7);
+}
+
+// Returns whether a JNI call left an exception pending, and if so describes, clears and
+// logs it against `instance_handle`, naming the call in `context`.
+inline bool clear_jni_exception(JNIEnv *env, const void *instance_handle, const char *context) {
+    if (!env || !env->ExceptionCheck()) {
+        return false;
+    }
+
+    // Describe + clear before logging: the log dispatcher makes JNI calls, which must not
+    // run with an exception pending.
+    env->ExceptionDescribe();
+    env->ExceptionClear();
+    LOG(instance_handle, LOG_LEVEL_ERROR, "JNI exception in %s", context);
+    return true;
+}
+
+} // namespace mediampv
+
+#endif // MEDIAMP_NATIVE_UTIL_H
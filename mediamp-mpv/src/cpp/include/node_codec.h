@@ -0,0 +1,29 @@
+#pragma once
+
+#ifndef MEDIAMP_NODE_CODEC_H
+#define MEDIAMP_NODE_CODEC_H
+
+#include <vector>
+#include <mpv/client.h>
+
+namespace mediampv {
+
+// Flattens an mpv_node tree (e.g. "track-list" read as MPV_FORMAT_NODE) into the compact
+// encoding MpvNode.kt decodes in one pass, so a structured property crosses JNI as a single
+// byte array instead of one property read per field.
+//
+// Each node is a one-byte tag (its mpv_format) followed by, little-endian:
+// - MPV_FORMAT_NONE: nothing;
+// - MPV_FORMAT_STRING: int32 byte length, UTF-8 bytes;
+// - MPV_FORMAT_FLAG: one byte, 0 or 1;
+// - MPV_FORMAT_INT64: int64;
+// - MPV_FORMAT_DOUBLE: the int64 bits of the double;
+// - MPV_FORMAT_NODE_ARRAY: int32 count, then that many nodes;
+// - MPV_FORMAT_NODE_MAP: int32 count, then that many (int32 key length, UTF-8 key, node);
+// - MPV_FORMAT_BYTE_ARRAY: int32 length, the bytes.
+// Any other format is written as MPV_FORMAT_NONE.
+void flatten_node(const mpv_node &node, std::vector<char> &out);
+
+} // namespace mediampv
+
+#endif // MEDIAMP_NODE_CODEC_H
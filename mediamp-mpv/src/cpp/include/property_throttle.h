@@ -0,0 +1,78 @@
+#pragma once
+
+#ifndef MEDIAMP_PROPERTY_THROTTLE_H
+#define MEDIAMP_PROPERTY_THROTTLE_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <mpv/client.h>
+
+namespace mediampv {
+
+// Rate limits of observed properties, keyed by the reply_userdata they were observed with.
+// mpv reports some properties (time-pos above all) at its internal rate; a throttled
+// property is delivered at most once per interval, changes in between are coalesced so
+// that only the latest value is delivered when the interval ends, and for doubles a change
+// smaller than epsilon from the last delivered value is dropped.
+//
+// configure/remove may be called from any thread; admit, flush_due and wait_timeout are
+// called by the event loop only.
+class property_throttle final {
+public:
+    using clock = std::chrono::steady_clock;
+
+    // A zero interval and epsilon removes the limit.
+    void configure(uint64_t reply_data, int64_t min_interval_nanos, double epsilon);
+    void remove(uint64_t reply_data);
+
+    // Returns true when `event` (a property change) should be delivered now. Otherwise it
+    // has been dropped, or kept as its property's pending change until flush_due.
+    bool admit(const mpv_event &event, clock::time_point now);
+
+    // Hands every pending change whose interval has elapsed to `deliver`, as a property
+    // change event valid only during the call.
+    void flush_due(clock::time_point now, const std::function<void(const mpv_event &)> &deliver);
+
+    // Hands every pending change to `deliver` whether or not it is due, like flush_due. For
+    // an event about to be delivered: the pending changes were queued before it.
+    void flush_pending(clock::time_point now, const std::function<void(const mpv_event &)> &deliver);
+
+    // Forgets every pending change, for a file that ended: its values are stale.
+    void drop_pending();
+
+    // Timeout for mpv_wait_event: seconds until the next pending change is due, or -1 when
+    // nothing is pending.
+    double wait_timeout(clock::time_point now);
+
+private:
+    struct entry final {
+        int64_t min_interval_nanos = 0;
+        double epsilon = 0;
+
+        bool delivered = false;
+        clock::time_point last_delivery;
+        double last_double = 0;
+
+        bool pending = false;
+        std::string name;
+        mpv_format format = MPV_FORMAT_NONE;
+        bool has_data = false;
+        int64_t value = 0; // flag, int64 or the bits of a double
+        std::string string_value;
+    };
+
+    std::mutex mutex_;
+    std::unordered_map<uint64_t, entry> entries_; // guarded by mutex_
+    bool empty_ = true;                           // guarded by mutex_
+
+    static void mark_delivered(entry &entry, clock::time_point now, double value);
+    void flush(clock::time_point now, bool due_only, const std::function<void(const mpv_event &)> &deliver);
+};
+
+} // namespace mediampv
+
+#endif // MEDIAMP_PROPERTY_THROTTLE_H
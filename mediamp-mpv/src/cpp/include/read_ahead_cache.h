@@ -0,0 +1,175 @@
+#pragma once
+
+#ifndef MEDIAMP_READ_AHEAD_CACHE_H
+#define MEDIAMP_READ_AHEAD_CACHE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace mediampv {
+
+// Where a read_ahead_cache gets its bytes from. Every method is called on the cache's
+// prefetch thread only, so an implementation needs no locking of its own against the
+// cache (it may still need it against other users of the underlying source).
+class block_source {
+public:
+    // What fetch returns when it failed because of interrupt_fetch, including an interrupt
+    // that arrived after the fetch it was meant for had already returned.
+    static constexpr int64_t kInterrupted = -2;
+
+    virtual ~block_source() = default;
+
+    // Bracket the prefetch thread's lifetime, e.g. to attach it to the JVM once instead of
+    // once per fetch.
+    virtual void attach_prefetch_thread() {}
+    virtual void detach_prefetch_thread() {}
+
+    // Reads up to `length` bytes at absolute `offset` into `buffer`. Returns the number of
+    // bytes read (may be short), 0 at end of input, kInterrupted when it was interrupted, or
+    // another negative value on error.
+    virtual int64_t fetch(int64_t offset, char *buffer, int64_t length) = 0;
+
+    // Makes a fetch blocked on another thread return promptly (with an error). Called from
+    // reader threads, concurrently with fetch; must not block.
+    virtual void interrupt_fetch() {}
+
+    // Optional persistent tier below the cache (disk_cache.h). load_block is tried before
+    // a block is fetched and returns true when it filled all `length` bytes of block
+    // `index`; store_block is handed every block that was fetched completely.
+    virtual bool load_block(int64_t /* index */, char * /* buffer */, int64_t /* length */) { return false; }
+    virtual void store_block(int64_t /* index */, const char * /* buffer */, int64_t /* length */) {}
+};
+
+struct read_ahead_stats final {
+    // Reads served from bytes that were already cached when the read arrived.
+    uint64_t hits = 0;
+    // Reads that had to wait for a prefetch thread to fetch their bytes.
+    uint64_t misses = 0;
+    // Blocks loaded from the source's persistent tier instead of being fetched.
+    uint64_t blocks_loaded = 0;
+};
+
+// Block cache in front of a block_source, filled by a dedicated prefetch thread that keeps
+// `read_ahead_size` bytes ahead of each reader. Readers only ever memcpy out of native
+// memory; a read whose block is not there yet waits until at least one chunk of it has been
+// fetched.
+//
+// Blocks live in one process-wide store, keyed by the stream key given at construction
+// and bounded by a shared memory budget with LRU eviction. Caches constructed with the
+// same key (e.g. the player and the frame-preview decoder opening the same media, each
+// through its own SeekableInput) therefore share every block either of them has fetched,
+// and a block being fetched by one is waited for, not fetched again, by the other. The
+// blocks of a key are dropped when its last cache is destroyed.
+//
+// A cache serves any number of readers, each with its own position (one per mpv open of
+// the stream). Blocks are filled in chunks of `fetch_size` bytes, one source fetch each,
+// so a reader is released as soon as the chunk holding its bytes arrives rather than when
+// the whole block is complete. When a reader
+// jumps to a block that is not cached, the prefetch thread abandons its current
+// (speculative) block and resumes it later if it is still wanted; the fetch in flight for
+// it is interrupted (block_source::interrupt_fetch), so the jump is not held up by data
+// that may be slow to arrive.
+class read_ahead_cache final {
+public:
+    static constexpr int64_t kBlockSize = 512 * 1024;
+    // Bounds of the fetch_size given at construction.
+    static constexpr int64_t kMinFetchSize = 64 * 1024;
+    static constexpr int64_t kMaxFetchSize = kBlockSize;
+    // Blocks behind each reader that are kept when evicting, so the short backward seeks
+    // demuxers do while probing stay in cache.
+    static constexpr int kBlocksBehind = 2;
+    static constexpr int64_t kDefaultMemoryBudget = 64 * 1024 * 1024;
+
+    // Sets the memory budget of the process-wide block store. Shrinking it takes effect as
+    // blocks are evicted for new ones; blocks readers are waiting for are always admitted.
+    static void set_memory_budget(int64_t bytes);
+
+    struct reader;
+
+    // An empty stream_key makes the cache private to this instance.
+    read_ahead_cache(
+            block_source &source,
+            const std::string &stream_key,
+            int64_t size,
+            int64_t read_ahead_size,
+            int64_t fetch_size,
+            const void *instance_handle);
+    ~read_ahead_cache();
+
+    read_ahead_cache(const read_ahead_cache &) = delete;
+    read_ahead_cache &operator=(const read_ahead_cache &) = delete;
+
+    // Starts the prefetch thread if it is not running yet. Returns false (leaving the cache
+    // unusable) when the thread cannot be started or the cache has already been stopped.
+    bool start();
+    // Wakes every waiting reader (they return an error) and tells the prefetch thread to
+    // exit after the fetch in flight. Does not block.
+    void request_stop();
+    // request_stop() and joins the prefetch thread. Must not be called from it.
+    void stop();
+    bool running() const { return running_.load(std::memory_order_acquire); }
+
+    // Readers are owned by the cache; a reader must be closed before the cache is destroyed.
+    reader *open_reader();
+    void close_reader(reader *reader);
+    // Makes the pending and later reads of `reader` fail, leaving the other readers and the
+    // prefetch thread running. A fetch in flight that no other reader wants is interrupted.
+    // Does not block.
+    void cancel_reader(reader *reader);
+
+    // Copies up to `length` bytes at `offset` into `buffer`, waiting for the prefetch
+    // thread when they are not cached yet. Never crosses a block boundary. Returns the
+    // number of bytes copied, 0 at end of input, or -1 when the fetch failed or the cache
+    // was stopped.
+    int64_t read(reader *reader, int64_t offset, char *buffer, int64_t length);
+
+    read_ahead_stats stats() const;
+
+private:
+    class store;
+    struct block;
+
+    block_source &source_;
+    const void *instance_handle_;
+    store &store_;
+    const std::string stream_key_;
+    const uint64_t stream_id_;
+    const int64_t size_;
+    const int64_t block_count_;
+    const int64_t ahead_blocks_;
+    const int64_t fetch_size_;
+
+    // Everything below is guarded by the store's mutex.
+    std::list<reader> readers_;
+    bool stopping_ = false;
+    std::atomic_bool running_{false};
+    std::thread thread_;
+    // Block the prefetch thread is fetching into, -1 when it is not fetching.
+    int64_t fetching_ = -1;
+    // interrupt_fetch has been called for the fetch in flight, which is taken as
+    // interrupted rather than failed if it fails. Reset whenever that fetch returns, so an
+    // interrupt the fetch ignored cannot excuse a later, real failure.
+    bool interrupt_requested_ = false;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> blocks_loaded_{0};
+
+    void prefetch_loop();
+    int64_t block_length(int64_t index) const;
+    bool needs_fetch(int64_t index);
+    bool is_waited_for(int64_t index) const;
+    bool is_wanted(int64_t index, int64_t behind) const;
+    int64_t next_block_to_fetch();
+    bool should_abandon(int64_t index);
+};
+
+} // namespace mediampv
+
+#endif // MEDIAMP_READ_AHEAD_CACHE_H
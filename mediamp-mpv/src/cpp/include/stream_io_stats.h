@@ -0,0 +1,69 @@
+#pragma once
+
+#ifndef MEDIAMP_STREAM_IO_STATS_H
+#define MEDIAMP_STREAM_IO_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace mediampv {
+
+// I/O telemetry of one stream_cb input. Every counter is a relaxed atomic so the mpv
+// demuxer thread, the read-ahead prefetch thread and a JNI reader can update and sample it
+// without a lock; a snapshot is therefore only approximately consistent across counters.
+class stream_io_stats final {
+public:
+    using clock = std::chrono::steady_clock;
+
+    static int64_t nanos_since(clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+    }
+
+    // A read_fn call that returned `result` after `nanos`.
+    void record_read(int64_t result, int64_t nanos);
+    void record_seek() { seek_calls_.fetch_add(1, std::memory_order_relaxed); }
+    // A SeekableInput.seekTo call that reached Kotlin.
+    void record_input_seek() { input_seeks_.fetch_add(1, std::memory_order_relaxed); }
+    // An mpv seek that was settled without SeekableInput.seekTo: the read after it was
+    // served from memory or the input was already there, or it was superseded unread.
+    void record_elided_seek() { elided_seeks_.fetch_add(1, std::memory_order_relaxed); }
+    void record_jni_attach() { jni_attaches_.fetch_add(1, std::memory_order_relaxed); }
+    // A SeekableInput.read call, on mpv's thread or the read-ahead thread.
+    void record_input_read() { input_reads_.fetch_add(1, std::memory_order_relaxed); }
+    // Time inside SeekableInput.read / seekTo, i.e. waiting for the input to produce data.
+    void add_input_nanos(int64_t nanos) { input_nanos_.fetch_add(nanos, std::memory_order_relaxed); }
+    // Time copying bytes between JVM and native memory, and out of the stash.
+    void add_copy_nanos(int64_t nanos) { copy_nanos_.fetch_add(nanos, std::memory_order_relaxed); }
+    // Time waiting for the stream's io_lock.
+    void add_lock_wait_nanos(int64_t nanos) { lock_wait_nanos_.fetch_add(nanos, std::memory_order_relaxed); }
+
+    // Appends the counters in the order of SeekableInputStats on the Kotlin side.
+    void append_to(std::vector<int64_t> &out) const;
+
+private:
+    // Bucket i counts reads that took less than 2^i microseconds (and at least 2^(i-1));
+    // the last bucket also takes everything slower.
+    static constexpr int kLatencyBuckets = 32;
+
+    int64_t latency_percentile_micros(double percentile) const;
+
+    std::atomic<uint64_t> read_calls_{0};
+    std::atomic<uint64_t> read_bytes_{0};
+    std::atomic<uint64_t> read_errors_{0};
+    std::atomic<uint64_t> seek_calls_{0};
+    std::atomic<uint64_t> input_seeks_{0};
+    std::atomic<uint64_t> elided_seeks_{0};
+    std::atomic<uint64_t> jni_attaches_{0};
+    std::atomic<uint64_t> input_reads_{0};
+    std::atomic<int64_t> input_nanos_{0};
+    std::atomic<int64_t> copy_nanos_{0};
+    std::atomic<int64_t> lock_wait_nanos_{0};
+    std::atomic<int64_t> max_read_nanos_{0};
+    std::atomic<uint64_t> latency_buckets_[kLatencyBuckets] = {};
+};
+
+} // namespace mediampv
+
+#endif // MEDIAMP_STREAM_IO_STATS_H
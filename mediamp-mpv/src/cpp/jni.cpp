@@ -1,6 +1,11 @@
 #include <iostream>
+#include <atomic>
 #include <cstdint>
+#include <cstring>
 #include <limits>
+#include <mutex>
+#include <string>
+#include <unordered_set>
 #include <vector>
 #include <jni.h>
 #include <cstdio>
@@ -15,16 +20,63 @@
 #include <jawt_md.h>
 #endif
 #include "mpv_handle_t.h"
+#include "read_ahead_cache.h"
+#include "disk_cache.h"
+#include "handle_pool.h"
 #include "method_cache.h"
+#include "node_codec.h"
 
 #define FN(name) Java_org_openani_mediamp_mpv_MPVHandleKt_##name
 #define FN_ANDROID(name) Java_org_openani_mediamp_mpv_MPVHandleAndroid_##name
 #define FN_DESKTOP(name) Java_org_openani_mediamp_mpv_MPVHandleDesktop_##name
+#define FN_JVM(name) Java_org_openani_mediamp_mpv_MPVHandleJvm_##name
 
 namespace {
 
+// Handles made by nMake and not yet finalized. A pointer passed in from Kotlin is checked
+// against this set before it is dereferenced, so a stale one (e.g. used after nFinalize)
+// is rejected instead of crashing the VM. Each thread remembers the last handle it
+// validated and the generation it did so in; the generation moves whenever a handle is
+// finalized, so the common case, one handle called over and over (the per-frame
+// getters), costs two thread-local compares and no lock.
+//
+// This catches a handle that was finalized before the call, not one finalized during it:
+// the registry lock is not held while the call uses the instance, so an nFinalize racing
+// the call on another thread can still delete it underneath. Ruling that out is up to
+// MPVHandle, whose close() must not run concurrently with its other methods.
+std::mutex live_instances_mutex;
+std::unordered_set<uintptr_t> live_instances;
+std::atomic<uint64_t> live_instances_generation{1};
+thread_local uintptr_t validated_instance = 0;
+thread_local uint64_t validated_generation = 0;
+
+void add_live_instance(mediampv::mpv_handle_t *instance) {
+    std::lock_guard<std::mutex> guard(live_instances_mutex);
+    live_instances.insert(reinterpret_cast<uintptr_t>(instance));
+}
+
+void remove_live_instance(mediampv::mpv_handle_t *instance) {
+    std::lock_guard<std::mutex> guard(live_instances_mutex);
+    live_instances.erase(reinterpret_cast<uintptr_t>(instance));
+    live_instances_generation.fetch_add(1, std::memory_order_release);
+}
+
 mediampv::mpv_handle_t *get_instance(jlong ptr) {
-    return reinterpret_cast<mediampv::mpv_handle_t *>(static_cast<uintptr_t>(ptr));
+    const auto address = static_cast<uintptr_t>(ptr);
+    if (!address) {
+        return nullptr;
+    }
+    const uint64_t generation = live_instances_generation.load(std::memory_order_acquire);
+    if (address != validated_instance || generation != validated_generation) {
+        std::lock_guard<std::mutex> guard(live_instances_mutex);
+        if (live_instances.find(address) == live_instances.end()) {
+            LOGW("rejected a native mpv handle that is not live: %p", reinterpret_cast<void *>(address));
+            return nullptr;
+        }
+        validated_instance = address;
+        validated_generation = generation;
+    }
+    return reinterpret_cast<mediampv::mpv_handle_t *>(address);
 }
 
 #if defined(_WIN32) || defined(__APPLE__) || (defined(__linux__) && !defined(__ANDROID__))
@@ -60,11 +112,25 @@ jintArray read_surface_pixels_to_java(
 #endif
 
 struct scoped_utf_chars final {
-    scoped_utf_chars(JNIEnv *env, jstring string)
-            : env(env), string(string), chars(string ? env->GetStringUTFChars(string, nullptr) : nullptr) {}
+    scoped_utf_chars(JNIEnv *env, jstring string) : env(env), string(string), chars(nullptr) {
+        if (!string) {
+            return;
+        }
+        // Property names, the keys of the hot getters, fit the inline buffer: copying them
+        // there saves the heap copy GetStringUTFChars makes and releases on every call. A
+        // UTF-16 unit is at most 3 bytes of modified UTF-8, which never contains a NUL.
+        const jsize length = env->GetStringLength(string);
+        if (length < static_cast<jsize>(sizeof(inline_chars) / 3)) {
+            std::memset(inline_chars, 0, static_cast<size_t>(length) * 3 + 1);
+            env->GetStringUTFRegion(string, 0, length, inline_chars);
+            chars = inline_chars;
+        } else {
+            chars = env->GetStringUTFChars(string, nullptr);
+        }
+    }
 
     ~scoped_utf_chars() {
-        if (env && string && chars) {
+        if (env && string && chars && chars != inline_chars) {
             env->ReleaseStringUTFChars(string, chars);
         }
     }
@@ -84,13 +150,105 @@ private:
     JNIEnv *env;
     jstring string;
     const char *chars;
+    char inline_chars[256];
 };
 
+// Converts the Java command arguments to the NULL-terminated array mpv takes and runs
+// `run` with it; false when there is no instance or an argument cannot be converted.
+template<typename Run>
+bool with_command_arguments(JNIEnv *env, mediampv::mpv_handle_t *instance, jobjectArray args, Run run) {
+    if (!instance || !args) {
+        return false;
+    }
+
+    const jsize len = env->GetArrayLength(args);
+    if (len >= 128) {
+        LOG(instance, mediampv::LOG_LEVEL_ERROR, "nCommand: too many arguments (%d >= 128)", len);
+        return false;
+    }
+
+    std::vector<jstring> local_args(static_cast<size_t>(len), nullptr);
+    std::vector<const char *> arguments(static_cast<size_t>(len) + 1, nullptr);
+    auto release_arguments = [&]() {
+        for (jsize i = 0; i < len; ++i) {
+            if (local_args[static_cast<size_t>(i)] && arguments[static_cast<size_t>(i)]) {
+                env->ReleaseStringUTFChars(local_args[static_cast<size_t>(i)], arguments[static_cast<size_t>(i)]);
+            }
+            if (local_args[static_cast<size_t>(i)]) {
+                env->DeleteLocalRef(local_args[static_cast<size_t>(i)]);
+            }
+        }
+    };
+
+    for (jsize i = 0; i < len; ++i) {
+        auto argument = static_cast<jstring>(env->GetObjectArrayElement(args, i));
+        if (!argument) {
+            release_arguments();
+            return false;
+        }
+        local_args[static_cast<size_t>(i)] = argument;
+        arguments[static_cast<size_t>(i)] = env->GetStringUTFChars(argument, nullptr);
+        if (!arguments[static_cast<size_t>(i)]) {
+            release_arguments();
+            return false;
+        }
+    }
+
+    const bool result = run(arguments.data());
+    release_arguments();
+
+    return result;
+}
+
+// Copies the Java String[] `array` into `out`; false when an element is null or cannot be
+// converted (an exception may then be pending).
+bool read_string_array(JNIEnv *env, jobjectArray array, std::vector<std::string> &out) {
+    if (!array) {
+        return false;
+    }
+    const jsize length = env->GetArrayLength(array);
+    out.reserve(static_cast<size_t>(length));
+    for (jsize i = 0; i < length; ++i) {
+        auto element = static_cast<jstring>(env->GetObjectArrayElement(array, i));
+        bool valid;
+        {
+            scoped_utf_chars chars(env, element);
+            valid = chars.valid();
+            if (valid) {
+                out.emplace_back(chars.get());
+            }
+        }
+        if (element) {
+            env->DeleteLocalRef(element);
+        }
+        if (!valid) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Copies the Java byte[] `bytes`, the standard UTF-8 of a path. Paths are passed this way
+// rather than as a jstring: GetStringUTFChars yields modified UTF-8, which mangles
+// supplementary characters in file names.
+std::string read_utf8_bytes(JNIEnv *env, jbyteArray bytes) {
+    std::string out(static_cast<size_t>(env->GetArrayLength(bytes)), '\0');
+    if (!out.empty()) {
+        env->GetByteArrayRegion(bytes, 0, static_cast<jsize>(out.size()), reinterpret_cast<jbyte *>(&out[0]));
+    }
+    return out;
+}
+
 } // namespace
 
 extern "C" {
     JNIEXPORT jboolean JNICALL FN(nGlobalInit)(JNIEnv *env, jclass clazz);
     JNIEXPORT jlong JNICALL FN(nMake)(JNIEnv *env, jclass clazz, jobject app_context);
+    /**
+     * 预先创建并初始化 mpv 实例的池 (handle_pool.h)
+     */
+    JNIEXPORT void JNICALL FN(nConfigureHandlePool)(JNIEnv *env, jclass clazz, jobject app_context, jobjectArray options, jint size);
+    JNIEXPORT jlong JNICALL FN(nTakePooledHandle)(JNIEnv *env, jclass clazz, jobjectArray options);
     JNIEXPORT jboolean JNICALL FN(nInitialize)(JNIEnv *env, jclass clazz, jlong ptr);
     JNIEXPORT jboolean JNICALL FN(nSetEventListener)(JNIEnv *env, jclass clazz, jlong ptr, jobject listener);
     JNIEXPORT jboolean JNICALL FN(nSetRenderUpdateListener)(JNIEnv *env, jclass clazz, jlong ptr, jobject listener);
@@ -99,6 +257,11 @@ extern "C" {
      * 执行 mpv 命令
      */
     JNIEXPORT jboolean JNICALL FN(nCommand)(JNIEnv *env, jclass clazz, jlong ptr, jobjectArray args);
+    /**
+     * 异步执行 mpv 命令 / 设置属性，完成时回调 AsyncReplyListener
+     */
+    JNIEXPORT jboolean JNICALL FN(nCommandAsync)(JNIEnv *env, jclass clazz, jlong ptr, jobjectArray args, jobject listener);
+    JNIEXPORT jboolean JNICALL FN(nSetPropertyAsync)(JNIEnv *env, jclass clazz, jlong ptr, jstring key, jint format, jlong value, jstring string_value, jobject listener);
     /**
      * 设置 mpv 选项
      */
@@ -109,16 +272,31 @@ extern "C" {
     JNIEXPORT jdouble JNICALL FN(nGetPropertyDouble)(JNIEnv *env, jclass clazz, jlong ptr, jstring key);
     JNIEXPORT jboolean JNICALL FN(nGetPropertyBoolean)(JNIEnv *env, jclass clazz, jlong ptr, jstring key);
     JNIEXPORT jstring JNICALL FN(nGetPropertyString)(JNIEnv *env, jclass clazz, jlong ptr, jstring key);
+    JNIEXPORT jbyteArray JNICALL FN(nGetPropertyNode)(JNIEnv *env, jclass clazz, jlong ptr, jstring key);
+    JNIEXPORT jlong JNICALL FN(nGetProperties)(JNIEnv *env, jclass clazz, jlong ptr, jobjectArray keys, jintArray formats, jlongArray out);
 
     JNIEXPORT jboolean JNICALL FN(nSetPropertyString)(JNIEnv *env, jclass clazz, jlong ptr, jstring key, jstring value);
     JNIEXPORT jboolean JNICALL FN(nSetPropertyInt)(JNIEnv *env, jclass clazz, jlong ptr, jstring key, jint value);
     JNIEXPORT jboolean JNICALL FN(nSetPropertyDouble)(JNIEnv *env, jclass clazz, jlong ptr, jstring key, jdouble value);
     JNIEXPORT jboolean JNICALL FN(nSetPropertyBoolean)(JNIEnv *env, jclass clazz, jlong ptr, jstring key, jboolean value);
 
-    JNIEXPORT jboolean JNICALL FN(nObserveProperty)(JNIEnv *env, jclass clazz, jlong ptr, jstring name, jint format, jlong reply_data);
+    JNIEXPORT jboolean JNICALL FN(nSetLogLevel)(JNIEnv *env, jclass clazz, jlong ptr, jint level);
+    JNIEXPORT void JNICALL FN(nSetDefaultLogLevel)(JNIEnv *env, jclass clazz, jint level);
+    JNIEXPORT jboolean JNICALL FN(nOpenLogRingFile)(JNIEnv *env, jclass clazz, jbyteArray path, jlong capacity);
+    JNIEXPORT jboolean JNICALL FN(nObserveProperty)(JNIEnv *env, jclass clazz, jlong ptr, jstring name, jint format, jlong reply_data, jlong min_interval_nanos, jdouble epsilon);
     JNIEXPORT jboolean JNICALL FN(nUnobserveProperty)(JNIEnv *env, jclass clazz, jlong ptr, jlong reply_data);
-    JNIEXPORT jboolean JNICALL FN(nRegisterSeekableInput)(JNIEnv *env, jclass clazz, jlong ptr, jobject input, jstring uri, jlong size);
+    JNIEXPORT jboolean JNICALL FN(nRegisterSeekableInput)(JNIEnv *env, jclass clazz, jlong ptr, jobject input, jstring uri, jlong size, jlong read_ahead_size, jint min_read_size, jstring cache_key, jstring content_id, jbyteArray file_path);
+    JNIEXPORT void JNICALL FN(nSetSeekableInputCacheBudget)(JNIEnv *env, jclass clazz, jlong bytes);
+    JNIEXPORT void JNICALL FN(nConfigureSeekableInputDiskCache)(JNIEnv *env, jclass clazz, jbyteArray directory, jlong budget, jint policy);
     JNIEXPORT jboolean JNICALL FN(nUnregisterSeekableInput)(JNIEnv *env, jclass clazz, jlong ptr, jstring uri);
+    JNIEXPORT jlongArray JNICALL FN(nGetSeekableInputStats)(JNIEnv *env, jclass clazz, jlong ptr, jstring uri);
+
+    // poll-based event ring (event_ring.h), JVM targets only
+    JNIEXPORT jobject JNICALL FN_JVM(nOpenEventRing)(JNIEnv *env, jclass clazz, jlong ptr, jobject ring, jobject buffer);
+    JNIEXPORT jlong JNICALL FN_JVM(nEventRingAdvance)(JNIEnv *env, jclass clazz, jlong ptr, jlong consumed);
+    JNIEXPORT jlong JNICALL FN_JVM(nMonotonicNanos)(JNIEnv *env, jclass clazz);
+    JNIEXPORT jlong JNICALL FN_JVM(nLogDroppedCount)(JNIEnv *env, jclass clazz);
+    JNIEXPORT jboolean JNICALL FN_JVM(nCommandPacked)(JNIEnv *env, jclass clazz, jlong ptr, jobject args, jint length);
 
     // renderer
     JNIEXPORT jboolean JNICALL FN_ANDROID(nAttachAndroidSurface)(JNIEnv *env, jclass clazz, jlong ptr, jobject surface);
@@ -166,6 +344,7 @@ extern "C" {
 	JNIEXPORT jboolean JNICALL FN_DESKTOP(nSetSurfaceConfigOpenGL)(JNIEnv *env, jclass clazz, jlong ptr, jint width, jint height, jlong consumer_environment_ptr);
 	JNIEXPORT jlong JNICALL FN_DESKTOP(nGetFrameStateOpenGL)(JNIEnv *env, jclass clazz, jlong ptr);
 	JNIEXPORT jlong JNICALL FN_DESKTOP(nGetBufferTextureOpenGL)(JNIEnv *env, jclass clazz, jlong ptr, jint index);
+	JNIEXPORT jboolean JNICALL FN_DESKTOP(nWaitBufferFenceOpenGL)(JNIEnv *env, jclass clazz, jlong ptr, jint index);
 	JNIEXPORT jboolean JNICALL FN_DESKTOP(nAckRetiredBuffersOpenGL)(JNIEnv *env, jclass clazz, jlong ptr);
 	JNIEXPORT jboolean JNICALL FN_DESKTOP(nHasOpenGLSurface)(JNIEnv *env, jclass clazz, jlong ptr);
 	JNIEXPORT jboolean JNICALL FN_DESKTOP(nSaveSurfacePngOpenGL)(JNIEnv *env, jclass clazz, jlong ptr, jstring path);
@@ -193,6 +372,7 @@ JNIEXPORT jboolean JNICALL FN(nGlobalInit)(JNIEnv *env, jclass clazz) {
 JNIEXPORT jlong JNICALL FN(nMake)(JNIEnv *env, jclass clazz, jobject app_context) {
     try {
         auto* handle = new mediampv::mpv_handle_t(env, app_context);
+        add_live_instance(handle);
         return reinterpret_cast<jlong>(handle);
     } catch (const std::exception &e) {
         // A C++ exception unwinding across the JNI boundary is undefined behavior. Translate
@@ -207,6 +387,28 @@ JNIEXPORT jlong JNICALL FN(nMake)(JNIEnv *env, jclass clazz, jobject app_context
     }
 }
 
+JNIEXPORT void JNICALL FN(nConfigureHandlePool)
+        (JNIEnv *env, jclass clazz, jobject app_context, jobjectArray options, jint size) {
+    std::vector<std::string> pool_options;
+    if (size < 0 || !read_string_array(env, options, pool_options)) {
+        return;
+    }
+    mediampv::handle_pool::instance().configure(env, app_context, std::move(pool_options), static_cast<size_t>(size));
+}
+
+JNIEXPORT jlong JNICALL FN(nTakePooledHandle)(JNIEnv *env, jclass clazz, jobjectArray options) {
+    std::vector<std::string> pool_options;
+    if (!read_string_array(env, options, pool_options)) {
+        return 0;
+    }
+    mediampv::mpv_handle_t *handle = mediampv::handle_pool::instance().take(pool_options);
+    if (!handle) {
+        return 0;
+    }
+    add_live_instance(handle);
+    return reinterpret_cast<jlong>(handle);
+}
+
 JNIEXPORT jboolean JNICALL FN(nInitialize)(JNIEnv *env, jclass clazz, jlong ptr) {
     auto *instance = get_instance(ptr);
     if (!instance) {
@@ -236,47 +438,55 @@ JNIEXPORT jboolean JNICALL FN(nSetRenderUpdateListener)
 
 JNIEXPORT jboolean JNICALL FN(nCommand)(JNIEnv *env, jclass clazz, jlong ptr, jobjectArray args) {
     auto *instance = get_instance(ptr);
-    if (!instance || !args) {
-        return JNI_FALSE;
-    }
+    return with_command_arguments(env, instance, args, [instance](const char **arguments) {
+        return instance->command(arguments);
+    }) ? JNI_TRUE : JNI_FALSE;
+}
 
-    const jsize len = env->GetArrayLength(args);
-    if (len >= 128) {
-        LOG(instance, mediampv::LOG_LEVEL_ERROR, "nCommand: too many arguments (%d >= 128)", len);
+JNIEXPORT jboolean JNICALL FN(nCommandAsync)
+        (JNIEnv *env, jclass clazz, jlong ptr, jobjectArray args, jobject listener) {
+    auto *instance = get_instance(ptr);
+    return with_command_arguments(env, instance, args, [env, instance, listener](const char **arguments) {
+        return instance->command_async(env, arguments, listener);
+    }) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL FN(nSetPropertyAsync)
+        (JNIEnv *env, jclass clazz, jlong ptr, jstring key, jint format, jlong value, jstring string_value,
+         jobject listener) {
+    auto *instance = get_instance(ptr);
+    scoped_utf_chars property_key(env, key);
+    if (!instance || !property_key.valid()) {
         return JNI_FALSE;
     }
 
-    std::vector<jstring> local_args(static_cast<size_t>(len), nullptr);
-    std::vector<const char *> arguments(static_cast<size_t>(len) + 1, nullptr);
-    auto release_arguments = [&]() {
-        for (jsize i = 0; i < len; ++i) {
-            if (local_args[static_cast<size_t>(i)] && arguments[static_cast<size_t>(i)]) {
-                env->ReleaseStringUTFChars(local_args[static_cast<size_t>(i)], arguments[static_cast<size_t>(i)]);
-            }
-            if (local_args[static_cast<size_t>(i)]) {
-                env->DeleteLocalRef(local_args[static_cast<size_t>(i)]);
-            }
+    // mpv copies the value before mpv_set_property_async returns.
+    switch (format) {
+        case MPV_FORMAT_FLAG: {
+            int flag = value != 0 ? 1 : 0;
+            return instance->set_property_async(env, property_key.get(), MPV_FORMAT_FLAG, &flag, listener);
         }
-    };
-
-    for (jsize i = 0; i < len; ++i) {
-        auto argument = static_cast<jstring>(env->GetObjectArrayElement(args, i));
-        if (!argument) {
-            release_arguments();
-            return JNI_FALSE;
+        case MPV_FORMAT_INT64: {
+            int64_t int64 = value;
+            return instance->set_property_async(env, property_key.get(), MPV_FORMAT_INT64, &int64, listener);
         }
-        local_args[static_cast<size_t>(i)] = argument;
-        arguments[static_cast<size_t>(i)] = env->GetStringUTFChars(argument, nullptr);
-        if (!arguments[static_cast<size_t>(i)]) {
-            release_arguments();
-            return JNI_FALSE;
+        case MPV_FORMAT_DOUBLE: {
+            double number = 0;
+            std::memcpy(&number, &value, sizeof(number));
+            return instance->set_property_async(env, property_key.get(), MPV_FORMAT_DOUBLE, &number, listener);
+        }
+        case MPV_FORMAT_STRING: {
+            scoped_utf_chars property_value(env, string_value);
+            if (!property_value.valid()) {
+                return JNI_FALSE;
+            }
+            const char *string = property_value.get();
+            return instance->set_property_async(env, property_key.get(), MPV_FORMAT_STRING, &string, listener);
         }
+        default:
+            mediampv::throw_illegal_argument(env, "nSetPropertyAsync: unsupported format", instance);
+            return JNI_FALSE;
     }
-
-    const bool result = instance->command(arguments.data());
-    release_arguments();
-
-    return result;
 }
 
 JNIEXPORT jboolean JNICALL FN(nOption)(JNIEnv *env, jclass clazz, jlong ptr, jstring key, jstring value) {
@@ -360,6 +570,73 @@ JNIEXPORT jstring JNICALL FN(nGetPropertyString)(JNIEnv *env, jclass clazz, jlon
     return jresult;
 }
 
+JNIEXPORT jbyteArray JNICALL FN(nGetPropertyNode)(JNIEnv *env, jclass clazz, jlong ptr, jstring key) {
+    auto *instance = get_instance(ptr);
+    scoped_utf_chars property_key(env, key);
+    if (!instance || !property_key.valid()) {
+        return nullptr;
+    }
+
+    mpv_node node{};
+    if (!instance->get_property(property_key.get(), MPV_FORMAT_NODE, &node)) {
+        return nullptr;
+    }
+    std::vector<char> flattened;
+    mediampv::flatten_node(node, flattened);
+    mpv_free_node_contents(&node);
+
+    jbyteArray result = env->NewByteArray(static_cast<jsize>(flattened.size()));
+    if (!result) {
+        return nullptr; // OOM; exception pending
+    }
+    env->SetByteArrayRegion(
+            result, 0, static_cast<jsize>(flattened.size()), reinterpret_cast<const jbyte *>(flattened.data()));
+    return result;
+}
+
+JNIEXPORT jlong JNICALL FN(nGetProperties)
+        (JNIEnv *env, jclass clazz, jlong ptr, jobjectArray keys, jintArray formats, jlongArray out) {
+    auto *instance = get_instance(ptr);
+    if (!instance || !keys || !formats || !out) {
+        return 0;
+    }
+    const jsize count = env->GetArrayLength(keys);
+    if (count > 64 || env->GetArrayLength(formats) < count || env->GetArrayLength(out) < count) {
+        mediampv::throw_illegal_argument(env, "nGetProperties: at most 64 keys, and as many formats and values");
+        return 0;
+    }
+
+    // The keys are copied back to back into one stack buffer, so the batch costs no heap
+    // allocation; a key that does not fit is reported as not read.
+    char key_chars[2048];
+    size_t used = 0;
+    const char *names[64] = {};
+    mpv_format key_formats[64] = {};
+    jint format_values[64] = {};
+    env->GetIntArrayRegion(formats, 0, count, format_values);
+    for (jsize i = 0; i < count; ++i) {
+        key_formats[i] = static_cast<mpv_format>(format_values[i]);
+        auto key = static_cast<jstring>(env->GetObjectArrayElement(keys, i));
+        if (!key) {
+            continue;
+        }
+        const jsize length = env->GetStringLength(key);
+        const auto utf_length = static_cast<size_t>(env->GetStringUTFLength(key));
+        if (used + utf_length + 1 <= sizeof(key_chars)) {
+            env->GetStringUTFRegion(key, 0, length, key_chars + used);
+            key_chars[used + utf_length] = '\0';
+            names[i] = key_chars + used;
+            used += utf_length + 1;
+        }
+        env->DeleteLocalRef(key);
+    }
+
+    int64_t values[64] = {};
+    const uint64_t valid = instance->get_properties(names, key_formats, values, static_cast<size_t>(count));
+    env->SetLongArrayRegion(out, 0, count, reinterpret_cast<const jlong *>(values));
+    return static_cast<jlong>(valid);
+}
+
 JNIEXPORT jboolean JNICALL FN(nSetPropertyString)(JNIEnv *env, jclass clazz, jlong ptr, jstring key, jstring value) {
     auto *instance = get_instance(ptr);
     scoped_utf_chars property_key(env, key);
@@ -404,14 +681,32 @@ JNIEXPORT jboolean JNICALL FN(nSetPropertyBoolean)(JNIEnv *env, jclass clazz, jl
     return instance->set_property(property_key.get(), MPV_FORMAT_FLAG, &native_value);
 }
 
-JNIEXPORT jboolean JNICALL FN(nObserveProperty)(JNIEnv *env, jclass clazz, jlong ptr, jstring key, jint format, jlong reply_data) {
+JNIEXPORT jboolean JNICALL FN(nSetLogLevel)(JNIEnv *env, jclass clazz, jlong ptr, jint level) {
+    auto *instance = get_instance(ptr);
+    return instance ? instance->set_log_level(level) : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL FN(nSetDefaultLogLevel)(JNIEnv *env, jclass clazz, jint level) {
+    mediampv::log_set_threshold(nullptr, level);
+}
+
+JNIEXPORT jboolean JNICALL FN(nOpenLogRingFile)(JNIEnv *env, jclass clazz, jbyteArray path, jlong capacity) {
+    if (!path) {
+        return JNI_FALSE;
+    }
+    const std::string file_path = read_utf8_bytes(env, path);
+    return mediampv::log_open_ring_file(file_path.c_str(), static_cast<uint64_t>(capacity)) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL FN(nObserveProperty)(JNIEnv *env, jclass clazz, jlong ptr, jstring key, jint format, jlong reply_data, jlong min_interval_nanos, jdouble epsilon) {
     auto *instance = get_instance(ptr);
     scoped_utf_chars property_key(env, key);
     if (!instance || !property_key.valid()) {
         return JNI_FALSE;
     }
 
-    return instance->observe_property(property_key.get(), static_cast<mpv_format>(format), reply_data);
+    return instance->observe_property(
+            property_key.get(), static_cast<mpv_format>(format), reply_data, min_interval_nanos, epsilon);
 }
 
 JNIEXPORT jboolean JNICALL FN(nUnobserveProperty)(JNIEnv *env, jclass clazz, jlong ptr, jlong reply_data) {
@@ -419,14 +714,36 @@ JNIEXPORT jboolean JNICALL FN(nUnobserveProperty)(JNIEnv *env, jclass clazz, jlo
     return instance ? instance->unobserve_property(reply_data) : JNI_FALSE;
 }
 
-JNIEXPORT jboolean JNICALL FN(nRegisterSeekableInput)(JNIEnv *env, jclass clazz, jlong ptr, jobject input, jstring uri, jlong size) {
+JNIEXPORT jboolean JNICALL FN(nRegisterSeekableInput)(JNIEnv *env, jclass clazz, jlong ptr, jobject input, jstring uri, jlong size, jlong read_ahead_size, jint min_read_size, jstring cache_key, jstring content_id, jbyteArray file_path) {
     auto *instance = get_instance(ptr);
     scoped_utf_chars stream_uri(env, uri);
-    if (!instance || !stream_uri.valid()) {
+    scoped_utf_chars stream_cache_key(env, cache_key);
+    scoped_utf_chars stream_content_id(env, content_id);
+    if (!instance || !stream_uri.valid() || (cache_key && !stream_cache_key.valid()) ||
+        (content_id && !stream_content_id.valid())) {
         return JNI_FALSE;
     }
 
-    return instance->register_seekable_input(env, input, stream_uri.get(), static_cast<int64_t>(size));
+    const std::string native_file_path = file_path ? read_utf8_bytes(env, file_path) : std::string();
+
+    return instance->register_seekable_input(
+            env, input, stream_uri.get(), static_cast<int64_t>(size), static_cast<int64_t>(read_ahead_size),
+            static_cast<int32_t>(min_read_size), stream_cache_key.get(), stream_content_id.get(), file_path ? native_file_path.c_str() : nullptr);
+}
+
+JNIEXPORT void JNICALL FN(nSetSeekableInputCacheBudget)(JNIEnv *env, jclass clazz, jlong bytes) {
+    mediampv::read_ahead_cache::set_memory_budget(static_cast<int64_t>(bytes));
+}
+
+JNIEXPORT void JNICALL FN(nConfigureSeekableInputDiskCache)(JNIEnv *env, jclass clazz, jbyteArray directory, jlong budget, jint policy) {
+    const std::string disk_directory = directory ? read_utf8_bytes(env, directory) : std::string();
+    mediampv::disk_cache::configure(
+            directory ? disk_directory.c_str() : nullptr,
+            static_cast<int64_t>(budget),
+            policy == static_cast<jint>(mediampv::disk_eviction_policy::oldest_first)
+            ? mediampv::disk_eviction_policy::oldest_first
+            : mediampv::disk_eviction_policy::least_recently_used,
+            nullptr);
 }
 
 JNIEXPORT jboolean JNICALL FN(nUnregisterSeekableInput)(JNIEnv *env, jclass clazz, jlong ptr, jstring uri) {
@@ -439,6 +756,68 @@ JNIEXPORT jboolean JNICALL FN(nUnregisterSeekableInput)(JNIEnv *env, jclass claz
     return instance->unregister_seekable_input(stream_uri.get());
 }
 
+JNIEXPORT jlongArray JNICALL FN(nGetSeekableInputStats)(JNIEnv *env, jclass clazz, jlong ptr, jstring uri) {
+    auto *instance = get_instance(ptr);
+    scoped_utf_chars stream_uri(env, uri);
+    if (!instance || !stream_uri.valid()) {
+        return nullptr;
+    }
+
+    std::vector<int64_t> stats;
+    if (!instance->get_seekable_input_stats(stream_uri.get(), stats)) {
+        return nullptr;
+    }
+    jlongArray result = env->NewLongArray(static_cast<jsize>(stats.size()));
+    if (!result) {
+        return nullptr; // OOM; exception pending
+    }
+    env->SetLongArrayRegion(
+            result, 0, static_cast<jsize>(stats.size()), reinterpret_cast<const jlong *>(stats.data()));
+    return result;
+}
+
+JNIEXPORT jobject JNICALL FN_JVM(nOpenEventRing)(JNIEnv *env, jclass clazz, jlong ptr, jobject ring, jobject buffer) {
+    auto *instance = get_instance(ptr);
+    return instance ? instance->open_event_ring(env, ring, buffer) : nullptr;
+}
+
+JNIEXPORT jlong JNICALL FN_JVM(nEventRingAdvance)(JNIEnv *env, jclass clazz, jlong ptr, jlong consumed) {
+    auto *instance = get_instance(ptr);
+    mediampv::event_ring *ring = instance ? instance->event_ring() : nullptr;
+    return ring ? static_cast<jlong>(ring->advance(static_cast<uint64_t>(consumed))) : 0;
+}
+
+JNIEXPORT jlong JNICALL FN_JVM(nMonotonicNanos)(JNIEnv *env, jclass clazz) {
+    return mediampv::event_ring::monotonic_nanos();
+}
+
+JNIEXPORT jlong JNICALL FN_JVM(nLogDroppedCount)(JNIEnv *env, jclass clazz) {
+    return static_cast<jlong>(mediampv::log_dropped_count());
+}
+
+// `args` is a direct buffer whose first `length` bytes are the arguments, each NUL-terminated
+// (MpvCommandBuffer); they are used in place, nothing is copied or allocated.
+JNIEXPORT jboolean JNICALL FN_JVM(nCommandPacked)(JNIEnv *env, jclass clazz, jlong ptr, jobject args, jint length) {
+    auto *instance = get_instance(ptr);
+    const auto *packed = args ? static_cast<const char *>(env->GetDirectBufferAddress(args)) : nullptr;
+    if (!instance || !packed || length <= 0 || length > env->GetDirectBufferCapacity(args)
+        || packed[length - 1] != '\0') {
+        return JNI_FALSE;
+    }
+
+    const char *arguments[128];
+    size_t count = 0;
+    for (jint offset = 0; offset < length; offset += static_cast<jint>(std::strlen(packed + offset)) + 1) {
+        if (count == 127) {
+            LOG(instance, mediampv::LOG_LEVEL_ERROR, "nCommandPacked: too many arguments (>= 128)");
+            return JNI_FALSE;
+        }
+        arguments[count++] = packed + offset;
+    }
+    arguments[count] = nullptr;
+    return instance->command(arguments) ? JNI_TRUE : JNI_FALSE;
+}
+
 JNIEXPORT jboolean JNICALL FN_ANDROID(nAttachAndroidSurface)(JNIEnv *env, jclass clazz, jlong ptr, jobject surface) {
     auto *instance = get_instance(ptr);
     return instance ? instance->attach_android_surface(env, surface) : JNI_FALSE;
@@ -698,6 +1077,11 @@ JNIEXPORT jlong JNICALL FN_DESKTOP(nGetBufferTextureOpenGL)(JNIEnv *, jclass, jl
     return instance ? static_cast<jlong>(instance->get_buffer_texture(index)) : 0;
 }
 
+JNIEXPORT jboolean JNICALL FN_DESKTOP(nWaitBufferFenceOpenGL)(JNIEnv *, jclass, jlong ptr, jint index) {
+    auto *instance = get_instance(ptr);
+    return instance && instance->wait_buffer_fence(index) ? JNI_TRUE : JNI_FALSE;
+}
+
 JNIEXPORT jboolean JNICALL FN_DESKTOP(nAckRetiredBuffersOpenGL)(JNIEnv *, jclass, jlong ptr) {
     auto *instance = get_instance(ptr);
     return instance && instance->ack_retired_buffers() ? JNI_TRUE : JNI_FALSE;
@@ -757,5 +1141,172 @@ JNIEXPORT void JNICALL FN(nFinalize)(JNIEnv *env, jclass clazz, jlong ptr) {
     if (!instance) {
         return;
     }
+    remove_live_instance(instance);
     delete instance;
 }
+
+// Binding: every native above is registered by name when the library is loaded, instead of
+// being looked up by its exported symbol on first call. The exports stay, so a class that
+// cannot be registered here (e.g. loaded by another class loader than the one loading this
+// library) still links lazily.
+
+namespace {
+
+#define NATIVE(name, signature, fn) \
+    {const_cast<char *>(name), const_cast<char *>(signature), reinterpret_cast<void *>(fn)}
+
+const JNINativeMethod mpv_handle_natives[] = {
+    NATIVE("nGlobalInit", "()Z", FN(nGlobalInit)),
+    NATIVE("nMake", "(Ljava/lang/Object;)J", FN(nMake)),
+    NATIVE("nConfigureHandlePool", "(Ljava/lang/Object;[Ljava/lang/String;I)V", FN(nConfigureHandlePool)),
+    NATIVE("nTakePooledHandle", "([Ljava/lang/String;)J", FN(nTakePooledHandle)),
+    NATIVE("nInitialize", "(J)Z", FN(nInitialize)),
+    NATIVE("nSetEventListener", "(JLorg/openani/mediamp/mpv/EventListener;)Z", FN(nSetEventListener)),
+    NATIVE("nSetRenderUpdateListener", "(JLorg/openani/mediamp/mpv/RenderUpdateListener;)Z",
+           FN(nSetRenderUpdateListener)),
+    NATIVE("nCommand", "(J[Ljava/lang/String;)Z", FN(nCommand)),
+    NATIVE("nCommandAsync", "(J[Ljava/lang/String;Lorg/openani/mediamp/mpv/AsyncReplyListener;)Z", FN(nCommandAsync)),
+    NATIVE("nSetPropertyAsync", "(JLjava/lang/String;IJLjava/lang/String;Lorg/openani/mediamp/mpv/AsyncReplyListener;)Z",
+           FN(nSetPropertyAsync)),
+    NATIVE("nOption", "(JLjava/lang/String;Ljava/lang/String;)Z", FN(nOption)),
+    NATIVE("nGetPropertyInt", "(JLjava/lang/String;)I", FN(nGetPropertyInt)),
+    NATIVE("nGetPropertyBoolean", "(JLjava/lang/String;)Z", FN(nGetPropertyBoolean)),
+    NATIVE("nGetPropertyDouble", "(JLjava/lang/String;)D", FN(nGetPropertyDouble)),
+    NATIVE("nGetPropertyString", "(JLjava/lang/String;)Ljava/lang/String;", FN(nGetPropertyString)),
+    NATIVE("nGetPropertyNode", "(JLjava/lang/String;)[B", FN(nGetPropertyNode)),
+    NATIVE("nGetProperties", "(J[Ljava/lang/String;[I[J)J", FN(nGetProperties)),
+    NATIVE("nSetPropertyInt", "(JLjava/lang/String;I)Z", FN(nSetPropertyInt)),
+    NATIVE("nSetPropertyBoolean", "(JLjava/lang/String;Z)Z", FN(nSetPropertyBoolean)),
+    NATIVE("nSetPropertyDouble", "(JLjava/lang/String;D)Z", FN(nSetPropertyDouble)),
+    NATIVE("nSetPropertyString", "(JLjava/lang/String;Ljava/lang/String;)Z", FN(nSetPropertyString)),
+    NATIVE("nSetLogLevel", "(JI)Z", FN(nSetLogLevel)),
+    NATIVE("nSetDefaultLogLevel", "(I)V", FN(nSetDefaultLogLevel)),
+    NATIVE("nOpenLogRingFile", "([BJ)Z", FN(nOpenLogRingFile)),
+    NATIVE("nObserveProperty", "(JLjava/lang/String;IJJD)Z", FN(nObserveProperty)),
+    NATIVE("nUnobserveProperty", "(JJ)Z", FN(nUnobserveProperty)),
+    NATIVE("nRegisterSeekableInput",
+           "(JLorg/openani/mediamp/io/SeekableInput;Ljava/lang/String;JJILjava/lang/String;Ljava/lang/String;[B)Z",
+           FN(nRegisterSeekableInput)),
+    NATIVE("nUnregisterSeekableInput", "(JLjava/lang/String;)Z", FN(nUnregisterSeekableInput)),
+    NATIVE("nSetSeekableInputCacheBudget", "(J)V", FN(nSetSeekableInputCacheBudget)),
+    NATIVE("nConfigureSeekableInputDiskCache", "([BJI)V", FN(nConfigureSeekableInputDiskCache)),
+    NATIVE("nGetSeekableInputStats", "(JLjava/lang/String;)[J", FN(nGetSeekableInputStats)),
+    NATIVE("nDestroy", "(J)Z", FN(nDestroy)),
+    NATIVE("nFinalize", "(J)V", FN(nFinalize)),
+};
+
+const JNINativeMethod mpv_handle_jvm_natives[] = {
+    NATIVE("nOpenEventRing",
+           "(JLorg/openani/mediamp/mpv/MpvEventRing;Ljava/nio/ByteBuffer;)Lorg/openani/mediamp/mpv/MpvEventRing;",
+           FN_JVM(nOpenEventRing)),
+    NATIVE("nEventRingAdvance", "(JJ)J", FN_JVM(nEventRingAdvance)),
+    NATIVE("nMonotonicNanos", "()J", FN_JVM(nMonotonicNanos)),
+    NATIVE("nLogDroppedCount", "()J", FN_JVM(nLogDroppedCount)),
+    NATIVE("nCommandPacked", "(JLjava/nio/ByteBuffer;I)Z", FN_JVM(nCommandPacked)),
+};
+
+#ifdef __ANDROID__
+const JNINativeMethod mpv_handle_android_natives[] = {
+    NATIVE("nAttachAndroidSurface", "(JLandroid/view/Surface;)Z", FN_ANDROID(nAttachAndroidSurface)),
+    NATIVE("nDetachAndroidSurface", "(J)Z", FN_ANDROID(nDetachAndroidSurface)),
+};
+#endif
+
+// MPVHandleDesktop declares the natives of every desktop platform; only this platform's
+// are registered, the others stay unlinked as before.
+#if defined(_WIN32) || defined(__APPLE__) || (defined(__linux__) && !defined(__ANDROID__))
+const JNINativeMethod mpv_handle_desktop_natives[] = {
+#ifdef _WIN32
+    NATIVE("nCreateRenderContextD3D11", "(J)Z", FN_DESKTOP(nCreateRenderContextD3D11)),
+    NATIVE("nDestroyRenderContextD3D11", "(J)Z", FN_DESKTOP(nDestroyRenderContextD3D11)),
+    NATIVE("nSetSurfaceConfigD3D11", "(JIIJ)Z", FN_DESKTOP(nSetSurfaceConfigD3D11)),
+    NATIVE("nGetFrameStateD3D11", "(J)J", FN_DESKTOP(nGetFrameStateD3D11)),
+    NATIVE("nGetBufferTextureD3D11", "(JI)J", FN_DESKTOP(nGetBufferTextureD3D11)),
+    NATIVE("nAckRetiredBuffersD3D11", "(J)Z", FN_DESKTOP(nAckRetiredBuffersD3D11)),
+    NATIVE("nHasD3D11Surface", "(J)Z", FN_DESKTOP(nHasD3D11Surface)),
+    NATIVE("nSaveSurfacePngD3D11", "(JLjava/lang/String;)Z", FN_DESKTOP(nSaveSurfacePngD3D11)),
+    NATIVE("nReadSurfacePixelsD3D11", "(J[I)[I", FN_DESKTOP(nReadSurfacePixelsD3D11)),
+    NATIVE("nCreateRenderContextWindowsOpenGL", "(J)Z", FN_DESKTOP(nCreateRenderContextWindowsOpenGL)),
+    NATIVE("nDestroyRenderContextWindowsOpenGL", "(J)Z", FN_DESKTOP(nDestroyRenderContextWindowsOpenGL)),
+    NATIVE("nSetSurfaceConfigWindowsOpenGL", "(JII)Z", FN_DESKTOP(nSetSurfaceConfigWindowsOpenGL)),
+    NATIVE("nGetFrameStateWindowsOpenGL", "(J)J", FN_DESKTOP(nGetFrameStateWindowsOpenGL)),
+    NATIVE("nHasWindowsOpenGLSurface", "(J)Z", FN_DESKTOP(nHasWindowsOpenGLSurface)),
+    NATIVE("nSaveSurfacePngWindowsOpenGL", "(JLjava/lang/String;)Z", FN_DESKTOP(nSaveSurfacePngWindowsOpenGL)),
+    NATIVE("nReadSurfacePixelsWindowsOpenGL", "(J[I)[I", FN_DESKTOP(nReadSurfacePixelsWindowsOpenGL)),
+    NATIVE("nCopyLatestFrameWindowsOpenGL", "(JJII)J", FN_DESKTOP(nCopyLatestFrameWindowsOpenGL)),
+#endif
+#ifdef __APPLE__
+    NATIVE("nCreateRenderContextMacos", "(J)Z", FN_DESKTOP(nCreateRenderContextMacos)),
+    NATIVE("nDestroyRenderContextMacos", "(J)Z", FN_DESKTOP(nDestroyRenderContextMacos)),
+    NATIVE("nSetSurfaceConfigMacos", "(JIIJ)Z", FN_DESKTOP(nSetSurfaceConfigMacos)),
+    NATIVE("nGetFrameStateMacos", "(J)J", FN_DESKTOP(nGetFrameStateMacos)),
+    NATIVE("nGetBufferTextureMacos", "(JI)J", FN_DESKTOP(nGetBufferTextureMacos)),
+    NATIVE("nAckRetiredBuffersMacos", "(J)Z", FN_DESKTOP(nAckRetiredBuffersMacos)),
+    NATIVE("nHasMetalSurface", "(J)Z", FN_DESKTOP(nHasMetalSurface)),
+    NATIVE("nSaveSurfacePng", "(JLjava/lang/String;)Z", FN_DESKTOP(nSaveSurfacePng)),
+    NATIVE("nReadSurfacePixelsMacos", "(J[I)[I", FN_DESKTOP(nReadSurfacePixelsMacos)),
+#endif
+#if defined(__linux__) && !defined(__ANDROID__)
+    NATIVE("nAttachRenderEnvironmentOpenGL", "(JLjava/awt/Component;JJJ)Z", FN_DESKTOP(nAttachRenderEnvironmentOpenGL)),
+    NATIVE("nCreateRenderContextOpenGL", "(J)Z", FN_DESKTOP(nCreateRenderContextOpenGL)),
+    NATIVE("nDestroyRenderContextOpenGL", "(J)Z", FN_DESKTOP(nDestroyRenderContextOpenGL)),
+    NATIVE("nSetSurfaceConfigOpenGL", "(JIIJ)Z", FN_DESKTOP(nSetSurfaceConfigOpenGL)),
+    NATIVE("nGetFrameStateOpenGL", "(J)J", FN_DESKTOP(nGetFrameStateOpenGL)),
+    NATIVE("nGetBufferTextureOpenGL", "(JI)J", FN_DESKTOP(nGetBufferTextureOpenGL)),
+    NATIVE("nWaitBufferFenceOpenGL", "(JI)Z", FN_DESKTOP(nWaitBufferFenceOpenGL)),
+    NATIVE("nAckRetiredBuffersOpenGL", "(J)Z", FN_DESKTOP(nAckRetiredBuffersOpenGL)),
+    NATIVE("nHasOpenGLSurface", "(J)Z", FN_DESKTOP(nHasOpenGLSurface)),
+    NATIVE("nSaveSurfacePngOpenGL", "(JLjava/lang/String;)Z", FN_DESKTOP(nSaveSurfacePngOpenGL)),
+    NATIVE("nReadSurfacePixelsOpenGL", "(J[I)[I", FN_DESKTOP(nReadSurfacePixelsOpenGL)),
+    NATIVE("nCreateOpenGLConsumerFbo", "(J)I", FN_DESKTOP(nCreateOpenGLConsumerFbo)),
+    NATIVE("nDeleteOpenGLConsumerFbo", "(I)Z", FN_DESKTOP(nDeleteOpenGLConsumerFbo)),
+#endif
+};
+#endif
+
+#undef NATIVE
+
+template<size_t N>
+bool register_natives(JNIEnv *env, const char *class_name, const JNINativeMethod (&methods)[N]) {
+    jclass clazz = env->FindClass(class_name);
+    if (!clazz) {
+        env->ExceptionClear();
+        LOGW("JNI_OnLoad: %s is not visible, its natives link on first call", class_name);
+        return false;
+    }
+    const bool registered = env->RegisterNatives(clazz, methods, static_cast<jint>(N)) == JNI_OK;
+    env->DeleteLocalRef(clazz);
+    if (!registered) {
+        // A signature mismatch, i.e. the Kotlin artifact does not match this library; the
+        // first call of the mismatching native then fails with UnsatisfiedLinkError.
+        env->ExceptionClear();
+        LOGW("JNI_OnLoad: cannot register the natives of %s, they link on first call", class_name);
+    }
+    return registered;
+}
+
+} // namespace
+
+extern "C" JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM *vm, void *) {
+    JNIEnv *env = nullptr;
+    if (vm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_6) != JNI_OK || !env) {
+        return JNI_ERR;
+    }
+    mediampv::global_jvm = vm;
+
+    const bool registered = register_natives(env, "org/openani/mediamp/mpv/MPVHandleKt", mpv_handle_natives);
+    register_natives(env, "org/openani/mediamp/mpv/MPVHandleJvm", mpv_handle_jvm_natives);
+#ifdef __ANDROID__
+    register_natives(env, "org/openani/mediamp/mpv/MPVHandleAndroid", mpv_handle_android_natives);
+#elif defined(_WIN32) || defined(__APPLE__) || defined(__linux__)
+    register_natives(env, "org/openani/mediamp/mpv/MPVHandleDesktop", mpv_handle_desktop_natives);
+#endif
+
+    // Resolve the callback classes now, on the loading thread and with the loading class
+    // loader, rather than under the cache mutex when the first handle is made. When the
+    // classes are not visible from here, the first nMake resolves them as before.
+    if (registered) {
+        mediampv::jni_cache_classes(env);
+    }
+    return JNI_VERSION_1_6;
+}
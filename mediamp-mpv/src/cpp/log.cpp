@@ -1,11 +1,22 @@
 #include "log.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdarg>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <jni.h>
 
+#include "log_filter.h"
+#include "log_ring_file.h"
+#include "log_queue.h"
 #include "method_cache.h"
+#include "native_util.h"
 
 #if defined(__ANDROID__)
 #include <android/log.h>
@@ -15,44 +26,6 @@ namespace mediampv {
 
 namespace {
 
-// Attaches the calling thread to the JVM when needed and detaches on scope exit only if
-// this helper performed the attach, so a thread the JVM already owns (event loop, render
-// thread, a thread inside a JNI downcall) is never wrongly detached.
-struct scoped_env final {
-    explicit scoped_env(JavaVM *vm) : vm_(vm) {
-        if (!vm_) {
-            return;
-        }
-        const jint rc = vm_->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_6);
-        if (rc == JNI_OK) {
-            return;
-        }
-        if (rc == JNI_EDETACHED) {
-#if defined(__ANDROID__)
-            if (vm_->AttachCurrentThread(&env, nullptr) == JNI_OK) {
-                attached_ = true;
-            }
-#else
-            if (vm_->AttachCurrentThread(reinterpret_cast<void **>(&env), nullptr) == JNI_OK) {
-                attached_ = true;
-            }
-#endif
-        }
-    }
-
-    ~scoped_env() {
-        if (attached_ && vm_) {
-            vm_->DetachCurrentThread();
-        }
-    }
-
-    JNIEnv *env = nullptr;
-
-private:
-    JavaVM *vm_ = nullptr;
-    bool attached_ = false;
-};
-
 // Last-resort sink used when the log line cannot reach the Kotlin handler. Never silently
 // drops the line: startup errors (before the JVM/cache exist) and JNI-path failures still
 // surface somewhere a developer can see them.
@@ -76,59 +49,302 @@ void log_to_stderr(int level, const char *prefix, const char *text) {
 #endif
 }
 
-void dispatch(const void *instance_handle, int level, const char *prefix, const char *text) {
-    if (!prefix) prefix = "mediampv";
-    if (!text) text = "";
+constexpr size_t kBatchSize = 64 * 1024;
+constexpr size_t kMaxThresholds = 64;
+constexpr size_t kRecordHeaderSize = 24;
 
-    JavaVM *vm = global_jvm;
-    if (!vm || !jni_mediamp_clazz_MPVLogKt || !jni_mediamp_method_MPVLogKt_onNativeLog) {
-        // JVM not attached yet, or the log method has not been cached: don't lose the line.
-        log_to_stderr(level, prefix, text);
-        return;
+enum drain_state : int {
+    drain_idle = 0,
+    drain_running = 1,
+    drain_failed = 2,
+};
+
+// Deliberately leaked: the drain thread is detached and may still be running while static
+// destructors run at exit.
+log_queue &shared_queue() {
+    static auto *queue = new log_queue();
+    return *queue;
+}
+
+struct drain_signal final {
+    std::atomic<int> state{drain_idle};
+    std::atomic_bool waiting{false};
+    std::mutex mutex;
+    std::condition_variable wakeup;
+};
+
+drain_signal &shared_signal() {
+    static auto *signal = new drain_signal();
+    return *signal;
+}
+
+struct threshold_slot final {
+    std::atomic<const void *> instance_handle{nullptr};
+    std::atomic<int> level{LOG_LEVEL_INFO};
+};
+
+std::atomic<int> default_threshold{LOG_LEVEL_INFO};
+// Per-handle thresholds. A handful of handles exist at a time, so a scan of this table is
+// cheaper than anything keyed; when it is full, further handles use the default threshold.
+// Read lock-free; slots are claimed and released under threshold_mutex.
+threshold_slot thresholds[kMaxThresholds];
+std::mutex threshold_mutex;
+
+threshold_slot *find_threshold(const void *instance_handle) {
+    for (threshold_slot &slot : thresholds) {
+        if (slot.instance_handle.load(std::memory_order_acquire) == instance_handle) {
+            return &slot;
+        }
     }
+    return nullptr;
+}
 
-    scoped_env scoped(vm);
-    JNIEnv *env = scoped.env;
-    if (!env) {
-        log_to_stderr(level, prefix, text);
-        return;
+// Opened at most once and never closed: a line may be being written into it at any time.
+std::atomic<log_ring_file *> ring_file{nullptr};
+std::mutex ring_file_mutex;
+
+void write_ring_file(const void *instance_handle, int level, const char *prefix, const char *text, size_t length) {
+    if (log_ring_file *file = ring_file.load(std::memory_order_acquire)) {
+        file->write(instance_handle, level, prefix, text, length);
     }
+}
 
-    // Any JNI call made while an exception is pending is undefined behaviour. This path is
-    // reached from clear_jni_exception() and from error handlers that run right after a
-    // failed JNI call, so fall back to stderr and leave the pending exception untouched for
-    // the caller to describe/clear.
+void copy_field(char *destination, size_t capacity, uint32_t &length, const char *source) {
+    const size_t source_length = std::strlen(source);
+    length = static_cast<uint32_t>(source_length < capacity - 1 ? source_length : capacity - 1);
+    std::memcpy(destination, source, length);
+    destination[length] = '\0';
+}
+
+// Appends one record to `batch` (see onNativeLogBatch in NativeLogBatch.kt):
+//   int32 size, int32 level, int64 instance handle, int32 prefix length, int32 text length,
+// then the prefix and text bytes, padded to 8 bytes. Returns the new size.
+size_t write_record(
+        char *batch,
+        size_t size,
+        const void *instance_handle,
+        int32_t level,
+        const char *prefix,
+        uint32_t prefix_length,
+        const char *text,
+        uint32_t text_length) {
+    const auto record_size = static_cast<int32_t>(align8(kRecordHeaderSize + prefix_length + text_length));
+    const auto instance = static_cast<int64_t>(reinterpret_cast<std::uintptr_t>(instance_handle));
+    char *record = batch + size;
+    std::memcpy(record, &record_size, 4);
+    std::memcpy(record + 4, &level, 4);
+    std::memcpy(record + 8, &instance, 8);
+    std::memcpy(record + 16, &prefix_length, 4);
+    std::memcpy(record + 20, &text_length, 4);
+    std::memcpy(record + kRecordHeaderSize, prefix, prefix_length);
+    std::memcpy(record + kRecordHeaderSize + prefix_length, text, text_length);
+    return size + static_cast<size_t>(record_size);
+}
+
+void flush(JNIEnv *env, jobject buffer, size_t size) {
+    if (size == 0) {
+        return;
+    }
+    env->CallStaticVoidMethod(jni_mediamp_clazz_NativeLogBatchKt, jni_mediamp_method_NativeLogBatchKt_onNativeLogBatch,
+                              buffer, static_cast<jint>(size));
     if (env->ExceptionCheck()) {
-        log_to_stderr(level, prefix, text);
+        // Not LOGged: a handler that keeps throwing would feed itself through the queue.
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+    }
+}
+
+// The single consumer of the queue. Attached to the JVM once for its lifetime, it drains
+// whatever has been published on each wakeup into one direct buffer and makes one upcall
+// per 64 KiB of lines, instead of the logging thread making one per line. Floods of
+// repeated lines are collapsed by log_filter on the way.
+void drain_loop() {
+    JavaVM *vm = global_jvm;
+    JNIEnv *env = nullptr;
+    JavaVMAttachArgs args{JNI_VERSION_1_6, const_cast<char *>("mediampv-log"), nullptr};
+    // As a daemon: this thread never exits and must not keep the JVM alive.
+#if defined(__ANDROID__)
+    const bool attached = vm->AttachCurrentThreadAsDaemon(&env, &args) == JNI_OK;
+#else
+    const bool attached = vm->AttachCurrentThreadAsDaemon(reinterpret_cast<void **>(&env), &args) == JNI_OK;
+#endif
+
+    std::unique_ptr<char[]> batch(new char[kBatchSize]);
+    jobject buffer = nullptr;
+    if (attached && env) {
+        jobject local = env->NewDirectByteBuffer(batch.get(), static_cast<jlong>(kBatchSize));
+        if (local) {
+            buffer = env->NewGlobalRef(local);
+            env->DeleteLocalRef(local);
+        }
+        if (env->ExceptionCheck()) {
+            env->ExceptionDescribe();
+            env->ExceptionClear();
+        }
+    }
+    if (!buffer) {
+        log_to_stderr(LOG_LEVEL_ERROR, "mediampv", "log drain thread cannot reach the JVM; logging to stderr");
+    }
+
+    log_queue &queue = shared_queue();
+    drain_signal &signal = shared_signal();
+    log_filter filter;
+    uint64_t reported_dropped = 0;
+    size_t size = 0;
+    const log_filter::emit_fn append = [&](const void *instance_handle, int level, const char *prefix,
+                                           const char *text) {
+        if (!buffer) {
+            log_to_stderr(level, prefix, text);
+            return;
+        }
+        const auto prefix_length = static_cast<uint32_t>(std::strlen(prefix));
+        const auto text_length = static_cast<uint32_t>(std::strlen(text));
+        if (size + align8(kRecordHeaderSize + prefix_length + text_length) > kBatchSize) {
+            flush(env, buffer, size);
+            size = 0;
+        }
+        size = write_record(batch.get(), size, instance_handle, level, prefix, prefix_length, text, text_length);
+    };
+    for (;;) {
+        const auto now = log_filter::clock::now();
+        while (log_queue::entry *entry = queue.front()) {
+            if (filter.admit(entry->instance_handle, entry->level, entry->prefix, entry->text, entry->text_length,
+                             now, append)) {
+                append(entry->instance_handle, entry->level, entry->prefix, entry->text);
+            }
+            queue.pop(entry);
+        }
+        filter.flush_due(now, append);
+
+        const uint64_t dropped = queue.dropped();
+        if (dropped != reported_dropped) {
+            char text[128];
+            snprintf(text, sizeof(text), "log queue overflowed: %llu lines dropped so far",
+                     static_cast<unsigned long long>(dropped));
+            reported_dropped = dropped;
+            append(nullptr, LOG_LEVEL_WARN, "mediampv", text);
+        }
+        if (buffer) {
+            flush(env, buffer, size);
+        }
+        size = 0;
+
+        // Sleeps until a line is published, or until the filter has a summary due: an idle
+        // process does not wake this thread at all.
+        const auto due = filter.next_due();
+        std::unique_lock<std::mutex> lock(signal.mutex);
+        signal.waiting.store(true);
+        // Pairs with the fence in wake(): either this sees the line published before it,
+        // or that producer sees `waiting` and notifies.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!queue.front()) {
+            if (due == log_filter::clock::time_point::max()) {
+                signal.wakeup.wait(lock);
+            } else {
+                signal.wakeup.wait_until(lock, due);
+            }
+        }
+        signal.waiting.store(false);
+    }
+}
+
+// Starts the drain thread on first use. Returns false while lines must still go to stderr:
+// before the first handle has captured the JVM and resolved NativeLogBatchKt, or when the
+// thread could not be started at all.
+bool drain_ready() {
+    if (!global_jvm || !jni_mediamp_method_NativeLogBatchKt_onNativeLogBatch) {
+        return false;
+    }
+    drain_signal &signal = shared_signal();
+    int state = signal.state.load(std::memory_order_acquire);
+    if (state == drain_idle && signal.state.compare_exchange_strong(state, drain_running)) {
+        try {
+            shared_queue();
+            std::thread(drain_loop).detach();
+            return true;
+        } catch (const std::exception &) {
+            signal.state.store(drain_failed, std::memory_order_release);
+            return false;
+        }
+    }
+    return state != drain_failed;
+}
+
+void wake() {
+    drain_signal &signal = shared_signal();
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // Only when the drain thread is idle, so a burst of lines takes the mutex once.
+    if (signal.waiting.load(std::memory_order_relaxed) && signal.waiting.exchange(false)) {
+        std::lock_guard<std::mutex> guard(signal.mutex);
+        signal.wakeup.notify_one();
+    }
+}
+
+void publish(log_queue::entry *entry, const void *instance_handle, int level, const char *prefix) {
+    entry->instance_handle = instance_handle;
+    entry->level = level;
+    copy_field(entry->prefix, sizeof(entry->prefix), entry->prefix_length, prefix);
+    shared_queue().publish(entry);
+    wake();
+}
+
+void dispatch(const void *instance_handle, int level, const char *prefix, const char *text) {
+    if (!log_enabled(instance_handle, level)) {
         return;
     }
+    if (!prefix) prefix = "mediampv";
+    if (!text) text = "";
+    write_ring_file(instance_handle, level, prefix, text, std::strlen(text));
 
-    jstring jprefix = env->NewStringUTF(prefix);
-    jstring jtext = env->NewStringUTF(text);
-    if (jprefix && jtext) {
-        env->CallStaticVoidMethod(jni_mediamp_clazz_MPVLogKt,
-                                  jni_mediamp_method_MPVLogKt_onNativeLog,
-                                  static_cast<jlong>(reinterpret_cast<std::uintptr_t>(instance_handle)),
-                                  static_cast<jint>(level), jprefix, jtext);
-    } else {
+    if (!drain_ready()) {
+        // JVM not attached yet, or the log method has not been cached: don't lose the line.
         log_to_stderr(level, prefix, text);
+        return;
     }
-
-    // Never propagate a failure of the logging path itself back to the caller.
-    if (env->ExceptionCheck()) {
-        env->ExceptionClear();
+    log_queue::entry *entry = shared_queue().claim();
+    if (!entry) {
+        return;
     }
-    if (jprefix) env->DeleteLocalRef(jprefix);
-    if (jtext) env->DeleteLocalRef(jtext);
+    copy_field(entry->text, sizeof(entry->text), entry->text_length, text);
+    publish(entry, instance_handle, level, prefix);
 }
 
 void log_vprint(const void *instance_handle, int level, const char *format, va_list args) {
-    char buffer[2048];
-    const int written = vsnprintf(buffer, sizeof(buffer), format ? format : "", args);
-    if (written < 0) {
+    if (!log_enabled(instance_handle, level)) {
+        return;
+    }
+    if (!drain_ready()) {
+        char buffer[2048];
+        const int written = vsnprintf(buffer, sizeof(buffer), format ? format : "", args);
+        if (written >= 0) {
+            write_ring_file(instance_handle, level, "mediampv", buffer, std::strlen(buffer));
+            log_to_stderr(level, "mediampv", buffer);
+        }
         return;
     }
-    dispatch(instance_handle, level, "mediampv", buffer);
+    log_queue::entry *entry = shared_queue().claim();
+    if (!entry) {
+        if (ring_file.load(std::memory_order_relaxed)) {
+            // The queue is full, but the line can still make it into the file.
+            char buffer[log_queue::kTextSize];
+            if (vsnprintf(buffer, sizeof(buffer), format ? format : "", args) >= 0) {
+                write_ring_file(instance_handle, level, "mediampv", buffer, std::strlen(buffer));
+            }
+        }
+        return;
+    }
+    // Formatted in place: a claimed slot must be published, so a failed format publishes
+    // an empty line, which the Kotlin side drops.
+    const int written = vsnprintf(entry->text, sizeof(entry->text), format ? format : "", args);
+    if (written < 0) {
+        entry->text[0] = '\0';
+        entry->text_length = 0;
+    } else {
+        entry->text_length = static_cast<uint32_t>(
+                static_cast<size_t>(written) < sizeof(entry->text) ? written : sizeof(entry->text) - 1);
+        write_ring_file(instance_handle, level, "mediampv", entry->text, entry->text_length);
+    }
+    publish(entry, instance_handle, level, "mediampv");
 }
 
 } // namespace
@@ -155,4 +371,77 @@ void log_forward(const void *instance_handle, int level, const char *prefix, con
     dispatch(instance_handle, level, prefix, text);
 }
 
+bool log_open_ring_file(const char *path, uint64_t capacity) {
+    std::lock_guard<std::mutex> guard(ring_file_mutex);
+    if (ring_file.load(std::memory_order_relaxed)) {
+        LOG(LOG_LEVEL_WARN, "log ring file: already open, not opening %s", path ? path : "");
+        return false;
+    }
+    std::unique_ptr<log_ring_file> file = log_ring_file::open(path, capacity);
+    if (!file) {
+        return false;
+    }
+    ring_file.store(file.release(), std::memory_order_release);
+    return true;
+}
+
+uint64_t log_dropped_count() {
+    return shared_queue().dropped();
+}
+
+int log_threshold(const void *instance_handle) {
+    if (instance_handle) {
+        if (threshold_slot *slot = find_threshold(instance_handle)) {
+            return slot->level.load(std::memory_order_relaxed);
+        }
+    }
+    return default_threshold.load(std::memory_order_relaxed);
+}
+
+void log_set_threshold(const void *instance_handle, int level) {
+    if (!instance_handle) {
+        default_threshold.store(level, std::memory_order_relaxed);
+        return;
+    }
+    std::lock_guard<std::mutex> guard(threshold_mutex);
+    threshold_slot *slot = find_threshold(instance_handle);
+    if (!slot) {
+        slot = find_threshold(nullptr);
+        if (!slot) {
+            return;
+        }
+        // The level is set before the slot is published, so no line of this handle is ever
+        // checked against the previous owner's threshold.
+        slot->level.store(level, std::memory_order_relaxed);
+        slot->instance_handle.store(instance_handle, std::memory_order_release);
+        return;
+    }
+    slot->level.store(level, std::memory_order_relaxed);
+}
+
+void log_clear_threshold(const void *instance_handle) {
+    if (!instance_handle) {
+        return;
+    }
+    std::lock_guard<std::mutex> guard(threshold_mutex);
+    if (threshold_slot *slot = find_threshold(instance_handle)) {
+        slot->instance_handle.store(nullptr, std::memory_order_release);
+    }
+}
+
+bool log_enabled(const void *instance_handle, int level) {
+    return level <= log_threshold(instance_handle);
+}
+
+const char *log_level_name(int level) {
+    if (level >= LOG_LEVEL_TRACE) return "trace";
+    if (level >= LOG_LEVEL_DEBUG) return "debug";
+    if (level >= LOG_LEVEL_V) return "v";
+    if (level >= LOG_LEVEL_INFO) return "info";
+    if (level >= LOG_LEVEL_WARN) return "warn";
+    if (level >= LOG_LEVEL_ERROR) return "error";
+    if (level >= LOG_LEVEL_FATAL) return "fatal";
+    return "no";
+}
+
 } // namespace mediampv
@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <cstdio>
+#include "log_filter.h"
+#include "log.h"
+
+namespace mediampv {
+
+namespace {
+
+uint64_t hash_text(const char *text, size_t length) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= static_cast<unsigned char>(text[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace
+
+bool log_filter::admit(
+        const void *instance_handle,
+        int level,
+        const char *prefix,
+        const char *text,
+        size_t text_length,
+        clock::time_point now,
+        const emit_fn &emit) {
+    if (level <= LOG_LEVEL_FATAL) {
+        return true;
+    }
+    auto it = sources_.find(prefix);
+    if (it == sources_.end()) {
+        if (sources_.size() >= kMaxSources) {
+            return true;
+        }
+        it = sources_.emplace(prefix, source{}).first;
+        it->second.refilled = now;
+    }
+    source &source = it->second;
+
+    const uint64_t hash = hash_text(text, text_length);
+    if (source.has_last && source.last_hash == hash && source.last_level == level &&
+        source.last_instance_handle == instance_handle) {
+        if (source.repeats++ == 0) {
+            source.first_repeat = now;
+        }
+        return false;
+    }
+    emit_repeats(it->first, source, emit);
+    source.has_last = true;
+    source.last_hash = hash;
+    source.last_level = level;
+    source.last_instance_handle = instance_handle;
+
+    refill(source, now);
+    if (source.tokens < 1) {
+        if (source.rate_limited++ == 0 || level < source.rate_limited_level) {
+            source.rate_limited_level = level;
+        }
+        // Repeats of a line that was not passed on are not summarized as repeats of it.
+        source.has_last = false;
+        return false;
+    }
+    source.tokens -= 1;
+    emit_rate_limited(it->first, source, emit);
+    return true;
+}
+
+void log_filter::flush_due(clock::time_point now, const emit_fn &emit) {
+    for (auto &[prefix, source] : sources_) {
+        if (source.repeats > 0 && now - source.first_repeat >= kSummaryDelay) {
+            emit_repeats(prefix, source, emit);
+        }
+        if (source.rate_limited > 0) {
+            refill(source, now);
+            if (source.tokens >= 1) {
+                source.tokens -= 1;
+                emit_rate_limited(prefix, source, emit);
+            }
+        }
+    }
+}
+
+log_filter::clock::time_point log_filter::next_due() const {
+    auto due = clock::time_point::max();
+    for (const auto &[prefix, source] : sources_) {
+        if (source.repeats > 0) {
+            due = std::min(due, source.first_repeat + kSummaryDelay);
+        }
+        if (source.rate_limited > 0) {
+            // When the bucket is back to one token.
+            const auto refill_time = std::chrono::ceil<clock::duration>(
+                    std::chrono::duration<double>(std::max(0.0, 1 - source.tokens) / kLinesPerSecond));
+            due = std::min(due, source.refilled + refill_time);
+        }
+    }
+    return due;
+}
+
+void log_filter::emit_repeats(const std::string &prefix, source &source, const emit_fn &emit) {
+    if (source.repeats == 0) {
+        return;
+    }
+    char text[64];
+    snprintf(text, sizeof(text), "last message repeated %llu times", static_cast<unsigned long long>(source.repeats));
+    source.repeats = 0;
+    emit(source.last_instance_handle, source.last_level, prefix.c_str(), text);
+}
+
+void log_filter::emit_rate_limited(const std::string &prefix, source &source, const emit_fn &emit) {
+    if (source.rate_limited == 0) {
+        return;
+    }
+    char text[96];
+    snprintf(text, sizeof(text), "%llu lines dropped by the rate limit of %.0f lines per second",
+             static_cast<unsigned long long>(source.rate_limited), kLinesPerSecond);
+    source.rate_limited = 0;
+    emit(nullptr, source.rate_limited_level, prefix.c_str(), text);
+}
+
+void log_filter::refill(source &source, clock::time_point now) {
+    const double elapsed = std::chrono::duration<double>(now - source.refilled).count();
+    source.refilled = now;
+    if (elapsed > 0) {
+        source.tokens = std::min(kBurst, source.tokens + elapsed * kLinesPerSecond);
+    }
+}
+
+} // namespace mediampv
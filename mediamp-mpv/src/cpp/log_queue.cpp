@@ -0,0 +1,53 @@
+#include "log_queue.h"
+
+namespace mediampv {
+
+static_assert((log_queue::kCapacity & (log_queue::kCapacity - 1)) == 0, "capacity must be a power of two");
+
+log_queue::log_queue() : entries_(new entry[kCapacity]) {
+    for (uint64_t i = 0; i < kCapacity; ++i) {
+        entries_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+log_queue::entry *log_queue::claim() {
+    uint64_t position = enqueue_position_.load(std::memory_order_relaxed);
+    for (;;) {
+        entry &slot = entries_[position & kMask];
+        const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<int64_t>(sequence - position);
+        if (difference == 0) {
+            if (enqueue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                slot.position = position;
+                return &slot;
+            }
+            // `position` was reloaded by the failed CAS.
+        } else if (difference < 0) {
+            // The slot still holds a line from one lap ago: the drain thread is behind.
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            position = enqueue_position_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void log_queue::publish(entry *entry) {
+    entry->sequence.store(entry->position + 1, std::memory_order_release);
+}
+
+log_queue::entry *log_queue::front() {
+    entry &slot = entries_[dequeue_position_ & kMask];
+    if (slot.sequence.load(std::memory_order_acquire) != dequeue_position_ + 1) {
+        // Empty, or the next producer has claimed its slot but is still formatting.
+        return nullptr;
+    }
+    return &slot;
+}
+
+void log_queue::pop(entry *entry) {
+    entry->sequence.store(dequeue_position_ + kCapacity, std::memory_order_release);
+    ++dequeue_position_;
+}
+
+} // namespace mediampv
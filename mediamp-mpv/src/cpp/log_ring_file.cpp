@@ -0,0 +1,268 @@
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include "log_ring_file.h"
+#include "log.h"
+#include "native_util.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace mediampv {
+
+namespace {
+
+constexpr uint64_t kMinCapacity = 64 * 1024;
+constexpr uint64_t kMaxCapacity = 64 * 1024 * 1024;
+constexpr size_t kPrefixTableOffset = log_ring_file::kHeaderSize;
+constexpr size_t kDataOffset =
+        kPrefixTableOffset + log_ring_file::kPrefixEntries * log_ring_file::kPrefixEntrySize;
+constexpr uint32_t kPrefixEmpty = 0;
+constexpr uint32_t kPrefixWriting = 1;
+constexpr uint32_t kPrefixReady = 2;
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t) && std::atomic<uint64_t>::is_always_lock_free,
+              "the write position is read as a plain uint64 by the decoder");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && std::atomic<uint32_t>::is_always_lock_free,
+              "prefix states are read as plain uint32s by the decoder");
+
+uint64_t round_capacity(uint64_t capacity) {
+    uint64_t rounded = kMinCapacity;
+    while (rounded < capacity && rounded < kMaxCapacity) {
+        rounded <<= 1;
+    }
+    return rounded;
+}
+
+int64_t unix_nanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::atomic<uint32_t> &prefix_state(char *entry) {
+    return *std::launder(reinterpret_cast<std::atomic<uint32_t> *>(entry));
+}
+
+} // namespace
+
+constexpr char log_ring_file::kMagic[8];
+
+log_ring_file::log_ring_file(char *mapping, size_t mapping_size, uint64_t capacity)
+    : mapping_(mapping),
+      mapping_size_(mapping_size),
+      prefixes_(mapping + kPrefixTableOffset),
+      data_(mapping + kDataOffset),
+      capacity_(capacity) {
+    // The file has just been created empty, so everything but the header is zero.
+    std::memcpy(mapping_, kMagic, sizeof(kMagic));
+    const uint32_t version = kVersion;
+    const auto data_offset = static_cast<uint32_t>(kDataOffset);
+    const auto prefix_entries = static_cast<uint32_t>(kPrefixEntries);
+    const auto prefix_table_offset = static_cast<uint32_t>(kPrefixTableOffset);
+    const int64_t opened_at = unix_nanos();
+    std::memcpy(mapping_ + 8, &version, 4);
+    std::memcpy(mapping_ + 12, &data_offset, 4);
+    std::memcpy(mapping_ + 16, &capacity_, 8);
+    new (mapping_ + 24) std::atomic<uint64_t>(0);
+    std::memcpy(mapping_ + 32, &prefix_entries, 4);
+    std::memcpy(mapping_ + 36, &prefix_table_offset, 4);
+    std::memcpy(mapping_ + 40, &opened_at, 8);
+    for (size_t i = 0; i < kPrefixEntries; ++i) {
+        new (prefixes_ + i * kPrefixEntrySize) std::atomic<uint32_t>(kPrefixEmpty);
+    }
+}
+
+std::atomic<uint64_t> &log_ring_file::write_position() {
+    return *std::launder(reinterpret_cast<std::atomic<uint64_t> *>(mapping_ + 24));
+}
+
+void log_ring_file::write(
+        const void *instance_handle,
+        int level,
+        const char *prefix,
+        const char *text,
+        size_t text_length) {
+    if (text_length > kMaxTextLength) {
+        text_length = kMaxTextLength;
+    }
+    const size_t size = align8(kRecordHeaderSize + text_length);
+    const uint64_t position = write_position().fetch_add(size, std::memory_order_relaxed);
+
+    char header[kRecordHeaderSize] = {};
+    const auto record_size = static_cast<uint32_t>(size);
+    const auto record_level = static_cast<int32_t>(level);
+    const int64_t time = unix_nanos();
+    const auto instance = static_cast<uint64_t>(reinterpret_cast<std::uintptr_t>(instance_handle));
+    const uint16_t prefix_index = prefix_id(prefix ? prefix : "");
+    const auto length = static_cast<uint16_t>(text_length);
+    std::memcpy(header + 8, &record_size, 4);
+    std::memcpy(header + 12, &record_level, 4);
+    std::memcpy(header + 16, &time, 8);
+    std::memcpy(header + 24, &instance, 8);
+    std::memcpy(header + 32, &prefix_index, 2);
+    std::memcpy(header + 34, &length, 2);
+    copy_in(position + 8, header + 8, kRecordHeaderSize - 8);
+    copy_in(position + kRecordHeaderSize, text, text_length);
+
+    // The position marks the record complete, so it goes last. Records are 8-aligned and the
+    // capacity is a multiple of 8, so it never wraps.
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(data_ + (position & (capacity_ - 1)), &position, 8);
+}
+
+void log_ring_file::copy_in(uint64_t position, const void *source, size_t length) {
+    const auto offset = static_cast<size_t>(position & (capacity_ - 1));
+    const size_t first = length < capacity_ - offset ? length : static_cast<size_t>(capacity_ - offset);
+    std::memcpy(data_ + offset, source, first);
+    if (first < length) {
+        std::memcpy(data_, static_cast<const char *>(source) + first, length - first);
+    }
+}
+
+uint16_t log_ring_file::prefix_id(const char *prefix) {
+    char name[kPrefixEntrySize - 4] = {};
+    std::strncpy(name, prefix, sizeof(name) - 1);
+
+    // FNV-1a of the (truncated) name picks the first slot; collisions probe linearly.
+    uint32_t hash = 2166136261u;
+    for (const char *c = name; *c; ++c) {
+        hash = (hash ^ static_cast<unsigned char>(*c)) * 16777619u;
+    }
+    for (size_t probe = 0; probe < kPrefixEntries; ++probe) {
+        const size_t index = (hash + probe) & (kPrefixEntries - 1);
+        char *entry = prefixes_ + index * kPrefixEntrySize;
+        std::atomic<uint32_t> &state = prefix_state(entry);
+        for (;;) {
+            uint32_t current = state.load(std::memory_order_acquire);
+            if (current == kPrefixEmpty) {
+                if (!state.compare_exchange_strong(current, kPrefixWriting, std::memory_order_acquire)) {
+                    continue;
+                }
+                std::memcpy(entry + 4, name, sizeof(name));
+                state.store(kPrefixReady, std::memory_order_release);
+                return static_cast<uint16_t>(index);
+            }
+            if (current == kPrefixWriting) {
+                // Another thread is copying a name of at most 28 bytes in.
+                std::this_thread::yield();
+                continue;
+            }
+            if (std::memcmp(entry + 4, name, sizeof(name)) == 0) {
+                return static_cast<uint16_t>(index);
+            }
+            break;
+        }
+    }
+    return kUnknownPrefix;
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+
+std::unique_ptr<log_ring_file> log_ring_file::open(const char *path, uint64_t capacity) {
+    if (!path || path[0] == '\0') {
+        return nullptr;
+    }
+    capacity = round_capacity(capacity);
+    const uint64_t size = kDataOffset + capacity;
+
+    const int wide_length = MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, path, -1, nullptr, 0);
+    if (wide_length <= 0) {
+        LOG(LOG_LEVEL_WARN, "log ring file: path is not valid UTF-8: %s", path);
+        return nullptr;
+    }
+    std::wstring wide_path(static_cast<size_t>(wide_length), L'\0');
+    MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, path, -1, &wide_path[0], wide_length);
+
+    HANDLE file = CreateFileW(wide_path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                              CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        LOG(LOG_LEVEL_WARN, "log ring file: cannot create %s (error %lu)", path,
+            static_cast<unsigned long>(GetLastError()));
+        return nullptr;
+    }
+    // Also extends the file to `size`.
+    HANDLE file_mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32),
+                                             static_cast<DWORD>(size & 0xFFFFFFFFu), nullptr);
+    void *mapping = file_mapping ? MapViewOfFile(file_mapping, FILE_MAP_WRITE, 0, 0, static_cast<SIZE_T>(size))
+                                 : nullptr;
+    if (!mapping) {
+        LOG(LOG_LEVEL_WARN, "log ring file: cannot map %s (error %lu)", path,
+            static_cast<unsigned long>(GetLastError()));
+        if (file_mapping) CloseHandle(file_mapping);
+        CloseHandle(file);
+        return nullptr;
+    }
+
+    std::unique_ptr<log_ring_file> ring(
+            new (std::nothrow) log_ring_file(static_cast<char *>(mapping), static_cast<size_t>(size), capacity));
+    if (!ring) {
+        UnmapViewOfFile(mapping);
+        CloseHandle(file_mapping);
+        CloseHandle(file);
+        return nullptr;
+    }
+    ring->file_ = file;
+    ring->file_mapping_ = file_mapping;
+    return ring;
+}
+
+log_ring_file::~log_ring_file() {
+    UnmapViewOfFile(mapping_);
+    CloseHandle(file_mapping_);
+    CloseHandle(file_);
+}
+
+#else
+
+std::unique_ptr<log_ring_file> log_ring_file::open(const char *path, uint64_t capacity) {
+    if (!path || path[0] == '\0') {
+        return nullptr;
+    }
+    capacity = round_capacity(capacity);
+    const uint64_t size = kDataOffset + capacity;
+
+    int fd;
+    do {
+        fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    } while (fd < 0 && errno == EINTR);
+    if (fd < 0) {
+        LOG(LOG_LEVEL_WARN, "log ring file: cannot create %s: %s", path, std::strerror(errno));
+        return nullptr;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        LOG(LOG_LEVEL_WARN, "log ring file: cannot size %s: %s", path, std::strerror(errno));
+        close(fd);
+        return nullptr;
+    }
+    void *mapping = mmap(nullptr, static_cast<size_t>(size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        LOG(LOG_LEVEL_WARN, "log ring file: cannot map %s: %s", path, std::strerror(errno));
+        close(fd);
+        return nullptr;
+    }
+
+    std::unique_ptr<log_ring_file> ring(
+            new (std::nothrow) log_ring_file(static_cast<char *>(mapping), static_cast<size_t>(size), capacity));
+    if (!ring) {
+        munmap(mapping, static_cast<size_t>(size));
+        close(fd);
+        return nullptr;
+    }
+    ring->fd_ = fd;
+    return ring;
+}
+
+log_ring_file::~log_ring_file() {
+    munmap(mapping_, mapping_size_);
+    close(fd_);
+}
+
+#endif
+
+} // namespace mediampv
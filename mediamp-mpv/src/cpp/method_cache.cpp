@@ -1,28 +1,17 @@
+#include <atomic>
 #include <mutex>
 
 #define UTIL_EXTERN
 #include "method_cache.h"
 #include "log.h"
+#include "native_util.h"
 
 namespace mediampv {
 
 namespace {
 
 std::mutex jni_cache_mutex;
-bool jni_class_cached = false;
-
-bool clear_jni_exception(JNIEnv *env, const void *instance_handle, const char *context) {
-    if (!env || !env->ExceptionCheck()) {
-        return false;
-    }
-
-    // Describe + clear before logging: the log dispatcher makes JNI calls, which must not
-    // run with an exception pending.
-    env->ExceptionDescribe();
-    env->ExceptionClear();
-    LOG(instance_handle, LOG_LEVEL_ERROR, "JNI exception in %s", context);
-    return true;
-}
+std::atomic<bool> jni_class_cached{false};
 
 jclass find_global_class(JNIEnv *env, const void *instance_handle, const char *name) {
     jclass local_class = env->FindClass(name);
@@ -102,20 +91,32 @@ bool jni_cache_classes(JNIEnv *env, const void *instance_handle) {
         return false;
     }
 
+    if (jni_class_cached.load(std::memory_order_acquire)) {
+        return true;
+    }
     std::lock_guard<std::mutex> guard(jni_cache_mutex);
-    if (jni_class_cached) {
+    if (jni_class_cached.load(std::memory_order_relaxed)) {
         return true;
     }
 
     jclass event_listener_class = find_global_class(env, instance_handle, "org/openani/mediamp/mpv/EventListener");
+    jclass event_batch_dispatcher_class =
+            find_global_class(env, instance_handle, "org/openani/mediamp/mpv/EventBatchDispatcher");
     jclass render_update_listener_class =
             find_global_class(env, instance_handle, "org/openani/mediamp/mpv/RenderUpdateListener");
-    jclass mpv_log_class = find_global_class(env, instance_handle, "org/openani/mediamp/mpv/MPVLogKt");
+    jclass async_reply_listener_class =
+            find_global_class(env, instance_handle, "org/openani/mediamp/mpv/AsyncReplyListener");
+    jclass native_log_batch_class =
+            find_global_class(env, instance_handle, "org/openani/mediamp/mpv/NativeLogBatchKt");
     jclass seekable_input_class = find_global_class(env, instance_handle, "org/openani/mediamp/io/SeekableInput");
+    jclass byte_buffer_seekable_input_class =
+            find_global_class(env, instance_handle, "org/openani/mediamp/io/ByteBufferSeekableInput");
 #ifdef __ANDROID__
     jclass surface_class = find_global_class(env, instance_handle, "android/view/Surface");
 #endif
-    if (!event_listener_class || !render_update_listener_class || !mpv_log_class || !seekable_input_class
+    if (!event_listener_class || !event_batch_dispatcher_class || !render_update_listener_class || !async_reply_listener_class
+        || !native_log_batch_class || !seekable_input_class
+        || !byte_buffer_seekable_input_class
 #ifdef __ANDROID__
         || !surface_class
 #endif
@@ -126,65 +127,89 @@ bool jni_cache_classes(JNIEnv *env, const void *instance_handle) {
             "jni_cache_classes: failed to resolve one or more mediamp JNI classes; "
             "the native mpv bridge will not function");
         delete_global_ref(env, event_listener_class);
+        delete_global_ref(env, event_batch_dispatcher_class);
         delete_global_ref(env, render_update_listener_class);
-        delete_global_ref(env, mpv_log_class);
+        delete_global_ref(env, async_reply_listener_class);
+        delete_global_ref(env, native_log_batch_class);
         delete_global_ref(env, seekable_input_class);
+        delete_global_ref(env, byte_buffer_seekable_input_class);
 #ifdef __ANDROID__
         delete_global_ref(env, surface_class);
 #endif
         return false;
     }
 
-    jmethodID on_property_change_none =
-            find_method(env, instance_handle, event_listener_class, "onPropertyChange", "(Ljava/lang/String;)V");
-    jmethodID on_property_change_flag =
-            find_method(env, instance_handle, event_listener_class, "onPropertyChange", "(Ljava/lang/String;Z)V");
-    jmethodID on_property_change_int64 =
-            find_method(env, instance_handle, event_listener_class, "onPropertyChange", "(Ljava/lang/String;J)V");
-    jmethodID on_property_change_double =
-            find_method(env, instance_handle, event_listener_class, "onPropertyChange", "(Ljava/lang/String;D)V");
-    jmethodID on_property_change_string =
-            find_method(env, instance_handle, event_listener_class, "onPropertyChange", "(Ljava/lang/String;Ljava/lang/String;)V");
+    // The keyed callbacks, which carry the ID a property was observed with; the interface
+    // defaults them to the name-keyed ones for listeners that do not care.
+    jmethodID on_property_none =
+            find_method(env, instance_handle, event_listener_class, "onPropertyNone", "(JLjava/lang/String;)V");
+    jmethodID on_property_flag =
+            find_method(env, instance_handle, event_listener_class, "onPropertyFlag", "(JLjava/lang/String;Z)V");
+    jmethodID on_property_int64 =
+            find_method(env, instance_handle, event_listener_class, "onPropertyInt64", "(JLjava/lang/String;J)V");
+    jmethodID on_property_double =
+            find_method(env, instance_handle, event_listener_class, "onPropertyDouble", "(JLjava/lang/String;D)V");
+    jmethodID on_property_string =
+            find_method(env, instance_handle, event_listener_class, "onPropertyString",
+                        "(JLjava/lang/String;Ljava/lang/String;)V");
     jmethodID on_event =
             find_method(env, instance_handle, event_listener_class, "onEvent", "(I)V");
     jmethodID on_start_file =
             find_method(env, instance_handle, event_listener_class, "onStartFile", "(J)V");
     jmethodID on_end_file =
             find_method(env, instance_handle, event_listener_class, "onEndFile", "(IIJ)V");
+    jmethodID event_batch_dispatch =
+            find_method(env, instance_handle, event_batch_dispatcher_class, "dispatch", "(Ljava/nio/ByteBuffer;I)V");
     jmethodID on_render_update =
             find_method(env, instance_handle, render_update_listener_class, "onRenderUpdate", "()V");
-    jmethodID on_native_log =
-            env->GetStaticMethodID(mpv_log_class, "onNativeLog", "(JILjava/lang/String;Ljava/lang/String;)V");
-    if (!on_native_log) {
-        clear_jni_exception(env, instance_handle, "onNativeLog");
+    jmethodID on_async_reply =
+            find_method(env, instance_handle, async_reply_listener_class, "onReply", "(I)V");
+    jmethodID on_native_log_batch =
+            env->GetStaticMethodID(native_log_batch_class, "onNativeLogBatch", "(Ljava/nio/ByteBuffer;I)V");
+    if (!on_native_log_batch) {
+        clear_jni_exception(env, instance_handle, "onNativeLogBatch");
     }
     jmethodID seekable_input_read =
             find_method(env, instance_handle, seekable_input_class, "read", "([BII)I");
     jmethodID seekable_input_seek_to =
             find_method(env, instance_handle, seekable_input_class, "seekTo", "(J)V");
+    jmethodID seekable_input_get_position =
+            find_method(env, instance_handle, seekable_input_class, "getPosition", "()J");
     jmethodID seekable_input_close =
             find_method(env, instance_handle, seekable_input_class, "close", "()V");
-
-    if (!on_property_change_none ||
-        !on_property_change_flag ||
-        !on_property_change_int64 ||
-        !on_property_change_double ||
-        !on_property_change_string ||
+    jmethodID seekable_input_interrupt =
+            find_method(env, instance_handle, seekable_input_class, "interrupt", "()V");
+    jmethodID byte_buffer_seekable_input_read =
+            find_method(env, instance_handle, byte_buffer_seekable_input_class, "read", "(Ljava/nio/ByteBuffer;)I");
+
+    if (!on_property_none ||
+        !on_property_flag ||
+        !on_property_int64 ||
+        !on_property_double ||
+        !on_property_string ||
         !on_event ||
         !on_start_file ||
         !on_end_file ||
+        !event_batch_dispatch ||
         !on_render_update ||
-        !on_native_log ||
+        !on_async_reply ||
+        !on_native_log_batch ||
         !seekable_input_read ||
         !seekable_input_seek_to ||
-        !seekable_input_close) {
+        !seekable_input_get_position ||
+        !seekable_input_close ||
+        !seekable_input_interrupt ||
+        !byte_buffer_seekable_input_read) {
         LOG(instance_handle, LOG_LEVEL_ERROR,
             "jni_cache_classes: failed to resolve one or more mediamp JNI methods; "
             "the native mpv bridge will not function");
         delete_global_ref(env, event_listener_class);
+        delete_global_ref(env, event_batch_dispatcher_class);
         delete_global_ref(env, render_update_listener_class);
-        delete_global_ref(env, mpv_log_class);
+        delete_global_ref(env, async_reply_listener_class);
+        delete_global_ref(env, native_log_batch_class);
         delete_global_ref(env, seekable_input_class);
+        delete_global_ref(env, byte_buffer_seekable_input_class);
 #ifdef __ANDROID__
         delete_global_ref(env, surface_class);
 #endif
@@ -192,27 +217,35 @@ bool jni_cache_classes(JNIEnv *env, const void *instance_handle) {
     }
 
     jni_mediamp_clazz_EventListener = event_listener_class;
-    jni_mediamp_method_EventListener_onPropertyChange_NONE = on_property_change_none;
-    jni_mediamp_method_EventListener_onPropertyChange_FLAG = on_property_change_flag;
-    jni_mediamp_method_EventListener_onPropertyChange_INT64 = on_property_change_int64;
-    jni_mediamp_method_EventListener_onPropertyChange_DOUBLE = on_property_change_double;
-    jni_mediamp_method_EventListener_onPropertyChange_STRING = on_property_change_string;
+    jni_mediamp_method_EventListener_onPropertyNone = on_property_none;
+    jni_mediamp_method_EventListener_onPropertyFlag = on_property_flag;
+    jni_mediamp_method_EventListener_onPropertyInt64 = on_property_int64;
+    jni_mediamp_method_EventListener_onPropertyDouble = on_property_double;
+    jni_mediamp_method_EventListener_onPropertyString = on_property_string;
     jni_mediamp_method_EventListener_onEvent = on_event;
     jni_mediamp_method_EventListener_onStartFile = on_start_file;
     jni_mediamp_method_EventListener_onEndFile = on_end_file;
+    jni_mediamp_clazz_EventBatchDispatcher = event_batch_dispatcher_class;
+    jni_mediamp_method_EventBatchDispatcher_dispatch = event_batch_dispatch;
     jni_mediamp_clazz_RenderUpdateListener = render_update_listener_class;
     jni_mediamp_method_RenderUpdateListener_onRenderUpdate = on_render_update;
-    jni_mediamp_clazz_MPVLogKt = mpv_log_class;
-    jni_mediamp_method_MPVLogKt_onNativeLog = on_native_log;
+    jni_mediamp_clazz_AsyncReplyListener = async_reply_listener_class;
+    jni_mediamp_method_AsyncReplyListener_onReply = on_async_reply;
+    jni_mediamp_clazz_NativeLogBatchKt = native_log_batch_class;
+    jni_mediamp_method_NativeLogBatchKt_onNativeLogBatch = on_native_log_batch;
     jni_mediamp_clazz_SeekableInput = seekable_input_class;
     jni_mediamp_method_SeekableInput_read = seekable_input_read;
     jni_mediamp_method_SeekableInput_seekTo = seekable_input_seek_to;
+    jni_mediamp_method_SeekableInput_getPosition = seekable_input_get_position;
     jni_mediamp_method_SeekableInput_close = seekable_input_close;
+    jni_mediamp_method_SeekableInput_interrupt = seekable_input_interrupt;
+    jni_mediamp_clazz_ByteBufferSeekableInput = byte_buffer_seekable_input_class;
+    jni_mediamp_method_ByteBufferSeekableInput_read = byte_buffer_seekable_input_read;
 #ifdef __ANDROID__
     jni_mediamp_clazz_android_Surface = surface_class;
 #endif
 
-    jni_class_cached = true;
+    jni_class_cached.store(true, std::memory_order_release);
     return true;
 }
     
@@ -1,6 +1,7 @@
 #include <clocale>
 #include <iostream>
 #include <atomic>
+#include <cstring>
 #include <limits>
 #include <new>
 #include <stdexcept>
@@ -9,7 +10,12 @@
 #include "mpv_handle_t.h"
 #include "method_cache.h"
 #include "compatible_thread.h"
+#include "disk_cache.h"
 #include "global_lock.h"
+#include "native_file.h"
+#include "native_util.h"
+#include "read_ahead_cache.h"
+#include "stream_io_stats.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -27,11 +33,24 @@ extern "C" {
     LOG(this, LOG_LEVEL_WARN, "mpv handle is not created when %s", __FUNCTION__); \
     return 0; \
 }
+// Entry of the hot methods: handle_lock shared, then CHECK_HANDLE. Once destroy() wants
+// the lock they fail without taking it, since std::shared_mutex may prefer readers (glibc's
+// does) and a steady stream of them would otherwise keep destroy() waiting indefinitely.
+#define SHARED_HANDLE_LOCK(fail_value) if (destroying_.load(std::memory_order_acquire)) { \
+    LOG(this, LOG_LEVEL_WARN, "mpv handle is being destroyed when %s", __FUNCTION__); \
+    return fail_value; \
+} \
+SHARED_LOCK(handle_lock)
 
 namespace mediampv {
 
-CREATE_LOCK(global_guard);
+// Guards the process-wide state touched while creating a handle: the one-time JVM setup
+// below, and the C locale around mpv_create(). Everything else in create() runs unguarded,
+// so handles created on different threads only serialize on those few calls.
+std::mutex global_guard;
 JavaVM *global_jvm = nullptr;
+// Guarded by global_guard.
+static bool ffmpeg_jvm_set = false;
 
 namespace {
 
@@ -42,8 +61,8 @@ struct stream_lock_guard final {
     explicit stream_lock_guard(CompatibleLock &lock) : guard(lock) {}
     LockGuard guard;
 #else
-    explicit stream_lock_guard(std::recursive_mutex &lock) : guard(lock) {}
-    std::lock_guard<std::recursive_mutex> guard;
+    explicit stream_lock_guard(std::mutex &lock) : guard(lock) {}
+    std::lock_guard<std::mutex> guard;
 #endif
 };
 
@@ -75,6 +94,9 @@ struct attached_jni_env final {
         }
     }
 
+    // Whether this had to attach the thread, i.e. it was not a JVM thread already.
+    bool attached_thread() const { return attached; }
+
     JNIEnv *env = nullptr;
 
 private:
@@ -82,19 +104,6 @@ private:
     bool attached = false;
 };
 
-bool clear_jni_exception(JNIEnv *env, const void *instance_handle, const char *context) {
-    if (!env || !env->ExceptionCheck()) {
-        return false;
-    }
-
-    // Describe + clear before logging: the log dispatcher makes JNI calls, which must not
-    // run with an exception pending.
-    env->ExceptionDescribe();
-    env->ExceptionClear();
-    LOG(instance_handle, LOG_LEVEL_ERROR, "JNI exception in %s", context);
-    return true;
-}
-
 void delete_global_ref(JNIEnv *env, jobject &reference) {
     if (env && reference) {
         env->DeleteGlobalRef(reference);
@@ -104,21 +113,82 @@ void delete_global_ref(JNIEnv *env, jobject &reference) {
 
 } // namespace
 
-struct mpv_handle_t::seekable_stream_entry final {
+struct mpv_handle_t::seekable_stream_entry final : block_source {
     seekable_stream_entry(
             const void *instance_handle,
             JavaVM *vm,
             jobject input,
             std::string stream_uri,
-            int64_t stream_size)
+            int64_t stream_size,
+            int64_t input_position,
+            bool direct_read,
+            int64_t read_ahead_size,
+            jint min_read_size,
+            const std::string &cache_key,
+            const std::string &content_id,
+            std::unique_ptr<native_file> file)
             : instance_handle(instance_handle),
               jvm(vm),
               input(input),
               uri(std::move(stream_uri)),
-              size(stream_size) {}
+              size(stream_size),
+              direct_read(direct_read),
+              min_read_size(std::max<jint>(min_read_size, 0)),
+              file(std::move(file)),
+              input_position(input_position) {
+        // A native file needs no cache of ours: the OS page cache and its read-ahead
+        // already sit between pread and the disk.
+        if (!this->file && read_ahead_size > 0 && stream_size > 0) {
+            cache.reset(new read_ahead_cache(
+                    *this, cache_key, stream_size, read_ahead_size, min_read_size, instance_handle));
+            disk = disk_cache::open(content_id, stream_size, read_ahead_cache::kBlockSize, instance_handle);
+        }
+    }
 
+    // Cancels every open of the stream, when it is unregistered or its handle destroyed.
+    // mpv's cancel_fn cancels a single open instead (seekable_stream_cancel).
     void request_cancel() {
         cancel_requested.store(true, std::memory_order_relaxed);
+        if (cache) {
+            cache->request_stop();
+        }
+        // A read blocked in Kotlin holds io_lock until it returns; make it return now
+        // rather than when its data arrives, so stop and destroy are not held up by it.
+        interrupt_input();
+    }
+
+    // SeekableInput.interrupt, without io_lock: it is meant to be called while a read
+    // holds it.
+    void interrupt_input() {
+        attached_jni_env attached_env(jvm);
+        JNIEnv *env = attached_env.env;
+        if (!env) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> guard(interrupt_lock);
+        if (input) {
+            interrupt_pending.store(true, std::memory_order_release);
+            env->CallVoidMethod(input, mediampv::jni_mediamp_method_SeekableInput_interrupt);
+            clear_jni_exception(env, instance_handle, "SeekableInput.interrupt");
+        }
+    }
+
+    // clear_jni_exception for calls into the input. The first exception after
+    // SeekableInput.interrupt is that interrupt doing its job, and is cleared quietly and
+    // recorded in `input_interrupted` instead of being described and logged as an error.
+    // Must be called with io_lock held.
+    bool clear_input_exception(JNIEnv *env, const char *context) {
+        if (!env->ExceptionCheck()) {
+            return false;
+        }
+        if (!interrupt_pending.exchange(false, std::memory_order_acq_rel)) {
+            return clear_jni_exception(env, instance_handle, context);
+        }
+        env->ExceptionClear();
+        input_interrupted = true;
+        LOG(instance_handle, LOG_LEVEL_DEBUG, "%s interrupted", context);
+        return true;
     }
 
     bool close_and_release() {
@@ -126,6 +196,12 @@ struct mpv_handle_t::seekable_stream_entry final {
             return false;
         }
 
+        // The prefetch thread takes io_lock for every fetch; stop it before taking the
+        // lock below, and before the input it reads from is closed.
+        if (cache) {
+            cache->stop();
+        }
+
         attached_jni_env attached_env(jvm);
         JNIEnv *env = attached_env.env;
         if (!env) {
@@ -137,6 +213,7 @@ struct mpv_handle_t::seekable_stream_entry final {
         if (input) {
             env->CallVoidMethod(input, mediampv::jni_mediamp_method_SeekableInput_close);
             clear_jni_exception(env, instance_handle, "SeekableInput.close");
+            std::lock_guard<std::mutex> interrupt_guard(interrupt_lock);
             env->DeleteGlobalRef(input);
             input = nullptr;
         }
@@ -149,10 +226,90 @@ struct mpv_handle_t::seekable_stream_entry final {
     jobject input = nullptr;
     std::string uri;
     int64_t size = -1;
-    std::atomic_bool opened{false};
+    // The input implements ByteBufferSeekableInput: reads are served straight into mpv's
+    // buffer through a direct ByteBuffer instead of bouncing through a Java byte[].
+    bool direct_read = false;
+    // Without read-ahead, mpv reads smaller than this are rounded up to it and the rest is
+    // kept in the cookie's stash, so mpv's many small reads while probing (and its seeks
+    // back into just-read data) are served natively instead of each calling into Kotlin.
+    // With read-ahead it is the cache's fetch size. 0 passes mpv's reads through.
+    const jint min_read_size;
+    // Live mpv opens of this stream; each has its own cookie and position. The input is
+    // closed when the last one is closed.
+    std::atomic_int open_count{0};
     std::atomic_bool cancel_requested{false};
     std::atomic_bool released{false};
     CREATE_LOCK(io_lock);
+    // The open (cookie) whose read is in Kotlin under io_lock, so that cancelling another
+    // open does not interrupt it. Null when no read is in Kotlin.
+    std::atomic<const void *> reading_open{nullptr};
+    // Keeps `input` alive for interrupt_input, which runs outside io_lock.
+    std::mutex interrupt_lock;
+    // SeekableInput.interrupt was called and no call into the input has failed since. The
+    // input may apply it to a later call than the one it was meant for.
+    std::atomic_bool interrupt_pending{false};
+    // The last call into the input failed because it was interrupted. Guarded by io_lock.
+    bool input_interrupted = false;
+
+    // The local file behind `input`, when it has one and it could be opened natively. mpv
+    // then reads it directly and `input` is only kept to be closed.
+    std::unique_ptr<native_file> file;
+    // Read-ahead block cache, null when disabled. Once started, its prefetch thread is
+    // the only reader of `input`; mpv's reads are served from native memory.
+    std::unique_ptr<read_ahead_cache> cache;
+    // Persistent tier under `cache`, null when no content ID was given or the tier is off.
+    std::shared_ptr<disk_cache> disk;
+    stream_io_stats stats;
+
+    // block_source, called on the cache's prefetch thread only.
+    void attach_prefetch_thread() override;
+    void detach_prefetch_thread() override;
+    int64_t fetch(int64_t offset, char *buffer, int64_t length) override;
+    void interrupt_fetch() override {
+        interrupt_input();
+    }
+    bool load_block(int64_t index, char *buffer, int64_t length) override {
+        return disk && disk->read_block(index, buffer, length);
+    }
+    void store_block(int64_t index, const char *buffer, int64_t length) override {
+        if (disk) {
+            disk->write_block(index, buffer, length);
+        }
+    }
+
+    // Reads up to `length` bytes at `offset` from the Kotlin input, positioning it first
+    // only when it is not already there; `seeked_input`, when given, is set when that took
+    // a SeekableInput.seekTo. Must be called with io_lock held.
+    int64_t read_at(
+            JNIEnv *env,
+            int64_t offset,
+            char *buffer,
+            jint length,
+            jobject &read_buffer,
+            jint &read_buffer_capacity,
+            bool *seeked_input = nullptr);
+
+private:
+    // Forward gaps up to this size are skipped by reading and discarding instead of
+    // SeekableInput.seekTo, which for a BufferedSeekableInput drops the buffer it has.
+    static constexpr int64_t kMaxSkipDistance = 64 * 1024;
+
+    bool move_input_to(
+            JNIEnv *env,
+            int64_t offset,
+            jobject &read_buffer,
+            jint &read_buffer_capacity,
+            bool *seeked_input);
+
+    JNIEnv *prefetch_env = nullptr;
+    bool prefetch_attached = false;
+    // Where the Kotlin input currently is, tracked natively so that seeks to where it
+    // already is never reach Kotlin; -1 when unknown (after an error, or when the input
+    // could not tell at registration). Guarded by io_lock.
+    int64_t input_position = -1;
+    std::unique_ptr<char[]> skip_buffer;
+    jobject fetch_buffer = nullptr;
+    jint fetch_buffer_capacity = 0;
 };
 
 struct mpv_handle_t::seekable_stream_cookie final {
@@ -160,118 +317,314 @@ struct mpv_handle_t::seekable_stream_cookie final {
             : entry(std::move(entry)) {}
 
     std::shared_ptr<seekable_stream_entry> entry;
+    // Set by mpv's cancel_fn for this open only; its reads and seeks fail from then on.
+    std::atomic_bool cancel_requested{false};
+    // This open's reader in entry->cache, null without read-ahead.
+    read_ahead_cache::reader *cache_reader = nullptr;
+    // mpv's read position in the stream. Seeks only move this; the Kotlin input follows
+    // lazily on the next read that actually needs it.
+    int64_t position = 0;
+    // A seek moved `position` and no read has been served since, so whether it needs a
+    // SeekableInput.seekTo is not known yet.
+    bool seek_pending = false;
+    // entry->min_read_size bytes, allocated on the first small read.
+    std::unique_ptr<char[]> stash;
+    int64_t stash_start = 0;
+    int64_t stash_end = 0;
     jobject read_buffer = nullptr;
     jint read_buffer_capacity = 0;
 };
 
 namespace {
 
-bool ensure_seekable_read_buffer(JNIEnv *env, mpv_handle_t::seekable_stream_cookie *cookie, jint size) {
+bool ensure_seekable_read_buffer(
+        JNIEnv *env,
+        const void *instance_handle,
+        jobject &buffer,
+        jint &capacity,
+        jint size) {
     if (size <= 0) {
         return true;
     }
-    if (cookie->read_buffer && cookie->read_buffer_capacity >= size) {
+    if (buffer && capacity >= size) {
         return true;
     }
 
-    if (cookie->read_buffer) {
-        env->DeleteGlobalRef(cookie->read_buffer);
-        cookie->read_buffer = nullptr;
-        cookie->read_buffer_capacity = 0;
+    if (buffer) {
+        env->DeleteGlobalRef(buffer);
+        buffer = nullptr;
+        capacity = 0;
     }
 
     jbyteArray local_buffer = env->NewByteArray(size);
-    if (!local_buffer || clear_jni_exception(env, cookie->entry->instance_handle, "NewByteArray")) {
+    if (!local_buffer || clear_jni_exception(env, instance_handle, "NewByteArray")) {
         return false;
     }
 
-    cookie->read_buffer = env->NewGlobalRef(local_buffer);
+    buffer = env->NewGlobalRef(local_buffer);
     env->DeleteLocalRef(local_buffer);
-    cookie->read_buffer_capacity = cookie->read_buffer ? size : 0;
-    return cookie->read_buffer != nullptr;
+    capacity = buffer ? size : 0;
+    return buffer != nullptr;
 }
 
-int64_t seekable_stream_read(void *cookie_ptr, char *buf, uint64_t nbytes) {
-    auto *cookie = static_cast<mpv_handle_t::seekable_stream_cookie *>(cookie_ptr);
-    if (!cookie || !cookie->entry) {
+constexpr int64_t kDirectReadUnavailable = std::numeric_limits<int64_t>::min();
+
+// Wraps mpv's own read buffer in a direct ByteBuffer and lets the input fill it in place,
+// saving the byte[] round trip and the GetByteArrayRegion copy. Returns
+// kDirectReadUnavailable when the VM cannot create direct buffers, so the caller can fall
+// back to the byte[] path. Must be called with entry->io_lock held.
+int64_t seekable_stream_read_direct(
+        JNIEnv *env,
+        mpv_handle_t::seekable_stream_entry *entry,
+        char *buf,
+        jint requested_size) {
+    jobject direct_buffer = env->NewDirectByteBuffer(buf, requested_size);
+    if (!direct_buffer) {
+        clear_jni_exception(env, entry->instance_handle, "NewDirectByteBuffer");
+        return kDirectReadUnavailable;
+    }
+
+    entry->stats.record_input_read();
+    const auto read_start = stream_io_stats::clock::now();
+    const jint bytes_read = env->CallIntMethod(
+            entry->input,
+            mediampv::jni_mediamp_method_ByteBufferSeekableInput_read,
+            direct_buffer
+    );
+    entry->stats.add_input_nanos(stream_io_stats::nanos_since(read_start));
+    // The buffer aliases memory owned by mpv; drop the reference right away so nothing on
+    // the Java side can observe it after this read returns.
+    env->DeleteLocalRef(direct_buffer);
+    if (entry->clear_input_exception(env, "ByteBufferSeekableInput.read")) {
         return -1;
     }
-
-    auto entry = cookie->entry;
-    if (entry->cancel_requested.load(std::memory_order_relaxed) || entry->released.load(std::memory_order_acquire)) {
+    if (bytes_read > requested_size) {
+        LOG(entry->instance_handle, LOG_LEVEL_ERROR,
+            "ByteBufferSeekableInput.read returned %d, more than the %d bytes requested",
+            bytes_read, requested_size);
         return -1;
     }
 
-    attached_jni_env attached_env(entry->jvm);
-    JNIEnv *env = attached_env.env;
-    if (!env) {
-        return -1;
-    }
+    // Kotlin reports EOF as -1; stream_cb (and read_at's position tracking) expect 0.
+    return bytes_read < 0 ? 0 : bytes_read;
+}
 
-    const jint requested_size = static_cast<jint>(
-            std::min<uint64_t>(nbytes, static_cast<uint64_t>(std::numeric_limits<jint>::max())));
-    if (requested_size <= 0) {
-        return 0;
+// Reads from the Kotlin input at its current position, through a direct ByteBuffer when
+// it supports one and through `read_buffer` otherwise. Returns the bytes read, 0 at EOF
+// or -1 when the input threw. Must be called with entry->io_lock held and the input not
+// yet released.
+int64_t read_seekable_input(
+        JNIEnv *env,
+        mpv_handle_t::seekable_stream_entry *entry,
+        char *buf,
+        jint requested_size,
+        jobject &read_buffer,
+        jint &read_buffer_capacity) {
+    if (entry->direct_read) {
+        const int64_t bytes_read = seekable_stream_read_direct(env, entry, buf, requested_size);
+        if (bytes_read != kDirectReadUnavailable) {
+            return bytes_read;
+        }
     }
 
-    stream_lock_guard guard(entry->io_lock);
-    if (entry->released.load(std::memory_order_acquire) || !entry->input) {
-        return -1;
-    }
-    if (!ensure_seekable_read_buffer(env, cookie, requested_size)) {
+    if (!ensure_seekable_read_buffer(env, entry->instance_handle, read_buffer, read_buffer_capacity, requested_size)) {
         return -1;
     }
 
-    auto read_buffer = reinterpret_cast<jbyteArray>(cookie->read_buffer);
+    auto array = reinterpret_cast<jbyteArray>(read_buffer);
+    entry->stats.record_input_read();
+    const auto read_start = stream_io_stats::clock::now();
     const jint bytes_read = env->CallIntMethod(
             entry->input,
             mediampv::jni_mediamp_method_SeekableInput_read,
-            read_buffer,
+            array,
             0,
             requested_size
     );
-    if (clear_jni_exception(env, entry->instance_handle, "SeekableInput.read")) {
+    entry->stats.add_input_nanos(stream_io_stats::nanos_since(read_start));
+    if (entry->clear_input_exception(env, "SeekableInput.read")) {
         return -1;
     }
 
     if (bytes_read > 0) {
-        env->GetByteArrayRegion(read_buffer, 0, bytes_read, reinterpret_cast<jbyte *>(buf));
+        const auto copy_start = stream_io_stats::clock::now();
+        env->GetByteArrayRegion(array, 0, bytes_read, reinterpret_cast<jbyte *>(buf));
+        entry->stats.add_copy_nanos(stream_io_stats::nanos_since(copy_start));
         if (clear_jni_exception(env, entry->instance_handle, "GetByteArrayRegion")) {
             return -1;
         }
     }
 
-    return bytes_read;
+    return bytes_read < 0 ? 0 : bytes_read;
 }
 
-int64_t seekable_stream_seek(void *cookie_ptr, int64_t offset) {
-    auto *cookie = static_cast<mpv_handle_t::seekable_stream_cookie *>(cookie_ptr);
-    if (!cookie || !cookie->entry) {
-        return MPV_ERROR_GENERIC;
+// Publishes `cookie` as the open reading from the Kotlin input while it holds io_lock.
+class reading_open_scope final {
+public:
+    explicit reading_open_scope(mpv_handle_t::seekable_stream_cookie *cookie)
+            : entry_(*cookie->entry) {
+        entry_.reading_open.store(cookie);
+    }
+    ~reading_open_scope() {
+        entry_.reading_open.store(nullptr);
     }
 
-    auto entry = cookie->entry;
-    if (offset < 0 || entry->cancel_requested.load(std::memory_order_relaxed) ||
-        entry->released.load(std::memory_order_acquire)) {
-        return MPV_ERROR_GENERIC;
+    reading_open_scope(const reading_open_scope &) = delete;
+    reading_open_scope &operator=(const reading_open_scope &) = delete;
+
+private:
+    mpv_handle_t::seekable_stream_entry &entry_;
+};
+
+bool is_cancelled(const mpv_handle_t::seekable_stream_cookie *cookie) {
+    return cookie->cancel_requested.load() ||
+           cookie->entry->cancel_requested.load(std::memory_order_relaxed) ||
+           cookie->entry->released.load(std::memory_order_acquire);
+}
+
+int64_t read_stream(mpv_handle_t::seekable_stream_cookie *cookie, char *buf, uint64_t nbytes, bool &seeked_input) {
+    auto &entry = cookie->entry;
+    if (is_cancelled(cookie)) {
+        return -1;
+    }
+
+    if (entry->file) {
+        const int64_t bytes_read = entry->file->read_at(
+                cookie->position,
+                buf,
+                static_cast<int64_t>(std::min<uint64_t>(nbytes, static_cast<uint64_t>(std::numeric_limits<int64_t>::max()))));
+        if (bytes_read > 0) {
+            cookie->position += bytes_read;
+        }
+        return bytes_read;
+    }
+
+    if (cookie->cache_reader) {
+        // Served from native memory; no JNI on mpv's thread.
+        const int64_t bytes_read = entry->cache->read(
+                cookie->cache_reader,
+                cookie->position,
+                buf,
+                static_cast<int64_t>(std::min<uint64_t>(nbytes, static_cast<uint64_t>(std::numeric_limits<int64_t>::max()))));
+        if (bytes_read > 0) {
+            cookie->position += bytes_read;
+        }
+        return bytes_read;
+    }
+
+    if (cookie->position >= cookie->stash_start && cookie->position < cookie->stash_end) {
+        const int64_t count = static_cast<int64_t>(
+                std::min<uint64_t>(nbytes, static_cast<uint64_t>(cookie->stash_end - cookie->position)));
+        const auto copy_start = stream_io_stats::clock::now();
+        std::memcpy(buf, cookie->stash.get() + (cookie->position - cookie->stash_start), static_cast<size_t>(count));
+        entry->stats.add_copy_nanos(stream_io_stats::nanos_since(copy_start));
+        cookie->position += count;
+        return count;
     }
 
     attached_jni_env attached_env(entry->jvm);
     JNIEnv *env = attached_env.env;
     if (!env) {
-        return MPV_ERROR_GENERIC;
+        return -1;
+    }
+    if (attached_env.attached_thread()) {
+        entry->stats.record_jni_attach();
     }
 
+    const jint requested_size = static_cast<jint>(
+            std::min<uint64_t>(nbytes, static_cast<uint64_t>(std::numeric_limits<jint>::max())));
+    if (requested_size <= 0) {
+        return 0;
+    }
+
+    const auto lock_start = stream_io_stats::clock::now();
     stream_lock_guard guard(entry->io_lock);
-    if (entry->released.load(std::memory_order_acquire) || !entry->input) {
+    entry->stats.add_lock_wait_nanos(stream_io_stats::nanos_since(lock_start));
+    // Published before the cancel flag is checked again, and seekable_stream_cancel sets
+    // the flag before it looks at reading_open (both sequentially consistent): a cancel
+    // racing with this read either fails it here or interrupts it in Kotlin.
+    reading_open_scope reading(cookie);
+    if (is_cancelled(cookie) || !entry->input) {
+        return -1;
+    }
+
+    if (requested_size >= entry->min_read_size) {
+        // Large enough to be worth reading straight into mpv's buffer.
+        const int64_t bytes_read = entry->read_at(
+                env, cookie->position, buf, requested_size, cookie->read_buffer, cookie->read_buffer_capacity,
+                &seeked_input);
+        if (bytes_read > 0) {
+            cookie->position += bytes_read;
+        }
+        return bytes_read;
+    }
+
+    if (!cookie->stash) {
+        cookie->stash.reset(new (std::nothrow) char[entry->min_read_size]);
+        if (!cookie->stash) {
+            return -1;
+        }
+    }
+    cookie->stash_start = cookie->stash_end = 0;
+    const int64_t stashed = entry->read_at(
+            env, cookie->position, cookie->stash.get(), entry->min_read_size,
+            cookie->read_buffer, cookie->read_buffer_capacity, &seeked_input);
+    if (stashed <= 0) {
+        return stashed;
+    }
+    cookie->stash_start = cookie->position;
+    cookie->stash_end = cookie->position + stashed;
+
+    const int64_t count = std::min<int64_t>(requested_size, stashed);
+    std::memcpy(buf, cookie->stash.get(), static_cast<size_t>(count));
+    cookie->position += count;
+    return count;
+}
+
+int64_t seekable_stream_read(void *cookie_ptr, char *buf, uint64_t nbytes) {
+    auto *cookie = static_cast<mpv_handle_t::seekable_stream_cookie *>(cookie_ptr);
+    if (!cookie || !cookie->entry) {
+        return -1;
+    }
+
+    const auto start = stream_io_stats::clock::now();
+    const bool after_seek = cookie->seek_pending;
+    cookie->seek_pending = false;
+    bool seeked_input = false;
+    const int64_t result = read_stream(cookie, buf, nbytes, seeked_input);
+    cookie->entry->stats.record_read(result, stream_io_stats::nanos_since(start));
+    // Counted here rather than as seeks minus input seeks: the prefetch thread makes input
+    // seeks of its own, and a failed read leaves it open whether the seek was needed.
+    if (after_seek && result >= 0 && !seeked_input) {
+        cookie->entry->stats.record_elided_seek();
+    }
+    return result;
+}
+
+int64_t seekable_stream_seek(void *cookie_ptr, int64_t offset) {
+    auto *cookie = static_cast<mpv_handle_t::seekable_stream_cookie *>(cookie_ptr);
+    if (!cookie || !cookie->entry) {
         return MPV_ERROR_GENERIC;
     }
 
-    env->CallVoidMethod(entry->input, mediampv::jni_mediamp_method_SeekableInput_seekTo, static_cast<jlong>(offset));
-    if (clear_jni_exception(env, entry->instance_handle, "SeekableInput.seekTo")) {
+    auto entry = cookie->entry;
+    entry->stats.record_seek();
+    // Past the end fails here, as it would have in SeekableInput.seekTo had the seek
+    // reached the input; seeking to the end itself is how mpv probes for EOF.
+    if (offset < 0 || (entry->size >= 0 && offset > entry->size) || is_cancelled(cookie)) {
         return MPV_ERROR_GENERIC;
     }
 
+    // Demuxers seek constantly, mostly to where they already are or into data they just
+    // read. Only record the position: the read-ahead cache or the stash serves it when
+    // the bytes are already here, and otherwise read_at positions the Kotlin input on the
+    // next read, so SeekableInput.seekTo is called only when it is really needed.
+    if (cookie->seek_pending) {
+        // Superseded before anything was read there.
+        entry->stats.record_elided_seek();
+    }
+    cookie->position = offset;
+    cookie->seek_pending = true;
     return offset;
 }
 
@@ -301,7 +654,15 @@ void seekable_stream_close(void *cookie_ptr) {
     }
 
     if (cookie->entry) {
-        cookie->entry->close_and_release();
+        if (cookie->seek_pending) {
+            cookie->entry->stats.record_elided_seek();
+        }
+        if (cookie->cache_reader) {
+            cookie->entry->cache->close_reader(cookie->cache_reader);
+        }
+        if (cookie->entry->open_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            cookie->entry->close_and_release();
+        }
     }
 
     delete cookie;
@@ -313,11 +674,141 @@ void seekable_stream_cancel(void *cookie_ptr) {
         return;
     }
 
-    cookie->entry->request_cancel();
+    // Only this open: other opens of the stream, and inputs on other handles sharing its
+    // read-ahead cache key, keep reading. The prefetch thread is stopped when the last
+    // open is closed (seekable_stream_close) or the stream is unregistered.
+    cookie->cancel_requested.store(true);
+    auto &entry = *cookie->entry;
+    if (cookie->cache_reader) {
+        entry.cache->cancel_reader(cookie->cache_reader);
+    } else if (entry.reading_open.load() == cookie) {
+        // Its read is blocked in Kotlin, holding io_lock until it returns.
+        entry.interrupt_input();
+    }
 }
 
 } // namespace
 
+void mpv_handle_t::seekable_stream_entry::attach_prefetch_thread() {
+    if (!jvm) {
+        return;
+    }
+    if (jvm->GetEnv(reinterpret_cast<void **>(&prefetch_env), JNI_VERSION_1_6) == JNI_OK) {
+        return;
+    }
+
+    // Attached for the thread's whole lifetime, as a daemon so a player that is never
+    // closed does not keep the JVM from exiting.
+    JavaVMAttachArgs args{JNI_VERSION_1_6, const_cast<char *>("mediamp-read-ahead"), nullptr};
+#if defined(__ANDROID__)
+    prefetch_attached = jvm->AttachCurrentThreadAsDaemon(&prefetch_env, &args) == JNI_OK;
+#else
+    prefetch_attached = jvm->AttachCurrentThreadAsDaemon(reinterpret_cast<void **>(&prefetch_env), &args) == JNI_OK;
+#endif
+    if (prefetch_attached) {
+        stats.record_jni_attach();
+    } else {
+        prefetch_env = nullptr;
+    }
+}
+
+void mpv_handle_t::seekable_stream_entry::detach_prefetch_thread() {
+    if (prefetch_env && fetch_buffer) {
+        prefetch_env->DeleteGlobalRef(fetch_buffer);
+        fetch_buffer = nullptr;
+        fetch_buffer_capacity = 0;
+    }
+    if (prefetch_attached) {
+        jvm->DetachCurrentThread();
+        prefetch_attached = false;
+    }
+    prefetch_env = nullptr;
+}
+
+int64_t mpv_handle_t::seekable_stream_entry::fetch(int64_t offset, char *buffer, int64_t length) {
+    JNIEnv *env = prefetch_env;
+    if (!env) {
+        return -1;
+    }
+
+    const auto lock_start = stream_io_stats::clock::now();
+    stream_lock_guard guard(io_lock);
+    stats.add_lock_wait_nanos(stream_io_stats::nanos_since(lock_start));
+    if (released.load(std::memory_order_acquire) || !input) {
+        return -1;
+    }
+
+    const auto requested_size = static_cast<jint>(std::min<int64_t>(length, std::numeric_limits<jint>::max()));
+    input_interrupted = false;
+    const int64_t fetched = read_at(env, offset, buffer, requested_size, fetch_buffer, fetch_buffer_capacity);
+    return fetched < 0 && input_interrupted ? kInterrupted : fetched;
+}
+
+int64_t mpv_handle_t::seekable_stream_entry::read_at(
+        JNIEnv *env,
+        int64_t offset,
+        char *buffer,
+        jint length,
+        jobject &read_buffer,
+        jint &read_buffer_capacity,
+        bool *seeked_input) {
+    if (!move_input_to(env, offset, read_buffer, read_buffer_capacity, seeked_input)) {
+        return -1;
+    }
+
+    const int64_t bytes_read = read_seekable_input(env, this, buffer, length, read_buffer, read_buffer_capacity);
+    if (bytes_read > 0) {
+        input_position += bytes_read;
+    } else if (bytes_read < 0) {
+        input_position = -1;
+    }
+    return bytes_read;
+}
+
+bool mpv_handle_t::seekable_stream_entry::move_input_to(
+        JNIEnv *env,
+        int64_t offset,
+        jobject &read_buffer,
+        jint &read_buffer_capacity,
+        bool *seeked_input) {
+    if (input_position == offset) {
+        return true;
+    }
+
+    if (input_position >= 0 && offset > input_position && offset - input_position <= kMaxSkipDistance) {
+        if (!skip_buffer) {
+            skip_buffer.reset(new (std::nothrow) char[kMaxSkipDistance]);
+        }
+        while (skip_buffer && input_position < offset) {
+            const int64_t skipped = read_seekable_input(
+                    env, this, skip_buffer.get(), static_cast<jint>(offset - input_position),
+                    read_buffer, read_buffer_capacity);
+            if (skipped <= 0) {
+                // Fall back to a real seek below.
+                break;
+            }
+            input_position += skipped;
+        }
+        if (input_position == offset) {
+            return true;
+        }
+    }
+
+    stats.record_input_seek();
+    if (seeked_input) {
+        *seeked_input = true;
+    }
+    const auto seek_start = stream_io_stats::clock::now();
+    env->CallVoidMethod(input, mediampv::jni_mediamp_method_SeekableInput_seekTo, static_cast<jlong>(offset));
+    stats.add_input_nanos(stream_io_stats::nanos_since(seek_start));
+    if (clear_input_exception(env, "SeekableInput.seekTo")) {
+        input_position = -1;
+        return false;
+    }
+    input_position = offset;
+    return true;
+}
+
 void mpv_handle_t::create(JNIEnv *env, jobject app_context) {
     // Unrecoverable construction failures throw a C++ exception carrying the concrete
     // reason; nMake translates it into a JVM exception. Do not log here — the exception is
@@ -326,14 +817,18 @@ void mpv_handle_t::create(JNIEnv *env, jobject app_context) {
         throw std::runtime_error("cannot create mpv handle: JNI env is null");
     }
 
-    LOCK(global_guard);
-
-    if (!global_jvm) {
-        if (env->GetJavaVM(&global_jvm) != JNI_OK || !global_jvm) {
-            throw std::runtime_error("cannot create mpv handle: failed to obtain the JavaVM");
+    {
+        std::lock_guard<std::mutex> guard(global_guard);
+        // Normally already captured by JNI_OnLoad.
+        if (!global_jvm) {
+            if (env->GetJavaVM(&global_jvm) != JNI_OK || !global_jvm) {
+                throw std::runtime_error("cannot create mpv handle: failed to obtain the JavaVM");
+            }
+        }
+        if (!ffmpeg_jvm_set) {
+            av_jni_set_java_vm(global_jvm, &app_context);
+            ffmpeg_jvm_set = true;
         }
-
-        av_jni_set_java_vm(global_jvm, &app_context);
     }
 
     jvm_ = global_jvm;
@@ -354,21 +849,26 @@ void mpv_handle_t::create(JNIEnv *env, jobject app_context) {
     // non-C locale (observed on macOS CI), which previously made mpv_create() fail silently
     // and mpv never work at all. Force it here, under global_guard, before mpv_create(). This
     // affects only C number parsing/formatting, not java.util.Locale.
-    setlocale(LC_NUMERIC, "C");
-    handle_ = mpv_create();
+    {
+        std::lock_guard<std::mutex> guard(global_guard);
+        setlocale(LC_NUMERIC, "C");
+        handle_ = mpv_create();
+    }
     if (!handle_) {
         throw std::runtime_error("cannot create mpv handle: mpv_create() returned null "
                                  "(out of memory, or LC_NUMERIC is not \"C\")");
     }
 
-    // use terminal log level but request verbose messages
-    // this way --msg-level can be used to adjust later
-    mpv_request_log_messages(handle_, "terminal-default");
-    mpv_set_option_string(handle_, "msg-level", "all=v");
+    // mpv formats and queues only the messages this instance's threshold lets through;
+    // verbose output is opt-in via set_log_level.
+    const int log_level = log_threshold(nullptr);
+    log_set_threshold(this, log_level);
+    mpv_request_log_messages(handle_, log_level_name(log_level));
 }
 
 mpv_handle_t::~mpv_handle_t() {
     destroy(nullptr);
+    log_clear_threshold(this);
 }
 
 bool mpv_handle_t::initialize() {
@@ -422,12 +922,18 @@ bool mpv_handle_t::set_event_listener(JNIEnv *env, jobject listener) {
         return false;
     }
 
-    clear_event_listener(env);
+    const bool batched =
+            env->IsInstanceOf(listener, mediampv::jni_mediamp_clazz_EventBatchDispatcher) == JNI_TRUE;
+    LOCK(event_listener_lock);
+    delete_global_ref(env, event_listener_);
+    event_listener_generation_.fetch_add(1, std::memory_order_release);
     event_listener_ = env->NewGlobalRef(listener);
     if (!event_listener_ || clear_jni_exception(env, this, "NewGlobalRef(EventListener)")) {
         event_listener_ = nullptr;
+        event_listener_batched_ = false;
         return false;
     }
+    event_listener_batched_ = batched;
 
     return true;
 }
@@ -445,7 +951,7 @@ bool mpv_handle_t::set_render_update_listener(JNIEnv *env, jobject listener) {
     }
 
     LOCK(render_update_listener_lock);
-    clear_render_update_listener(env);
+    delete_global_ref(env, render_update_listener_);
     if (!listener) {
         return true;
     }
@@ -460,7 +966,7 @@ bool mpv_handle_t::set_render_update_listener(JNIEnv *env, jobject listener) {
 }
 
 bool mpv_handle_t::command(const char **args) {
-    LOCK(handle_lock);
+    SHARED_HANDLE_LOCK(false);
     CHECK_HANDLE()
     if (!args) {
         return false;
@@ -473,8 +979,131 @@ bool mpv_handle_t::command(const char **args) {
     return rc >= 0;
 }
 
+bool mpv_handle_t::command_async(JNIEnv *env, const char **args, jobject listener) {
+    SHARED_HANDLE_LOCK(false);
+    CHECK_HANDLE()
+    if (!args || !args[0]) {
+        return false;
+    }
+
+    // The node form of the command, built over the caller's strings without copying them.
+    constexpr size_t kMaxArgs = 128;
+    mpv_node arg_nodes[kMaxArgs];
+    size_t count = 0;
+    for (; args[count]; ++count) {
+        if (count == kMaxArgs) {
+            LOG(this, LOG_LEVEL_ERROR, "command_async: too many arguments (>= %zu)", kMaxArgs);
+            return false;
+        }
+        arg_nodes[count].format = MPV_FORMAT_STRING;
+        arg_nodes[count].u.string = const_cast<char *>(args[count]);
+    }
+    mpv_node_list list{};
+    list.num = static_cast<int>(count);
+    list.values = arg_nodes;
+    mpv_node command{};
+    command.format = MPV_FORMAT_NODE_ARRAY;
+    command.u.list = &list;
+
+    // Registered first: the reply may arrive on the event loop before mpv_command_node_async returns.
+    const uint64_t request_id = add_pending_reply(env, listener);
+    if (!request_id) {
+        return false;
+    }
+    const int rc = mpv_command_node_async(handle_, request_id, &command);
+    if (rc < 0) {
+        LOG(this, LOG_LEVEL_WARN, "mpv_command_node_async(%s) failed: %s", args[0], mpv_error_string(rc));
+        jobject unused = take_pending_reply(request_id);
+        delete_global_ref(env, unused);
+        return false;
+    }
+    return true;
+}
+
+bool mpv_handle_t::set_property_async(
+        JNIEnv *env,
+        const char *name,
+        mpv_format format,
+        void *in_value,
+        jobject listener) {
+    SHARED_HANDLE_LOCK(false);
+    CHECK_HANDLE()
+    if (!name || !in_value) {
+        return false;
+    }
+    const uint64_t request_id = add_pending_reply(env, listener);
+    if (!request_id) {
+        return false;
+    }
+    const int rc = mpv_set_property_async(handle_, request_id, name, format, in_value);
+    if (rc < 0) {
+        LOG(this, LOG_LEVEL_WARN, "mpv_set_property_async(%s) failed: %s", name, mpv_error_string(rc));
+        jobject unused = take_pending_reply(request_id);
+        delete_global_ref(env, unused);
+        return false;
+    }
+    return true;
+}
+
+uint64_t mpv_handle_t::add_pending_reply(JNIEnv *env, jobject listener) {
+    if (!env || !listener) {
+        return 0;
+    }
+    jobject reference = env->NewGlobalRef(listener);
+    if (!reference || clear_jni_exception(env, this, "NewGlobalRef(AsyncReplyListener)")) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> guard(pending_replies_lock);
+    const uint64_t request_id = next_request_id_++;
+    pending_replies_.emplace(request_id, reference);
+    return request_id;
+}
+
+jobject mpv_handle_t::take_pending_reply(uint64_t request_id) {
+    std::lock_guard<std::mutex> guard(pending_replies_lock);
+    auto it = pending_replies_.find(request_id);
+    if (it == pending_replies_.end()) {
+        return nullptr;
+    }
+    jobject listener = it->second;
+    pending_replies_.erase(it);
+    return listener;
+}
+
+void mpv_handle_t::complete_reply(JNIEnv *env, uint64_t request_id, int error) {
+    jobject listener = take_pending_reply(request_id);
+    if (!listener) {
+        return;
+    }
+    if (error < 0) {
+        LOG(this, LOG_LEVEL_WARN, "async request %llu failed: %s",
+            static_cast<unsigned long long>(request_id), mpv_error_string(error));
+    }
+    if (env && jni_mediamp_method_AsyncReplyListener_onReply) {
+        env->CallVoidMethod(listener, jni_mediamp_method_AsyncReplyListener_onReply, static_cast<jint>(error));
+        clear_jni_exception(env, this, "AsyncReplyListener.onReply");
+    }
+    delete_global_ref(env, listener);
+}
+
+void mpv_handle_t::fail_pending_replies(JNIEnv *env) {
+    std::unordered_map<uint64_t, jobject> pending;
+    {
+        std::lock_guard<std::mutex> guard(pending_replies_lock);
+        pending.swap(pending_replies_);
+    }
+    for (auto &entry : pending) {
+        if (env && jni_mediamp_method_AsyncReplyListener_onReply) {
+            env->CallVoidMethod(entry.second, jni_mediamp_method_AsyncReplyListener_onReply,
+                                static_cast<jint>(MPV_ERROR_UNINITIALIZED));
+            clear_jni_exception(env, this, "AsyncReplyListener.onReply");
+        }
+        delete_global_ref(env, entry.second);
+    }
+}
+
 bool mpv_handle_t::set_option(const char *key, const char *value) {
-    LOCK(handle_lock);
+    SHARED_HANDLE_LOCK(false);
     CHECK_HANDLE()
     if (!key || !value) {
         return false;
@@ -487,14 +1116,66 @@ bool mpv_handle_t::set_option(const char *key, const char *value) {
     return rc >= 0;
 }
 
+bool mpv_handle_t::set_log_level(int level) {
+    log_set_threshold(this, level);
+    SHARED_HANDLE_LOCK(false);
+    CHECK_HANDLE()
+    const int rc = mpv_request_log_messages(handle_, log_level_name(level));
+    if (rc < 0) {
+        LOG(this, LOG_LEVEL_WARN,
+            "mpv_request_log_messages(%s) failed: %s", log_level_name(level), mpv_error_string(rc));
+    }
+    return rc >= 0;
+}
+
 bool mpv_handle_t::get_property(const char *name, mpv_format format, void *out_result) {
-    LOCK(handle_lock);
+    SHARED_HANDLE_LOCK(false);
     CHECK_HANDLE()
     return mpv_get_property(handle_, name, format, out_result) >= 0;
 }
 
+uint64_t mpv_handle_t::get_properties(
+        const char *const *names,
+        const mpv_format *formats,
+        int64_t *out,
+        size_t count) {
+    SHARED_HANDLE_LOCK(0);
+    CHECK_HANDLE_RETURN_INT()
+    uint64_t valid = 0;
+    for (size_t i = 0; i < count && i < 64; ++i) {
+        out[i] = 0;
+        if (!names[i]) {
+            continue;
+        }
+        bool read = false;
+        switch (formats[i]) {
+            case MPV_FORMAT_FLAG: {
+                int flag = 0;
+                read = mpv_get_property(handle_, names[i], MPV_FORMAT_FLAG, &flag) >= 0;
+                out[i] = flag ? 1 : 0;
+                break;
+            }
+            case MPV_FORMAT_INT64:
+                read = mpv_get_property(handle_, names[i], MPV_FORMAT_INT64, &out[i]) >= 0;
+                break;
+            case MPV_FORMAT_DOUBLE: {
+                double value = 0;
+                read = mpv_get_property(handle_, names[i], MPV_FORMAT_DOUBLE, &value) >= 0;
+                std::memcpy(&out[i], &value, sizeof(value));
+                break;
+            }
+            default:
+                break;
+        }
+        if (read) {
+            valid |= uint64_t{1} << i;
+        }
+    }
+    return valid;
+}
+
 bool mpv_handle_t::set_property(const char *name, mpv_format format, void *in_value) {
-    LOCK(handle_lock);
+    SHARED_HANDLE_LOCK(false);
     CHECK_HANDLE()
     const int rc = mpv_set_property(handle_, name, format, in_value);
     if (rc < 0) {
@@ -504,21 +1185,81 @@ bool mpv_handle_t::set_property(const char *name, mpv_format format, void *in_va
     return rc >= 0;
 }
 
-bool mpv_handle_t::observe_property(const char *property, mpv_format format, uint64_t reply_data) {
-    LOCK(handle_lock);
+bool mpv_handle_t::observe_property(
+        const char *property,
+        mpv_format format,
+        uint64_t reply_data,
+        int64_t min_interval_nanos,
+        double epsilon) {
+    SHARED_HANDLE_LOCK(false);
     CHECK_HANDLE()
+    // Configured first so that not even the initial change mpv reports right away escapes it.
+    property_throttle_.configure(reply_data, min_interval_nanos, epsilon);
     const int rc = mpv_observe_property(handle_, reply_data, property, format);
     if (rc < 0) {
         LOG(this, LOG_LEVEL_WARN,
             "mpv_observe_property(%s) failed: %s", property ? property : "?", mpv_error_string(rc));
+        property_throttle_.remove(reply_data);
     }
     return rc >= 0;
 }
 
+jobject mpv_handle_t::open_event_ring(JNIEnv *env, jobject ring, jobject buffer) {
+    EXCLUSIVE_LOCK(handle_lock);
+    if (event_ring_object_) {
+        return env->NewLocalRef(event_ring_object_);
+    }
+    if (!ring || !buffer) {
+        return nullptr;
+    }
+
+    char *memory = static_cast<char *>(env->GetDirectBufferAddress(buffer));
+    const jlong size = env->GetDirectBufferCapacity(buffer);
+    const int64_t capacity = size > static_cast<jlong>(mediampv::event_ring::kControlSize)
+                             ? (size - static_cast<jlong>(mediampv::event_ring::kControlSize))
+                               / static_cast<jlong>(mediampv::event_ring::kSlotSize)
+                             : 0;
+    if (!memory || reinterpret_cast<uintptr_t>(memory) % alignof(std::atomic<uint64_t>) != 0
+        || capacity > mediampv::event_ring::kMaxCapacity
+        || !mediampv::event_ring::valid_capacity(static_cast<uint32_t>(capacity))) {
+        LOG(this, LOG_LEVEL_ERROR, "cannot lay an event ring out over a buffer of %lld bytes",
+            static_cast<long long>(size));
+        return nullptr;
+    }
+    event_ring_object_ = env->NewGlobalRef(ring);
+    event_ring_buffer_ = env->NewGlobalRef(buffer);
+    if (!event_ring_object_ || !event_ring_buffer_
+        || clear_jni_exception(env, this, "NewGlobalRef(MpvEventRing)")) {
+        delete_global_ref(env, event_ring_object_);
+        delete_global_ref(env, event_ring_buffer_);
+        return nullptr;
+    }
+    try {
+        event_ring_owner_ = std::make_unique<mediampv::event_ring>(memory, static_cast<uint32_t>(capacity));
+    } catch (const std::bad_alloc &) {
+        delete_global_ref(env, event_ring_object_);
+        delete_global_ref(env, event_ring_buffer_);
+        return nullptr;
+    }
+    event_ring_.store(event_ring_owner_.get(), std::memory_order_release);
+    return env->NewLocalRef(event_ring_object_);
+}
+
+void mpv_handle_t::close_event_ring(JNIEnv *env) {
+    // Only once the event loop has stopped: it is the ring's producer.
+    EXCLUSIVE_LOCK(handle_lock);
+    event_ring_.store(nullptr, std::memory_order_release);
+    event_ring_owner_.reset();
+    attached_jni_env attached_env(env ? nullptr : jvm_);
+    delete_global_ref(env ? env : attached_env.env, event_ring_object_);
+    delete_global_ref(env ? env : attached_env.env, event_ring_buffer_);
+}
+
 bool mpv_handle_t::unobserve_property(uint64_t reply_data) {
-    LOCK(handle_lock);
+    SHARED_HANDLE_LOCK(false);
     CHECK_HANDLE()
     const int rc = mpv_unobserve_property(handle_, reply_data);
+    property_throttle_.remove(reply_data);
     if (rc < 0) {
         LOG(this, LOG_LEVEL_WARN, "mpv_unobserve_property(reply_data=%llu) failed: %s",
             (unsigned long long) reply_data, mpv_error_string(rc));
@@ -542,7 +1283,16 @@ bool mpv_handle_t::ensure_stream_protocol_registered() {
     return true;
 }
 
-bool mpv_handle_t::register_seekable_input(JNIEnv *env, jobject seekable_input, const char *uri, int64_t size) {
+bool mpv_handle_t::register_seekable_input(
+        JNIEnv *env,
+        jobject seekable_input,
+        const char *uri,
+        int64_t size,
+        int64_t read_ahead_size,
+        int32_t min_read_size,
+        const char *cache_key,
+        const char *content_id,
+        const char *file_path) {
     // Registering the input source is a precondition for playback: every failure here is
     // unrecoverable, so raise a specific JVM exception (precondition -> IllegalArgument,
     // invalid state -> IllegalState) rather than collapsing them all into a bare false and
@@ -571,6 +1321,12 @@ bool mpv_handle_t::register_seekable_input(JNIEnv *env, jobject seekable_input,
         return false;
     }
 
+    // Where the input starts, so that the first read does not seekTo where it already is.
+    jlong input_position = env->CallLongMethod(seekable_input, jni_mediamp_method_SeekableInput_getPosition);
+    if (clear_jni_exception(env, this, "SeekableInput.getPosition")) {
+        input_position = -1;
+    }
+
     LOCK(stream_registry_lock);
     if (!ensure_stream_protocol_registered()) {
         throw_illegal_state(
@@ -597,9 +1353,17 @@ bool mpv_handle_t::register_seekable_input(JNIEnv *env, jobject seekable_input,
         return false;
     }
 
+    const bool direct_read = jni_mediamp_clazz_ByteBufferSeekableInput &&
+                             env->IsInstanceOf(seekable_input, jni_mediamp_clazz_ByteBufferSeekableInput) == JNI_TRUE;
+    // Falls back to reading through the SeekableInput when the file cannot be opened here.
+    std::unique_ptr<native_file> file = file_path ? native_file::open(file_path, this) : nullptr;
     seekable_streams_.emplace(
             stream_uri,
-            std::make_shared<seekable_stream_entry>(this, jvm_, global_input, stream_uri, size));
+            std::make_shared<seekable_stream_entry>(
+                    this, jvm_, global_input, stream_uri, size, input_position, direct_read, read_ahead_size,
+                    min_read_size,
+                    cache_key ? std::string(cache_key) : std::string(),
+                    content_id ? std::string(content_id) : std::string(), std::move(file)));
     return true;
 }
 
@@ -621,13 +1385,39 @@ bool mpv_handle_t::unregister_seekable_input(const char *uri) {
     }
 
     entry->request_cancel();
-    if (!entry->opened.load(std::memory_order_acquire)) {
+    if (entry->open_count.load(std::memory_order_acquire) == 0) {
         entry->close_and_release();
     }
 
     return true;
 }
 
+bool mpv_handle_t::get_seekable_input_stats(const char *uri, std::vector<int64_t> &out_stats) {
+    if (!uri) {
+        return false;
+    }
+
+    std::shared_ptr<seekable_stream_entry> entry;
+    {
+        LOCK(stream_registry_lock);
+        auto iterator = seekable_streams_.find(uri);
+        if (iterator == seekable_streams_.end()) {
+            return false;
+        }
+        entry = iterator->second;
+    }
+
+    // Layout shared with SeekableInputStats on the Kotlin side.
+    const read_ahead_stats cache_stats = entry->cache ? entry->cache->stats() : read_ahead_stats{};
+    out_stats.assign({
+            static_cast<int64_t>(cache_stats.hits),
+            static_cast<int64_t>(cache_stats.misses),
+    });
+    entry->stats.append_to(out_stats);
+    out_stats.push_back(static_cast<int64_t>(cache_stats.blocks_loaded));
+    return true;
+}
+
 int mpv_handle_t::open_seekable_stream(const char *uri, mpv_stream_cb_info *info) {
     if (!uri || !info) {
         return MPV_ERROR_LOADING_FAILED;
@@ -647,18 +1437,23 @@ int mpv_handle_t::open_seekable_stream(const char *uri, mpv_stream_cb_info *info
     if (entry->released.load(std::memory_order_acquire)) {
         return MPV_ERROR_LOADING_FAILED;
     }
-    if (entry->opened.exchange(true, std::memory_order_acq_rel)) {
-        LOG(this, LOG_LEVEL_WARN, "seekable stream %s has already been opened", uri);
-        return MPV_ERROR_LOADING_FAILED;
-    }
 
+    // mpv may open the same stream more than once (e.g. when it re-probes); every open gets
+    // its own cookie and position over the same input.
     auto *cookie = new (std::nothrow) seekable_stream_cookie(entry);
     if (!cookie) {
-        entry->opened.store(false, std::memory_order_release);
         return MPV_ERROR_NOMEM;
     }
+    entry->open_count.fetch_add(1, std::memory_order_acq_rel);
+
+    if (entry->cache) {
+        if (entry->cache->start()) {
+            cookie->cache_reader = entry->cache->open_reader();
+        } else {
+            LOG(this, LOG_LEVEL_WARN, "read-ahead disabled for seekable stream %s", uri);
+        }
+    }
 
-    entry->cancel_requested.store(false, std::memory_order_relaxed);
     info->cookie = cookie;
     info->read_fn = &seekable_stream_read;
     info->seek_fn = &seekable_stream_seek;
@@ -770,6 +1565,7 @@ bool mpv_handle_t::destroy(JNIEnv *env) {
 #endif
     clear_event_listener(cleanup_env);
     clear_render_update_listener(cleanup_env);
+    close_event_ring(cleanup_env);
 #ifdef __ANDROID__
     clear_android_surface(cleanup_env);
 #endif
@@ -777,21 +1573,28 @@ bool mpv_handle_t::destroy(JNIEnv *env) {
 
     // Mutually exclusive with the hot methods' mpv_* calls (they hold handle_lock),
     // so a call either completes before the handle is torn down or sees handle_==null.
+    destroying_.store(true, std::memory_order_release);
     {
-        LOCK(handle_lock);
+        EXCLUSIVE_LOCK(handle_lock);
         if (handle_) {
             mpv_terminate_destroy(handle_);
             handle_ = nullptr;
         }
     }
+    // After the handle is gone: no request can be queued anymore, and the event loop that
+    // would have delivered the replies has stopped.
+    fail_pending_replies(cleanup_env);
     stream_protocol_registered_ = false;
 
     return true;
 }
 
 void mpv_handle_t::clear_event_listener(JNIEnv *env) {
+    LOCK(event_listener_lock);
     attached_jni_env attached_env(env ? nullptr : jvm_);
     delete_global_ref(env ? env : attached_env.env, event_listener_);
+    event_listener_batched_ = false;
+    event_listener_generation_.fetch_add(1, std::memory_order_release);
 }
 
 void mpv_handle_t::clear_render_update_listener(JNIEnv *env) {
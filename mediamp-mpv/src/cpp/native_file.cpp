@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <string>
+#include "native_file.h"
+#include "log.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__ANDROID__) && !defined(__LP64__)
+// 32-bit bionic has a 32-bit off_t; use the explicit 64-bit variants so files over 2 GiB work.
+#define MEDIAMP_PREAD pread64
+#define MEDIAMP_FADVISE posix_fadvise64
+#define MEDIAMP_OFF_T off64_t
+#else
+#define MEDIAMP_PREAD pread
+#define MEDIAMP_FADVISE posix_fadvise
+#define MEDIAMP_OFF_T off_t
+#endif
+#endif
+
+namespace mediampv {
+
+#if defined(_WIN32) || defined(_WIN64)
+
+std::unique_ptr<native_file> native_file::open(const char *path, const void *instance_handle) {
+    if (!path || path[0] == '\0') {
+        return nullptr;
+    }
+
+    const int wide_length = MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, path, -1, nullptr, 0);
+    if (wide_length <= 0) {
+        LOG(instance_handle, LOG_LEVEL_WARN, "native file: path is not valid UTF-8: %s", path);
+        return nullptr;
+    }
+    std::wstring wide_path(static_cast<size_t>(wide_length), L'\0');
+    MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, path, -1, &wide_path[0], wide_length);
+
+    HANDLE handle = CreateFileW(
+            wide_path.c_str(),
+            GENERIC_READ,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            nullptr,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+            nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        LOG(instance_handle, LOG_LEVEL_WARN,
+            "native file: cannot open %s (error %lu)", path, static_cast<unsigned long>(GetLastError()));
+        return nullptr;
+    }
+
+    std::unique_ptr<native_file> file(new (std::nothrow) native_file(handle, instance_handle));
+    if (!file) {
+        CloseHandle(handle);
+    }
+    return file;
+}
+
+native_file::~native_file() {
+    if (handle_ != INVALID_HANDLE_VALUE) {
+        CloseHandle(handle_);
+    }
+}
+
+int64_t native_file::read_at(int64_t offset, char *buffer, int64_t length) {
+    if (offset < 0 || length < 0) {
+        return -1;
+    }
+
+    OVERLAPPED overlapped{};
+    overlapped.Offset = static_cast<DWORD>(static_cast<uint64_t>(offset) & 0xFFFFFFFFu);
+    overlapped.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(offset) >> 32);
+    DWORD bytes_read = 0;
+    const auto to_read = static_cast<DWORD>(std::min<int64_t>(length, std::numeric_limits<DWORD>::max()));
+    if (!ReadFile(handle_, buffer, to_read, &bytes_read, &overlapped)) {
+        const DWORD error = GetLastError();
+        if (error == ERROR_HANDLE_EOF) {
+            return 0;
+        }
+        LOG(instance_handle_, LOG_LEVEL_ERROR,
+            "native file: read at %lld failed (error %lu)",
+            static_cast<long long>(offset), static_cast<unsigned long>(error));
+        return -1;
+    }
+    return bytes_read;
+}
+
+#else
+
+std::unique_ptr<native_file> native_file::open(const char *path, const void *instance_handle) {
+    if (!path || path[0] == '\0') {
+        return nullptr;
+    }
+
+    int fd;
+    do {
+        fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    } while (fd < 0 && errno == EINTR);
+    if (fd < 0) {
+        LOG(instance_handle, LOG_LEVEL_WARN, "native file: cannot open %s: %s", path, std::strerror(errno));
+        return nullptr;
+    }
+
+#if defined(__APPLE__)
+    fcntl(fd, F_RDAHEAD, 1);
+#else
+    // Doubles the kernel's read-ahead window for this file.
+    MEDIAMP_FADVISE(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    std::unique_ptr<native_file> file(new (std::nothrow) native_file(fd, instance_handle));
+    if (!file) {
+        close(fd);
+    }
+    return file;
+}
+
+native_file::~native_file() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+void native_file::advise(int64_t offset) {
+    // Re-announce once the reader is halfway through the previous window, and whenever it
+    // seeks outside of it.
+    const int64_t advised_end = advised_end_.load(std::memory_order_relaxed);
+    const bool inside_window = offset >= advised_end - kAdviseWindow && offset < advised_end;
+    if (inside_window && offset + kAdviseWindow / 2 < advised_end) {
+        return;
+    }
+    advised_end_.store(offset + kAdviseWindow, std::memory_order_relaxed);
+
+#if defined(__APPLE__)
+    radvisory advisory{};
+    advisory.ra_offset = offset;
+    advisory.ra_count = static_cast<int>(kAdviseWindow);
+    fcntl(fd_, F_RDADVISE, &advisory);
+#else
+    MEDIAMP_FADVISE(fd_, static_cast<MEDIAMP_OFF_T>(offset), kAdviseWindow, POSIX_FADV_WILLNEED);
+#endif
+}
+
+int64_t native_file::read_at(int64_t offset, char *buffer, int64_t length) {
+    if (offset < 0 || length < 0) {
+        return -1;
+    }
+
+    advise(offset);
+
+    const auto to_read = static_cast<size_t>(std::min<int64_t>(length, std::numeric_limits<ssize_t>::max()));
+    ssize_t bytes_read;
+    do {
+        bytes_read = MEDIAMP_PREAD(fd_, buffer, to_read, static_cast<MEDIAMP_OFF_T>(offset));
+    } while (bytes_read < 0 && errno == EINTR);
+    if (bytes_read < 0) {
+        LOG(instance_handle_, LOG_LEVEL_ERROR,
+            "native file: read at %lld failed: %s", static_cast<long long>(offset), std::strerror(errno));
+        return -1;
+    }
+    return bytes_read;
+}
+
+#endif
+
+} // namespace mediampv
@@ -0,0 +1,77 @@
+#include <cstring>
+#include "node_codec.h"
+
+namespace mediampv {
+
+namespace {
+
+void put_u8(std::vector<char> &out, uint8_t value) {
+    out.push_back(static_cast<char>(value));
+}
+
+// Explicitly little-endian so that the Kotlin side decodes it the same on every platform.
+void put_le(std::vector<char> &out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+void put_bytes(std::vector<char> &out, const char *bytes, size_t length) {
+    put_le(out, static_cast<uint32_t>(length), 4);
+    out.insert(out.end(), bytes, bytes + length);
+}
+
+void put_string(std::vector<char> &out, const char *string) {
+    put_bytes(out, string ? string : "", string ? std::strlen(string) : 0);
+}
+
+} // namespace
+
+void flatten_node(const mpv_node &node, std::vector<char> &out) {
+    switch (node.format) {
+        case MPV_FORMAT_STRING:
+            put_u8(out, MPV_FORMAT_STRING);
+            put_string(out, node.u.string);
+            break;
+        case MPV_FORMAT_FLAG:
+            put_u8(out, MPV_FORMAT_FLAG);
+            put_u8(out, node.u.flag ? 1 : 0);
+            break;
+        case MPV_FORMAT_INT64:
+            put_u8(out, MPV_FORMAT_INT64);
+            put_le(out, static_cast<uint64_t>(node.u.int64), 8);
+            break;
+        case MPV_FORMAT_DOUBLE: {
+            uint64_t bits;
+            std::memcpy(&bits, &node.u.double_, sizeof(bits));
+            put_u8(out, MPV_FORMAT_DOUBLE);
+            put_le(out, bits, 8);
+            break;
+        }
+        case MPV_FORMAT_NODE_ARRAY:
+        case MPV_FORMAT_NODE_MAP: {
+            const mpv_node_list *list = node.u.list;
+            const int count = list ? list->num : 0;
+            put_u8(out, static_cast<uint8_t>(node.format));
+            put_le(out, static_cast<uint32_t>(count), 4);
+            for (int i = 0; i < count; ++i) {
+                if (node.format == MPV_FORMAT_NODE_MAP) {
+                    put_string(out, list->keys[i]);
+                }
+                flatten_node(list->values[i], out);
+            }
+            break;
+        }
+        case MPV_FORMAT_BYTE_ARRAY: {
+            const mpv_byte_array *array = node.u.ba;
+            put_u8(out, MPV_FORMAT_BYTE_ARRAY);
+            put_bytes(out, array ? static_cast<const char *>(array->data) : nullptr, array ? array->size : 0);
+            break;
+        }
+        default:
+            put_u8(out, MPV_FORMAT_NONE);
+            break;
+    }
+}
+
+} // namespace mediampv
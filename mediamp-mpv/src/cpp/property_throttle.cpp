@@ -0,0 +1,182 @@
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include "property_throttle.h"
+
+namespace mediampv {
+
+void property_throttle::configure(uint64_t reply_data, int64_t min_interval_nanos, double epsilon) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (min_interval_nanos <= 0 && !(epsilon > 0)) {
+        entries_.erase(reply_data);
+    } else {
+        entry &entry = entries_[reply_data];
+        entry.min_interval_nanos = min_interval_nanos > 0 ? min_interval_nanos : 0;
+        entry.epsilon = epsilon > 0 ? epsilon : 0;
+    }
+    empty_ = entries_.empty();
+}
+
+void property_throttle::remove(uint64_t reply_data) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    entries_.erase(reply_data);
+    empty_ = entries_.empty();
+}
+
+void property_throttle::mark_delivered(entry &entry, clock::time_point now, double value) {
+    entry.delivered = true;
+    entry.last_delivery = now;
+    entry.last_double = value;
+    entry.pending = false;
+}
+
+bool property_throttle::admit(const mpv_event &event, clock::time_point now) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (empty_) {
+        return true;
+    }
+    auto it = entries_.find(event.reply_userdata);
+    auto *prop = static_cast<const mpv_event_property *>(event.data);
+    if (it == entries_.end() || !prop || !prop->name) {
+        return true;
+    }
+    entry &entry = it->second;
+
+    double double_value = 0;
+    if (prop->format == MPV_FORMAT_DOUBLE && prop->data) {
+        double_value = *static_cast<const double *>(prop->data);
+        if (entry.delivered && entry.epsilon > 0 && std::fabs(double_value - entry.last_double) < entry.epsilon) {
+            // Back within epsilon of what the listener has: a pending change is moot too.
+            entry.pending = false;
+            return false;
+        }
+    }
+
+    if (!entry.delivered ||
+        now - entry.last_delivery >= std::chrono::nanoseconds(entry.min_interval_nanos)) {
+        mark_delivered(entry, now, double_value);
+        return true;
+    }
+
+    // Within the interval: keep the latest value, replacing any earlier pending one.
+    entry.pending = true;
+    if (entry.name != prop->name) {
+        entry.name = prop->name;
+    }
+    entry.format = prop->format;
+    entry.value = 0;
+    entry.string_value.clear();
+    // mpv reports an unavailable property with null data; keep that for the listener.
+    entry.has_data = prop->data != nullptr &&
+                     (prop->format != MPV_FORMAT_STRING || *static_cast<const char *const *>(prop->data));
+    if (entry.has_data) {
+        switch (prop->format) {
+            case MPV_FORMAT_FLAG:
+                entry.value = *static_cast<const int *>(prop->data);
+                break;
+            case MPV_FORMAT_INT64:
+                entry.value = *static_cast<const int64_t *>(prop->data);
+                break;
+            case MPV_FORMAT_DOUBLE:
+                std::memcpy(&entry.value, prop->data, sizeof(double));
+                break;
+            case MPV_FORMAT_STRING:
+                if (const char *string = *static_cast<const char *const *>(prop->data)) {
+                    entry.string_value = string;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return false;
+}
+
+void property_throttle::flush_due(clock::time_point now, const std::function<void(const mpv_event &)> &deliver) {
+    flush(now, true, deliver);
+}
+
+void property_throttle::flush_pending(clock::time_point now, const std::function<void(const mpv_event &)> &deliver) {
+    flush(now, false, deliver);
+}
+
+void property_throttle::drop_pending() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto &[reply_data, entry] : entries_) {
+        entry.pending = false;
+    }
+}
+
+void property_throttle::flush(
+        clock::time_point now, bool due_only, const std::function<void(const mpv_event &)> &deliver) {
+    // Copied out so that `deliver` runs without the lock: it calls into Kotlin, which may
+    // observe or unobserve properties.
+    std::vector<std::pair<uint64_t, entry>> due;
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (empty_) {
+            return;
+        }
+        for (auto &[reply_data, entry] : entries_) {
+            if (!entry.pending || (due_only &&
+                now - entry.last_delivery < std::chrono::nanoseconds(entry.min_interval_nanos))) {
+                continue;
+            }
+            due.emplace_back(reply_data, entry);
+            double double_value;
+            std::memcpy(&double_value, &entry.value, sizeof(double));
+            mark_delivered(entry, now, entry.format == MPV_FORMAT_DOUBLE ? double_value : 0);
+        }
+    }
+
+    for (auto &[reply_data, entry] : due) {
+        int flag = static_cast<int>(entry.value);
+        int64_t int64 = entry.value;
+        double double_value;
+        std::memcpy(&double_value, &entry.value, sizeof(double));
+        const char *string = entry.string_value.c_str();
+
+        mpv_event_property prop{};
+        prop.name = entry.name.c_str();
+        prop.format = entry.format;
+        switch (entry.has_data ? entry.format : MPV_FORMAT_NONE) {
+            case MPV_FORMAT_FLAG:
+                prop.data = &flag;
+                break;
+            case MPV_FORMAT_INT64:
+                prop.data = &int64;
+                break;
+            case MPV_FORMAT_DOUBLE:
+                prop.data = &double_value;
+                break;
+            case MPV_FORMAT_STRING:
+                prop.data = &string;
+                break;
+            default:
+                break;
+        }
+        mpv_event event{};
+        event.event_id = MPV_EVENT_PROPERTY_CHANGE;
+        event.reply_userdata = reply_data;
+        event.data = &prop;
+        deliver(event);
+    }
+}
+
+double property_throttle::wait_timeout(clock::time_point now) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    double timeout = -1;
+    for (const auto &[reply_data, entry] : entries_) {
+        if (!entry.pending) {
+            continue;
+        }
+        const auto due = entry.last_delivery + std::chrono::nanoseconds(entry.min_interval_nanos);
+        const double seconds = due > now ? std::chrono::duration<double>(due - now).count() : 0;
+        if (timeout < 0 || seconds < timeout) {
+            timeout = seconds;
+        }
+    }
+    return timeout;
+}
+
+} // namespace mediampv
@@ -0,0 +1,501 @@
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+#include "read_ahead_cache.h"
+#include "log.h"
+
+namespace mediampv {
+
+struct read_ahead_cache::reader final {
+    int64_t block = 0;    // block of the latest read, the start of this reader's window
+    int64_t waiting = -1; // block this reader is blocked on, -1 when not blocked
+    bool cancelled = false; // reads fail and the reader no longer wants any block
+};
+
+struct read_ahead_cache::block final {
+    std::unique_ptr<char[]> data;
+    int64_t filled = 0; // valid bytes from the start of the block
+    bool loading = false;
+    bool complete = false;
+    bool failed = false;
+    uint64_t last_used = 0;
+};
+
+// The process-wide block store. One mutex guards every block and every cache's reader
+// state, and one condition variable is broadcast on any change: there are only a handful
+// of readers and prefetch threads in a process, and a single lock keeps the cross-cache
+// rules (a block loading for one cache is waited for by another) simple.
+class read_ahead_cache::store final {
+public:
+    static store &instance() {
+        // Leaked on purpose: prefetch threads of caches that were never destroyed may
+        // still use it while static destructors run at exit.
+        static auto *instance = new store();
+        return *instance;
+    }
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    uint64_t clock = 0;
+
+    uint64_t acquire_stream(const std::string &key) {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (key.empty()) {
+            return next_stream_id_++;
+        }
+        auto &stream = streams_[key];
+        if (stream.references++ == 0) {
+            stream.id = next_stream_id_++;
+        }
+        return stream.id;
+    }
+
+    // Makes `cache`'s readers protect their windows from eviction. Separate from
+    // acquire_stream so that the cache is fully constructed before the store looks at it.
+    void add_cache(read_ahead_cache *cache) {
+        std::lock_guard<std::mutex> guard(mutex);
+        caches_.push_back(cache);
+    }
+
+    void release_stream(const std::string &key, uint64_t id, read_ahead_cache *cache) {
+        std::lock_guard<std::mutex> guard(mutex);
+        caches_.erase(std::remove(caches_.begin(), caches_.end(), cache), caches_.end());
+        if (!key.empty()) {
+            auto iterator = streams_.find(key);
+            if (iterator != streams_.end() && --iterator->second.references > 0) {
+                return;
+            }
+            if (iterator != streams_.end()) {
+                streams_.erase(iterator);
+            }
+        }
+        for (auto iterator = blocks_.begin(); iterator != blocks_.end();) {
+            if (iterator->first.stream == id) {
+                used_ -= kBlockSize;
+                iterator = blocks_.erase(iterator);
+            } else {
+                ++iterator;
+            }
+        }
+    }
+
+    void set_budget(int64_t bytes) {
+        std::lock_guard<std::mutex> guard(mutex);
+        budget_ = std::max<int64_t>(bytes, 0);
+    }
+
+    // The following require `mutex` to be held.
+
+    block *find(uint64_t stream, int64_t index) {
+        auto iterator = blocks_.find(key{stream, index});
+        return iterator == blocks_.end() ? nullptr : &iterator->second;
+    }
+
+    void drop(uint64_t stream, int64_t index) {
+        if (blocks_.erase(key{stream, index}) > 0) {
+            used_ -= kBlockSize;
+        }
+    }
+
+    // Inserts an empty block, evicting least recently used blocks that no reader of any
+    // cache still wants to stay within the budget. When that is not possible, returns null
+    // unless `required` (a reader is blocked on it), in which case the budget is exceeded
+    // rather than stalling playback.
+    block *claim(uint64_t stream, int64_t index, bool required, const void *instance_handle) {
+        while (used_ + kBlockSize > budget_) {
+            auto victim = blocks_.end();
+            for (auto iterator = blocks_.begin(); iterator != blocks_.end(); ++iterator) {
+                if (iterator->second.loading || is_protected(iterator->first)) {
+                    continue;
+                }
+                if (victim == blocks_.end() || iterator->second.last_used < victim->second.last_used) {
+                    victim = iterator;
+                }
+            }
+            if (victim == blocks_.end()) {
+                if (!required) {
+                    return nullptr;
+                }
+                break;
+            }
+            used_ -= kBlockSize;
+            blocks_.erase(victim);
+        }
+
+        std::unique_ptr<char[]> data(new (std::nothrow) char[kBlockSize]);
+        if (!data) {
+            LOG(instance_handle, LOG_LEVEL_WARN, "read-ahead cache: cannot allocate a block");
+            return nullptr;
+        }
+        block &slot = blocks_[key{stream, index}];
+        slot.data = std::move(data);
+        slot.last_used = ++clock;
+        used_ += kBlockSize;
+        return &slot;
+    }
+
+private:
+    struct key final {
+        uint64_t stream;
+        int64_t index;
+
+        bool operator==(const key &other) const {
+            return stream == other.stream && index == other.index;
+        }
+    };
+
+    struct key_hash final {
+        size_t operator()(const key &value) const {
+            return std::hash<uint64_t>()(value.stream * 0x9E3779B97F4A7C15ull ^ static_cast<uint64_t>(value.index));
+        }
+    };
+
+    struct stream final {
+        uint64_t id = 0;
+        int references = 0;
+    };
+
+    bool is_protected(const key &value) const {
+        for (const read_ahead_cache *cache : caches_) {
+            if (cache->stream_id_ == value.stream && cache->is_wanted(value.index, kBlocksBehind)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    int64_t budget_ = kDefaultMemoryBudget;
+    int64_t used_ = 0;
+    uint64_t next_stream_id_ = 1;
+    std::unordered_map<key, block, key_hash> blocks_;
+    std::unordered_map<std::string, stream> streams_;
+    std::vector<read_ahead_cache *> caches_;
+};
+
+namespace {
+
+int64_t blocks_for(int64_t bytes) {
+    return bytes <= 0 ? 0 : (bytes + read_ahead_cache::kBlockSize - 1) / read_ahead_cache::kBlockSize;
+}
+
+} // namespace
+
+void read_ahead_cache::set_memory_budget(int64_t bytes) {
+    store::instance().set_budget(bytes);
+}
+
+read_ahead_cache::read_ahead_cache(
+        block_source &source,
+        const std::string &stream_key,
+        int64_t size,
+        int64_t read_ahead_size,
+        int64_t fetch_size,
+        const void *instance_handle)
+        : source_(source),
+          instance_handle_(instance_handle),
+          store_(store::instance()),
+          stream_key_(stream_key),
+          stream_id_(store_.acquire_stream(stream_key)),
+          size_(size),
+          block_count_(blocks_for(size)),
+          // At least one block, otherwise a reader's own block could never be fetched.
+          ahead_blocks_(std::max<int64_t>(1, blocks_for(read_ahead_size))),
+          fetch_size_(std::min(std::max(fetch_size, kMinFetchSize), kMaxFetchSize)) {
+    store_.add_cache(this);
+}
+
+read_ahead_cache::~read_ahead_cache() {
+    stop();
+    store_.release_stream(stream_key_, stream_id_, this);
+}
+
+bool read_ahead_cache::start() {
+    std::lock_guard<std::mutex> guard(store_.mutex);
+    if (running_.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    if (stopping_ || block_count_ <= 0) {
+        return false;
+    }
+
+    try {
+        thread_ = std::thread([this] { prefetch_loop(); });
+    } catch (const std::system_error &error) {
+        LOG(instance_handle_, LOG_LEVEL_WARN, "read-ahead cache: cannot start prefetch thread: %s", error.what());
+        return false;
+    }
+
+    running_.store(true, std::memory_order_release);
+    return true;
+}
+
+void read_ahead_cache::request_stop() {
+    {
+        std::lock_guard<std::mutex> guard(store_.mutex);
+        stopping_ = true;
+    }
+    store_.changed.notify_all();
+}
+
+void read_ahead_cache::stop() {
+    request_stop();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    running_.store(false, std::memory_order_release);
+}
+
+read_ahead_cache::reader *read_ahead_cache::open_reader() {
+    std::lock_guard<std::mutex> guard(store_.mutex);
+    readers_.emplace_back();
+    return &readers_.back();
+}
+
+void read_ahead_cache::close_reader(reader *reader) {
+    {
+        std::lock_guard<std::mutex> guard(store_.mutex);
+        readers_.remove_if([reader](const read_ahead_cache::reader &candidate) { return &candidate == reader; });
+    }
+    store_.changed.notify_all();
+}
+
+void read_ahead_cache::cancel_reader(reader *reader) {
+    bool interrupt = false;
+    {
+        std::lock_guard<std::mutex> guard(store_.mutex);
+        reader->cancelled = true;
+        reader->waiting = -1;
+        if (fetching_ >= 0 && !interrupt_requested_ && !is_wanted(fetching_, 0)) {
+            interrupt_requested_ = true;
+            interrupt = true;
+        }
+    }
+    store_.changed.notify_all();
+    if (interrupt) {
+        source_.interrupt_fetch();
+    }
+}
+
+int64_t read_ahead_cache::read(reader *reader, int64_t offset, char *buffer, int64_t length) {
+    if (!reader || offset < 0 || length < 0) {
+        return -1;
+    }
+    if (offset >= size_ || length == 0) {
+        return 0;
+    }
+
+    const int64_t index = offset / kBlockSize;
+    const int64_t offset_in_block = offset - index * kBlockSize;
+
+    std::unique_lock<std::mutex> lock(store_.mutex);
+    if (reader->block != index) {
+        reader->block = index;
+        store_.changed.notify_all();
+    }
+
+    bool waited = false;
+    for (;;) {
+        if (stopping_ || reader->cancelled) {
+            reader->waiting = -1;
+            return -1;
+        }
+
+        block *slot = store_.find(stream_id_, index);
+        if (slot) {
+            if (slot->filled > offset_in_block) {
+                // Fetches only write past `filled`, and loading blocks are never evicted,
+                // so this range is stable even while the block is still loading.
+                const int64_t count = std::min(length, slot->filled - offset_in_block);
+                std::memcpy(buffer, slot->data.get() + offset_in_block, static_cast<size_t>(count));
+                slot->last_used = ++store_.clock;
+                reader->waiting = -1;
+                (waited ? misses_ : hits_).fetch_add(1, std::memory_order_relaxed);
+                return count;
+            }
+            if (slot->failed) {
+                // Report the failure once and forget the block, so a later read retries it.
+                store_.drop(stream_id_, index);
+                reader->waiting = -1;
+                return -1;
+            }
+            if (slot->complete) {
+                // The source ended before the size it reported.
+                reader->waiting = -1;
+                return 0;
+            }
+        }
+
+        waited = true;
+        reader->waiting = index;
+        store_.changed.notify_all();
+        if (fetching_ >= 0 && fetching_ != index && !interrupt_requested_ && !is_waited_for(fetching_)) {
+            // The prefetch thread is blocked on a block nobody is waiting for; it would
+            // only get to this one after its fetch returns.
+            interrupt_requested_ = true;
+            lock.unlock();
+            source_.interrupt_fetch();
+            lock.lock();
+            continue;
+        }
+        store_.changed.wait(lock);
+    }
+}
+
+read_ahead_stats read_ahead_cache::stats() const {
+    read_ahead_stats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.blocks_loaded = blocks_loaded_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void read_ahead_cache::prefetch_loop() {
+    source_.attach_prefetch_thread();
+
+    std::unique_lock<std::mutex> lock(store_.mutex);
+    while (!stopping_) {
+        const int64_t index = next_block_to_fetch();
+        block *slot = nullptr;
+        if (index >= 0) {
+            slot = store_.find(stream_id_, index);
+            if (!slot) {
+                slot = store_.claim(stream_id_, index, is_waited_for(index), instance_handle_);
+            }
+        }
+        if (!slot) {
+            store_.changed.wait(lock);
+            continue;
+        }
+
+        slot->loading = true;
+        const int64_t length = block_length(index);
+        bool fetched_any = false;
+        if (slot->filled == 0) {
+            lock.unlock();
+            const bool loaded = source_.load_block(index, slot->data.get(), length);
+            lock.lock();
+            if (loaded) {
+                slot->filled = length;
+                blocks_loaded_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        while (!stopping_ && slot->filled < length) {
+            const int64_t fetch_offset = index * kBlockSize + slot->filled;
+            const int64_t fetch_length = std::min(fetch_size_, length - slot->filled);
+            char *destination = slot->data.get() + slot->filled;
+
+            fetching_ = index;
+            lock.unlock();
+            const int64_t fetched = source_.fetch(fetch_offset, destination, fetch_length);
+            lock.lock();
+            fetching_ = -1;
+            const bool interrupted = interrupt_requested_;
+            interrupt_requested_ = false;
+
+            if (fetched < 0) {
+                // Stopping interrupts the fetch too, and must not fail a block that other
+                // caches of the same stream key are waiting for. Abandoned, not failed: the
+                // bytes so far stay and the rest is fetched when the block is wanted again.
+                if (fetched != block_source::kInterrupted && !interrupted && !stopping_) {
+                    slot->failed = true;
+                }
+                break;
+            }
+            if (fetched == 0) {
+                slot->complete = true;
+                break;
+            }
+            slot->filled += std::min(fetched, fetch_length);
+            fetched_any = true;
+            store_.changed.notify_all();
+            if (should_abandon(index)) {
+                break;
+            }
+        }
+        if (slot->filled >= length) {
+            slot->complete = true;
+            if (fetched_any) {
+                // Still marked loading, so the block cannot be evicted while it is written
+                // out; readers only look at `filled` and are released right away.
+                store_.changed.notify_all();
+                lock.unlock();
+                source_.store_block(index, slot->data.get(), length);
+                lock.lock();
+            }
+        }
+        slot->loading = false;
+        store_.changed.notify_all();
+    }
+
+    lock.unlock();
+    source_.detach_prefetch_thread();
+}
+
+int64_t read_ahead_cache::block_length(int64_t index) const {
+    return std::min(kBlockSize, size_ - index * kBlockSize);
+}
+
+bool read_ahead_cache::needs_fetch(int64_t index) {
+    // A block loading for another cache with the same key counts as on its way.
+    const block *slot = store_.find(stream_id_, index);
+    return !slot || (!slot->loading && !slot->complete && !slot->failed);
+}
+
+bool read_ahead_cache::is_waited_for(int64_t index) const {
+    for (const auto &reader : readers_) {
+        if (reader.waiting == index) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool read_ahead_cache::is_wanted(int64_t index, int64_t behind) const {
+    for (const auto &reader : readers_) {
+        if (reader.cancelled) {
+            continue;
+        }
+        if (reader.waiting == index || (index >= reader.block - behind && index < reader.block + ahead_blocks_)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int64_t read_ahead_cache::next_block_to_fetch() {
+    for (const auto &reader : readers_) {
+        if (reader.waiting >= 0 && needs_fetch(reader.waiting)) {
+            return reader.waiting;
+        }
+    }
+    // Nearest first across readers, so one reader far ahead does not starve the others.
+    for (int64_t distance = 0; distance < ahead_blocks_; ++distance) {
+        for (const auto &reader : readers_) {
+            if (reader.cancelled) {
+                continue;
+            }
+            const int64_t index = reader.block + distance;
+            if (index < block_count_ && needs_fetch(index)) {
+                return index;
+            }
+        }
+    }
+    return -1;
+}
+
+bool read_ahead_cache::should_abandon(int64_t index) {
+    // A reader is blocked on another block nobody is fetching, or no reader wants this
+    // block any more. The bytes fetched so far stay cached and the block is resumed if it
+    // is wanted again.
+    for (const auto &reader : readers_) {
+        if (reader.waiting >= 0 && reader.waiting != index && needs_fetch(reader.waiting)) {
+            return true;
+        }
+    }
+    return !is_wanted(index, 0);
+}
+
+} // namespace mediampv
@@ -195,6 +195,19 @@ int64_t mpv_handle_t::get_buffer_texture(int index) {
     return static_cast<int64_t>(buffers_[index].texture);
 }
 
+bool mpv_handle_t::wait_buffer_fence(int index) {
+    if (!glXGetCurrentContext()) return false;
+    // Held across glWaitSync so the render thread cannot delete the fence under it.
+    // glWaitSync only queues a server-side wait into the current context; it does not
+    // block this thread.
+    std::lock_guard<std::mutex> lock(render_mutex_);
+    if (!buffers_allocated_ || index < 0 || index >= kOpenGLBufferCount) return false;
+    auto fence = static_cast<GLsync>(buffers_[index].fence);
+    if (!fence) return false;
+    glWaitSync(fence, 0, GL_TIMEOUT_IGNORED);
+    return true;
+}
+
 bool mpv_handle_t::ack_retired_buffers() {
     {
         std::lock_guard<std::mutex> lock(render_mutex_);
@@ -353,8 +366,12 @@ void mpv_handle_t::render_thread_loop() {
         const int next = (latest_index_ + 1) % kOpenGLBufferCount;
         const opengl_buffer target = buffers_[next];
         lock.unlock();
-        const bool rendered = render_into(target);
+        void *fence = nullptr;
+        const bool rendered = render_into(target, fence);
         lock.lock();
+        // The previous fence of this slot belongs to a frame that is no longer published.
+        if (buffers_[next].fence) glDeleteSync(static_cast<GLsync>(buffers_[next].fence));
+        buffers_[next].fence = fence;
         if (rendered) {
             latest_index_ = next;
             ++frame_serial_;
@@ -451,6 +468,7 @@ void mpv_handle_t::destroy_buffer_ring(opengl_buffer *ring) {
     for (int i = 0; i < kOpenGLBufferCount; ++i) {
         if (ring[i].fbo) glDeleteFramebuffers(1, &ring[i].fbo);
         if (ring[i].texture) glDeleteTextures(1, &ring[i].texture);
+        if (ring[i].fence) glDeleteSync(static_cast<GLsync>(ring[i].fence));
         ring[i] = opengl_buffer{};
     }
 }
@@ -465,7 +483,8 @@ void mpv_handle_t::publish_state_locked() {
         (frame_serial_ & 0xFFFFu), std::memory_order_release);
 }
 
-bool mpv_handle_t::render_into(const opengl_buffer &buffer) {
+bool mpv_handle_t::render_into(const opengl_buffer &buffer, void *&out_fence) {
+    out_fence = nullptr;
     if (!render_context_ || !buffer.fbo) return false;
     mpv_opengl_fbo fbo{static_cast<int>(buffer.fbo), buffer_width_, buffer_height_, 0};
     int flip_y = 1;
@@ -485,9 +504,17 @@ bool mpv_handle_t::render_into(const opengl_buffer &buffer) {
     glClear(GL_COLOR_BUFFER_BIT);
     glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    // glFlush merely submits work. Publication after glFinish is the first-version
-    // producer completion protocol and prevents Skia from sampling partial writes.
-    glFinish();
+    // Publish without waiting for the GPU: the consumer makes A wait on this fence
+    // (wait_buffer_fence) before Skia samples the texture. The flush makes the fence
+    // visible to A; a wait on an unflushed fence of another context may never return.
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    if (fence) {
+        glFlush();
+    } else {
+        // Without a fence the consumer cannot wait, so complete the frame here.
+        glFinish();
+    }
+    out_fence = fence;
     return result >= 0 && glGetError() == GL_NO_ERROR;
 }
 
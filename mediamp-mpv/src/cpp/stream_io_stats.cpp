@@ -0,0 +1,71 @@
+#include <algorithm>
+#include "stream_io_stats.h"
+
+namespace mediampv {
+
+void stream_io_stats::record_read(int64_t result, int64_t nanos) {
+    read_calls_.fetch_add(1, std::memory_order_relaxed);
+    if (result > 0) {
+        read_bytes_.fetch_add(static_cast<uint64_t>(result), std::memory_order_relaxed);
+    } else if (result < 0) {
+        read_errors_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    int bucket = 0;
+    for (int64_t micros = nanos / 1000; micros > 0 && bucket < kLatencyBuckets - 1; micros >>= 1) {
+        ++bucket;
+    }
+    latency_buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    int64_t max = max_read_nanos_.load(std::memory_order_relaxed);
+    while (nanos > max && !max_read_nanos_.compare_exchange_weak(max, nanos, std::memory_order_relaxed)) {
+    }
+}
+
+int64_t stream_io_stats::latency_percentile_micros(double percentile) const {
+    uint64_t counts[kLatencyBuckets];
+    uint64_t total = 0;
+    for (int i = 0; i < kLatencyBuckets; ++i) {
+        counts[i] = latency_buckets_[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    // Reported as the upper bound of the bucket the percentile falls in, capped by the
+    // slowest read seen: at most 2x pessimistic, which is enough to tell a 100us cache hit
+    // from a 50ms network stall.
+    const auto rank = static_cast<uint64_t>(static_cast<double>(total) * percentile);
+    uint64_t seen = 0;
+    int bucket = 0;
+    for (; bucket < kLatencyBuckets - 1; ++bucket) {
+        seen += counts[bucket];
+        if (seen > rank) {
+            break;
+        }
+    }
+    const int64_t max_micros = max_read_nanos_.load(std::memory_order_relaxed) / 1000;
+    return std::min<int64_t>(int64_t(1) << bucket, std::max<int64_t>(max_micros, 1));
+}
+
+void stream_io_stats::append_to(std::vector<int64_t> &out) const {
+    out.insert(out.end(), {
+            static_cast<int64_t>(read_calls_.load(std::memory_order_relaxed)),
+            static_cast<int64_t>(read_bytes_.load(std::memory_order_relaxed)),
+            static_cast<int64_t>(read_errors_.load(std::memory_order_relaxed)),
+            static_cast<int64_t>(seek_calls_.load(std::memory_order_relaxed)),
+            static_cast<int64_t>(input_seeks_.load(std::memory_order_relaxed)),
+            static_cast<int64_t>(elided_seeks_.load(std::memory_order_relaxed)),
+            static_cast<int64_t>(jni_attaches_.load(std::memory_order_relaxed)),
+            latency_percentile_micros(0.5),
+            latency_percentile_micros(0.99),
+            max_read_nanos_.load(std::memory_order_relaxed) / 1000,
+            input_nanos_.load(std::memory_order_relaxed),
+            copy_nanos_.load(std::memory_order_relaxed),
+            lock_wait_nanos_.load(std::memory_order_relaxed),
+            static_cast<int64_t>(input_reads_.load(std::memory_order_relaxed)),
+    });
+}
+
+} // namespace mediampv
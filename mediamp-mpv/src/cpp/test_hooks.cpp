@@ -0,0 +1,703 @@
+// Entry points for the desktop tests (NativeTestHooks.kt in desktopTest), which drive the
+// native units directly, without an mpv instance or a JVM-backed input. They are resolved
+// by their JNI names instead of being registered in JNI_OnLoad: nothing but the tests calls
+// them, and the players never load that class. Compiled only into the test builds of the
+// library (MEDIAMP_TEST_HOOKS, set by mpvBuildJniTest* and the dev build), never into the
+// shipped one: they reach process-wide state such as the handle pool and the log queue.
+#if defined(MEDIAMP_TEST_HOOKS)
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <jni.h>
+#include "disk_cache.h"
+#include "event_batch.h"
+#include "handle_pool.h"
+#include "log.h"
+#include "log_queue.h"
+#include "log_ring_file.h"
+#include "method_cache.h"
+#include "mpv_handle_t.h"
+#include "node_codec.h"
+#include "property_throttle.h"
+#include "read_ahead_cache.h"
+
+#define FN_TEST(name) Java_org_openani_mediamp_mpv_NativeTestHooksKt_##name
+
+namespace {
+
+using mediampv::disk_cache;
+using mediampv::event_batch;
+using mediampv::log_queue;
+using mediampv::log_ring_file;
+using mediampv::property_throttle;
+using mediampv::read_ahead_cache;
+
+std::string to_string(JNIEnv *env, jstring string) {
+    const char *chars = string ? env->GetStringUTFChars(string, nullptr) : nullptr;
+    std::string result = chars ? chars : "";
+    if (chars) {
+        env->ReleaseStringUTFChars(string, chars);
+    }
+    return result;
+}
+
+std::vector<std::string> to_strings(JNIEnv *env, jobjectArray array) {
+    std::vector<std::string> result;
+    const jsize length = array ? env->GetArrayLength(array) : 0;
+    for (jsize i = 0; i < length; ++i) {
+        auto element = static_cast<jstring>(env->GetObjectArrayElement(array, i));
+        result.push_back(to_string(env, element));
+        env->DeleteLocalRef(element);
+    }
+    return result;
+}
+
+// Standard UTF-8 passed as bytes, the way jni.cpp takes paths.
+std::string to_utf8(JNIEnv *env, jbyteArray bytes) {
+    std::string result(static_cast<size_t>(env->GetArrayLength(bytes)), '\0');
+    if (!result.empty()) {
+        env->GetByteArrayRegion(bytes, 0, static_cast<jsize>(result.size()), reinterpret_cast<jbyte *>(&result[0]));
+    }
+    return result;
+}
+
+// The byte at `offset` of every test stream, so that a read can be checked wherever it lands.
+char test_stream_byte(int64_t offset) {
+    return static_cast<char>((offset ^ (offset >> 8) ^ (offset >> 16)) & 0xff);
+}
+
+// A block_source over test_stream_byte that counts its fetches per block. It can be set
+// up to hang on the next fetch of a block until interrupted, like a SeekableInput waiting
+// for data that is not there yet, and to fail the next fetches of a block on its own.
+class test_block_source final : public mediampv::block_source {
+public:
+    int64_t fetch(int64_t offset, char *buffer, int64_t length) override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        const int64_t block = offset / read_ahead_cache::kBlockSize;
+        ++fetches_[block];
+        if (block == hang_block_) {
+            hang_block_ = -1;
+            hanging_ = true;
+            changed_.notify_all();
+            changed_.wait(lock, [this] { return interrupted_; });
+            hanging_ = false;
+            interrupted_ = false;
+            if (!hang_ignores_interrupt_) {
+                // Fails the way a SeekableInput.read that was interrupted throws.
+                return -1;
+            }
+        }
+        if (block == fail_block_ && fail_count_ > 0) {
+            --fail_count_;
+            return -1;
+        }
+        for (int64_t i = 0; i < length; ++i) {
+            buffer[i] = test_stream_byte(offset + i);
+        }
+        return length;
+    }
+
+    void interrupt_fetch() override {
+        std::lock_guard<std::mutex> guard(mutex_);
+        ++interrupts_;
+        if (hanging_) {
+            interrupted_ = true;
+            changed_.notify_all();
+        }
+    }
+
+    // `hang_block` < 0 and `fail_count` 0 turn either mode off.
+    void configure(int64_t hang_block, bool hang_ignores_interrupt, int64_t fail_block, int64_t fail_count) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        hang_block_ = hang_block;
+        hang_ignores_interrupt_ = hang_ignores_interrupt;
+        fail_block_ = fail_block;
+        fail_count_ = fail_count;
+    }
+
+    void await_hang() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [this] { return hanging_; });
+    }
+
+    // Ends a hang the test left behind, so that the prefetch thread can be joined.
+    void release() {
+        std::lock_guard<std::mutex> guard(mutex_);
+        hang_block_ = -1;
+        interrupted_ = true;
+        changed_.notify_all();
+    }
+
+    int64_t interrupts() {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return interrupts_;
+    }
+
+    int64_t fetches(int64_t block) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (block >= 0) {
+            auto iterator = fetches_.find(block);
+            return iterator == fetches_.end() ? 0 : iterator->second;
+        }
+        int64_t total = 0;
+        for (const auto &entry : fetches_) {
+            total += entry.second;
+        }
+        return total;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::map<int64_t, int64_t> fetches_;
+    int64_t interrupts_ = 0;
+    int64_t hang_block_ = -1;
+    bool hang_ignores_interrupt_ = false;
+    bool hanging_ = false;
+    bool interrupted_ = false;
+    int64_t fail_block_ = -1;
+    int64_t fail_count_ = 0;
+};
+
+struct test_read_ahead final {
+    test_read_ahead(const std::string &key, int64_t size, int64_t read_ahead_size, int64_t fetch_size)
+            : cache(source, key, size, read_ahead_size, fetch_size, nullptr) {}
+
+    ~test_read_ahead() {
+        cache.request_stop();
+        source.release();
+    }
+
+    test_block_source source;
+    read_ahead_cache cache;
+};
+
+test_read_ahead *read_ahead_from(jlong ptr) {
+    return reinterpret_cast<test_read_ahead *>(static_cast<intptr_t>(ptr));
+}
+
+read_ahead_cache::reader *reader_from(jlong ptr) {
+    return reinterpret_cast<read_ahead_cache::reader *>(static_cast<intptr_t>(ptr));
+}
+
+// A disk_cache opened by the tests, holding blocks of test_stream_byte.
+struct test_disk_cache final {
+    std::shared_ptr<disk_cache> cache;
+    int64_t size;
+    int64_t block_size;
+
+    int64_t block_length(int64_t index) const {
+        return std::min(block_size, size - index * block_size);
+    }
+};
+
+test_disk_cache *disk_cache_from(jlong ptr) {
+    return reinterpret_cast<test_disk_cache *>(static_cast<intptr_t>(ptr));
+}
+
+event_batch *event_batch_from(jlong ptr) {
+    return reinterpret_cast<event_batch *>(static_cast<intptr_t>(ptr));
+}
+
+log_queue *log_queue_from(jlong ptr) {
+    return reinterpret_cast<log_queue *>(static_cast<intptr_t>(ptr));
+}
+
+log_ring_file *log_ring_from(jlong ptr) {
+    return reinterpret_cast<log_ring_file *>(static_cast<intptr_t>(ptr));
+}
+
+mpv_node node_of(mpv_format format) {
+    mpv_node node{};
+    node.format = format;
+    return node;
+}
+
+mpv_node string_node(const char *string) {
+    mpv_node node = node_of(MPV_FORMAT_STRING);
+    node.u.string = const_cast<char *>(string);
+    return node;
+}
+
+mpv_node int64_node(int64_t value) {
+    mpv_node node = node_of(MPV_FORMAT_INT64);
+    node.u.int64 = value;
+    return node;
+}
+
+mpv_node flag_node(bool value) {
+    mpv_node node = node_of(MPV_FORMAT_FLAG);
+    node.u.flag = value ? 1 : 0;
+    return node;
+}
+
+// `list` must outlive the node; `keys` is null for an array.
+mpv_node list_node(mpv_node_list &list, std::vector<mpv_node> &values, std::vector<const char *> *keys) {
+    mpv_node node = node_of(keys ? MPV_FORMAT_NODE_MAP : MPV_FORMAT_NODE_ARRAY);
+    list.num = static_cast<int>(values.size());
+    list.values = values.data();
+    list.keys = keys ? const_cast<char **>(keys->data()) : nullptr;
+    node.u.list = &list;
+    return node;
+}
+
+property_throttle *throttle_from(jlong ptr) {
+    return reinterpret_cast<property_throttle *>(static_cast<intptr_t>(ptr));
+}
+
+// The tests' clock: `nanos` after the steady clock's epoch.
+property_throttle::clock::time_point at(jlong nanos) {
+    return property_throttle::clock::time_point(std::chrono::nanoseconds(nanos));
+}
+
+bool admit(jlong ptr, jlong reply_data, const std::string &name, mpv_format format, void *data, jlong now) {
+    mpv_event_property prop{};
+    prop.name = name.c_str();
+    prop.format = format;
+    prop.data = data;
+    mpv_event event{};
+    event.event_id = MPV_EVENT_PROPERTY_CHANGE;
+    event.reply_userdata = static_cast<uint64_t>(reply_data);
+    event.data = &prop;
+    return throttle_from(ptr)->admit(event, at(now));
+}
+
+// "<reply_data>:<name>=<value>", or "<reply_data>:<name>" for a change without data.
+std::string describe(const mpv_event &event) {
+    const auto *prop = static_cast<const mpv_event_property *>(event.data);
+    std::ostringstream out;
+    out << event.reply_userdata << ':' << prop->name;
+    if (!prop->data) {
+        return out.str();
+    }
+    out << '=';
+    switch (prop->format) {
+        case MPV_FORMAT_FLAG:
+            out << (*static_cast<const int *>(prop->data) ? "true" : "false");
+            break;
+        case MPV_FORMAT_INT64:
+            out << *static_cast<const int64_t *>(prop->data);
+            break;
+        case MPV_FORMAT_DOUBLE:
+            out << *static_cast<const double *>(prop->data);
+            break;
+        case MPV_FORMAT_STRING:
+            out << *static_cast<const char *const *>(prop->data);
+            break;
+        default:
+            break;
+    }
+    return out.str();
+}
+
+} // namespace
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL FN_TEST(nTestReadAheadCreate)(
+        JNIEnv *env, jclass, jstring key, jlong size, jlong read_ahead_size, jlong fetch_size) {
+    auto *test = new test_read_ahead(to_string(env, key), size, read_ahead_size, fetch_size);
+    if (!test->cache.start()) {
+        delete test;
+        return 0;
+    }
+    return static_cast<jlong>(reinterpret_cast<intptr_t>(test));
+}
+
+JNIEXPORT void JNICALL FN_TEST(nTestReadAheadDestroy)(JNIEnv *, jclass, jlong ptr) {
+    delete read_ahead_from(ptr);
+}
+
+JNIEXPORT jlong JNICALL FN_TEST(nTestReadAheadOpenReader)(JNIEnv *, jclass, jlong ptr) {
+    return static_cast<jlong>(reinterpret_cast<intptr_t>(read_ahead_from(ptr)->cache.open_reader()));
+}
+
+JNIEXPORT void JNICALL FN_TEST(nTestReadAheadCloseReader)(JNIEnv *, jclass, jlong ptr, jlong reader) {
+    read_ahead_from(ptr)->cache.close_reader(reader_from(reader));
+}
+
+JNIEXPORT void JNICALL FN_TEST(nTestReadAheadCancelReader)(JNIEnv *, jclass, jlong ptr, jlong reader) {
+    read_ahead_from(ptr)->cache.cancel_reader(reader_from(reader));
+}
+
+// Returns what read_ahead_cache::read returns, or -2 when the bytes it copied are wrong.
+JNIEXPORT jint JNICALL FN_TEST(nTestReadAheadRead)(
+        JNIEnv *, jclass, jlong ptr, jlong reader, jlong offset, jint length) {
+    std::vector<char> buffer(static_cast<size_t>(length > 0 ? length : 0));
+    const int64_t count = read_ahead_from(ptr)->cache.read(reader_from(reader), offset, buffer.data(), length);
+    for (int64_t i = 0; i < count; ++i) {
+        if (buffer[static_cast<size_t>(i)] != test_stream_byte(offset + i)) {
+            return -2;
+        }
+    }
+    return static_cast<jint>(count);
+}
+
+// Fetches the source made for `block`, or for all blocks when it is negative.
+JNIEXPORT jlong JNICALL FN_TEST(nTestReadAheadSourceFetches)(JNIEnv *, jclass, jlong ptr, jlong block) {
+    return read_ahead_from(ptr)->source.fetches(block);
+}
+
+JNIEXPORT void JNICALL FN_TEST(nTestReadAheadConfigureSource)(
+        JNIEnv *, jclass, jlong ptr, jlong hang_block, jboolean hang_ignores_interrupt, jlong fail_block,
+        jlong fail_count) {
+    read_ahead_from(ptr)->source.configure(hang_block, hang_ignores_interrupt == JNI_TRUE, fail_block, fail_count);
+}
+
+// Returns once the source is hanging in a fetch, as set up by nTestReadAheadConfigureSource.
+JNIEXPORT void JNICALL FN_TEST(nTestReadAheadAwaitSourceHang)(JNIEnv *, jclass, jlong ptr) {
+    read_ahead_from(ptr)->source.await_hang();
+}
+
+JNIEXPORT jlong JNICALL FN_TEST(nTestReadAheadSourceInterrupts)(JNIEnv *, jclass, jlong ptr) {
+    return read_ahead_from(ptr)->source.interrupts();
+}
+
+JNIEXPORT jlong JNICALL FN_TEST(nTestThrottleCreate)(JNIEnv *, jclass) {
+    return static_cast<jlong>(reinterpret_cast<intptr_t>(new property_throttle()));
+}
+
+JNIEXPORT void JNICALL FN_TEST(nTestThrottleDestroy)(JNIEnv *, jclass, jlong ptr) {
+    delete throttle_from(ptr);
+}
+
+JNIEXPORT void JNICALL FN_TEST(nTestThrottleConfigure)(
+        JNIEnv *, jclass, jlong ptr, jlong reply_data, jlong min_interval_nanos, jdouble epsilon) {
+    throttle_from(ptr)->configure(static_cast<uint64_t>(reply_data), min_interval_nanos, epsilon);
+}
+
+JNIEXPORT jboolean JNICALL FN_TEST(nTestThrottleAdmitDouble)(
+        JNIEnv *env, jclass, jlong ptr, jlong reply_data, jstring name, jdouble value, jlong now) {
+    double data = value;
+    return admit(ptr, reply_data, to_string(env, name), MPV_FORMAT_DOUBLE, &data, now) ? JNI_TRUE : JNI_FALSE;
+}
+
+// A null `value` is a change without data, as mpv reports an unavailable property.
+JNIEXPORT jboolean JNICALL FN_TEST(nTestThrottleAdmitString)(
+        JNIEnv *env, jclass, jlong ptr, jlong reply_data, jstring name, jstring value, jlong now) {
+    const std::string string = to_string(env, value);
+    const char *data = string.c_str();
+    return admit(ptr, reply_data, to_string(env, name), MPV_FORMAT_STRING, value ? &data : nullptr, now)
+           ? JNI_TRUE : JNI_FALSE;
+}
+
+// The changes flush_due delivered, described as "<reply_data>:<name>=<value>" and joined
+// by newlines.
+JNIEXPORT jstring JNICALL FN_TEST(nTestThrottleFlushDue)(JNIEnv *env, jclass, jlong ptr, jlong now) {
+    std::string delivered;
+    throttle_from(ptr)->flush_due(at(now), [&delivered](const mpv_event &event) {
+        if (!delivered.empty()) {
+            delivered += '\n';
+        }
+        delivered += describe(event);
+    });
+    return env->NewStringUTF(delivered.c_str());
+}
+
+// Like nTestThrottleFlushDue, for flush_pending.
+JNIEXPORT jstring JNICALL FN_TEST(nTestThrottleFlushPending)(JNIEnv *env, jclass, jlong ptr, jlong now) {
+    std::string delivered;
+    throttle_from(ptr)->flush_pending(at(now), [&delivered](const mpv_event &event) {
+        if (!delivered.empty()) {
+            delivered += '\n';
+        }
+        delivered += describe(event);
+    });
+    return env->NewStringUTF(delivered.c_str());
+}
+
+JNIEXPORT void JNICALL FN_TEST(nTestThrottleDropPending)(JNIEnv *, jclass, jlong ptr) {
+    throttle_from(ptr)->drop_pending();
+}
+
+JNIEXPORT jdouble JNICALL FN_TEST(nTestThrottleWaitTimeout)(JNIEnv *, jclass, jlong ptr, jlong now) {
+    return throttle_from(ptr)->wait_timeout(at(now));
+}
+
+// An event_batch for the calling thread, which must be the only one to use it.
+JNIEXPORT jlong JNICALL FN_TEST(nTestEventBatchCreate)(JNIEnv *env, jclass) {
+    mediampv::jni_cache_classes(env);
+    return static_cast<jlong>(reinterpret_cast<intptr_t>(new event_batch(env, nullptr)));
+}
+
+JNIEXPORT void JNICALL FN_TEST(nTestEventBatchDestroy)(JNIEnv *, jclass, jlong ptr) {
+    delete event_batch_from(ptr);
+}
+
+// Appends an event without data but for MPV_EVENT_START_FILE (`entry_id`) and
+// MPV_EVENT_END_FILE (`reason`, `error` and `entry_id`). Returns the size of the batch after
+// it, 0 when append flushed it to `dispatcher`.
+JNIEXPORT jint JNICALL FN_TEST(nTestEventBatchAppendEvent)(
+        JNIEnv *, jclass, jlong ptr, jint event_id, jint reason, jint error, jlong entry_id, jobject dispatcher) {
+    mpv_event_start_file start_file{entry_id};
+    mpv_event_end_file end_file{};
+    end_file.reason = static_cast<mpv_end_file_reason>(reason);
+    end_file.error = error;
+    end_file.playlist_entry_id = entry_id;
+    mpv_event event{};
+    event.event_id = static_cast<mpv_event_id>(event_id);
+    if (event.event_id == MPV_EVENT_START_FILE) {
+        event.data = &start_file;
+    } else if (event.event_id == MPV_EVENT_END_FILE) {
+        event.data = &end_file;
+    }
+    event_batch *batch = event_batch_from(ptr);
+    batch->append(&event, dispatcher);
+    return static_cast<jint>(batch->size());
+}
+
+// Appends a change of `name` in `format`: `value` is the flag (0/1), the int64 or the bits of
+// the double; a string is `string`, standard UTF-8. Returns like nTestEventBatchAppendEvent.
+JNIEXPORT jint JNICALL FN_TEST(nTestEventBatchAppendProperty)(
+        JNIEnv *env, jclass, jlong ptr, jlong reply_data, jstring name, jint format, jlong value, jbyteArray string,
+        jobject dispatcher) {
+    const std::string property_name = to_string(env, name);
+    const std::string string_value = string ? to_utf8(env, string) : std::string();
+    const char *string_data = string_value.c_str();
+    int flag = value != 0 ? 1 : 0;
+    int64_t int64 = value;
+    double number;
+    std::memcpy(&number, &value, sizeof(number));
+    mpv_event_property property{};
+    property.name = property_name.c_str();
+    property.format = static_cast<mpv_format>(format);
+    switch (property.format) {
+        case MPV_FORMAT_FLAG:
+            property.data = &flag;
+            break;
+        case MPV_FORMAT_INT64:
+            property.data = &int64;
+            break;
+        case MPV_FORMAT_DOUBLE:
+            property.data = &number;
+            break;
+        case MPV_FORMAT_STRING:
+            property.data = &string_data;
+            break;
+        default:
+            break;
+    }
+    mpv_event event{};
+    event.event_id = MPV_EVENT_PROPERTY_CHANGE;
+    event.reply_userdata = static_cast<uint64_t>(reply_data);
+    event.data = &property;
+    event_batch *batch = event_batch_from(ptr);
+    batch->append(&event, dispatcher);
+    return static_cast<jint>(batch->size());
+}
+
+JNIEXPORT void JNICALL FN_TEST(nTestEventBatchFlush)(JNIEnv *, jclass, jlong ptr, jobject dispatcher) {
+    event_batch_from(ptr)->flush(dispatcher);
+}
+
+// flatten_node of a fixed tree with a node of every format, shaped like what mpv returns for
+// a property such as "track-list":
+//   {"none": NONE, "string": "日本語", "flag": true, "int64": -2, "double": 12.5,
+//    "bytes": [1, 2, 3] as a byte array, "osd": an MPV_FORMAT_OSD_STRING node, "empty": [],
+//    "tracks": [{"id": 1, "type": "audio", "selected": true}, {"id": 2, "lang": "jpn"}]}
+JNIEXPORT jbyteArray JNICALL FN_TEST(nTestFlattenNode)(JNIEnv *env, jclass) {
+    std::vector<mpv_node> first_values = {int64_node(1), string_node("audio"), flag_node(true)};
+    std::vector<const char *> first_keys = {"id", "type", "selected"};
+    std::vector<mpv_node> second_values = {int64_node(2), string_node("jpn")};
+    std::vector<const char *> second_keys = {"id", "lang"};
+    mpv_node_list first_list{}, second_list{}, tracks_list{}, empty_list{}, root_list{};
+    std::vector<mpv_node> tracks = {
+            list_node(first_list, first_values, &first_keys),
+            list_node(second_list, second_values, &second_keys),
+    };
+    std::vector<mpv_node> empty;
+
+    char bytes[] = {1, 2, 3};
+    mpv_byte_array byte_array{bytes, sizeof(bytes)};
+    mpv_node byte_array_node = node_of(MPV_FORMAT_BYTE_ARRAY);
+    byte_array_node.u.ba = &byte_array;
+    mpv_node double_node = node_of(MPV_FORMAT_DOUBLE);
+    double_node.u.double_ = 12.5;
+    mpv_node osd_node = node_of(MPV_FORMAT_OSD_STRING);
+    osd_node.u.string = const_cast<char *>("osd");
+
+    std::vector<mpv_node> root_values = {
+            node_of(MPV_FORMAT_NONE),
+            string_node("\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e"),
+            flag_node(true),
+            int64_node(-2),
+            double_node,
+            byte_array_node,
+            osd_node,
+            list_node(empty_list, empty, nullptr),
+            list_node(tracks_list, tracks, nullptr),
+    };
+    std::vector<const char *> root_keys = {
+            "none", "string", "flag", "int64", "double", "bytes", "osd", "empty", "tracks"};
+    std::vector<char> flattened;
+    mediampv::flatten_node(list_node(root_list, root_values, &root_keys), flattened);
+
+    jbyteArray result = env->NewByteArray(static_cast<jsize>(flattened.size()));
+    if (result) {
+        env->SetByteArrayRegion(
+                result, 0, static_cast<jsize>(flattened.size()), reinterpret_cast<const jbyte *>(flattened.data()));
+    }
+    return result;
+}
+
+// log_ring_file::open, or 0 when it failed.
+JNIEXPORT jlong JNICALL FN_TEST(nTestLogRingOpen)(JNIEnv *env, jclass, jbyteArray path, jlong capacity) {
+    auto ring = log_ring_file::open(to_utf8(env, path).c_str(), static_cast<uint64_t>(capacity));
+    return static_cast<jlong>(reinterpret_cast<intptr_t>(ring.release()));
+}
+
+JNIEXPORT void JNICALL FN_TEST(nTestLogRingClose)(JNIEnv *, jclass, jlong ptr) {
+    delete log_ring_from(ptr);
+}
+
+JNIEXPORT void JNICALL FN_TEST(nTestLogRingWrite)(
+        JNIEnv *env, jclass, jlong ptr, jlong instance_handle, jint level, jstring prefix, jstring text) {
+    const std::string line = to_string(env, text);
+    log_ring_from(ptr)->write(
+            reinterpret_cast<const void *>(static_cast<intptr_t>(instance_handle)), level,
+            to_string(env, prefix).c_str(), line.data(), line.size());
+}
+
+JNIEXPORT jlong JNICALL FN_TEST(nTestLogQueueCreate)(JNIEnv *, jclass) {
+    return static_cast<jlong>(reinterpret_cast<intptr_t>(new log_queue()));
+}
+
+JNIEXPORT void JNICALL FN_TEST(nTestLogQueueDestroy)(JNIEnv *, jclass, jlong ptr) {
+    delete log_queue_from(ptr);
+}
+
+// Claims a slot, writes `text` into it and publishes it; false when the queue was full.
+JNIEXPORT jboolean JNICALL FN_TEST(nTestLogQueuePush)(JNIEnv *env, jclass, jlong ptr, jstring text) {
+    log_queue::entry *entry = log_queue_from(ptr)->claim();
+    if (!entry) {
+        return JNI_FALSE;
+    }
+    const std::string line = to_string(env, text);
+    entry->text_length = static_cast<uint32_t>(std::min(line.size(), sizeof(entry->text) - 1));
+    std::copy_n(line.data(), entry->text_length, entry->text);
+    entry->text[entry->text_length] = '\0';
+    log_queue_from(ptr)->publish(entry);
+    return JNI_TRUE;
+}
+
+// The text of the oldest published line, which is popped, or null when there is none.
+JNIEXPORT jstring JNICALL FN_TEST(nTestLogQueuePop)(JNIEnv *env, jclass, jlong ptr) {
+    log_queue::entry *entry = log_queue_from(ptr)->front();
+    if (!entry) {
+        return nullptr;
+    }
+    jstring text = env->NewStringUTF(entry->text);
+    log_queue_from(ptr)->pop(entry);
+    return text;
+}
+
+JNIEXPORT jlong JNICALL FN_TEST(nTestLogQueueDropped)(JNIEnv *, jclass, jlong ptr) {
+    return static_cast<jlong>(log_queue_from(ptr)->dropped());
+}
+
+// log_forward of a process-wide line, through the shared queue and the drain thread.
+JNIEXPORT void JNICALL FN_TEST(nTestLogForward)(JNIEnv *env, jclass, jint level, jstring prefix, jstring text) {
+    mediampv::log_forward(level, to_string(env, prefix).c_str(), to_string(env, text).c_str());
+}
+
+JNIEXPORT jint JNICALL FN_TEST(nTestLogThreshold)(JNIEnv *, jclass, jlong instance_handle) {
+    return mediampv::log_threshold(reinterpret_cast<const void *>(static_cast<intptr_t>(instance_handle)));
+}
+
+// log_print of a line of the handle at `instance_handle`, which is filtered by its threshold.
+JNIEXPORT void JNICALL FN_TEST(nTestLogPrint)(JNIEnv *env, jclass, jlong instance_handle, jint level, jstring text) {
+    mediampv::log_print(reinterpret_cast<const void *>(static_cast<intptr_t>(instance_handle)), level, "%s",
+                        to_string(env, text).c_str());
+}
+
+// A disk_cache::open of `content_id`, or 0 when it returned null.
+JNIEXPORT jlong JNICALL FN_TEST(nTestDiskCacheOpen)(
+        JNIEnv *env, jclass, jstring content_id, jlong size, jlong block_size) {
+    auto cache = disk_cache::open(to_string(env, content_id), size, block_size, nullptr);
+    if (!cache) {
+        return 0;
+    }
+    return static_cast<jlong>(reinterpret_cast<intptr_t>(new test_disk_cache{std::move(cache), size, block_size}));
+}
+
+JNIEXPORT void JNICALL FN_TEST(nTestDiskCacheClose)(JNIEnv *, jclass, jlong ptr) {
+    delete disk_cache_from(ptr);
+}
+
+JNIEXPORT void JNICALL FN_TEST(nTestDiskCacheWrite)(JNIEnv *, jclass, jlong ptr, jlong index) {
+    auto *test = disk_cache_from(ptr);
+    std::vector<char> block(static_cast<size_t>(test->block_length(index)));
+    for (size_t i = 0; i < block.size(); ++i) {
+        block[i] = test_stream_byte(index * test->block_size + static_cast<int64_t>(i));
+    }
+    test->cache->write_block(index, block.data(), static_cast<int64_t>(block.size()));
+}
+
+// 1 when block `index` was read back intact, 0 when it is not stored, -2 when it was read
+// but its bytes are wrong.
+JNIEXPORT jint JNICALL FN_TEST(nTestDiskCacheRead)(JNIEnv *, jclass, jlong ptr, jlong index) {
+    auto *test = disk_cache_from(ptr);
+    std::vector<char> block(static_cast<size_t>(test->block_length(index)));
+    if (!test->cache->read_block(index, block.data(), static_cast<int64_t>(block.size()))) {
+        return 0;
+    }
+    for (size_t i = 0; i < block.size(); ++i) {
+        if (block[i] != test_stream_byte(index * test->block_size + static_cast<int64_t>(i))) {
+            return -2;
+        }
+    }
+    return 1;
+}
+
+// Pushes an event into the ring open on the handle at `ptr` the way its event loop would.
+// The handle must not be initialized, so that the calling thread is the ring's only
+// producer. MPV_EVENT_START_FILE and MPV_EVENT_END_FILE (reason EOF) carry `entry_id`;
+// other events have no data.
+JNIEXPORT jboolean JNICALL FN_TEST(nTestEventRingPush)(JNIEnv *, jclass, jlong ptr, jint event_id, jlong entry_id) {
+    mediampv::event_ring *ring = reinterpret_cast<mediampv::mpv_handle_t *>(ptr)->event_ring();
+    if (!ring) {
+        return JNI_FALSE;
+    }
+    mpv_event_start_file start_file{entry_id};
+    mpv_event_end_file end_file{};
+    end_file.reason = MPV_END_FILE_REASON_EOF;
+    end_file.playlist_entry_id = entry_id;
+    mpv_event event{};
+    event.event_id = static_cast<mpv_event_id>(event_id);
+    if (event.event_id == MPV_EVENT_START_FILE) {
+        event.data = &start_file;
+    } else if (event.event_id == MPV_EVENT_END_FILE) {
+        event.data = &end_file;
+    }
+    return ring->push(event) ? JNI_TRUE : JNI_FALSE;
+}
+
+// The idle instances of the pool profile `options`, as handle pointers.
+JNIEXPORT jlongArray JNICALL FN_TEST(nTestHandlePoolIdle)(JNIEnv *env, jclass, jobjectArray options) {
+    const auto idle = mediampv::handle_pool::instance().idle(to_strings(env, options));
+    std::vector<jlong> pointers;
+    for (const mediampv::mpv_handle_t *handle : idle) {
+        pointers.push_back(reinterpret_cast<jlong>(handle));
+    }
+    jlongArray result = env->NewLongArray(static_cast<jsize>(pointers.size()));
+    if (result) {
+        env->SetLongArrayRegion(result, 0, static_cast<jsize>(pointers.size()), pointers.data());
+    }
+    return result;
+}
+
+JNIEXPORT jint JNICALL FN_TEST(nTestHandlePoolFailures)(JNIEnv *env, jclass, jobjectArray options) {
+    return mediampv::handle_pool::instance().failures(to_strings(env, options));
+}
+
+} // extern "C"
+
+#endif // defined(MEDIAMP_TEST_HOOKS)
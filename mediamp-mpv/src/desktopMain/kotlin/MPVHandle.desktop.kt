@@ -204,6 +204,13 @@ external fun nGetFrameStateOpenGL(ptr: Long): Long
 @InternalMediampApi
 external fun nGetBufferTextureOpenGL(ptr: Long, index: Int): Long
 
+/**
+ * Makes the GL context current on the calling thread wait, on the GPU, until the producer has finished writing
+ * ring buffer [index]. Returns false when there is nothing to wait for.
+ */
+@InternalMediampApi
+external fun nWaitBufferFenceOpenGL(ptr: Long, index: Int): Boolean
+
 /** Signals that Skia no longer references the retired shared-texture generation. */
 @InternalMediampApi
 external fun nAckRetiredBuffersOpenGL(ptr: Long): Boolean
@@ -16,6 +16,7 @@ import org.jetbrains.skia.DirectContext
 import org.jetbrains.skia.Image
 import org.jetbrains.skiko.SkiaLayer
 import org.openani.mediamp.InternalMediampApi
+import org.openani.mediamp.mpv.internal.MpvPreviewDecoder
 import org.openani.mediamp.mpv.internal.MpvRenderContextHost
 import org.openani.mediamp.mpv.internal.MpvRenderContextLifecycle
 import org.openani.mediamp.mpv.internal.MpvSurfaceBackend
@@ -153,6 +154,16 @@ actual class MpvMediampPlayer(
         fun prepareLibraries() {
             MPVHandle.useDefaultRuntimeLibraryDirectory()
         }
+
+        /**
+         * Keeps [size] mpv handles configured for frame preview ready, so that previewing newly opened media
+         * does not wait for one to be created. 0, the default, turns it off.
+         *
+         * @see JvmMpvMediampPlayer.configureHandlePool
+         */
+        fun configureFramePreviewHandlePool(context: Any, size: Int) {
+            MPVHandle.configurePool(context, MpvPreviewDecoder.HANDLE_OPTIONS, size)
+        }
     }
 }
 
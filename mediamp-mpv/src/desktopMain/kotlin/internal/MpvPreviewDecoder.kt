@@ -38,7 +38,7 @@ internal class MpvPreviewDecoder(
     private val ringBackend: MpvSurfaceBackend,
     provisioning: MpvRenderContextProvisioning,
 ) : AutoCloseable {
-    val handle = MPVHandle(context)
+    val handle = MPVHandle.createInitialized(context, HANDLE_OPTIONS)
 
     /** Input opened for stream_cb media; owned and closed by this decoder. */
     private var openInput: SeekableInput? = null
@@ -69,34 +69,6 @@ internal class MpvPreviewDecoder(
     }
 
     private fun configure() {
-        // Mirrored from JvmMpvMediampPlayer.configureNativeHandle — keep the two in sync.
-        // Only options that affect decoding or frame correctness are kept; playback-only
-        // options (ao, volume-max, input bindings) are intentionally absent.
-        handle.option("config", "no")
-        handle.option("profile", "fast")
-        handle.option("vo", "libmpv")
-        // HDR -> SDR tone-mapping, same as the main player (see there for the full
-        // rationale) — without it HDR sources produce near-black thumbnails.
-        handle.option("gpu-dumb-mode", "no")
-        handle.option("hwdec", "auto")
-        handle.option("hwdec-codecs", "h264,hevc,mpeg4,mpeg2video,vp8,vp9,av1")
-        // Prefer libdav1d for software AV1 — same rationale as the main player (see
-        // JvmMpvMediampPlayer.configureNativeHandle).
-        handle.option("vd", "libdav1d")
-        // workaround for <https://github.com/mpv-player/mpv/issues/14651>
-        handle.option("vd-lavc-film-grain", "cpu")
-
-        // Preview-specific: no audio/subtitles, start paused, and bound how much data a
-        // single keyframe seek may pull in (the player default of 64 MB would be read
-        // ahead after every scrub position).
-        handle.option("aid", "no")
-        handle.option("sid", "no")
-        handle.option("pause", "yes")
-        handle.option("demuxer-max-bytes", "${8 * 1024 * 1024}")
-        handle.option("demuxer-max-back-bytes", "${4 * 1024 * 1024}")
-
-        handle.initialize()
-
         handle.option("save-position-on-quit", "no")
         handle.option("force-window", "no")
         handle.option("idle", "yes")
@@ -123,7 +95,13 @@ internal class MpvPreviewDecoder(
             is SeekableInputMediaData -> {
                 val input = data.createInput(Dispatchers.IO_ + inputAwaitJob)
                 val registered = try {
-                    handle.registerSeekableInput(input, FRAME_PREVIEW_LOAD_TARGET_PREFIX + data.uri)
+                    handle.registerSeekableInput(
+                        input,
+                        FRAME_PREVIEW_LOAD_TARGET_PREFIX + data.uri,
+                        // Same cache as the player's registration, so already-played ranges come from native memory.
+                        readAheadSize = MPVHandle.RECOMMENDED_READ_AHEAD_SIZE,
+                        cacheKey = data.uri,
+                    )
                 } catch (t: Throwable) {
                     input.close()
                     throw t
@@ -169,4 +147,38 @@ internal class MpvPreviewDecoder(
         }
         openInput = null
     }
+
+    companion object {
+        /**
+         * Options set before the handle is initialized; the pool profile of
+         * `MpvMediampPlayer.configureFramePreviewHandlePool`.
+         *
+         * Mirrored from JvmMpvMediampPlayer's handle options — keep the two in sync.
+         * Only options that affect decoding or frame correctness are kept; playback-only
+         * options (ao, volume-max, input bindings) are intentionally absent.
+         */
+        val HANDLE_OPTIONS: List<Pair<String, String>> = listOf(
+            "config" to "no",
+            "profile" to "fast",
+            "vo" to "libmpv",
+            // HDR -> SDR tone-mapping, same as the main player (see there for the full
+            // rationale) — without it HDR sources produce near-black thumbnails.
+            "gpu-dumb-mode" to "no",
+            "hwdec" to "auto",
+            "hwdec-codecs" to "h264,hevc,mpeg4,mpeg2video,vp8,vp9,av1",
+            // Prefer libdav1d for software AV1 — same rationale as the main player.
+            "vd" to "libdav1d",
+            // workaround for <https://github.com/mpv-player/mpv/issues/14651>
+            "vd-lavc-film-grain" to "cpu",
+
+            // Preview-specific: no audio/subtitles, start paused, and bound how much data a
+            // single keyframe seek may pull in (the player default of 64 MB would be read
+            // ahead after every scrub position).
+            "aid" to "no",
+            "sid" to "no",
+            "pause" to "yes",
+            "demuxer-max-bytes" to "${8 * 1024 * 1024}",
+            "demuxer-max-back-bytes" to "${4 * 1024 * 1024}",
+        )
+    }
 }
@@ -54,6 +54,7 @@ import org.openani.mediamp.mpv.nSaveSurfacePngOpenGL
 import org.openani.mediamp.mpv.nSetSurfaceConfigD3D11
 import org.openani.mediamp.mpv.nSetSurfaceConfigMacos
 import org.openani.mediamp.mpv.nSetSurfaceConfigOpenGL
+import org.openani.mediamp.mpv.nWaitBufferFenceOpenGL
 import org.openani.mediamp.mpv.nAttachRenderEnvironmentOpenGL
 import org.openani.mediamp.mpv.utils.OpenGLRenderEnvironment
 import org.openani.mediamp.mpv.utils.SkiaDirectXInterop
@@ -167,6 +168,12 @@ internal interface MpvSurfaceRingBackend : MpvSurfaceBackend {
     fun getBufferTexture(ptr: Long, index: Int): Long
     fun ackRetiredBuffers(ptr: Long): Boolean
 
+    /**
+     * Orders the consumer's upcoming reads of buffer [index] after the producer's writes to it, on the current
+     * DirectContext. Backends whose producer completes each frame before publishing it need nothing here.
+     */
+    fun awaitBufferReady(ptr: Long, index: Int) {}
+
     fun makeConsumerRenderTarget(width: Int, height: Int, texturePtr: Long): MpvConsumerRenderTarget
     val wrapColorFormat: SurfaceColorFormat
     val skiaSurfaceOrigin: SurfaceOrigin get() = SurfaceOrigin.TOP_LEFT
@@ -254,6 +261,9 @@ internal object OpenGLSurfaceRingBackend : MpvSurfaceRingBackend {
     override fun getFrameState(ptr: Long) = nGetFrameStateOpenGL(ptr)
     override fun getBufferTexture(ptr: Long, index: Int) = nGetBufferTextureOpenGL(ptr, index)
     override fun ackRetiredBuffers(ptr: Long) = nAckRetiredBuffersOpenGL(ptr)
+    override fun awaitBufferReady(ptr: Long, index: Int) {
+        nWaitBufferFenceOpenGL(ptr, index)
+    }
     override fun hasSurface(ptr: Long) = nHasOpenGLSurface(ptr)
     override fun saveSurfacePng(ptr: Long, path: String) = nSaveSurfacePngOpenGL(ptr, path)
     override fun readSurfacePixels(ptr: Long, dims: IntArray) = nReadSurfacePixelsOpenGL(ptr, dims)
@@ -401,10 +411,6 @@ internal class MpvSurfaceRing(
 
         val source = wrappedSurfaces[index] ?: return cachedFrame
         val blit = blitSurface ?: return cachedFrame
-        // The wrapped surface content was produced externally (GL/D3D11); without this,
-        // Skia reuses a generation-cached snapshot of the texture and the video freezes
-        // on the first frame when sampled into another surface.
-        source.notifyContentWillChange(ContentChangeMode.DISCARD)
         // Snapshots of a BRT-wrapped surface do not render (Skia does not own the
         // texture), so blit into a Skia-owned GPU surface and snapshot that. The snapshot
         // is a GPU image on the current DirectContext; the caller draws it straight onto
@@ -414,13 +420,24 @@ internal class MpvSurfaceRing(
         // GPU->CPU transfer (a ~20ms stall at 4K that pins the whole Compose scene, and
         // the danmaku overlay with it, to ~40fps) and crashes on window resize (the
         // readback runs inside reshape()'s redraw against a stale swapchain context).
-        source.draw(blit.canvas, 0, 0, null)
+        sampleBuffer(index, source, blit)
         cachedFrame?.close()
         cachedFrame = blit.makeImageSnapshot()
         cachedState = state
         return cachedFrame
     }
 
+    /** Draws ring buffer [index], wrapped as [source], into [blit]. */
+    internal fun sampleBuffer(index: Int, source: Surface, blit: Surface) {
+        // The wrapped surface content was produced externally (GL/D3D11); without this,
+        // Skia reuses a generation-cached snapshot of the texture and the video freezes
+        // on the first frame when sampled into another surface.
+        source.notifyContentWillChange(ContentChangeMode.DISCARD)
+        // The producer publishes a frame as soon as it is queued; make the GPU finish it before Skia samples.
+        backend.awaitBufferReady(handlePtr, index)
+        source.draw(blit.canvas, 0, 0, null)
+    }
+
     private fun rewrapBuffers(
         generation: Int,
         width: Int,
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import kotlinx.coroutines.runBlocking
+import kotlinx.coroutines.withTimeout
+import java.util.concurrent.CountDownLatch
+import java.util.concurrent.TimeUnit
+import kotlin.test.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertFalse
+import kotlin.test.assertTrue
+
+/**
+ * Asynchronous requests ([MPVHandle.commandAsync], [MPVHandle.setPropertyAsync]): replies delivered by the event loop,
+ * mpv's error codes, and requests still pending when the handle is destroyed.
+ *
+ * Needs the dev natives (`mediamp.mpv.dev.native.dir`); skipped otherwise.
+ */
+class MpvAsyncRequestTest {
+    private val natives = MpvDevNatives("MpvAsyncRequestTest")
+
+    @Test
+    fun `replies complete the results of commands and property sets`() {
+        if (!natives.prepareOrSkip()) return
+        natives.withHandle { handle ->
+            check(handle.initialize()) { "initialize failed" }
+            runBlocking {
+                withTimeout(5_000) {
+                    assertTrue(handle.commandAsync("set", "volume", "42").await())
+                    assertTrue(handle.setPropertyAsync("speed", 1.5).await())
+                    assertTrue(handle.setPropertyAsync("pause", true).await())
+                }
+            }
+            assertEquals(42.0, handle.getPropertyDouble("volume"))
+            assertEquals(1.5, handle.getPropertyDouble("speed"))
+            assertTrue(handle.getPropertyBoolean("pause"))
+        }
+    }
+
+    @Test
+    fun `failed requests report mpv's error`() {
+        if (!natives.prepareOrSkip()) return
+        natives.withHandle { handle ->
+            check(handle.initialize()) { "initialize failed" }
+            val unknownProperty = RecordingReply()
+            assertTrue(
+                nSetPropertyAsync(handle.ptr, "no-such-property", MPVFormat.MPV_FORMAT_INT64.ordinal, 1, null, unknownProperty),
+            )
+            assertEquals(MPV_ERROR_PROPERTY_NOT_FOUND, unknownProperty.await())
+
+            val failedCommand = RecordingReply()
+            assertTrue(nCommandAsync(handle.ptr, arrayOf("set", "no-such-property", "1"), failedCommand))
+            assertTrue(failedCommand.await() < 0, "the command succeeded")
+
+            runBlocking {
+                // Refused before it is queued: mpv cannot parse it.
+                assertFalse(withTimeout(5_000) { handle.commandAsync("no-such-command").await() })
+            }
+        }
+    }
+
+    @Test
+    fun `requests pending when the handle is destroyed fail`() {
+        if (!natives.prepareOrSkip()) return
+        natives.withHandle { handle ->
+            // Never initialized: no event loop takes the replies, so both are still pending at destroy.
+            val command = RecordingReply()
+            val property = RecordingReply()
+            assertTrue(nCommandAsync(handle.ptr, arrayOf("set", "volume", "42"), command))
+            assertTrue(
+                nSetPropertyAsync(handle.ptr, "volume", MPVFormat.MPV_FORMAT_DOUBLE.ordinal, 50.0.toRawBits(), null, property),
+            )
+
+            handle.destroy()
+            assertEquals(MPV_ERROR_UNINITIALIZED, command.await())
+            assertEquals(MPV_ERROR_UNINITIALIZED, property.await())
+        }
+    }
+
+    private class RecordingReply : AsyncReplyListener {
+        private val replied = CountDownLatch(1)
+        private val errors = mutableListOf<Int>()
+
+        override fun onReply(mpvError: Int) {
+            synchronized(errors) { errors += mpvError }
+            replied.countDown()
+        }
+
+        /** The error of the one reply, once it arrives. */
+        fun await(): Int {
+            check(replied.await(5, TimeUnit.SECONDS)) { "no reply" }
+            return synchronized(errors) { errors.single() }
+        }
+    }
+
+    private companion object {
+        // mpv_error
+        const val MPV_ERROR_UNINITIALIZED = -3
+        const val MPV_ERROR_PROPERTY_NOT_FOUND = -8
+    }
+}
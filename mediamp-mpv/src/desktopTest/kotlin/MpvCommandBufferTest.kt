@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import kotlin.test.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertFailsWith
+import kotlin.test.assertTrue
+
+/**
+ * [MpvCommandBuffer] on a live handle: what reaches mpv, and which commands are refused before they do.
+ *
+ * Needs the dev natives (`mediamp.mpv.dev.native.dir`); skipped otherwise.
+ */
+class MpvCommandBufferTest {
+    private val natives = MpvDevNatives("MpvCommandBufferTest")
+
+    @Test
+    fun `arguments longer than the buffer reach mpv whole`() {
+        if (!natives.prepareOrSkip()) return
+        natives.withHandle { handle ->
+            check(handle.initialize()) { "initialize failed" }
+            val buffer = MpvCommandBuffer()
+            val title = (0 until 100).joinToString(" ") { "title-$it" }
+            check(title.length > 256)
+
+            assertTrue(buffer.command(handle, "set", "title", title))
+            assertEquals(title, handle.getPropertyNode("title"))
+            assertTrue(buffer.command(handle, "set", "title", "short"), "reusing the grown buffer")
+            assertEquals("short", handle.getPropertyNode("title"))
+        }
+    }
+
+    @Test
+    fun `characters outside the BMP reach mpv intact`() {
+        if (!natives.prepareOrSkip()) return
+        natives.withHandle { handle ->
+            check(handle.initialize()) { "initialize failed" }
+            val title = "日本語 🎬 𠀋"
+
+            assertTrue(MpvCommandBuffer().command(handle, "set", "title", title))
+            assertEquals(title, handle.getPropertyNode("title"))
+        }
+    }
+
+    @Test
+    fun `up to 127 arguments are passed`() {
+        if (!natives.prepareOrSkip()) return
+        natives.withHandle { handle ->
+            check(handle.initialize()) { "initialize failed" }
+            val buffer = MpvCommandBuffer()
+
+            // script-message takes any number of arguments; with no scripts loaded it only succeeds.
+            assertTrue(buffer.command(handle, "script-message", *Array(126) { "argument-$it" }))
+            assertFailsWith<IllegalArgumentException> {
+                buffer.command(handle, "script-message", *Array(127) { "argument-$it" })
+            }
+        }
+    }
+
+    @Test
+    fun `arguments containing NUL are refused`() {
+        if (!natives.prepareOrSkip()) return
+        natives.withHandle { handle ->
+            assertFailsWith<IllegalArgumentException> {
+                MpvCommandBuffer().command(handle, "set", "title", "split\u0000here")
+            }
+        }
+    }
+}
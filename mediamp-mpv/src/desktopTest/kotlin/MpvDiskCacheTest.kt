@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import java.io.File
+import java.io.RandomAccessFile
+import java.nio.file.Files
+import kotlin.test.AfterTest
+import kotlin.test.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertFalse
+import kotlin.test.assertTrue
+
+/**
+ * The persistent tier of the read-ahead cache ([MPVHandle.configureSeekableInputDiskCache]), driven through the test
+ * hooks: what survives reopening, what happens to blocks damaged on disk, and eviction.
+ *
+ * Needs the dev natives (`mediamp.mpv.dev.native.dir`); skipped otherwise.
+ */
+class MpvDiskCacheTest {
+    private val natives = MpvDevNatives("MpvDiskCacheTest")
+    private var directory: File? = null
+
+    @AfterTest
+    fun tearDown() {
+        val directory = directory ?: return
+        MPVHandle.configureSeekableInputDiskCache(null)
+        directory.deleteRecursively()
+    }
+
+    @Test
+    fun `stored blocks are read back after reopening`() {
+        if (!configureOrSkip(budget = 16 * BLOCK)) return
+        val size = 4 * BLOCK + 100
+        TestDiskCache("content", size).use { cache ->
+            cache.write(0, 3, 4)
+        }
+
+        TestDiskCache("content", size).use { cache ->
+            assertEquals(STORED, cache.read(0))
+            assertEquals(STORED, cache.read(3))
+            assertEquals(STORED, cache.read(4), "the last, short block")
+            assertEquals(NOT_STORED, cache.read(1))
+        }
+    }
+
+    @Test
+    fun `a content stored with another size starts over`() {
+        if (!configureOrSkip(budget = 16 * BLOCK)) return
+        TestDiskCache("content", 4 * BLOCK).use { it.write(0) }
+
+        TestDiskCache("content", 5 * BLOCK).use { cache ->
+            assertEquals(NOT_STORED, cache.read(0))
+        }
+    }
+
+    @Test
+    fun `blocks damaged on disk are dropped and stored again`() {
+        if (!configureOrSkip(budget = 16 * BLOCK)) return
+        TestDiskCache("content", 4 * BLOCK).use { it.write(0, 1, 2) }
+
+        RandomAccessFile(blocksFile(), "rw").use { file ->
+            // A torn write in block 0, and a file that ends in the middle of block 1.
+            file.seek(10)
+            file.write(file.read() xor 0xff)
+            file.setLength(BLOCK + BLOCK / 2)
+        }
+
+        TestDiskCache("content", 4 * BLOCK).use { cache ->
+            assertEquals(NOT_STORED, cache.read(0), "corrupted block")
+            assertEquals(NOT_STORED, cache.read(1), "truncated block")
+            assertEquals(NOT_STORED, cache.read(2), "block past the end of the file")
+
+            cache.write(1)
+            assertEquals(STORED, cache.read(1), "a dropped block is not stored again")
+        }
+    }
+
+    @Test
+    fun `least recently used contents are evicted first`() {
+        if (!configureOrSkip(budget = 4 * BLOCK)) return
+        storeTwoContentsAndUseTheFirstAgain()
+
+        TestDiskCache("third", 4 * BLOCK).use { cache ->
+            cache.write(0)
+            assertEquals(STORED, cache.read(0))
+        }
+        TestDiskCache("first", 4 * BLOCK).use { assertEquals(STORED, it.read(0), "the most recently used content") }
+        TestDiskCache("second", 4 * BLOCK).use { assertEquals(NOT_STORED, it.read(0)) }
+    }
+
+    @Test
+    fun `oldest contents are evicted first`() {
+        if (!configureOrSkip(budget = 4 * BLOCK, policy = SeekableInputDiskCachePolicy.OLDEST_FIRST)) return
+        storeTwoContentsAndUseTheFirstAgain()
+
+        TestDiskCache("third", 4 * BLOCK).use { cache ->
+            cache.write(0)
+            assertEquals(STORED, cache.read(0))
+        }
+        TestDiskCache("second", 4 * BLOCK).use { assertEquals(STORED, it.read(0)) }
+        TestDiskCache("first", 4 * BLOCK).use { assertEquals(NOT_STORED, it.read(0), "the oldest content") }
+    }
+
+    @Test
+    fun `open contents are never evicted`() {
+        if (!configureOrSkip(budget = 2 * BLOCK)) return
+        TestDiskCache("open", 4 * BLOCK).use { open ->
+            open.write(0, 1)
+            TestDiskCache("new", 4 * BLOCK).use { new ->
+                new.write(0)
+                assertEquals(NOT_STORED, new.read(0), "stored beyond the budget")
+            }
+            assertEquals(STORED, open.read(0))
+            assertEquals(STORED, open.read(1))
+        }
+    }
+
+    @Test
+    fun `a short last block is counted by its length after a rescan`() {
+        if (!configureOrSkip(budget = 2 * BLOCK)) return
+        TestDiskCache("short", BLOCK + 100).use { it.write(0, 1) }
+        // Reconfiguring rescans the directory, recounting what "short" takes.
+        MPVHandle.configureSeekableInputDiskCache(checkNotNull(directory).absolutePath, 2 * BLOCK)
+
+        TestDiskCache("other", BLOCK - 100).use { cache ->
+            cache.write(0)
+            assertEquals(STORED, cache.read(0))
+        }
+        TestDiskCache("short", BLOCK + 100).use { cache ->
+            assertEquals(STORED, cache.read(0), "evicted although both fit in the budget")
+            assertEquals(STORED, cache.read(1))
+        }
+    }
+
+    @Test
+    fun `files that are not ours are left alone`() {
+        if (!natives.prepareOrSkip()) return
+        val directory = Files.createTempDirectory("mediamp-disk-cache-test").toFile()
+        this.directory = directory
+        val foreign = listOf("notes.index", "notes.blocks", "0123456789abcdeg.index", "0123456789abcdef0.index")
+            .map { File(directory, it).apply { writeText("not a cache index") } }
+        val torn = File(directory, "0123456789abcdef.index").apply { writeText("torn") }
+
+        MPVHandle.configureSeekableInputDiskCache(directory.absolutePath, 4 * BLOCK)
+
+        foreign.forEach { assertTrue(it.exists(), "${it.name} was deleted") }
+        assertFalse(torn.exists(), "a torn index is not removed")
+    }
+
+    @Test
+    fun `a directory with supplementary characters is used as named`() {
+        if (!natives.prepareOrSkip()) return
+        val directory = Files.createTempDirectory("mediamp-disk-cache-test-\uD83C\uDFAC").toFile()
+        this.directory = directory
+        MPVHandle.configureSeekableInputDiskCache(directory.absolutePath, 4 * BLOCK)
+
+        TestDiskCache("content", 4 * BLOCK).use { it.write(0) }
+        assertEquals(1, directory.listFiles { file -> file.name.endsWith(".blocks") }!!.size)
+    }
+
+    /** "first" is stored, then "second", then "first" is used again; together they fill a budget of 4 blocks. */
+    private fun storeTwoContentsAndUseTheFirstAgain() {
+        TestDiskCache("first", 4 * BLOCK).use { it.write(0, 1) }
+        // Timestamps are in milliseconds.
+        Thread.sleep(20)
+        TestDiskCache("second", 4 * BLOCK).use { it.write(0, 1) }
+        Thread.sleep(20)
+        TestDiskCache("first", 4 * BLOCK).use { assertEquals(STORED, it.read(1)) }
+        Thread.sleep(20)
+    }
+
+    private fun configureOrSkip(
+        budget: Long,
+        policy: SeekableInputDiskCachePolicy = SeekableInputDiskCachePolicy.LEAST_RECENTLY_USED,
+    ): Boolean {
+        if (!natives.prepareOrSkip()) return false
+        val directory = Files.createTempDirectory("mediamp-disk-cache-test").toFile()
+        this.directory = directory
+        MPVHandle.configureSeekableInputDiskCache(directory.absolutePath, budget, policy)
+        return true
+    }
+
+    private fun blocksFile(): File =
+        checkNotNull(directory).listFiles { file -> file.name.endsWith(".blocks") }!!.single()
+
+    private class TestDiskCache(contentId: String, size: Long) : AutoCloseable {
+        private val ptr = nTestDiskCacheOpen(contentId, size, BLOCK)
+            .also { check(it != 0L) { "cannot open $contentId" } }
+
+        fun write(vararg blocks: Long) = blocks.forEach { nTestDiskCacheWrite(ptr, it) }
+
+        fun read(block: Long): Int = nTestDiskCacheRead(ptr, block)
+
+        override fun close() = nTestDiskCacheClose(ptr)
+    }
+
+    private companion object {
+        const val BLOCK = 64L * 1024
+        const val STORED = 1
+        const val NOT_STORED = 0
+    }
+}
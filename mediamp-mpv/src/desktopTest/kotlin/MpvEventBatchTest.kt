@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import kotlin.test.AfterTest
+import kotlin.test.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertTrue
+
+/**
+ * Batches written by `event_batch.cpp` and decoded by [EventBatchDispatcher], driven through the test hooks with
+ * synthetic events: what the listener is told, in which order, and when a long batch is flushed early.
+ *
+ * Needs the dev natives (`mediamp.mpv.dev.native.dir`); skipped otherwise.
+ */
+class MpvEventBatchTest {
+    private val natives = MpvDevNatives("MpvEventBatchTest")
+    private val received = ArrayList<String>()
+    private val dispatcher = EventBatchDispatcher(
+        object : NoopEventListener() {
+            override fun onPropertyNone(id: Long, name: String) {
+                received += "$id:$name"
+            }
+
+            override fun onPropertyFlag(id: Long, name: String, value: Boolean) {
+                received += "$id:$name=$value"
+            }
+
+            override fun onPropertyInt64(id: Long, name: String, value: Long) {
+                received += "$id:$name=$value"
+            }
+
+            override fun onPropertyDouble(id: Long, name: String, value: Double) {
+                received += "$id:$name=$value"
+            }
+
+            override fun onPropertyString(id: Long, name: String, value: String) {
+                received += "$id:$name=\"$value\""
+            }
+
+            override fun onEvent(event: Int) {
+                received += "event $event"
+            }
+
+            override fun onStartFile(playlistEntryId: Long) {
+                received += "start $playlistEntryId"
+            }
+
+            override fun onEndFile(reason: Int, mpvError: Int, playlistEntryId: Long) {
+                received += "end $reason $mpvError $playlistEntryId"
+            }
+        },
+    )
+    private var ptr = 0L
+
+    @AfterTest
+    fun tearDown() {
+        if (ptr != 0L) nTestEventBatchDestroy(ptr)
+    }
+
+    @Test
+    fun `records decode in order with their names and values`() {
+        if (!createOrSkip()) return
+        appendEvent(MPVEvent.START_FILE, entryId = 7)
+        appendProperty(1, "pause", MPVFormat.MPV_FORMAT_FLAG, 1)
+        appendProperty(2, "time-pos", MPVFormat.MPV_FORMAT_DOUBLE, 12.5.toRawBits())
+        appendProperty(3, "duration-ms", MPVFormat.MPV_FORMAT_INT64, -2)
+        appendProperty(4, "track-list", MPVFormat.MPV_FORMAT_NONE)
+        appendProperty(2, "time-pos", MPVFormat.MPV_FORMAT_DOUBLE, 13.0.toRawBits())
+        appendEvent(MPVEvent.FILE_LOADED)
+        appendEvent(MPVEvent.END_FILE, reason = 4, error = -13, entryId = 7)
+        nTestEventBatchFlush(ptr, dispatcher)
+
+        assertEquals(
+            listOf(
+                "event ${MPVEvent.START_FILE}",
+                "start 7",
+                "1:pause=true",
+                "2:time-pos=12.5",
+                "3:duration-ms=-2",
+                "4:track-list",
+                "2:time-pos=13.0",
+                "event ${MPVEvent.FILE_LOADED}",
+                "event ${MPVEvent.END_FILE}",
+                "end 4 -13 7",
+            ),
+            received,
+        )
+    }
+
+    @Test
+    fun `strings arrive whole whatever their length`() {
+        if (!createOrSkip()) return
+        // Around the 8-byte record alignment, past the dispatcher's 256-byte scratch array and past the batch's
+        // initial 16 KiB, which makes it reallocate its buffer mid-batch.
+        val values = listOf("", "a", "1234567", "12345678", "123456789", "x".repeat(300), "y".repeat(20_000), "日本語 🎬")
+        for (value in values) {
+            appendProperty(5, "media-title", MPVFormat.MPV_FORMAT_STRING, string = value)
+        }
+        nTestEventBatchFlush(ptr, dispatcher)
+
+        assertEquals(values.map { "5:media-title=\"$it\"" }, received)
+    }
+
+    @Test
+    fun `a batch reaching the threshold is flushed by append and names survive the flush`() {
+        if (!createOrSkip()) return
+        val value = "v".repeat(1024)
+        var appended = 0
+        var sizeBefore = 0
+        while (true) {
+            val size = appendProperty(6, "media-title", MPVFormat.MPV_FORMAT_STRING, string = value)
+            appended++
+            if (size == 0) break
+            assertEquals(emptyList(), received, "flushed below the threshold")
+            sizeBefore = size
+        }
+
+        assertEquals(appended, received.size, "every record appended up to the flush")
+        assertTrue(sizeBefore < FLUSH_THRESHOLD, "$sizeBefore bytes before the flushing append")
+        assertTrue(sizeBefore + 32 + value.length >= FLUSH_THRESHOLD, "$sizeBefore bytes before the flushing append")
+
+        // The name was interned in the flushed batch; the next one refers to it by ID only.
+        received.clear()
+        appendProperty(6, "media-title", MPVFormat.MPV_FORMAT_STRING, string = "after")
+        nTestEventBatchFlush(ptr, dispatcher)
+        assertEquals(listOf("6:media-title=\"after\""), received)
+    }
+
+    private fun createOrSkip(): Boolean {
+        if (!natives.prepareOrSkip()) return false
+        ptr = nTestEventBatchCreate()
+        return true
+    }
+
+    private fun appendEvent(eventId: Int, reason: Int = 0, error: Int = 0, entryId: Long = 0): Int =
+        nTestEventBatchAppendEvent(ptr, eventId, reason, error, entryId, dispatcher)
+
+    private fun appendProperty(
+        replyData: Long,
+        name: String,
+        format: MPVFormat,
+        value: Long = 0,
+        string: String? = null,
+    ): Int = nTestEventBatchAppendProperty(
+        ptr, replyData, name, format.ordinal, value, string?.encodeToByteArray(), dispatcher,
+    )
+
+    private companion object {
+        // event_batch::kFlushThreshold
+        const val FLUSH_THRESHOLD = 64 * 1024
+    }
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import kotlin.test.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertFailsWith
+import kotlin.test.assertFalse
+import kotlin.test.assertSame
+import kotlin.test.assertTrue
+
+/**
+ * Poll-based event delivery ([MPVHandle.openEventRing]) on a handle that is never initialized, so that the test hooks
+ * are the ring's only producer: wraparound, events dropped when the ring is full, reopening, and reading the ring
+ * after the handle is gone.
+ *
+ * Needs the dev natives (`mediamp.mpv.dev.native.dir`); skipped otherwise.
+ */
+class MpvEventRingTest {
+    private val natives = MpvDevNatives("MpvEventRingTest")
+
+    @Test
+    fun `events wrap around the ring in order`() {
+        if (!natives.prepareOrSkip()) return
+        natives.withHandle { handle ->
+            val ring = handle.openEventRing(capacity = 16)
+            assertEquals(16, ring.capacity)
+            val listener = RecordingListener()
+            for (round in 0 until 3) {
+                for (i in 0 until 10) assertTrue(nTestEventRingPush(handle.ptr, PLAYBACK_RESTART, 0))
+                assertEquals(10, ring.poll(listener))
+            }
+            assertEquals(List(30) { "event $PLAYBACK_RESTART" }, listener.calls)
+            assertEquals(0L, ring.droppedEvents)
+        }
+    }
+
+    @Test
+    fun `START_FILE and END_FILE take one record each`() {
+        if (!natives.prepareOrSkip()) return
+        natives.withHandle { handle ->
+            val ring = handle.openEventRing(capacity = 16)
+            for (entry in 1L..8L) {
+                assertTrue(nTestEventRingPush(handle.ptr, START_FILE, entry))
+                assertTrue(nTestEventRingPush(handle.ptr, END_FILE, entry))
+            }
+
+            val listener = RecordingListener()
+            assertEquals(16, ring.poll(listener))
+            val expected = (1L..8L).flatMap { entry ->
+                listOf("event $START_FILE", "start $entry", "event $END_FILE", "end 0 0 $entry")
+            }
+            assertEquals(expected, listener.calls)
+        }
+    }
+
+    @Test
+    fun `events pushed into a full ring are dropped and counted`() {
+        if (!natives.prepareOrSkip()) return
+        natives.withHandle { handle ->
+            val ring = handle.openEventRing(capacity = 16)
+            for (i in 0 until 16) assertTrue(nTestEventRingPush(handle.ptr, START_FILE, i.toLong()))
+            for (i in 16 until 20) assertFalse(nTestEventRingPush(handle.ptr, START_FILE, i.toLong()))
+            assertEquals(4L, ring.droppedEvents)
+
+            val listener = RecordingListener()
+            assertEquals(16, ring.poll(listener))
+            assertEquals("start 15", listener.calls.last(), "a dropped event was delivered")
+            assertTrue(nTestEventRingPush(handle.ptr, START_FILE, 20), "polling did not free the slots")
+        }
+    }
+
+    @Test
+    fun `opening the ring again returns the same ring`() {
+        if (!natives.prepareOrSkip()) return
+        natives.withHandle { handle ->
+            val ring = handle.openEventRing(capacity = 16)
+            for (entry in 1L..3L) assertTrue(nTestEventRingPush(handle.ptr, START_FILE, entry))
+            assertEquals(2, ring.poll(RecordingListener(), maxEvents = 2))
+
+            val reopened = handle.openEventRing(capacity = 1024)
+            assertSame(ring, reopened)
+            assertEquals(16, reopened.capacity)
+            val listener = RecordingListener()
+            assertEquals(1, reopened.poll(listener))
+            assertEquals(listOf("event $START_FILE", "start 3"), listener.calls, "events were read twice")
+        }
+    }
+
+    @Test
+    fun `the ring stays readable after the handle is closed`() {
+        if (!natives.prepareOrSkip()) return
+        val listener = RecordingListener()
+        val ring = natives.withHandle { handle ->
+            val ring = handle.openEventRing(capacity = 16)
+            for (i in 0 until 17) nTestEventRingPush(handle.ptr, PLAYBACK_RESTART, 0)
+            handle.destroy()
+            assertEquals(0, ring.poll(listener), "events were delivered after destroy")
+            ring
+        }
+
+        assertEquals(1L, ring.droppedEvents)
+        assertFailsWith<IllegalStateException> { ring.poll(listener) }
+        assertEquals(emptyList(), listener.calls)
+    }
+
+    private class RecordingListener : NoopEventListener() {
+        val calls = mutableListOf<String>()
+
+        override fun onEvent(event: Int) {
+            calls += "event $event"
+        }
+
+        override fun onStartFile(playlistEntryId: Long) {
+            calls += "start $playlistEntryId"
+        }
+
+        override fun onEndFile(reason: Int, mpvError: Int, playlistEntryId: Long) {
+            calls += "end $reason $mpvError $playlistEntryId"
+        }
+    }
+
+    private companion object {
+        // mpv_event_id
+        const val START_FILE = 6
+        const val END_FILE = 7
+        const val PLAYBACK_RESTART = 21
+    }
+}
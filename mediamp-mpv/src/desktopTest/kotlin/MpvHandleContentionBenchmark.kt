@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import java.util.concurrent.atomic.AtomicBoolean
+import java.util.concurrent.atomic.AtomicLong
+import kotlin.concurrent.thread
+import kotlin.test.Test
+import kotlin.test.assertTrue
+
+/**
+ * Contention benchmark of `mpv_handle_t::handle_lock`: 1 to 8 threads poll properties of one handle while its event
+ * loop delivers `time-pos` changes of playing media, and the poll rates are printed for comparison across changes.
+ * Takes several seconds, so it is not part of the unit tests: run it via `:mediamp-mpv:contentionBenchmark`.
+ *
+ * The polls hold the lock shared. libmpv still serializes property access on its core, so the total rate does not
+ * grow with the threads, but it must not collapse either, as it would behind a lock that the polls take in turn.
+ *
+ * Needs the dev natives (`mediamp.mpv.dev.native.dir`); skipped otherwise.
+ */
+class MpvHandleContentionBenchmark {
+    private val natives = MpvDevNatives("MpvHandleContentionBenchmark")
+
+    @Test
+    fun `property poll throughput holds up with many threads`() {
+        if (System.getProperty("mediamp.mpv.benchmark") != "true") {
+            println("[MpvHandleContentionBenchmark] skipped: run via :mediamp-mpv:contentionBenchmark")
+            return
+        }
+        if (!natives.prepareOrSkip()) return
+        natives.withHandle { handle ->
+            val timeChanges = AtomicLong()
+            handle.setEventListener(
+                object : NoopEventListener() {
+                    override fun onPropertyChange(name: String, value: Double) {
+                        timeChanges.incrementAndGet()
+                    }
+                },
+            )
+            check(handle.initialize()) { "initialize failed" }
+            handle.observeProperty("time-pos", MPVFormat.MPV_FORMAT_DOUBLE, 1)
+            check(handle.command("loadfile", "av://lavfi:testsrc2=size=320x240:rate=60")) { "loadfile failed" }
+
+            val rates = listOf(1, 2, 4, 8).map { threads -> threads to pollRate(handle, threads, millis = 1000) }
+            for ((threads, rate) in rates) {
+                println("[MpvHandleContentionBenchmark] $threads thread(s): $rate polls/s")
+            }
+            println("[MpvHandleContentionBenchmark] time-pos changes delivered meanwhile: ${timeChanges.get()}")
+            val single = rates.first().second
+            assertTrue(single > 0, "no poll completed")
+            assertTrue(rates.all { it.second * 2 >= single }, "the poll rate collapsed under contention: $rates")
+        }
+    }
+
+    /**
+     * Polls from [threads] threads for [millis] and returns the total polls per second.
+     */
+    private fun pollRate(handle: MPVHandle, threads: Int, millis: Long): Long {
+        val polls = AtomicLong()
+        val stop = AtomicBoolean(false)
+        val pollers = List(threads) {
+            thread(name = "mpv-contention-$it") {
+                var count = 0L
+                while (!stop.get()) {
+                    handle.getProperties(MpvHandleContentionTest.POLLED_PROPERTIES)
+                    handle.getPropertyDouble("time-pos")
+                    count += 2
+                }
+                polls.addAndGet(count)
+            }
+        }
+        Thread.sleep(millis)
+        stop.set(true)
+        pollers.forEach { it.join() }
+        return polls.get() * 1000 / millis
+    }
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import java.util.concurrent.CountDownLatch
+import java.util.concurrent.TimeUnit
+import java.util.concurrent.atomic.AtomicBoolean
+import kotlin.concurrent.thread
+import kotlin.test.Test
+import kotlin.test.assertFalse
+import kotlin.test.assertTrue
+
+/**
+ * `mpv_handle_t::handle_lock` under contention: the handle is destroyed while many threads keep polling its
+ * properties. Destroying must not be held off by the polls, and must leave the later ones failing cleanly. The poll
+ * throughput itself is measured by [MpvHandleContentionBenchmark].
+ *
+ * Needs the dev natives (`mediamp.mpv.dev.native.dir`); skipped otherwise.
+ */
+class MpvHandleContentionTest {
+    private val natives = MpvDevNatives("MpvHandleContentionTest")
+
+    @Test
+    fun `destroy is not starved by property polls from many threads`() {
+        if (!natives.prepareOrSkip()) return
+        natives.withHandle { handle ->
+            check(handle.initialize()) { "initialize failed" }
+            check(handle.command("loadfile", "av://lavfi:testsrc2=size=320x240:rate=60")) { "loadfile failed" }
+
+            val stop = AtomicBoolean(false)
+            val started = CountDownLatch(8)
+            val pollers = List(8) {
+                thread(name = "mpv-contention-destroy-$it") {
+                    started.countDown()
+                    while (!stop.get()) {
+                        handle.getProperties(POLLED_PROPERTIES)
+                    }
+                }
+            }
+            try {
+                started.await(5, TimeUnit.SECONDS)
+                val start = System.nanoTime()
+                assertTrue(handle.destroy(), "destroy failed")
+                val millis = TimeUnit.NANOSECONDS.toMillis(System.nanoTime() - start)
+                assertTrue(millis < 5_000, "destroy took $millis ms under the polls")
+            } finally {
+                stop.set(true)
+                pollers.forEach { it.join(5_000) }
+            }
+            assertTrue(pollers.none { it.isAlive }, "a poller hung after destroy")
+            assertFalse(handle.getProperties(POLLED_PROPERTIES).isValid(0), "a destroyed handle still read a property")
+        }
+    }
+
+    internal companion object {
+        val POLLED_PROPERTIES = MPVPropertyBatch(
+            "pause" to MPVFormat.MPV_FORMAT_FLAG,
+            "time-pos" to MPVFormat.MPV_FORMAT_DOUBLE,
+            "volume" to MPVFormat.MPV_FORMAT_DOUBLE,
+        )
+    }
+}
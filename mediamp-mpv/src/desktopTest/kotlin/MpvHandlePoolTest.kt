@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import java.io.File
+import java.util.UUID
+import java.util.concurrent.TimeUnit
+import kotlin.test.AfterTest
+import kotlin.test.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertNotEquals
+
+/**
+ * The pool of initialized handles ([MPVHandle.configurePool], [MPVHandle.createInitialized]): taking an idle handle,
+ * creating one when none is pooled, profiles kept apart, disabling a profile, and giving up on a profile whose
+ * handles cannot be created. Every test pools a profile of its own, told apart by its `title`.
+ *
+ * Needs the dev natives (`mediamp.mpv.dev.native.dir`); skipped otherwise.
+ */
+class MpvHandlePoolTest {
+    private val natives = MpvDevNatives("MpvHandlePoolTest")
+    private val configured = mutableListOf<List<Pair<String, String>>>()
+    private val taken = mutableListOf<MPVHandle>()
+
+    @AfterTest
+    fun tearDown() {
+        for (options in configured) MPVHandle.configurePool(Any(), options, 0)
+        for (handle in taken) {
+            handle.destroy()
+            handle.close()
+        }
+    }
+
+    @Test
+    fun `a pooled handle is taken and replaced`() {
+        if (!natives.prepareOrSkip()) return
+        val options = profile()
+        configure(options, 1)
+        val idle = awaitIdle(options, 1).single()
+
+        val handle = take(options)
+        assertEquals(idle, handle.ptr)
+        assertEquals(options.title, handle.getPropertyString("title"))
+        assertNotEquals(idle, awaitIdle(options, 1).single(), "the taken handle is still pooled")
+    }
+
+    @Test
+    fun `a handle is created when none is pooled`() {
+        if (!natives.prepareOrSkip()) return
+        val options = profile()
+        val handle = take(options)
+        assertEquals(options.title, handle.getPropertyString("title"))
+        assertEquals(0, nTestHandlePoolIdle(options.flat()).size, "an unconfigured profile was pooled")
+    }
+
+    @Test
+    fun `a handle of other options is not taken`() {
+        if (!natives.prepareOrSkip()) return
+        val pooled = profile()
+        configure(pooled, 1)
+        val idle = awaitIdle(pooled, 1).single()
+
+        val other = profile()
+        val handle = take(other)
+        assertNotEquals(idle, handle.ptr)
+        assertEquals(other.title, handle.getPropertyString("title"))
+        assertEquals(listOf(idle), nTestHandlePoolIdle(pooled.flat()).toList())
+    }
+
+    @Test
+    fun `size 0 destroys the idle handles`() {
+        if (!natives.prepareOrSkip()) return
+        val options = profile()
+        configure(options, 2)
+        awaitIdle(options, 2)
+
+        MPVHandle.configurePool(Any(), options, 0)
+        assertEquals(0, nTestHandlePoolIdle(options.flat()).size)
+        Thread.sleep(200)
+        assertEquals(0, nTestHandlePoolIdle(options.flat()).size, "the profile was refilled")
+    }
+
+    @Test
+    fun `a profile that keeps failing is given up`() {
+        if (!natives.prepareOrSkip()) return
+        // Encoding to a format that does not exist: every option is accepted, mpv_initialize fails.
+        val output = File.createTempFile("mediamp-pool", ".mkv").apply { deleteOnExit() }
+        val options = profile() + listOf("o" to output.absolutePath, "of" to "mediamp-no-such-format")
+        configure(options, 1)
+        awaitFailures(options, MAX_FAILURES)
+        if (nTestHandlePoolIdle(options.flat()).isNotEmpty()) {
+            natives.skip("mpv initialized with an unknown output format")
+            return
+        }
+
+        Thread.sleep(200)
+        assertEquals(MAX_FAILURES, nTestHandlePoolFailures(options.flat()), "the profile was retried")
+        assertEquals(0, nTestHandlePoolIdle(options.flat()).size)
+    }
+
+    private fun profile(): List<Pair<String, String>> =
+        listOf("config" to "no", "vo" to "null", "ao" to "null", "idle" to "yes", "title" to UUID.randomUUID().toString())
+
+    private val List<Pair<String, String>>.title: String get() = single { it.first == "title" }.second
+
+    private fun List<Pair<String, String>>.flat(): Array<String> = flatMap { it.toList() }.toTypedArray()
+
+    private fun configure(options: List<Pair<String, String>>, size: Int) {
+        configured += options
+        MPVHandle.configurePool(Any(), options, size)
+    }
+
+    private fun take(options: List<Pair<String, String>>): MPVHandle =
+        MPVHandle.createInitialized(Any(), options).also { taken += it }
+
+    /** Waits up to 10 s for the profile to hold [count] idle handles, and returns them. */
+    private fun awaitIdle(options: List<Pair<String, String>>, count: Int): List<Long> {
+        val deadline = System.nanoTime() + TimeUnit.SECONDS.toNanos(10)
+        while (nTestHandlePoolIdle(options.flat()).size < count && System.nanoTime() < deadline) Thread.sleep(10)
+        return nTestHandlePoolIdle(options.flat()).toList().also { assertEquals(count, it.size, "the pool was not filled") }
+    }
+
+    private fun awaitFailures(options: List<Pair<String, String>>, count: Int) {
+        val deadline = System.nanoTime() + TimeUnit.SECONDS.toNanos(10)
+        while (nTestHandlePoolFailures(options.flat()) < count && System.nanoTime() < deadline) Thread.sleep(10)
+        if (nTestHandlePoolIdle(options.flat()).isNotEmpty()) return
+        assertEquals(count, nTestHandlePoolFailures(options.flat()))
+    }
+
+    private companion object {
+        // kMaxFailures in handle_pool.cpp
+        const val MAX_FAILURES = 3
+    }
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import java.util.concurrent.CopyOnWriteArrayList
+import kotlin.test.AfterTest
+import kotlin.test.Test
+import kotlin.test.assertEquals
+
+/**
+ * Native log thresholds: [MPVHandle.setLogLevel] for one handle, and [MPVHandle.setDefaultLogLevel] for handles created
+ * afterwards and for lines of no handle.
+ *
+ * Needs the dev natives (`mediamp.mpv.dev.native.dir`); skipped otherwise.
+ */
+class MpvLogLevelTest {
+    private val natives = MpvDevNatives("MpvLogLevelTest")
+
+    @AfterTest
+    fun tearDown() {
+        if (natives.dir() == null) return
+        MPVHandle.setDefaultLogLevel(MPVLog.INFO)
+        MPVLog.setHandler(null)
+    }
+
+    @Test
+    fun `a handle's log level applies to its lines only`() {
+        if (!natives.prepareOrSkip()) return
+        val lines = CopyOnWriteArrayList<String>()
+        natives.withHandle { quiet ->
+            natives.withHandle { other ->
+                MPVLog.setHandler { message ->
+                    // The handles' own lines are not this test's business.
+                    if (message.line !in listOf("filtered", "warning", "error")) return@setHandler
+                    if (message.instanceHandle == quiet.ptr) lines += "quiet ${message.line}"
+                    if (message.instanceHandle == other.ptr) lines += "other ${message.line}"
+                }
+                quiet.setLogLevel(MPVLog.ERROR)
+                assertEquals(MPVLog.ERROR, nTestLogThreshold(quiet.ptr))
+                assertEquals(MPVLog.INFO, nTestLogThreshold(other.ptr))
+
+                nTestLogPrint(quiet.ptr, MPVLog.WARN, "filtered")
+                nTestLogPrint(other.ptr, MPVLog.WARN, "warning")
+                // Delivered in order: once this is in, so would be the filtered line.
+                nTestLogPrint(quiet.ptr, MPVLog.ERROR, "error")
+                awaitSize(lines, 2)
+            }
+        }
+        assertEquals(listOf("other warning", "quiet error"), lines)
+    }
+
+    @Test
+    fun `the default log level applies to new handles and to lines of no handle`() {
+        if (!natives.prepareOrSkip()) return
+        natives.withHandle { before ->
+            MPVHandle.setDefaultLogLevel(MPVLog.DEBUG)
+            assertEquals(MPVLog.DEBUG, nTestLogThreshold(0))
+            assertEquals(MPVLog.INFO, nTestLogThreshold(before.ptr), "an existing handle changed its level")
+            natives.withHandle { after ->
+                assertEquals(MPVLog.DEBUG, nTestLogThreshold(after.ptr))
+            }
+        }
+    }
+
+    @Test
+    fun `a closed handle's log level is released`() {
+        if (!natives.prepareOrSkip()) return
+        val ptr = natives.withHandle { handle ->
+            handle.setLogLevel(MPVLog.TRACE)
+            assertEquals(MPVLog.TRACE, nTestLogThreshold(handle.ptr))
+            handle.ptr
+        }
+        assertEquals(MPVLog.INFO, nTestLogThreshold(ptr))
+    }
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import java.io.File
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import kotlin.test.AfterTest
+import kotlin.test.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertFailsWith
+import kotlin.test.assertTrue
+
+/**
+ * [MpvLogRingFile.decode], fed files written by `log_ring_file.cpp` through the test hooks.
+ *
+ * Needs the dev natives (`mediamp.mpv.dev.native.dir`); skipped otherwise.
+ */
+class MpvLogRingFileTest {
+    private val natives = MpvDevNatives("MpvLogRingFileTest")
+    private val file: File = File.createTempFile("mediamp-log-ring-test", ".bin")
+
+    @AfterTest
+    fun tearDown() {
+        file.delete()
+    }
+
+    @Test
+    fun `records decode in order and torn records are skipped`() {
+        if (!natives.prepareOrSkip()) return
+        val before = System.currentTimeMillis() * 1_000_000
+        writeRing(capacity = MIN_CAPACITY) { ring ->
+            nTestLogRingWrite(ring, 0x1234, MPVLog.WARN, "ffmpeg/demuxer", "first\n")
+            nTestLogRingWrite(ring, 0x1234, MPVLog.INFO, "ffmpeg/demuxer", "torn")
+            nTestLogRingWrite(ring, 0x1234, MPVLog.ERROR, "ffmpeg/demuxer", "日本語")
+        }
+        val after = System.currentTimeMillis() * 1_000_000
+
+        // Tear the second record as a crash in the middle of writing it would: its position field, which is written
+        // last, does not match yet. The first record ("first\n") takes 48 bytes.
+        val bytes = file.readBytes()
+        val dataOffset = ByteBuffer.wrap(bytes).order(ByteOrder.LITTLE_ENDIAN).getInt(12)
+        bytes[dataOffset + 48] = (bytes[dataOffset + 48].toInt() xor 0xff).toByte()
+
+        val records = MpvLogRingFile.decode(bytes)
+
+        assertEquals(listOf("first", "日本語"), records.map { it.line })
+        assertEquals(listOf(MPVLog.WARN, MPVLog.ERROR), records.map { it.level })
+        assertEquals("ffmpeg/demuxer", records[0].prefix)
+        assertEquals(0x1234L, records[0].instanceHandle)
+        assertTrue(records[0].timeEpochNanos in before - 1_000_000..after + 1_000_000, "${records[0].timeEpochNanos}")
+    }
+
+    @Test
+    fun `a wrapped ring keeps only the records of its last capacity bytes`() {
+        if (!natives.prepareOrSkip()) return
+        // 56 bytes a record: the ring wraps twice.
+        writeRing(capacity = MIN_CAPACITY) { ring ->
+            repeat(3000) { nTestLogRingWrite(ring, 0, MPVLog.INFO, "cplayer", line(it)) }
+        }
+
+        val lines = MpvLogRingFile.decode(file.readBytes()).map { it.line }
+
+        assertTrue(lines.size in 1 until 3000, "${lines.size} records")
+        assertEquals((3000 - lines.size until 3000).map(::line), lines)
+    }
+
+    @Test
+    fun `a file name with supplementary characters is used as named`() {
+        if (!natives.prepareOrSkip()) return
+        val named = File(file.parentFile, "mediamp-log-ring-test-\uD83D\uDCDD-${System.nanoTime()}.bin")
+        try {
+            writeRing(capacity = MIN_CAPACITY, file = named) { ring ->
+                nTestLogRingWrite(ring, 0, MPVLog.INFO, "cplayer", "named")
+            }
+            assertEquals(listOf("named"), MpvLogRingFile.decode(named.readBytes()).map { it.line })
+        } finally {
+            named.delete()
+        }
+    }
+
+    @Test
+    fun `other files are rejected`() {
+        assertFailsWith<IllegalArgumentException> { MpvLogRingFile.decode(ByteArray(128)) }
+    }
+
+    private fun line(index: Int) = "line %04d".format(index)
+
+    private inline fun writeRing(capacity: Long, file: File = this.file, block: (ring: Long) -> Unit) {
+        val ring = nTestLogRingOpen(file.absolutePath.encodeToByteArray(), capacity)
+        check(ring != 0L) { "cannot open the ring file" }
+        try {
+            block(ring)
+        } finally {
+            nTestLogRingClose(ring)
+        }
+    }
+
+    private companion object {
+        // What log_ring_file rounds smaller capacities up to.
+        const val MIN_CAPACITY = 64L * 1024
+    }
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import java.util.concurrent.CopyOnWriteArrayList
+import kotlin.test.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertFalse
+import kotlin.test.assertNull
+import kotlin.test.assertTrue
+
+/**
+ * The native log path: the bounded queue between the logging threads and the drain thread (`log_queue.h`), driven
+ * through the test hooks, and the drain thread delivering lines and the filter's summaries to [MPVLog].
+ *
+ * Needs the dev natives (`mediamp.mpv.dev.native.dir`); skipped otherwise.
+ */
+class MpvNativeLogQueueTest {
+    private val natives = MpvDevNatives("MpvNativeLogQueueTest")
+
+    @Test
+    fun `lines are popped in the order they were pushed, across wraparound`() {
+        if (!natives.prepareOrSkip()) return
+        withQueue { queue ->
+            var pushed = 0
+            var popped = 0
+            repeat(5) {
+                repeat(700) { assertTrue(nTestLogQueuePush(queue, "line ${pushed++}")) }
+                while (true) {
+                    val line = nTestLogQueuePop(queue) ?: break
+                    assertEquals("line ${popped++}", line)
+                }
+            }
+            assertEquals(pushed, popped)
+            assertEquals(0L, nTestLogQueueDropped(queue))
+        }
+    }
+
+    @Test
+    fun `lines pushed into a full queue are dropped and counted`() {
+        if (!natives.prepareOrSkip()) return
+        withQueue { queue ->
+            repeat(CAPACITY) { assertTrue(nTestLogQueuePush(queue, "line $it")) }
+            assertFalse(nTestLogQueuePush(queue, "dropped 1"))
+            assertFalse(nTestLogQueuePush(queue, "dropped 2"))
+            assertEquals(2L, nTestLogQueueDropped(queue))
+
+            assertEquals("line 0", nTestLogQueuePop(queue))
+            assertTrue(nTestLogQueuePush(queue, "after"), "popping did not free a slot")
+            repeat(CAPACITY - 1) { assertEquals("line ${it + 1}", nTestLogQueuePop(queue)) }
+            assertEquals("after", nTestLogQueuePop(queue))
+            assertNull(nTestLogQueuePop(queue))
+        }
+    }
+
+    @Test
+    fun `the drain thread delivers lines in order`() {
+        if (!natives.prepareOrSkip()) return
+        val prefix = "drain-test-order"
+        val lines = captureLines(prefix) {
+            repeat(200) { nTestLogForward(MPVLog.WARN, prefix, "line $it") }
+            awaitSize(it, 200)
+        }
+        assertEquals(List(200) { "line $it" }, lines)
+    }
+
+    @Test
+    fun `the drain thread wakes up on its own for a summary that is due`() {
+        if (!natives.prepareOrSkip()) return
+        val prefix = "drain-test-summary"
+        val lines = captureLines(prefix) {
+            repeat(4) { nTestLogForward(MPVLog.WARN, prefix, "the same line") }
+            // Nothing is logged after the repeats: only the filter's deadline can get the summary out.
+            awaitSize(it, 2)
+        }
+        assertEquals(listOf("the same line", "last message repeated 3 times"), lines)
+    }
+
+    private fun withQueue(block: (Long) -> Unit) {
+        val queue = nTestLogQueueCreate()
+        try {
+            block(queue)
+        } finally {
+            nTestLogQueueDestroy(queue)
+        }
+    }
+
+    /** Runs [block] with [MPVLog] capturing the lines of [prefix], and returns them. */
+    private fun captureLines(prefix: String, block: (MutableList<String>) -> Unit): List<String> {
+        val lines = CopyOnWriteArrayList<String>()
+        MPVLog.setHandler { message -> if (message.prefix == prefix) lines += message.line }
+        try {
+            block(lines)
+        } finally {
+            MPVLog.setHandler(null)
+        }
+        return lines
+    }
+
+    private companion object {
+        // log_queue::kCapacity
+        const val CAPACITY = 1024
+    }
+}
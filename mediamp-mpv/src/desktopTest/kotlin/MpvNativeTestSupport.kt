@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import org.openani.mediamp.io.SeekableInput
+import java.io.File
+import java.io.RandomAccessFile
+import java.util.Collections
+import java.util.concurrent.CountDownLatch
+import java.util.concurrent.TimeUnit
+import java.util.concurrent.atomic.AtomicInteger
+
+/**
+ * Setup shared by the tests that need the dev natives (`mediamp.mpv.dev.native.dir`): they are skipped when the
+ * natives are not there, unless `mediamp.mpv.test.required` makes that a failure.
+ */
+internal class MpvDevNatives(private val testName: String) {
+    fun dir(): File? =
+        System.getProperty("mediamp.mpv.dev.native.dir")
+            ?.let(::File)
+            ?.takeIf {
+                it.resolve("libmediampv.dylib").isFile || it.resolve("libmediampv.so").isFile ||
+                        it.resolve("mediampv.dll").isFile
+            }
+
+    /** Reports [reason] and returns false, or fails when the runner requires the mpv tests. */
+    fun skip(reason: String): Boolean {
+        System.err.println("[$testName] setup skipped: $reason")
+        check(System.getProperty("mediamp.mpv.test.required") != "true") {
+            "mpv tests are required on this runner but $testName would be skipped: $reason"
+        }
+        return false
+    }
+
+    /** Loads the dev natives; returns false when the test has to be skipped. */
+    fun prepareOrSkip(): Boolean {
+        val dir = dir()
+            ?: return skip(
+                "dev native dir not usable " +
+                        "(mediamp.mpv.dev.native.dir=${System.getProperty("mediamp.mpv.dev.native.dir")})",
+            )
+        runCatching { MpvMediampPlayer.prepareLibraries(dir.absolutePath, extractRuntimeLibrary = false) }
+            .onFailure { return skip("prepareLibraries failed: $it") }
+        return true
+    }
+
+    /**
+     * An uninitialized handle without config files, video or audio output, for [block] to configure; destroyed and
+     * closed afterwards.
+     */
+    inline fun <R> withHandle(block: (MPVHandle) -> R): R {
+        val handle = MPVHandle(Any())
+        try {
+            handle.option("config", "no")
+            handle.option("vo", "null")
+            handle.option("ao", "null")
+            handle.option("idle", "yes")
+            return block(handle)
+        } finally {
+            handle.destroy()
+            handle.close()
+        }
+    }
+
+    // Same discovery as MpvMediampPlayerSmokeTest.
+    fun findFfmpeg(): String? =
+        listOfNotNull(
+            dir()?.resolve("ffmpeg.exe")?.absolutePath,
+            "/opt/homebrew/bin/ffmpeg",
+            "/usr/local/bin/ffmpeg",
+            "/usr/bin/ffmpeg",
+            "ffmpeg",
+            "ffmpeg.exe",
+        ).firstOrNull { runCatching { ProcessBuilder(it, "-version").start().waitFor() }.getOrNull() == 0 }
+
+    /**
+     * A 10 s Matroska file with video, audio and an interleaved subtitle track, the layout that makes mpv read in
+     * small pieces; `null` when ffmpeg is unavailable.
+     */
+    fun interleavedTestVideo(): File? {
+        val target = File(System.getProperty("java.io.tmpdir"), "mediamp-mpv-interleaved.mkv")
+        if (target.isFile && target.length() > 0) return target
+        val subtitles = File(System.getProperty("java.io.tmpdir"), "mediamp-mpv-interleaved.srt")
+        subtitles.writeText(
+            (0 until 10).joinToString("\n") { i ->
+                "${i + 1}\n00:00:0$i,000 --> 00:00:0$i,900\nline $i\n"
+            },
+        )
+        val ffmpeg = findFfmpeg() ?: return null
+        val process = ProcessBuilder(
+            ffmpeg, "-y",
+            "-f", "lavfi", "-i", "testsrc2=size=640x360:rate=30",
+            "-f", "lavfi", "-i", "sine=frequency=440:sample_rate=44100",
+            "-i", subtitles.absolutePath,
+            "-map", "0:v", "-map", "1:a", "-map", "2:s",
+            "-t", "10", "-c:v", "mpeg4", "-q:v", "3", "-c:a", "aac", "-c:s", "srt",
+            target.absolutePath,
+        ).redirectErrorStream(true).start()
+        process.inputStream.readAllBytes()
+        if (!process.waitFor(60, TimeUnit.SECONDS) || process.exitValue() != 0) return null
+        return target
+    }
+}
+
+/**
+ * Waits up to 5 s for [list], filled on another thread, to hold [count] elements. Tests then assert on what it holds.
+ */
+internal fun awaitSize(list: List<*>, count: Int) {
+    val deadline = System.nanoTime() + TimeUnit.SECONDS.toNanos(5)
+    while (list.size < count && System.nanoTime() < deadline) Thread.sleep(10)
+}
+
+/**
+ * [EventListener] that ignores everything; tests override what they wait for.
+ */
+internal open class NoopEventListener : EventListener {
+    override fun onPropertyChange(name: String) {}
+    override fun onPropertyChange(name: String, value: Boolean) {}
+    override fun onPropertyChange(name: String, value: Long) {}
+    override fun onPropertyChange(name: String, value: Double) {}
+    override fun onPropertyChange(name: String, value: String) {}
+    override fun onEvent(event: Int) {}
+    override fun onStartFile(playlistEntryId: Long) {}
+    override fun onEndFile(reason: Int, mpvError: Int, playlistEntryId: Long) {}
+}
+
+/**
+ * Listener whose [load] waits for `MPV_EVENT_FILE_LOADED`, and [stop] for `MPV_EVENT_END_FILE`.
+ */
+internal class FileLoadedListener : NoopEventListener() {
+    private val loaded = CountDownLatch(1)
+    private val ended = CountDownLatch(1)
+
+    @Volatile
+    var endReason: Int = -1
+        private set
+
+    override fun onEvent(event: Int) {
+        if (event == MPVEvent.FILE_LOADED) loaded.countDown()
+    }
+
+    override fun onEndFile(reason: Int, mpvError: Int, playlistEntryId: Long) {
+        endReason = reason
+        loaded.countDown()
+        ended.countDown()
+    }
+
+    /**
+     * Loads [uri] on [handle], which must have this listener set, and waits until it is loaded; fails when the file
+     * ends first or does not load within [timeoutSeconds].
+     */
+    fun load(handle: MPVHandle, uri: String, timeoutSeconds: Long = 20) {
+        check(handle.command("loadfile", uri)) { "loadfile failed" }
+        check(loaded.await(timeoutSeconds, TimeUnit.SECONDS)) { "$uri was not loaded within ${timeoutSeconds}s" }
+        check(endReason < 0) { "$uri ended before it was loaded, reason=$endReason" }
+    }
+
+    /** Stops playback and waits until the file has ended, so that mpv no longer reads it. */
+    fun stop(handle: MPVHandle, timeoutSeconds: Long = 20) {
+        check(handle.command("stop")) { "stop failed" }
+        check(ended.await(timeoutSeconds, TimeUnit.SECONDS)) { "file did not end within ${timeoutSeconds}s" }
+    }
+}
+
+/**
+ * [SeekableInput] over a local file that records what is done to it. It does not expose the file's path, so mpv
+ * reads it through the stream_cb bridge rather than natively.
+ */
+internal open class RecordingFileInput(file: File) : SeekableInput {
+    private val raf = RandomAccessFile(file, "r")
+    private val fileSize = raf.length()
+
+    val reads = AtomicInteger()
+    val seeks = AtomicInteger()
+
+    /** `read@<position>` and `seek@<position>`, in call order. */
+    val operations: MutableList<String> = Collections.synchronizedList(mutableListOf())
+
+    /** Names of the threads [read] was called on. */
+    val readThreads: MutableSet<String> = Collections.synchronizedSet(mutableSetOf())
+
+    override val position: Long get() = raf.filePointer
+    override val bytesRemaining: Long get() = fileSize - raf.filePointer
+    override val size: Long get() = fileSize
+
+    override fun seekTo(position: Long) {
+        seeks.incrementAndGet()
+        operations += "seek@$position"
+        raf.seek(position)
+    }
+
+    override fun read(buffer: ByteArray, offset: Int, length: Int): Int {
+        reads.incrementAndGet()
+        operations += "read@${raf.filePointer}"
+        readThreads += Thread.currentThread().name
+        return raf.read(buffer, offset, length)
+    }
+
+    override fun close() = raf.close()
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import org.openani.mediamp.mpv.internal.decodeMpvNode
+import kotlin.test.Test
+import kotlin.test.assertContentEquals
+import kotlin.test.assertEquals
+import kotlin.test.assertNull
+
+/**
+ * The decoder of the flattened `mpv_node` encoding ([MPVHandle.getPropertyNode]), fed what `flatten_node` writes for
+ * a fixed tree built natively (see `nTestFlattenNode`).
+ *
+ * Needs the dev natives (`mediamp.mpv.dev.native.dir`); skipped otherwise.
+ */
+class MpvNodeDecodingTest {
+    private val natives = MpvDevNatives("MpvNodeDecodingTest")
+
+    @Test
+    fun `every format decodes to its Kotlin type`() {
+        val node = decodeOrSkip() ?: return
+
+        assertNull(node["none"])
+        assertEquals("日本語", node["string"])
+        assertEquals(true, node["flag"])
+        assertEquals(-2L, node["int64"])
+        assertEquals(12.5, node["double"])
+        assertContentEquals(byteArrayOf(1, 2, 3), node["bytes"] as ByteArray)
+        assertNull(node["osd"], "formats a node cannot hold are written as none")
+        assertEquals(emptyList<Any?>(), node["empty"])
+    }
+
+    @Test
+    fun `track list decodes as a list of maps in order`() {
+        val node = decodeOrSkip() ?: return
+
+        assertEquals(listOf("none", "string", "flag", "int64", "double", "bytes", "osd", "empty", "tracks"), node.keys.toList())
+        val tracks = node["tracks"] as List<*>
+        assertEquals(
+            listOf(
+                mapOf("id" to 1L, "type" to "audio", "selected" to true),
+                mapOf("id" to 2L, "lang" to "jpn"),
+            ),
+            tracks,
+        )
+        assertEquals(listOf("id", "type", "selected"), (tracks[0] as Map<*, *>).keys.toList())
+    }
+
+    private fun decodeOrSkip(): Map<*, *>? {
+        if (!natives.prepareOrSkip()) return null
+        return decodeMpvNode(nTestFlattenNode()) as Map<*, *>
+    }
+}
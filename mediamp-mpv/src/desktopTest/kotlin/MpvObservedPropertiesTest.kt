@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import java.util.Collections
+import kotlin.test.Test
+import kotlin.test.assertEquals
+
+/**
+ * The properties [MpvMediampPlayer] observes ([MPV_OBSERVED_PROPERTIES]) reach a listener through the keyed callbacks,
+ * under the ID they were observed with, which is what the player's listener dispatches on.
+ *
+ * Needs the dev natives (`mediamp.mpv.dev.native.dir`); skipped otherwise.
+ */
+class MpvObservedPropertiesTest {
+    private val natives = MpvDevNatives("MpvObservedPropertiesTest")
+
+    @Test
+    fun `every observed property arrives keyed by its ID`() {
+        if (!natives.prepareOrSkip()) return
+        val keyed = Collections.synchronizedList(ArrayList<Pair<Long, String>>())
+        val unkeyed = Collections.synchronizedList(ArrayList<String>())
+        natives.withHandle { handle ->
+            handle.setEventListener(
+                object : NoopEventListener() {
+                    override fun onPropertyChange(name: String) {
+                        unkeyed += name
+                    }
+
+                    override fun onPropertyChange(name: String, value: Boolean) {
+                        unkeyed += name
+                    }
+
+                    override fun onPropertyChange(name: String, value: Long) {
+                        unkeyed += name
+                    }
+
+                    override fun onPropertyChange(name: String, value: Double) {
+                        unkeyed += name
+                    }
+
+                    override fun onPropertyChange(name: String, value: String) {
+                        unkeyed += name
+                    }
+
+                    override fun onPropertyNone(id: Long, name: String) {
+                        keyed += id to name
+                    }
+
+                    override fun onPropertyFlag(id: Long, name: String, value: Boolean) {
+                        keyed += id to name
+                    }
+
+                    override fun onPropertyInt64(id: Long, name: String, value: Long) {
+                        keyed += id to name
+                    }
+
+                    override fun onPropertyDouble(id: Long, name: String, value: Double) {
+                        keyed += id to name
+                    }
+
+                    override fun onPropertyString(id: Long, name: String, value: String) {
+                        keyed += id to name
+                    }
+                },
+            )
+            check(handle.initialize()) { "initialize failed" }
+            for (property in MPV_OBSERVED_PROPERTIES) {
+                check(handle.observeProperty(property.name, property.format, property.id, property.maxRateHz)) {
+                    "cannot observe ${property.name}"
+                }
+            }
+
+            // mpv reports every observed property once right away, as unavailable while nothing is loaded.
+            val expected = MPV_OBSERVED_PROPERTIES.associate { it.id to it.name }
+            assertEquals(MPV_OBSERVED_PROPERTIES.size, expected.size, "IDs must be distinct")
+            val deadline = System.nanoTime() + 5_000_000_000L
+            while (synchronized(keyed) { keyed.map { it.first }.toSet() } != expected.keys &&
+                System.nanoTime() < deadline
+            ) {
+                Thread.sleep(10)
+            }
+
+            assertEquals(expected, synchronized(keyed) { keyed.toMap() })
+            assertEquals(emptyList(), unkeyed.toList())
+        }
+    }
+}
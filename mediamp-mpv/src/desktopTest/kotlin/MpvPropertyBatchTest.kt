@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import org.openani.mediamp.mpv.MPVFormat.MPV_FORMAT_DOUBLE
+import org.openani.mediamp.mpv.MPVFormat.MPV_FORMAT_FLAG
+import org.openani.mediamp.mpv.MPVFormat.MPV_FORMAT_INT64
+import kotlin.test.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertFailsWith
+import kotlin.test.assertFalse
+import kotlin.test.assertNull
+import kotlin.test.assertTrue
+
+/**
+ * [MPVHandle.getProperties] on a live handle: values by format, and which properties are reported as not read.
+ *
+ * The tests reading properties need the dev natives (`mediamp.mpv.dev.native.dir`); they are skipped otherwise.
+ */
+class MpvPropertyBatchTest {
+    private val natives = MpvDevNatives("MpvPropertyBatchTest")
+
+    @Test
+    fun `values are read by format and unreadable properties have none`() {
+        if (!natives.prepareOrSkip()) return
+        natives.withHandle { handle ->
+            initialize(handle)
+            val values = handle.getProperties(
+                MPVPropertyBatch(
+                    "pause" to MPV_FORMAT_FLAG,
+                    "osd-level" to MPV_FORMAT_INT64,
+                    "volume" to MPV_FORMAT_DOUBLE,
+                    "width" to MPV_FORMAT_INT64,
+                    "no-such-property" to MPV_FORMAT_FLAG,
+                    // Longer than the native side copies keys into; reported as not read.
+                    "x".repeat(4096) to MPV_FORMAT_INT64,
+                    "volume" to MPV_FORMAT_DOUBLE,
+                ),
+            )
+
+            assertEquals(true, values.getBoolean(0))
+            assertEquals(3, values.getInt(1))
+            assertEquals(42.5, values.getDouble(2))
+            assertNull(values.getLong(3), "width while nothing is loaded")
+            assertNull(values.getBoolean(4))
+            assertNull(values.getLong(5))
+            assertEquals(42.5, values.getDouble(6), "a property after an unread one")
+        }
+    }
+
+    @Test
+    fun `the 64th property has its own bit`() {
+        if (!natives.prepareOrSkip()) return
+        natives.withHandle { handle ->
+            initialize(handle)
+            val values = handle.getProperties(
+                MPVPropertyBatch(
+                    *Array(MPVPropertyBatch.MAX_SIZE) {
+                        (if (it == 62) "no-such-property" else "volume") to MPV_FORMAT_DOUBLE
+                    },
+                ),
+            )
+
+            assertTrue(values.isValid(63))
+            assertEquals(42.5, values.getDouble(63))
+            assertFalse(values.isValid(62))
+            assertTrue((0 until 62).all { values.isValid(it) })
+        }
+    }
+
+    @Test
+    fun `batches are limited to formats and sizes the native side reads`() {
+        assertFailsWith<IllegalArgumentException> { MPVPropertyBatch("media-title" to MPVFormat.MPV_FORMAT_STRING) }
+        assertFailsWith<IllegalArgumentException> {
+            MPVPropertyBatch(*Array(MPVPropertyBatch.MAX_SIZE + 1) { "p$it" to MPV_FORMAT_INT64 })
+        }
+        assertEquals(2, MPVPropertyBatch("pause" to MPV_FORMAT_FLAG, "volume" to MPV_FORMAT_DOUBLE).size)
+    }
+
+    private fun initialize(handle: MPVHandle) {
+        check(handle.initialize()) { "initialize failed" }
+        check(handle.setPropertyBoolean("pause", true))
+        check(handle.setPropertyInt("osd-level", 3))
+        check(handle.setPropertyDouble("volume", 42.5))
+    }
+}
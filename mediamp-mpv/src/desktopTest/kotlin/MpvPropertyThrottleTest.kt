@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import kotlin.test.AfterTest
+import kotlin.test.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertFalse
+import kotlin.test.assertTrue
+
+/**
+ * The rate limits of [MPVHandle.observeProperty]'s `maxRateHz` and `epsilon`, driven through the test hooks with
+ * synthetic property changes and explicit time points, so that nothing depends on the speed of the machine.
+ *
+ * Needs the dev natives (`mediamp.mpv.dev.native.dir`); skipped otherwise.
+ */
+class MpvPropertyThrottleTest {
+    private val natives = MpvDevNatives("MpvPropertyThrottleTest")
+    private var ptr = 0L
+
+    @AfterTest
+    fun tearDown() {
+        if (ptr != 0L) nTestThrottleDestroy(ptr)
+    }
+
+    @Test
+    fun `changes within the interval are coalesced into the latest`() {
+        if (!createOrSkip()) return
+        nTestThrottleConfigure(ptr, 1, minIntervalNanos = 100 * MS, epsilon = 0.0)
+
+        assertTrue(admit(1, "time-pos", 1.0, at = 0), "the first change")
+        assertFalse(admit(1, "time-pos", 1.1, at = 10 * MS))
+        assertFalse(admit(1, "time-pos", 1.2, at = 20 * MS))
+        assertEquals(0.05, nTestThrottleWaitTimeout(ptr, 50 * MS), 1e-9)
+
+        assertEquals("", nTestThrottleFlushDue(ptr, 99 * MS))
+        assertEquals("1:time-pos=1.2", nTestThrottleFlushDue(ptr, 100 * MS))
+        assertEquals(-1.0, nTestThrottleWaitTimeout(ptr, 100 * MS), "nothing pending")
+
+        // The interval runs from the flushed delivery.
+        assertFalse(admit(1, "time-pos", 1.3, at = 150 * MS))
+        assertEquals("1:time-pos=1.3", nTestThrottleFlushDue(ptr, 200 * MS))
+    }
+
+    @Test
+    fun `changes smaller than epsilon are dropped`() {
+        if (!createOrSkip()) return
+        nTestThrottleConfigure(ptr, 2, minIntervalNanos = 0, epsilon = 0.5)
+        assertTrue(admit(2, "volume", 10.0, at = 0))
+        assertFalse(admit(2, "volume", 10.2, at = MS))
+        assertTrue(admit(2, "volume", 10.6, at = 2 * MS))
+
+        nTestThrottleConfigure(ptr, 3, minIntervalNanos = 100 * MS, epsilon = 0.5)
+        assertTrue(admit(3, "speed", 1.0, at = 0))
+        assertFalse(admit(3, "speed", 2.0, at = 10 * MS))
+        assertFalse(admit(3, "speed", 1.1, at = 20 * MS), "back within epsilon of the delivered value")
+        assertEquals("", nTestThrottleFlushDue(ptr, 1000 * MS), "the pending change was moot")
+        assertEquals(-1.0, nTestThrottleWaitTimeout(ptr, 1000 * MS))
+    }
+
+    @Test
+    fun `properties without a limit pass through`() {
+        if (!createOrSkip()) return
+        assertTrue(admit(4, "other", 1.0, at = 0))
+        assertTrue(admit(4, "other", 1.0, at = 0))
+
+        nTestThrottleConfigure(ptr, 5, minIntervalNanos = 100 * MS, epsilon = 0.0)
+        assertTrue(admit(5, "time-pos", 1.0, at = 0))
+        assertFalse(admit(5, "time-pos", 2.0, at = MS))
+        nTestThrottleConfigure(ptr, 5, minIntervalNanos = 0, epsilon = 0.0)
+        assertTrue(admit(5, "time-pos", 3.0, at = 2 * MS), "after the limit was removed")
+        assertEquals("", nTestThrottleFlushDue(ptr, 1000 * MS), "removed with its limit")
+    }
+
+    @Test
+    fun `a property becoming unavailable is delivered without data`() {
+        if (!createOrSkip()) return
+        nTestThrottleConfigure(ptr, 6, minIntervalNanos = 100 * MS, epsilon = 0.0)
+        assertTrue(nTestThrottleAdmitString(ptr, 6, "media-title", "title", 0))
+        assertFalse(nTestThrottleAdmitString(ptr, 6, "media-title", null, 10 * MS))
+        assertEquals("6:media-title", nTestThrottleFlushDue(ptr, 100 * MS))
+    }
+
+    @Test
+    fun `each property is due after its own interval`() {
+        if (!createOrSkip()) return
+        nTestThrottleConfigure(ptr, 7, minIntervalNanos = 100 * MS, epsilon = 0.0)
+        nTestThrottleConfigure(ptr, 8, minIntervalNanos = 50 * MS, epsilon = 0.0)
+        assertTrue(admit(7, "slow", 1.0, at = 0))
+        assertTrue(admit(8, "fast", 1.0, at = 0))
+        assertFalse(admit(7, "slow", 2.0, at = 10 * MS))
+        assertFalse(admit(8, "fast", 2.0, at = 10 * MS))
+
+        assertEquals(0.04, nTestThrottleWaitTimeout(ptr, 10 * MS), 1e-9, "until the sooner one is due")
+        assertEquals("8:fast=2", nTestThrottleFlushDue(ptr, 60 * MS))
+        assertEquals("7:slow=2", nTestThrottleFlushDue(ptr, 100 * MS))
+    }
+
+    @Test
+    fun `a pending change is delivered before the event that follows it`() {
+        if (!createOrSkip()) return
+        nTestThrottleConfigure(ptr, 9, minIntervalNanos = 100 * MS, epsilon = 0.0)
+        assertTrue(admit(9, "time-pos", 1.0, at = 0))
+        assertFalse(admit(9, "time-pos", 1.1, at = 10 * MS))
+
+        // The event loop takes a PLAYBACK_RESTART at 20 ms, long before the change is due.
+        assertEquals("9:time-pos=1.1", nTestThrottleFlushPending(ptr, 20 * MS))
+        assertEquals(-1.0, nTestThrottleWaitTimeout(ptr, 20 * MS), "nothing pending")
+        assertEquals("", nTestThrottleFlushDue(ptr, 1000 * MS), "delivered twice")
+
+        // The interval runs from the flushed delivery.
+        assertFalse(admit(9, "time-pos", 5.0, at = 30 * MS))
+        assertEquals("9:time-pos=5", nTestThrottleFlushDue(ptr, 120 * MS))
+    }
+
+    @Test
+    fun `pending changes are dropped when the file ends`() {
+        if (!createOrSkip()) return
+        nTestThrottleConfigure(ptr, 10, minIntervalNanos = 100 * MS, epsilon = 0.0)
+        assertTrue(admit(10, "time-pos", 1.0, at = 0))
+        assertFalse(admit(10, "time-pos", 1.1, at = 10 * MS))
+
+        nTestThrottleDropPending(ptr)
+        assertEquals("", nTestThrottleFlushPending(ptr, 20 * MS))
+        assertEquals("", nTestThrottleFlushDue(ptr, 1000 * MS))
+        assertEquals(-1.0, nTestThrottleWaitTimeout(ptr, 1000 * MS))
+    }
+
+    private fun createOrSkip(): Boolean {
+        if (!natives.prepareOrSkip()) return false
+        ptr = nTestThrottleCreate()
+        return true
+    }
+
+    private fun admit(replyData: Long, name: String, value: Double, at: Long): Boolean =
+        nTestThrottleAdmitDouble(ptr, replyData, name, value, at)
+
+    private companion object {
+        const val MS = 1_000_000L
+    }
+}
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import java.util.UUID
+import kotlin.test.Test
+import kotlin.test.assertEquals
+
+/**
+ * The native read-ahead cache behind [MPVHandle.registerSeekableInput]'s `readAheadSize`, driven through the test
+ * hooks over a synthetic source: sharing between inputs with the same `cacheKey`, when shared blocks are dropped,
+ * per-reader cancellation, interrupted and failing fetches, and LRU eviction.
+ *
+ * Needs the dev natives (`mediamp.mpv.dev.native.dir`); skipped otherwise.
+ */
+class MpvReadAheadCacheTest {
+    private val natives = MpvDevNatives("MpvReadAheadCacheTest")
+
+    @Test
+    fun `caches with the same key share fetched blocks`() {
+        if (!natives.prepareOrSkip()) return
+        val key = uniqueKey()
+        TestReadAheadCache(key).use { first ->
+            first.readBlocks(first.openReader(), 0 until 4)
+            assertEquals(4L, first.fetches())
+
+            TestReadAheadCache(key).use { second ->
+                second.readBlocks(second.openReader(), 0 until 4)
+                assertEquals(0L, second.fetches(), "blocks the first cache fetched were fetched again")
+            }
+        }
+    }
+
+    @Test
+    fun `shared blocks are dropped with the last cache of their key`() {
+        if (!natives.prepareOrSkip()) return
+        val key = uniqueKey()
+        val second = TestReadAheadCache(key)
+        second.use {
+            TestReadAheadCache(key).use { first -> first.readBlocks(first.openReader(), 0 until 2) }
+            // The first cache is gone, but the key is still referenced.
+            second.readBlocks(second.openReader(), 0 until 2)
+            assertEquals(0L, second.fetches())
+        }
+
+        TestReadAheadCache(key).use { third ->
+            third.readBlocks(third.openReader(), 0 until 1)
+            assertEquals(1L, third.fetches(0), "blocks outlived every cache of their key")
+        }
+    }
+
+    @Test
+    fun `cancelling a reader leaves the other readers reading`() {
+        if (!natives.prepareOrSkip()) return
+        val key = uniqueKey()
+        TestReadAheadCache(key).use { cache ->
+            TestReadAheadCache(key).use { other ->
+                val cancelled = cache.openReader()
+                val sibling = cache.openReader()
+                val elsewhere = other.openReader()
+                cache.readBlocks(cancelled, 0 until 1)
+
+                nTestReadAheadCancelReader(cache.ptr, cancelled)
+                assertEquals(-1, nTestReadAheadRead(cache.ptr, cancelled, 0, 1), "cached bytes")
+                assertEquals(-1, nTestReadAheadRead(cache.ptr, cancelled, 5 * BLOCK, 1), "bytes not cached yet")
+
+                cache.readBlocks(sibling, 1 until 3)
+                other.readBlocks(elsewhere, 3 until 5)
+            }
+        }
+    }
+
+    @Test
+    fun `least recently used blocks are evicted beyond the budget`() {
+        if (!natives.prepareOrSkip()) return
+        MPVHandle.setSeekableInputCacheBudget(4 * BLOCK)
+        try {
+            TestReadAheadCache(uniqueKey()).use { cache ->
+                val reader = cache.openReader()
+                cache.readBlocks(reader, 0 until 6) // keeps 2..5
+                cache.readBlocks(reader, 2 until 3) // now more recent than 3
+                cache.readBlocks(reader, 6 until 7) // evicts 3, not 2
+
+                cache.readBlocks(reader, 2 until 3)
+                assertEquals(1L, cache.fetches(2), "a recently read block was evicted")
+                cache.readBlocks(reader, 3 until 4)
+                assertEquals(2L, cache.fetches(3), "the least recently used block was kept")
+                cache.readBlocks(reader, 0 until 1)
+                assertEquals(2L, cache.fetches(0), "8 blocks were kept within a budget of 4")
+            }
+        } finally {
+            MPVHandle.setSeekableInputCacheBudget(MPVHandle.DEFAULT_SEEKABLE_INPUT_CACHE_BUDGET)
+        }
+    }
+
+    @Test
+    fun `a speculative fetch failing because it was interrupted is fetched again`() {
+        if (!natives.prepareOrSkip()) return
+        TestReadAheadCache(uniqueKey(), readAheadBlocks = 2).use { cache ->
+            val reader = cache.openReader()
+            nTestReadAheadConfigureSource(cache.ptr, hangBlock = 1, hangIgnoresInterrupt = false, failBlock = -1, failCount = 0)
+            cache.readBlocks(reader, 0 until 1)
+            nTestReadAheadAwaitSourceHang(cache.ptr)
+
+            // Nobody waits for block 1, so jumping to block 5 interrupts its fetch.
+            cache.readBlocks(reader, 5 until 6)
+            assertEquals(1L, nTestReadAheadSourceInterrupts(cache.ptr))
+
+            cache.readBlocks(reader, 1 until 2)
+            assertEquals(2L, cache.fetches(1))
+        }
+    }
+
+    @Test
+    fun `a fetch failing on its own after an ignored interrupt is reported`() {
+        if (!natives.prepareOrSkip()) return
+        TestReadAheadCache(uniqueKey(), readAheadBlocks = 2).use { cache ->
+            val reader = cache.openReader()
+            // The fetch of block 1 completes despite the interrupt; the next fetch, of block 5, fails on its own.
+            nTestReadAheadConfigureSource(cache.ptr, hangBlock = 1, hangIgnoresInterrupt = true, failBlock = 5, failCount = 1)
+            cache.readBlocks(reader, 0 until 1)
+            nTestReadAheadAwaitSourceHang(cache.ptr)
+
+            assertEquals(-1, nTestReadAheadRead(cache.ptr, reader, 5 * BLOCK, CHUNK), "the failure was taken as the interrupt")
+            assertEquals(1L, nTestReadAheadSourceInterrupts(cache.ptr))
+            assertEquals(1L, cache.fetches(5))
+        }
+    }
+
+    private fun uniqueKey() = "read-ahead-test/${UUID.randomUUID()}"
+
+    /**
+     * A cache of 8 blocks that reads ahead [readAheadBlocks] from the reader's own block on, with one source fetch per
+     * block, so that fetch counts are exact.
+     */
+    private class TestReadAheadCache(key: String, readAheadBlocks: Long = 1) : AutoCloseable {
+        val ptr = nTestReadAheadCreate(key, 8 * BLOCK, readAheadSize = readAheadBlocks * BLOCK, fetchSize = BLOCK)
+            .also { check(it != 0L) { "cannot start the cache" } }
+        private val readers = mutableListOf<Long>()
+
+        fun openReader(): Long = nTestReadAheadOpenReader(ptr).also { readers += it }
+
+        fun fetches(block: Long = -1): Long = nTestReadAheadSourceFetches(ptr, block)
+
+        /** Reads every byte of [blocks] through [reader], checking them. */
+        fun readBlocks(reader: Long, blocks: IntRange) {
+            for (block in blocks) {
+                var offset = block * BLOCK
+                while (offset < (block + 1) * BLOCK) {
+                    val count = nTestReadAheadRead(ptr, reader, offset, CHUNK)
+                    check(count > 0) { "read at $offset returned $count" }
+                    offset += count
+                }
+            }
+        }
+
+        override fun close() {
+            readers.forEach { nTestReadAheadCloseReader(ptr, it) }
+            nTestReadAheadDestroy(ptr)
+        }
+    }
+
+    private companion object {
+        // read_ahead_cache::kBlockSize
+        const val BLOCK = 512L * 1024
+        const val CHUNK = 64 * 1024
+    }
+}
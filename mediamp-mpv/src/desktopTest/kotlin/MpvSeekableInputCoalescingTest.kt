@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import org.openani.mediamp.io.SeekableInput
+import java.io.File
+import kotlin.test.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertNotNull
+import kotlin.test.assertTrue
+
+/**
+ * Read coalescing of stream_cb inputs ([MPVHandle.registerSeekableInput] `minReadSize`):
+ * opening a file must cost an order of magnitude fewer [SeekableInput.read] upcalls than
+ * mpv makes read calls.
+ *
+ * mpv's stream buffer is shrunk to its 4 KiB minimum to reproduce the many small reads it
+ * makes while probing some containers, and read-ahead is off so that only coalescing is
+ * measured. Needs the dev natives (`mediamp.mpv.dev.native.dir`) and ffmpeg; skipped otherwise.
+ */
+class MpvSeekableInputCoalescingTest {
+    private val natives = MpvDevNatives("MpvSeekableInputCoalescingTest")
+
+    @Test
+    fun `coalescing cuts upcalls during open by an order of magnitude`() {
+        if (!natives.prepareOrSkip()) return
+        val video = natives.interleavedTestVideo()
+            ?: run { natives.skip("ffmpeg unavailable or test video generation failed"); return }
+
+        val passthrough = openAndCountUpcalls(video, minReadSize = 0)
+        val coalesced = openAndCountUpcalls(video, minReadSize = MPVHandle.DEFAULT_MIN_READ_SIZE)
+        println("[MpvSeekableInputCoalescingTest] upcalls during open: passthrough=$passthrough, coalesced=$coalesced")
+
+        assertTrue(passthrough > 0 && coalesced > 0, "the input was never read")
+        assertTrue(
+            coalesced * 10 <= passthrough,
+            "expected at least 10x fewer upcalls with coalescing, got $coalesced vs $passthrough",
+        )
+    }
+
+    /**
+     * Opens [video] through a counting [SeekableInput] and returns the number of
+     * [SeekableInput.read] calls made until `MPV_EVENT_FILE_LOADED`.
+     */
+    private fun openAndCountUpcalls(video: File, minReadSize: Int): Int = natives.withHandle { handle ->
+        handle.option("pause", "yes")
+        handle.option("stream-buffer-size", "4KiB")
+        val listener = FileLoadedListener()
+        handle.setEventListener(listener)
+        check(handle.initialize()) { "initialize failed" }
+
+        val input = RecordingFileInput(video)
+        val uri = handle.registerSeekableInput(
+            input,
+            "mediamp://coalescing_test/${video.name}",
+            readAheadSize = 0,
+            minReadSize = minReadSize,
+        )
+        listener.load(handle, uri)
+
+        val upcalls = input.reads.get()
+        val stats = assertNotNull(handle.getSeekableInputStats(uri))
+        assertEquals(upcalls.toLong(), stats.inputReads, "native upcall counter disagrees with the input")
+        upcalls
+    }
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import org.openani.mediamp.io.SeekableInput
+import java.io.File
+import kotlin.test.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertNotNull
+import kotlin.test.assertTrue
+
+/**
+ * Read-ahead and seek elision of stream_cb inputs ([MPVHandle.registerSeekableInput]): which thread reads the
+ * [SeekableInput], and which of mpv's seeks reach [SeekableInput.seekTo].
+ *
+ * Needs the dev natives (`mediamp.mpv.dev.native.dir`) and ffmpeg; skipped otherwise.
+ */
+class MpvSeekableInputReadAheadTest {
+    private val natives = MpvDevNatives("MpvSeekableInputReadAheadTest")
+
+    @Test
+    fun `read-ahead reads the input on the prefetch thread only`() {
+        val video = videoOrSkip() ?: return
+        val (input, stats) = open(video, readAheadSize = MPVHandle.RECOMMENDED_READ_AHEAD_SIZE)
+
+        assertTrue(stats.cacheHits > 0, "no read was served by the read-ahead cache")
+        assertEquals(setOf(PREFETCH_THREAD), input.readThreads.toSet())
+    }
+
+    @Test
+    fun `with read-ahead no mpv seek reaches the input`() {
+        val video = videoOrSkip() ?: return
+        val (input, stats) = open(video, readAheadSize = MPVHandle.RECOMMENDED_READ_AHEAD_SIZE)
+
+        // The prefetch thread's own seeks must not be taken for mpv's. A seek followed by a read that failed when
+        // playback was stopped counts as neither.
+        assertTrue(stats.seekCalls > 0, "mpv never seeked: $stats")
+        assertTrue(stats.elidedSeeks in (stats.seekCalls - 1)..stats.seekCalls, "$stats")
+        assertEquals(input.seeks.get().toLong(), stats.inputSeeks)
+    }
+
+    @Test
+    fun `read-ahead is off by default`() {
+        val video = videoOrSkip() ?: return
+        val (input, stats) = open(video, readAheadSize = null)
+
+        assertEquals(0L, stats.cacheHits + stats.cacheMisses, "the read-ahead cache was used")
+        assertTrue(input.reads.get() > 0, "the input was never read")
+        assertTrue(PREFETCH_THREAD !in input.readThreads, "the input was read by the prefetch thread")
+    }
+
+    @Test
+    fun `seeks to where the input already is do not reach it`() {
+        val video = videoOrSkip() ?: return
+        val (input, stats) = open(video, readAheadSize = 0)
+
+        assertTrue(stats.elidedSeeks > 0, "no seek was elided: $stats")
+        assertTrue(stats.elidedSeeks <= stats.seekCalls, "more seeks elided than made: $stats")
+        assertEquals(input.seeks.get().toLong(), stats.inputSeeks, "native seek counter disagrees with the input")
+        assertTrue(input.seeks.get() < stats.seekCalls, "every mpv seek reached the input")
+        // The input starts at 0, so the first read needs no seekTo(0).
+        assertEquals("read@0", input.operations.first())
+    }
+
+    private fun videoOrSkip(): File? {
+        if (!natives.prepareOrSkip()) return null
+        return natives.interleavedTestVideo()
+            ?: run { natives.skip("ffmpeg unavailable or test video generation failed"); null }
+    }
+
+    /**
+     * Opens [video] through a [RecordingFileInput] registered with [readAheadSize] (the default when `null`), and
+     * returns it with its stats once the file was loaded and stopped again, so that the counters no longer move.
+     */
+    private fun open(video: File, readAheadSize: Long?): Pair<RecordingFileInput, SeekableInputStats> =
+        natives.withHandle { handle ->
+            handle.option("pause", "yes")
+            val listener = FileLoadedListener()
+            handle.setEventListener(listener)
+            check(handle.initialize()) { "initialize failed" }
+
+            val input = RecordingFileInput(video)
+            val uri = "mediamp://read_ahead_test/${video.name}"
+            if (readAheadSize == null) {
+                handle.registerSeekableInput(input, uri)
+            } else {
+                handle.registerSeekableInput(input, uri, readAheadSize = readAheadSize)
+            }
+            listener.load(handle, uri)
+            listener.stop(handle)
+            input to assertNotNull(handle.getSeekableInputStats(uri))
+        }
+
+    private companion object {
+        // The name the native layer attaches its prefetch threads with.
+        const val PREFETCH_THREAD = "mediamp-read-ahead"
+    }
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+// Test-only entry points of the native library (src/cpp/test_hooks.cpp), which looks them up under this file's class
+// name, NativeTestHooksKt. Available once the dev natives are loaded (MpvDevNatives.prepareOrSkip): only the test
+// builds of the library have them, never the published runtime.
+
+// read_ahead_cache over a synthetic source whose byte at offset `o` is a fixed function of `o`.
+internal external fun nTestReadAheadCreate(key: String, size: Long, readAheadSize: Long, fetchSize: Long): Long
+internal external fun nTestReadAheadDestroy(ptr: Long)
+internal external fun nTestReadAheadOpenReader(ptr: Long): Long
+internal external fun nTestReadAheadCloseReader(ptr: Long, reader: Long)
+internal external fun nTestReadAheadCancelReader(ptr: Long, reader: Long)
+
+/** `read_ahead_cache::read`, or -2 when the bytes read are not the source's. */
+internal external fun nTestReadAheadRead(ptr: Long, reader: Long, offset: Long, length: Int): Int
+
+/** Fetches made by the source for [block], or for every block when it is negative. */
+internal external fun nTestReadAheadSourceFetches(ptr: Long, block: Long): Long
+
+/**
+ * Makes the source hang on the next fetch of [hangBlock] until it is interrupted, then fail that fetch, or complete it
+ * when [hangIgnoresInterrupt]; and fail the next [failCount] fetches of [failBlock] on its own. -1 and 0 turn them off.
+ */
+internal external fun nTestReadAheadConfigureSource(
+    ptr: Long,
+    hangBlock: Long,
+    hangIgnoresInterrupt: Boolean,
+    failBlock: Long,
+    failCount: Long,
+)
+
+/** Returns once the source is hanging as set up by [nTestReadAheadConfigureSource]. */
+internal external fun nTestReadAheadAwaitSourceHang(ptr: Long)
+
+/** Calls of the source's `interrupt_fetch`. */
+internal external fun nTestReadAheadSourceInterrupts(ptr: Long): Long
+
+// disk_cache, as configured by MPVHandle.configureSeekableInputDiskCache, storing blocks of the same synthetic bytes.
+
+/** `disk_cache::open`, or 0 when it returned null. */
+internal external fun nTestDiskCacheOpen(contentId: String, size: Long, blockSize: Long): Long
+internal external fun nTestDiskCacheClose(ptr: Long)
+internal external fun nTestDiskCacheWrite(ptr: Long, index: Long)
+
+/** 1 when block [index] was read back intact, 0 when it is not stored, -2 when its bytes are wrong. */
+internal external fun nTestDiskCacheRead(ptr: Long, index: Long): Int
+
+// property_throttle, on a clock the tests set: every `now` is nanoseconds after a fixed epoch.
+internal external fun nTestThrottleCreate(): Long
+internal external fun nTestThrottleDestroy(ptr: Long)
+internal external fun nTestThrottleConfigure(ptr: Long, replyData: Long, minIntervalNanos: Long, epsilon: Double)
+
+/** `property_throttle::admit` of a double property change. */
+internal external fun nTestThrottleAdmitDouble(ptr: Long, replyData: Long, name: String, value: Double, now: Long): Boolean
+
+/** `property_throttle::admit` of a string property change; a null [value] is a change without data. */
+internal external fun nTestThrottleAdmitString(ptr: Long, replyData: Long, name: String, value: String?, now: Long): Boolean
+
+/** The changes `property_throttle::flush_due` delivered, one `<replyData>:<name>=<value>` per line. */
+internal external fun nTestThrottleFlushDue(ptr: Long, now: Long): String
+
+/** Like [nTestThrottleFlushDue], for `property_throttle::flush_pending`: every pending change, due or not. */
+internal external fun nTestThrottleFlushPending(ptr: Long, now: Long): String
+internal external fun nTestThrottleDropPending(ptr: Long)
+internal external fun nTestThrottleWaitTimeout(ptr: Long, now: Long): Double
+
+// event_batch, used by the calling thread only; `dispatcher` is an EventBatchDispatcher.
+internal external fun nTestEventBatchCreate(): Long
+internal external fun nTestEventBatchDestroy(ptr: Long)
+
+/**
+ * `event_batch::append` of an event without data but for `MPV_EVENT_START_FILE` ([entryId]) and `MPV_EVENT_END_FILE`
+ * ([reason], [error] and [entryId]). Returns the size of the batch after it, 0 when it was flushed to [dispatcher].
+ */
+internal external fun nTestEventBatchAppendEvent(
+    ptr: Long,
+    eventId: Int,
+    reason: Int,
+    error: Int,
+    entryId: Long,
+    dispatcher: Any,
+): Int
+
+/**
+ * `event_batch::append` of a change of [name] in [format]: [value] is the flag (0/1), the int64 or the bits of the
+ * double; a string is [string], as UTF-8. Returns like [nTestEventBatchAppendEvent].
+ */
+internal external fun nTestEventBatchAppendProperty(
+    ptr: Long,
+    replyData: Long,
+    name: String,
+    format: Int,
+    value: Long,
+    string: ByteArray?,
+    dispatcher: Any,
+): Int
+
+internal external fun nTestEventBatchFlush(ptr: Long, dispatcher: Any)
+
+/** `flatten_node` of a fixed tree with a node of every format; the tree is described in test_hooks.cpp. */
+internal external fun nTestFlattenNode(): ByteArray
+
+// log_queue, on its own; lines are pushed and popped by their text only.
+internal external fun nTestLogQueueCreate(): Long
+internal external fun nTestLogQueueDestroy(ptr: Long)
+
+/** Claims, fills and publishes a slot; false when the queue was full. */
+internal external fun nTestLogQueuePush(ptr: Long, text: String): Boolean
+
+/** Pops the oldest published line, or returns null when there is none. */
+internal external fun nTestLogQueuePop(ptr: Long): String?
+internal external fun nTestLogQueueDropped(ptr: Long): Long
+
+/** `log_forward` of a process-wide line, which reaches [MPVLog] through the shared queue and the drain thread. */
+internal external fun nTestLogForward(level: Int, prefix: String, text: String)
+
+/** `log_threshold` of the handle at [instanceHandle]; 0 for the default threshold. */
+internal external fun nTestLogThreshold(instanceHandle: Long): Int
+
+/** `log_print` of a line of the handle at [instanceHandle], subject to its threshold. */
+internal external fun nTestLogPrint(instanceHandle: Long, level: Int, text: String)
+
+// log_ring_file, writing to the file at `path` (standard UTF-8).
+
+/** `log_ring_file::open`, or 0 when it failed. */
+internal external fun nTestLogRingOpen(path: ByteArray, capacity: Long): Long
+internal external fun nTestLogRingClose(ptr: Long)
+internal external fun nTestLogRingWrite(ptr: Long, instanceHandle: Long, level: Int, prefix: String, text: String)
+
+/**
+ * Pushes event [eventId] into the ring open on the handle at [ptr], as its event loop would; the handle must not be
+ * initialized. `START_FILE` and `END_FILE` (reason EOF) carry [entryId]. False when the ring was full or is not open.
+ */
+internal external fun nTestEventRingPush(ptr: Long, eventId: Int, entryId: Long): Boolean
+
+// handle_pool, keyed like MPVHandle.configurePool: the options flattened to key, value, key, value...
+
+/** The idle instances of the profile [options], as handle pointers. */
+internal external fun nTestHandlePoolIdle(options: Array<String>): LongArray
+
+/** Consecutive failures to create an instance of the profile [options]; 0 when it is not configured. */
+internal external fun nTestHandlePoolFailures(options: Array<String>): Int
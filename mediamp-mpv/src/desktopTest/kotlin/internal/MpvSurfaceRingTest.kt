@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv.internal
+
+import org.jetbrains.skia.Bitmap
+import org.jetbrains.skia.Color
+import org.jetbrains.skia.Surface
+import org.jetbrains.skia.SurfaceColorFormat
+import org.jetbrains.skiko.SkiaLayer
+import org.openani.mediamp.mpv.utils.SkiaRenderDeviceInterop
+import kotlin.test.Test
+import kotlin.test.assertEquals
+
+/**
+ * [MpvSurfaceRing.sampleBuffer] on raster surfaces, standing in for the wrapped ring buffers: the producer's frame
+ * only becomes visible once [MpvSurfaceRingBackend.awaitBufferReady] returns, so Skia must not sample before it.
+ */
+class MpvSurfaceRingTest {
+    @Test
+    fun `a buffer is sampled after the backend waited for it`() {
+        val source = Surface.makeRasterN32Premul(4, 4)
+        val blit = Surface.makeRasterN32Premul(4, 4)
+        try {
+            source.canvas.clear(Color.BLACK)
+            val backend = FenceBackend(source)
+            MpvSurfaceRing(HANDLE, backend).sampleBuffer(2, source, blit)
+
+            assertEquals(listOf("await $HANDLE 2"), backend.calls)
+            val pixels = Bitmap()
+            try {
+                pixels.allocN32Pixels(4, 4)
+                check(blit.readPixels(pixels, 0, 0)) { "readPixels failed" }
+                assertEquals(Color.RED, pixels.getColor(1, 1), "the buffer was sampled before the wait")
+            } finally {
+                pixels.close()
+            }
+        } finally {
+            source.close()
+            blit.close()
+        }
+    }
+
+    /** Completes the producer's frame, red, into [frame] when the consumer waits for it. */
+    private class FenceBackend(private val frame: Surface) : MpvSurfaceRingBackend {
+        val calls = mutableListOf<String>()
+
+        override fun awaitBufferReady(ptr: Long, index: Int) {
+            calls += "await $ptr $index"
+            frame.canvas.clear(Color.RED)
+        }
+
+        override fun getBufferTexture(ptr: Long, index: Int): Long = error("not used")
+        override fun ackRetiredBuffers(ptr: Long): Boolean = error("not used")
+        override fun makeConsumerRenderTarget(width: Int, height: Int, texturePtr: Long): MpvConsumerRenderTarget =
+            error("not used")
+        override val wrapColorFormat: SurfaceColorFormat get() = SurfaceColorFormat.RGBA_8888
+        override fun createRenderContext(ptr: Long): Boolean = error("not used")
+        override fun destroyRenderContext(ptr: Long): Boolean = error("not used")
+        override val rendererName: String get() = "test"
+        override fun createSkiaInterop(layer: SkiaLayer): SkiaRenderDeviceInterop = error("not used")
+        override fun setSurfaceConfig(ptr: Long, width: Int, height: Int, devicePtr: Long): Boolean = error("not used")
+        override fun getFrameState(ptr: Long): Long = error("not used")
+        override fun hasSurface(ptr: Long): Boolean = error("not used")
+        override fun saveSurfacePng(ptr: Long, path: String): Boolean = error("not used")
+        override fun readSurfacePixels(ptr: Long, dims: IntArray): IntArray? = error("not used")
+    }
+
+    private companion object {
+        const val HANDLE = 1L
+    }
+}
@@ -9,6 +9,11 @@
 package org.openani.mediamp.mpv
 
 import org.openani.mediamp.InternalMediampApi
+import org.openani.mediamp.io.SeekableInput
+
+internal actual fun SeekableInput.localFilePathOrNull(): String? = null
+
+internal actual fun EventListener.forEventLoop(): EventListener = this
 
 internal actual fun attachSurface(ptr: Long, surface: Any): Boolean {
     TODO("Not yet implemented")
@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import java.nio.Buffer
+import java.nio.ByteBuffer
+
+/**
+ * Copies bytes out of the direct buffers the native side fills (event batches, the event ring, log batches) through
+ * one array reused across reads. Not thread-safe: each reader keeps its own.
+ */
+internal class ByteBufferScratch(initialSize: Int) {
+    /** Holds the bytes of the last [read] at its start. */
+    var bytes = ByteArray(initialSize)
+        private set
+
+    /** Copies [length] bytes at [offset] of [buffer] to the start of [bytes]. */
+    fun read(buffer: ByteBuffer, offset: Int, length: Int) {
+        if (bytes.size < length) bytes = ByteArray(maxOf(length, bytes.size * 2))
+        // Through Buffer: ByteBuffer.position(Int) only exists since Java 9 and on newer Android.
+        (buffer as Buffer).position(offset)
+        buffer.get(bytes, 0, length)
+    }
+
+    /** Decodes the [length] UTF-8 bytes at [offset] of [buffer]. */
+    fun readString(buffer: ByteBuffer, offset: Int, length: Int): String {
+        read(buffer, offset, length)
+        return String(bytes, 0, length, Charsets.UTF_8)
+    }
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * The [EventListener] the native event loop is given on JVM targets.
+ *
+ * On each wakeup the event loop drains every event mpv has queued and calls [dispatch] once
+ * with all of them packed into a direct buffer, instead of making one upcall (and creating a
+ * property name string) per event. This class decodes the records and forwards them, in
+ * order, to [delegate]; property changes go to the keyed callbacks
+ * ([EventListener.onPropertyDouble] etc.). The layout is documented in `event_batch.h`.
+ */
+internal class EventBatchDispatcher(
+    private val delegate: EventListener,
+) : EventListener by delegate {
+    // Property names by the ID the native side interned them under; each name crosses JNI once.
+    private val names = ArrayList<String>()
+    private val scratch = ByteBufferScratch(256)
+
+    /**
+     * Called from the native event loop thread with [size] bytes of records at the start of [buffer].
+     */
+    fun dispatch(buffer: ByteBuffer, size: Int) {
+        buffer.order(ByteOrder.nativeOrder())
+        var failure: Throwable? = null
+        var offset = 0
+        while (offset + HEADER_SIZE <= size) {
+            val recordSize = buffer.getInt(offset + 4)
+            if (recordSize < HEADER_SIZE) break
+            // A listener that throws must not make the rest of the batch disappear.
+            try {
+                dispatchRecord(buffer, offset)
+            } catch (e: Throwable) {
+                if (failure == null) failure = e else failure.addSuppressed(e)
+            }
+            offset += recordSize
+        }
+        failure?.let { throw it }
+    }
+
+    private fun dispatchRecord(buffer: ByteBuffer, offset: Int) {
+        val a = buffer.getInt(offset + 8)
+        val b = buffer.getInt(offset + 12)
+        val c = buffer.getLong(offset + 16)
+        val d = buffer.getLong(offset + 24)
+        when (buffer.getInt(offset)) {
+            KIND_EVENT -> delegate.onEvent(a)
+            KIND_START_FILE -> delegate.onStartFile(c)
+            KIND_END_FILE -> delegate.onEndFile(a, b, c)
+            KIND_NAME -> {
+                val name = scratch.readString(buffer, offset + HEADER_SIZE, b)
+                if (a == names.size) names.add(name) else names[a] = name
+            }
+
+            KIND_PROPERTY -> {
+                val name = names[a]
+                when (b) {
+                    FORMAT_NONE -> delegate.onPropertyNone(d, name)
+                    FORMAT_FLAG -> delegate.onPropertyFlag(d, name, c != 0L)
+                    FORMAT_INT64 -> delegate.onPropertyInt64(d, name, c)
+                    FORMAT_DOUBLE -> delegate.onPropertyDouble(d, name, Double.fromBits(c))
+                    FORMAT_STRING -> {
+                        val value = scratch.readString(buffer, offset + HEADER_SIZE, c.toInt())
+                        delegate.onPropertyString(d, name, value)
+                    }
+                }
+            }
+        }
+    }
+
+    private companion object {
+        // Shared with event_batch.h.
+        const val HEADER_SIZE = 32
+        const val KIND_EVENT = 0
+        const val KIND_START_FILE = 1
+        const val KIND_END_FILE = 2
+        const val KIND_NAME = 3
+        const val KIND_PROPERTY = 4
+
+        // mpv_format
+        const val FORMAT_NONE = 0
+        const val FORMAT_STRING = 1
+        const val FORMAT_FLAG = 3
+        const val FORMAT_INT64 = 4
+        const val FORMAT_DOUBLE = 5
+    }
+}
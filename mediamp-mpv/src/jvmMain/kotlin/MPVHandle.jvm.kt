@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+@file:JvmName("MPVHandleJvm")
+
+package org.openani.mediamp.mpv
+
+import org.openani.mediamp.io.FileSeekableInput
+import org.openani.mediamp.io.SeekableInput
+import java.nio.ByteBuffer
+
+internal actual fun SeekableInput.localFilePathOrNull(): String? = (this as? FileSeekableInput)?.filePath
+
+internal actual fun EventListener.forEventLoop(): EventListener = EventBatchDispatcher(this)
+
+/**
+ * Switches [this] to poll-based event delivery: events are written into a ring of at least [capacity] records, which
+ * the returned [MpvEventRing] reads, and the [EventListener] set with [MPVHandle.setEventListener] is no longer called.
+ * Opening it again returns the same [MpvEventRing], whatever [capacity] is, so no event is read twice.
+ */
+fun MPVHandle.openEventRing(capacity: Int = MpvEventRing.DEFAULT_CAPACITY): MpvEventRing {
+    require(capacity > 0) { "capacity must be positive" }
+    val ptr = ptr
+    nOpenEventRing(ptr, null, null)?.let { return it }
+    val ring = MpvEventRing(this, capacity)
+    return nOpenEventRing(ptr, ring, ring.buffer) ?: error("Failed to open the mpv event ring")
+}
+
+/** Opens [ring] over [buffer] unless a ring is open already, and returns the open one; null [ring] only looks it up. */
+private external fun nOpenEventRing(ptr: Long, ring: MpvEventRing?, buffer: ByteBuffer?): MpvEventRing?
+internal external fun nEventRingAdvance(ptr: Long, consumed: Long): Long
+internal external fun nMonotonicNanos(): Long
+internal external fun nLogDroppedCount(): Long
+internal external fun nCommandPacked(ptr: Long, args: ByteBuffer, length: Int): Boolean
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import java.nio.Buffer
+import java.nio.ByteBuffer
+import java.nio.CharBuffer
+import java.nio.charset.CodingErrorAction
+
+/**
+ * Runs mpv commands with their arguments packed as NUL-terminated UTF-8 into one reused direct buffer, which the
+ * native side splits in place, instead of passing a `String` array that is converted and released argument by
+ * argument. For commands issued at a high rate, like `seek`.
+ *
+ * Arguments are encoded as real UTF-8, so, unlike with [MPVHandle.command], characters outside the BMP
+ * reach mpv intact.
+ */
+internal class MpvCommandBuffer(initialCapacity: Int = 256) {
+    private var buffer: ByteBuffer = ByteBuffer.allocateDirect(initialCapacity)
+    private val encoder = Charsets.UTF_8.newEncoder()
+        .onMalformedInput(CodingErrorAction.REPLACE)
+        .onUnmappableCharacter(CodingErrorAction.REPLACE)
+
+    /**
+     * Runs the command [args] on [handle] and waits for it, like [MPVHandle.command].
+     */
+    @Synchronized
+    fun command(handle: MPVHandle, vararg args: String): Boolean {
+        require(args.size < MAX_ARGUMENTS) { "At most ${MAX_ARGUMENTS - 1} arguments are supported" }
+        (buffer as Buffer).clear()
+        for (arg in args) {
+            put(arg)
+        }
+        return nCommandPacked(handle.ptr, buffer, buffer.position())
+    }
+
+    /**
+     * Runs `seek <seconds> <flags>` on [handle], like [command], with [positionMillis] written as decimal seconds
+     * straight into the buffer, so that a seek allocates nothing.
+     */
+    @Synchronized
+    fun seek(handle: MPVHandle, positionMillis: Long, flags: String): Boolean {
+        require(positionMillis >= 0) { "positionMillis must be non-negative, but was $positionMillis" }
+        (buffer as Buffer).clear()
+        put("seek")
+        putSeconds(positionMillis)
+        put(flags)
+        return nCommandPacked(handle.ptr, buffer, buffer.position())
+    }
+
+    private fun put(arg: String) {
+        // The native side splits arguments at NUL.
+        require(arg.indexOf('\u0000') < 0) { "Arguments must not contain NUL" }
+        if (arg.all { it.code < 0x80 }) {
+            // ASCII, like command names and flags: copied as is, without wrapping it for the encoder.
+            while (buffer.remaining() <= arg.length) grow()
+            for (c in arg) buffer.put(c.code.toByte())
+            buffer.put(0)
+            return
+        }
+        val chars = CharBuffer.wrap(arg)
+        encoder.reset()
+        while (encoder.encode(chars, buffer, true).isOverflow) grow()
+        while (encoder.flush(buffer).isOverflow) grow()
+        if (!buffer.hasRemaining()) grow()
+        buffer.put(0)
+    }
+
+    // "<seconds>.<milliseconds>", e.g. "83.042"; mpv parses decimal seconds in any locale.
+    private fun putSeconds(millis: Long) {
+        val seconds = millis / 1000
+        var divisor = 1L
+        while (divisor <= seconds / 10) divisor *= 10
+        // At most 19 digits, the point, 3 digits and the NUL.
+        while (buffer.remaining() < 24) grow()
+        while (divisor > 0) {
+            buffer.put(('0'.code + (seconds / divisor % 10).toInt()).toByte())
+            divisor /= 10
+        }
+        buffer.put('.'.code.toByte())
+        val fraction = (millis % 1000).toInt()
+        buffer.put(('0'.code + fraction / 100).toByte())
+        buffer.put(('0'.code + fraction / 10 % 10).toByte())
+        buffer.put(('0'.code + fraction % 10).toByte())
+        buffer.put(0)
+    }
+
+    private fun grow() {
+        val larger = ByteBuffer.allocateDirect(buffer.capacity() * 2)
+        (buffer as Buffer).flip()
+        larger.put(buffer)
+        buffer = larger
+    }
+
+    private companion object {
+        // Shared with FN_JVM(nCommandPacked).
+        const val MAX_ARGUMENTS = 128
+    }
+}
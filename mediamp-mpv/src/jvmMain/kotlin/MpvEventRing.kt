@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Poll-based event delivery, opened with [MPVHandle.openEventRing].
+ *
+ * mpv's event loop writes each event into a lock-free single-producer/single-consumer ring in native
+ * memory instead of calling an [EventListener] on its own thread; [poll] reads what has arrived since the
+ * last call and dispatches it on the caller's thread, e.g. once per UI frame. The event thread then makes
+ * no JNI upcalls at all. The layout is documented in `event_ring.h`.
+ *
+ * When the ring is full, new events are dropped and counted in [droppedEvents]; poll often enough, or
+ * open the ring with a larger capacity, for that not to happen.
+ *
+ * Not thread-safe: [poll] must be called from one thread at a time. Once the handle is destroyed, [poll] dispatches
+ * nothing, and after it is closed, throws; [droppedEvents] keeps its last value.
+ */
+class MpvEventRing internal constructor(
+    private val handle: MPVHandle,
+    capacity: Int,
+) {
+    /** Number of records the ring holds: the requested capacity, rounded up to a power of two. */
+    val capacity: Int = roundCapacity(capacity)
+
+    // Owned here rather than by the native handle, so that reading it stays safe after the handle is closed.
+    internal val buffer: ByteBuffer =
+        ByteBuffer.allocateDirect(CONTROL_SIZE + this.capacity * SLOT_SIZE).order(ByteOrder.nativeOrder())
+
+    private var readIndex = 0L
+    private val scratch = ByteBufferScratch(SLOT_SIZE)
+    // Last name seen per reply ID, so that a property's name is decoded once, not per change.
+    private val names = HashMap<Long, CachedName>()
+
+    /** Events dropped because the ring was full. */
+    val droppedEvents: Long get() = buffer.getLong(DROPPED_OFFSET)
+
+    /** Time from the event loop writing an event to [poll] reading it, for the last event polled. */
+    var lastLatencyNanos: Long = 0L
+        private set
+
+    /** Highest [lastLatencyNanos] so far. */
+    var maxLatencyNanos: Long = 0L
+        private set
+
+    /**
+     * Dispatches up to [maxEvents] events that have arrived since the last call to [listener], in order.
+     * Property changes go to the keyed callbacks ([EventListener.onPropertyDouble] etc.).
+     *
+     * @return the number of events dispatched
+     */
+    fun poll(listener: EventListener, maxEvents: Int = Int.MAX_VALUE): Int {
+        val ptr = handle.ptr
+        val writeIndex = nEventRingAdvance(ptr, readIndex)
+        val count = minOf(writeIndex - readIndex, maxEvents.toLong()).toInt()
+        if (count <= 0) return 0
+
+        val now = nMonotonicNanos()
+        var failure: Throwable? = null
+        for (i in 0 until count) {
+            val offset = CONTROL_SIZE + ((readIndex + i) and (capacity - 1).toLong()).toInt() * SLOT_SIZE
+            val latency = now - buffer.getLong(offset + 32)
+            lastLatencyNanos = latency
+            if (latency > maxLatencyNanos) maxLatencyNanos = latency
+            // Every event is dispatched even if one throws; the first failure is rethrown at the end.
+            try {
+                dispatch(listener, offset)
+            } catch (e: Throwable) {
+                if (failure == null) failure = e else failure.addSuppressed(e)
+            }
+        }
+        readIndex += count
+        // Frees the slots right away rather than on the next poll.
+        nEventRingAdvance(ptr, readIndex)
+        failure?.let { throw it }
+        return count
+    }
+
+    private fun dispatch(listener: EventListener, offset: Int) {
+        val a = buffer.getInt(offset + 4)
+        val b = buffer.getInt(offset + 8)
+        val c = buffer.getLong(offset + 16)
+        when (buffer.getInt(offset)) {
+            KIND_EVENT -> listener.onEvent(a)
+            KIND_START_FILE -> {
+                listener.onEvent(MPV_EVENT_START_FILE)
+                listener.onStartFile(c)
+            }
+
+            KIND_END_FILE -> {
+                listener.onEvent(MPV_EVENT_END_FILE)
+                listener.onEndFile(a, b, c)
+            }
+
+            KIND_PROPERTY -> {
+                val id = buffer.getLong(offset + 24)
+                val nameLength = buffer.getInt(offset + 40)
+                val name = readName(id, offset + PAYLOAD_OFFSET, nameLength)
+                when (a) {
+                    FORMAT_NONE -> listener.onPropertyNone(id, name)
+                    FORMAT_FLAG -> listener.onPropertyFlag(id, name, c != 0L)
+                    FORMAT_INT64 -> listener.onPropertyInt64(id, name, c)
+                    FORMAT_DOUBLE -> listener.onPropertyDouble(id, name, Double.fromBits(c))
+                    FORMAT_STRING -> {
+                        val value =
+                            scratch.readString(buffer, offset + PAYLOAD_OFFSET + nameLength, buffer.getInt(offset + 44))
+                        val truncated = buffer.getInt(offset + 12) and FLAG_TRUNCATED != 0
+                        // Did not fit in the slot; the property still holds the full value (or a newer one).
+                        val full = if (truncated) handle.getPropertyString(name) ?: value else value
+                        listener.onPropertyString(id, name, full)
+                    }
+                }
+            }
+        }
+    }
+
+    private fun readName(id: Long, offset: Int, length: Int): String {
+        scratch.read(buffer, offset, length)
+        val bytes = scratch.bytes
+        val cached = names[id]
+        if (cached != null && cached.matches(bytes, length)) return cached.name
+        return bytes.decodeToString(0, length).also { names[id] = CachedName(bytes.copyOf(length), it) }
+    }
+
+    private class CachedName(val bytes: ByteArray, val name: String) {
+        fun matches(other: ByteArray, length: Int): Boolean {
+            if (bytes.size != length) return false
+            for (i in 0 until length) if (bytes[i] != other[i]) return false
+            return true
+        }
+    }
+
+    companion object {
+        /** Default `capacity` of [MPVHandle.openEventRing]. */
+        const val DEFAULT_CAPACITY: Int = 1024
+
+        // Shared with event_ring.h.
+        private const val MIN_CAPACITY = 16
+        private const val MAX_CAPACITY = 1 shl 16
+        private const val CONTROL_SIZE = 192
+        private const val DROPPED_OFFSET = 128
+        private const val SLOT_SIZE = 256
+        private const val PAYLOAD_OFFSET = 48
+        private const val FLAG_TRUNCATED = 1
+        private const val KIND_EVENT = 0
+        private const val KIND_START_FILE = 1
+        private const val KIND_END_FILE = 2
+        private const val KIND_PROPERTY = 4
+
+        // mpv_event_id
+        private const val MPV_EVENT_START_FILE = 6
+        private const val MPV_EVENT_END_FILE = 7
+
+        // mpv_format
+        private const val FORMAT_NONE = 0
+        private const val FORMAT_STRING = 1
+        private const val FORMAT_FLAG = 3
+        private const val FORMAT_INT64 = 4
+        private const val FORMAT_DOUBLE = 5
+
+        /** Rounds [capacity] up to a power of two within what event_ring.h accepts. */
+        private fun roundCapacity(capacity: Int): Int =
+            Integer.highestOneBit((capacity - 1).coerceIn(MIN_CAPACITY - 1, MAX_CAPACITY - 1)) shl 1
+    }
+}
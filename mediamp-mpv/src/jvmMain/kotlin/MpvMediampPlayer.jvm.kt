@@ -55,6 +55,79 @@ private fun buildSeekableInputLoadTarget(data: SeekableInputMediaData): String {
     return SEEKABLE_INPUT_LOAD_TARGET_PREFIX + data.uri
 }
 
+// replyData of the observed properties: the event listener dispatches on these IDs
+// instead of comparing property names.
+private const val PROPERTY_EOF_REACHED = 1L
+private const val PROPERTY_TIME_POS = 2L
+private const val PROPERTY_DURATION = 3L
+private const val PROPERTY_PAUSE = 4L
+private const val PROPERTY_PAUSED_FOR_CACHE = 5L
+private const val PROPERTY_VOLUME = 6L
+private const val PROPERTY_MUTE = 7L
+private const val PROPERTY_CACHE_BUFFERING_STATE = 8L
+private const val PROPERTY_MEDIA_TITLE = 9L
+private const val PROPERTY_TRACK_LIST = 10L
+private const val PROPERTY_CHAPTER_LIST = 11L
+private const val PROPERTY_VIDEO_PARAMS = 12L
+private const val PROPERTY_HWDEC_CURRENT = 13L
+
+/**
+ * A property [MpvMediampPlayer] observes, reported to its event listener under [id].
+ */
+internal class MpvObservedProperty(
+    val name: String,
+    val format: MPVFormat,
+    val id: Long,
+    val maxRateHz: Double = 0.0,
+)
+
+// Observed by configureNativeHandle on every handle the player uses.
+internal val MPV_OBSERVED_PROPERTIES: List<MpvObservedProperty> = listOf(
+    MpvObservedProperty("eof-reached", MPVFormat.MPV_FORMAT_FLAG, PROPERTY_EOF_REACHED),
+    // mpv reports time-pos on every frame; nothing downstream needs more than a few updates per
+    // second, and seek completion reads the position live.
+    MpvObservedProperty("time-pos", MPVFormat.MPV_FORMAT_DOUBLE, PROPERTY_TIME_POS, maxRateHz = 10.0),
+    MpvObservedProperty("duration", MPVFormat.MPV_FORMAT_DOUBLE, PROPERTY_DURATION),
+    MpvObservedProperty("pause", MPVFormat.MPV_FORMAT_FLAG, PROPERTY_PAUSE),
+    MpvObservedProperty("paused-for-cache", MPVFormat.MPV_FORMAT_FLAG, PROPERTY_PAUSED_FOR_CACHE),
+    MpvObservedProperty("volume", MPVFormat.MPV_FORMAT_DOUBLE, PROPERTY_VOLUME),
+    MpvObservedProperty("mute", MPVFormat.MPV_FORMAT_FLAG, PROPERTY_MUTE),
+    MpvObservedProperty(
+        "cache-buffering-state", MPVFormat.MPV_FORMAT_INT64, PROPERTY_CACHE_BUFFERING_STATE, maxRateHz = 4.0,
+    ),
+    MpvObservedProperty("media-title", MPVFormat.MPV_FORMAT_STRING, PROPERTY_MEDIA_TITLE),
+    MpvObservedProperty("track-list", MPVFormat.MPV_FORMAT_NONE, PROPERTY_TRACK_LIST),
+    MpvObservedProperty("chapter-list", MPVFormat.MPV_FORMAT_NONE, PROPERTY_CHAPTER_LIST),
+    MpvObservedProperty("video-params", MPVFormat.MPV_FORMAT_NONE, PROPERTY_VIDEO_PARAMS),
+    MpvObservedProperty("hwdec-current", MPVFormat.MPV_FORMAT_NONE, PROPERTY_HWDEC_CURRENT),
+)
+
+// Properties read together, each batch in one native call; the indices are the properties' positions. The
+// transport state is read alone, or with the position as the first properties of TRANSPORT_PROPERTIES.
+private val TRANSPORT_STATE_PROPERTIES = MPVPropertyBatch(
+    "pause" to MPVFormat.MPV_FORMAT_FLAG,
+    "paused-for-cache" to MPVFormat.MPV_FORMAT_FLAG,
+)
+private val TRANSPORT_PROPERTIES = MPVPropertyBatch(
+    "pause" to MPVFormat.MPV_FORMAT_FLAG,
+    "paused-for-cache" to MPVFormat.MPV_FORMAT_FLAG,
+    "time-pos" to MPVFormat.MPV_FORMAT_DOUBLE,
+)
+private const val TRANSPORT_PAUSE = 0
+private const val TRANSPORT_PAUSED_FOR_CACHE = 1
+private const val TRANSPORT_TIME_POS = 2
+
+private val VIDEO_SIZE_PROPERTIES = MPVPropertyBatch(
+    "dwidth" to MPVFormat.MPV_FORMAT_INT64,
+    "width" to MPVFormat.MPV_FORMAT_INT64,
+    "dheight" to MPVFormat.MPV_FORMAT_INT64,
+    "height" to MPVFormat.MPV_FORMAT_INT64,
+)
+private const val VIDEO_SIZE_DWIDTH = 0
+private const val VIDEO_SIZE_WIDTH = 1
+private const val VIDEO_SIZE_DHEIGHT = 2
+private const val VIDEO_SIZE_HEIGHT = 3
+
 /**
  * The shared JVM (desktop + Android) mpv backend.
  *
@@ -94,7 +167,7 @@ abstract class JvmMpvMediampPlayer(
     parentCoroutineContext = parentCoroutineContext,
     mainDispatcher = mainDispatcher,
 ) {
-    internal val handle by lazy { MPVHandle(context) }
+    internal val handle by lazy { MPVHandle.createInitialized(context, playerHandleOptions()) }
 
     override val impl: Any get() = handle
 
@@ -137,6 +210,7 @@ abstract class JvmMpvMediampPlayer(
     private val screenshots = MpvScreenshots { path -> takeScreenshotImpl(path) }
     private val videoAspectRatio = MpvVideoAspectRatio(handle)
     private val mediaMetadata = MpvMediaMetadata(handle)
+    private val seekCommand = MpvCommandBuffer()
     private val framePreview: FramePreview? = createMpvFramePreview(this, context, parentCoroutineContext)
 
     override val features: PlayerFeatures = buildPlayerFeatures {
@@ -155,21 +229,47 @@ abstract class JvmMpvMediampPlayer(
             if (debugProps) System.err.println("[mpv-prop] $kind $name = $value (adapter=${sessionAdapter != null})")
         }
 
-        override fun onPropertyChange(name: String) {
+        // Every property is observed with an ID (PROPERTY_*), and the native event loop only
+        // calls the keyed callbacks below. Should a name-keyed one be reached anyway, the
+        // change is logged and routed by its name, not thrown back into the native upcall.
+        override fun onPropertyChange(name: String) = onPropertyNone(unkeyedPropertyId(name), name)
+        override fun onPropertyChange(name: String, value: Boolean) =
+            onPropertyFlag(unkeyedPropertyId(name), name, value)
+
+        override fun onPropertyChange(name: String, value: Long) =
+            onPropertyInt64(unkeyedPropertyId(name), name, value)
+
+        override fun onPropertyChange(name: String, value: Double) =
+            onPropertyDouble(unkeyedPropertyId(name), name, value)
+
+        override fun onPropertyChange(name: String, value: String) =
+            onPropertyString(unkeyedPropertyId(name), name, value)
+
+        // Called on the event loop thread only.
+        private val unkeyedNames = HashSet<String>()
+
+        private fun unkeyedPropertyId(name: String): Long {
+            if (unkeyedNames.add(name)) {
+                MPVLog.warn(handle.ptr, "property change of '$name' delivered without its ID; dispatching on its name")
+            }
+            return MPV_OBSERVED_PROPERTIES.firstOrNull { it.name == name }?.id ?: 0L
+        }
+
+        override fun onPropertyNone(id: Long, name: String) {
             if (nativeTeardownStarted) return
             dbg("none", name, null)
-            when (name) {
-                "track-list" -> mediaMetadata.refreshTracks()
-                "chapter-list" -> mediaMetadata.refreshChapters()
-                "video-params" -> refreshVideoSize()
+            when (id) {
+                PROPERTY_TRACK_LIST -> mediaMetadata.refreshTracks()
+                PROPERTY_CHAPTER_LIST -> mediaMetadata.refreshChapters()
+                PROPERTY_VIDEO_PARAMS -> refreshVideoSize()
             }
         }
 
-        override fun onPropertyChange(name: String, value: Boolean) {
+        override fun onPropertyFlag(id: Long, name: String, value: Boolean) {
             if (nativeTeardownStarted) return
             dbg("bool", name, value)
-            when (name) {
-                "pause" -> {
+            when (id) {
+                PROPERTY_PAUSE -> {
                     val adapter = sessionAdapter ?: return
                     // The keep-open auto-pause at EOF is part of the Ended fact and must not
                     // be reported as a transport change (spec §5). eof-reached is read live
@@ -178,13 +278,13 @@ abstract class JvmMpvMediampPlayer(
                     adapter.session.reportTransport(liveTransportSnapshot())
                 }
 
-                "paused-for-cache" -> {
+                PROPERTY_PAUSED_FOR_CACHE -> {
                     sessionAdapter?.session?.reportTransport(liveTransportSnapshot())
                 }
 
-                "mute" -> audioLevelController.onMuteChanged(value)
+                PROPERTY_MUTE -> audioLevelController.onMuteChanged(value)
 
-                "eof-reached" -> {
+                PROPERTY_EOF_REACHED -> {
                     val adapter = sessionAdapter ?: return
                     if (adapter.onEofReachedChanged(value)) {
                         adapter.session.notifyEnded()
@@ -193,36 +293,36 @@ abstract class JvmMpvMediampPlayer(
             }
         }
 
-        override fun onPropertyChange(name: String, value: Long) {
+        override fun onPropertyInt64(id: Long, name: String, value: Long) {
             if (nativeTeardownStarted) return
-            when (name) {
-                "cache-buffering-state" -> buffering.bufferedPercentage.value = value.toInt().coerceIn(0, 100)
+            when (id) {
+                PROPERTY_CACHE_BUFFERING_STATE -> buffering.bufferedPercentage.value = value.toInt().coerceIn(0, 100)
             }
         }
 
-        override fun onPropertyChange(name: String, value: Double) {
+        override fun onPropertyDouble(id: Long, name: String, value: Double) {
             if (nativeTeardownStarted) return
             dbg("double", name, value)
-            when (name) {
-                "time-pos" -> {
+            when (id) {
+                PROPERTY_TIME_POS -> {
                     // Stale pre-seek reports are dropped by the machine's seek gating.
                     sessionAdapter?.session?.notifyPosition((value * 1000).toLong().coerceAtLeast(0L))
                 }
 
-                "duration" -> {
+                PROPERTY_DURATION -> {
                     val adapter = sessionAdapter ?: return
                     adapter.lastDurationMillis = (value * 1000).toLong().takeIf { it > 0 } // unknown -> null
                     adapter.session.notifyProperties(adapter.mediaProperties())
                 }
 
-                "volume" -> audioLevelController.onVolumeChanged(value)
+                PROPERTY_VOLUME -> audioLevelController.onVolumeChanged(value)
             }
         }
 
-        override fun onPropertyChange(name: String, value: String) {
+        override fun onPropertyString(id: Long, name: String, value: String) {
             if (nativeTeardownStarted) return
-            when (name) {
-                "media-title" -> {
+            when (id) {
+                PROPERTY_MEDIA_TITLE -> {
                     val adapter = sessionAdapter ?: return
                     adapter.lastTitle = value
                     adapter.session.notifyProperties(adapter.mediaProperties())
@@ -251,11 +351,7 @@ abstract class JvmMpvMediampPlayer(
                     // closing every superseded generation at once (spec §5).
                     val generation = adapter.onPlaybackRestart()
                     if (generation != 0) {
-                        adapter.session.notifySeekCompleted(
-                            generation,
-                            currentNativePositionMillis(),
-                            liveTransportSnapshot(),
-                        )
+                        notifySeekCompleted(adapter, generation)
                     }
                 }
             }
@@ -335,10 +431,10 @@ abstract class JvmMpvMediampPlayer(
     }
 
     init {
-        // Resolve the native handle now: if its creation fails, nMake throws with nothing
-        // to release. If any later configuration step fails (e.g. initialize() throwing),
-        // close the handle so a failed construction never leaks the native mpv instance,
-        // then rethrow for the caller to handle.
+        // Resolve the native handle now: if its creation or initialization fails,
+        // createInitialized throws with nothing to release. If any later configuration step
+        // fails, close the handle so a failed construction never leaks the native mpv
+        // instance, then rethrow for the caller to handle.
         val nativeHandle = handle
         try {
             configureNativeHandle(nativeHandle)
@@ -349,115 +445,17 @@ abstract class JvmMpvMediampPlayer(
     }
 
     private fun configureNativeHandle(handle: MPVHandle) {
+        // A pooled handle has been initialized long before; it reports nothing of interest until media is loaded.
         handle.setEventListener(eventListener)
 
-        handle.option("config", "no")
-        handle.option("profile", "fast")
-
-        when (currentPlatform()) {
-            is Platform.Android -> {
-                handle.option("gpu-context", "android")
-                handle.option("opengl-es", "yes")
-                handle.option("ao", "audiotrack,opensles")
-                handle.option("vo", "gpu-next")
-            }
-
-            is Platform.Windows -> {
-                // The desktop render path drives either the libmpv D3D11 render API on
-                // its own ID3D11Device (render_d3d11.cpp) or, when Compose renders with
-                // Skiko's OpenGL backend, the OpenGL render API on a private offscreen
-                // WGL context with CPU readback (render_opengl_win.cpp). gpu-context is
-                // not used with vo=libmpv either way.
-                handle.option("ao", "wasapi")
-                handle.option("vo", "libmpv")
-            }
-
-            is Platform.MacOS -> {
-                // The render API provides its own offscreen CGL context (render_macos.mm);
-                // gpu-context is not used with vo=libmpv.
-                handle.option("ao", "coreaudio")
-                handle.option("vo", "libmpv")
-                // https://github.com/open-ani/animeko/issues/3283
-                // https://github.com/open-ani/animeko/issues/3285
-                handle.option("audio-format", "float")
-            }
-
-            is Platform.Linux -> {
-                // The desktop GLX bridge creates libmpv's OpenGL render context only after
-                // Skiko exposes its live share context; ao is picked at playback time.
-                handle.option("ao", "pulse,alsa")
-                handle.option("vo", "libmpv")
-            }
-
-            else -> {}
-        }
-
-        when (currentPlatform()) {
-            is Platform.Windows, is Platform.MacOS, is Platform.Linux -> {
-                // The desktop render API draws into an 8-bit SDR texture; force the full
-                // color-management path so HDR sources get tone-mapped instead of passed
-                // through near-black (check_dumb_mode() never inspects the colorspace).
-                // Keep target-prim/target-trc at "auto": it tone-maps HDR while passing
-                // SDR through untouched. Do not set target-trc=srgb — that re-grades SDR
-                // BT.1886 content to the sRGB curve, visibly darkening the whole picture
-                // compared to other players.
-                handle.option("gpu-dumb-mode", "no")
-            }
-
-            else -> {}
-        }
-
-        handle.option("hwdec", "auto")
-        if (currentPlatform().let { it is Platform.Windows && it.arch == Arch.AARCH64 }) {
-            // TODO: restore multi-threaded hwdec once FFmpeg fixes the race this works
-            // around: dxva2/d3d11va hwaccels attach the decoder interface ref to
-            // frame->buf[1] in end_frame, and FFmpeg frame threading copies that frame
-            // concurrently (update_thread_context DPB copy). The AVBufferRef publication
-            // is unfenced, so on ARM64's weak memory model the copy can observe the
-            // pointer before the ref contents, yielding a blank ref and crashing
-            // av_buffer_replace (NULL AVBuffer->refcount). x86 TSO hides this.
-            handle.option("hwdec-threads", "1")
-        }
-        handle.option("hwdec-codecs", "h264,hevc,mpeg4,mpeg2video,vp8,vp9,av1")
-        // FFmpeg 8 removed the native AV1 software decoder: the remaining "av1" decoder
-        // is a hwaccel-only shim (upstream registers it after the external decoders with
-        // "hwaccel hooks only, so prefer external decoders"). Software AV1 therefore goes
-        // through libdav1d, which is statically linked into our desktop FFmpeg builds.
-        // State the preference explicitly so decoder selection does not silently depend
-        // on FFmpeg's registration order; harmless on runtimes without libdav1d, and the
-        // hwdec path is unaffected (it binds hwaccels to the native "av1" decoder).
-        handle.option("vd", "libdav1d")
-        handle.option("input-default-bindings", "no")
-        handle.option("volume-max", "200")
-
-        // Limit demuxer cache since the defaults are too high for mobile devices
-        val cacheMegs = if (limitDemuxer()) 32 else 64
-        handle.option("demuxer-max-bytes", "${cacheMegs * 1024 * 1024}")
-        handle.option("demuxer-max-back-bytes", "${cacheMegs * 1024 * 1024}")
-        // workaround for <https://github.com/mpv-player/mpv/issues/14651>
-        handle.option("vd-lavc-film-grain", "cpu")
-
-        handle.initialize()
-
         handle.option("save-position-on-quit", "no")
         handle.option("force-window", "no")
         handle.option("idle", "yes")
         handle.option("keep-open", "always")
 
-        handle.observeProperty("eof-reached", MPVFormat.MPV_FORMAT_FLAG)
-        handle.observeProperty("time-pos", MPVFormat.MPV_FORMAT_DOUBLE)
-        handle.observeProperty("duration", MPVFormat.MPV_FORMAT_DOUBLE)
-        handle.observeProperty("pause", MPVFormat.MPV_FORMAT_FLAG)
-        handle.observeProperty("paused-for-cache", MPVFormat.MPV_FORMAT_FLAG)
-        handle.observeProperty("volume", MPVFormat.MPV_FORMAT_DOUBLE)
-        handle.observeProperty("mute", MPVFormat.MPV_FORMAT_FLAG)
-        handle.observeProperty("cache-buffering-state", MPVFormat.MPV_FORMAT_INT64)
-        handle.observeProperty("media-title", MPVFormat.MPV_FORMAT_STRING)
-        handle.observeProperty("track-list", MPVFormat.MPV_FORMAT_NONE)
-        handle.observeProperty("chapter-list", MPVFormat.MPV_FORMAT_NONE)
-        handle.observeProperty("video-params", MPVFormat.MPV_FORMAT_NONE)
-        handle.observeProperty("hwdec-current", MPVFormat.MPV_FORMAT_NONE)
-
+        for (property in MPV_OBSERVED_PROPERTIES) {
+            handle.observeProperty(property.name, property.format, property.id, maxRateHz = property.maxRateHz)
+        }
     }
 
     @InternalMediampApi
@@ -544,7 +542,17 @@ abstract class JvmMpvMediampPlayer(
                     throw t
                 }
                 val registered = try {
-                    handle.registerSeekableInput(input, target)
+                    // Read ahead, so that a read waiting for data (e.g. an undownloaded torrent piece) blocks the
+                    // prefetch thread instead of mpv's demuxer. Keyed by the media's URI so that the frame-preview
+                    // decoder reuses what the player fetched. Only a media that names its content is stored in the
+                    // disk cache, when configured, to be served again in a later session.
+                    handle.registerSeekableInput(
+                        input,
+                        target,
+                        readAheadSize = MPVHandle.RECOMMENDED_READ_AHEAD_SIZE,
+                        cacheKey = data.uri,
+                        contentId = data.contentId,
+                    )
                 } catch (t: Throwable) {
                     awaitJob.cancel()
                     input.close()
@@ -649,23 +657,19 @@ abstract class JvmMpvMediampPlayer(
     override fun seekImpl(positionMillis: Long, seekGeneration: Int) {
         val adapter = sessionAdapter ?: return
         adapter.onSeekIssued(seekGeneration)
-        val targetSeconds = positionMillis.coerceAtLeast(0L) / 1000.0
-        if (!handle.command("seek", formatSeconds(targetSeconds), "absolute+exact")) {
+        if (!seekCommand.seek(handle, positionMillis.coerceAtLeast(0L), "absolute+exact")) {
             // Synchronous refusal (unseekable/live media): the seek gate must never wedge
             // (spec §5) — synthesize the completion at the actual native position, stamped
             // with the issued generation.
             if (adapter.onSeekRejected(seekGeneration)) {
-                adapter.session.notifySeekCompleted(
-                    seekGeneration,
-                    currentNativePositionMillis(),
-                    liveTransportSnapshot(),
-                )
+                notifySeekCompleted(adapter, seekGeneration)
             }
         }
     }
 
     override fun setRateImpl(rate: Float) {
-        handle.setPropertyDouble("speed", rate.toDouble())
+        // Not awaited: mpv applies it on its own time, the caller (e.g. a rate slider) should not wait for that.
+        handle.setPropertyAsync("speed", rate.toDouble())
     }
 
     override fun stopImpl() {
@@ -714,13 +718,27 @@ abstract class JvmMpvMediampPlayer(
      * while the transport is playing, so a stall with play intent is never reported as
      * `isStalled = false`.
      */
-    private fun liveTransportSnapshot(): TransportSnapshot = TransportSnapshot(
-        nativePlayWhenReady = !handle.getPropertyBoolean("pause"),
-        isStalled = handle.getPropertyBoolean("paused-for-cache"),
+    private fun liveTransportSnapshot(
+        transport: MPVPropertyValues = handle.getProperties(TRANSPORT_STATE_PROPERTIES),
+    ): TransportSnapshot = TransportSnapshot(
+        nativePlayWhenReady = transport.getBoolean(TRANSPORT_PAUSE) != true,
+        isStalled = transport.getBoolean(TRANSPORT_PAUSED_FOR_CACHE) == true,
     )
 
-    private fun currentNativePositionMillis(): Long =
-        (handle.getPropertyDouble("time-pos") * 1000).toLong().coerceAtLeast(0L)
+    private fun currentNativePositionMillis(transport: MPVPropertyValues): Long =
+        ((transport.getDouble(TRANSPORT_TIME_POS) ?: 0.0) * 1000).toLong().coerceAtLeast(0L)
+
+    /**
+     * Reports a completed seek with the position and transport, read in one native call.
+     */
+    private fun notifySeekCompleted(adapter: MpvSessionAdapter, generation: Int) {
+        val transport = handle.getProperties(TRANSPORT_PROPERTIES)
+        adapter.session.notifySeekCompleted(
+            generation,
+            currentNativePositionMillis(transport),
+            liveTransportSnapshot(transport),
+        )
+    }
 
     private fun refreshVideoSize() {
         val adapter = sessionAdapter ?: return
@@ -729,10 +747,11 @@ abstract class JvmMpvMediampPlayer(
     }
 
     private fun readVideoSize(adapter: MpvSessionAdapter) {
-        adapter.lastVideoWidth = handle.getPropertyInt("dwidth").takeIf { it > 0 }
-            ?: handle.getPropertyInt("width").takeIf { it > 0 }
-        adapter.lastVideoHeight = handle.getPropertyInt("dheight").takeIf { it > 0 }
-            ?: handle.getPropertyInt("height").takeIf { it > 0 }
+        val size = handle.getProperties(VIDEO_SIZE_PROPERTIES)
+        adapter.lastVideoWidth = size.getInt(VIDEO_SIZE_DWIDTH)?.takeIf { it > 0 }
+            ?: size.getInt(VIDEO_SIZE_WIDTH)?.takeIf { it > 0 }
+        adapter.lastVideoHeight = size.getInt(VIDEO_SIZE_DHEIGHT)?.takeIf { it > 0 }
+            ?: size.getInt(VIDEO_SIZE_HEIGHT)?.takeIf { it > 0 }
     }
 
     /**
@@ -740,6 +759,18 @@ abstract class JvmMpvMediampPlayer(
      * Used by the frame-preview decoder to mirror the main player's media.
      */
     internal fun currentMediaDataOrNull(): MediaData? = mediaData.value
+
+    public companion object {
+        /**
+         * Keeps [size] mpv handles configured for a player ready, created and initialized in the background, so
+         * that creating a player skips that on its way to the first frame. 0, the default, turns it off.
+         *
+         * @see MPVHandle.configurePool
+         */
+        public fun configureHandlePool(context: Any, size: Int) {
+            MPVHandle.configurePool(context, playerHandleOptions(), size)
+        }
+    }
 }
 
 private fun MpvSessionAdapter.mediaProperties(): MediaProperties = MediaProperties(
@@ -762,6 +793,97 @@ internal expect fun createMpvFramePreview(
     parentCoroutineContext: CoroutineContext,
 ): FramePreview?
 
+/**
+ * Options of the player's handle, set before it is initialized; the pool profile of [JvmMpvMediampPlayer.configureHandlePool].
+ */
+private fun playerHandleOptions(): List<Pair<String, String>> = buildList {
+    add("config" to "no")
+    add("profile" to "fast")
+
+    when (currentPlatform()) {
+        is Platform.Android -> {
+            add("gpu-context" to "android")
+            add("opengl-es" to "yes")
+            add("ao" to "audiotrack,opensles")
+            add("vo" to "gpu-next")
+        }
+
+        is Platform.Windows -> {
+            // The desktop render path drives either the libmpv D3D11 render API on
+            // its own ID3D11Device (render_d3d11.cpp) or, when Compose renders with
+            // Skiko's OpenGL backend, the OpenGL render API on a private offscreen
+            // WGL context with CPU readback (render_opengl_win.cpp). gpu-context is
+            // not used with vo=libmpv either way.
+            add("ao" to "wasapi")
+            add("vo" to "libmpv")
+        }
+
+        is Platform.MacOS -> {
+            // The render API provides its own offscreen CGL context (render_macos.mm);
+            // gpu-context is not used with vo=libmpv.
+            add("ao" to "coreaudio")
+            add("vo" to "libmpv")
+            // https://github.com/open-ani/animeko/issues/3283
+            // https://github.com/open-ani/animeko/issues/3285
+            add("audio-format" to "float")
+        }
+
+        is Platform.Linux -> {
+            // The desktop GLX bridge creates libmpv's OpenGL render context only after
+            // Skiko exposes its live share context; ao is picked at playback time.
+            add("ao" to "pulse,alsa")
+            add("vo" to "libmpv")
+        }
+
+        else -> {}
+    }
+
+    when (currentPlatform()) {
+        is Platform.Windows, is Platform.MacOS, is Platform.Linux -> {
+            // The desktop render API draws into an 8-bit SDR texture; force the full
+            // color-management path so HDR sources get tone-mapped instead of passed
+            // through near-black (check_dumb_mode() never inspects the colorspace).
+            // Keep target-prim/target-trc at "auto": it tone-maps HDR while passing
+            // SDR through untouched. Do not set target-trc=srgb — that re-grades SDR
+            // BT.1886 content to the sRGB curve, visibly darkening the whole picture
+            // compared to other players.
+            add("gpu-dumb-mode" to "no")
+        }
+
+        else -> {}
+    }
+
+    add("hwdec" to "auto")
+    if (currentPlatform().let { it is Platform.Windows && it.arch == Arch.AARCH64 }) {
+        // TODO: restore multi-threaded hwdec once FFmpeg fixes the race this works
+        // around: dxva2/d3d11va hwaccels attach the decoder interface ref to
+        // frame->buf[1] in end_frame, and FFmpeg frame threading copies that frame
+        // concurrently (update_thread_context DPB copy). The AVBufferRef publication
+        // is unfenced, so on ARM64's weak memory model the copy can observe the
+        // pointer before the ref contents, yielding a blank ref and crashing
+        // av_buffer_replace (NULL AVBuffer->refcount). x86 TSO hides this.
+        add("hwdec-threads" to "1")
+    }
+    add("hwdec-codecs" to "h264,hevc,mpeg4,mpeg2video,vp8,vp9,av1")
+    // FFmpeg 8 removed the native AV1 software decoder: the remaining "av1" decoder
+    // is a hwaccel-only shim (upstream registers it after the external decoders with
+    // "hwaccel hooks only, so prefer external decoders"). Software AV1 therefore goes
+    // through libdav1d, which is statically linked into our desktop FFmpeg builds.
+    // State the preference explicitly so decoder selection does not silently depend
+    // on FFmpeg's registration order; harmless on runtimes without libdav1d, and the
+    // hwdec path is unaffected (it binds hwaccels to the native "av1" decoder).
+    add("vd" to "libdav1d")
+    add("input-default-bindings" to "no")
+    add("volume-max" to "200")
+
+    // Limit demuxer cache since the defaults are too high for mobile devices
+    val cacheMegs = if (limitDemuxer()) 32 else 64
+    add("demuxer-max-bytes" to "${cacheMegs * 1024 * 1024}")
+    add("demuxer-max-back-bytes" to "${cacheMegs * 1024 * 1024}")
+    // workaround for <https://github.com/mpv-player/mpv/issues/14651>
+    add("vd-lavc-film-grain" to "cpu")
+}
+
 private fun formatSeconds(seconds: Double): String {
     // mpv parses decimal seconds; String.format would be locale-sensitive.
     return ((seconds * 1000).toLong() / 1000.0).toBigDecimal().toPlainString()
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2024-2026 OpenAni and contributors.
+ *
+ * Use of this source code is governed by the Apache License version 2 license, which can be found at the following link.
+ *
+ * https://github.com/open-ani/mediamp/blob/main/LICENSE
+ */
+
+package org.openani.mediamp.mpv
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Native log lines dropped so far because the native log queue was full, across all handles.
+ * The native log drain thread also reports this as a warning whenever it grows.
+ *
+ * Requires the mpv native library to be loaded.
+ */
+public val MPVLog.droppedNativeLines: Long get() = nLogDroppedCount()
+
+// Reused by the single native log drain thread that calls onNativeLogBatch.
+private val scratch = ByteBufferScratch(1024)
+
+/**
+ * Called from the native log drain thread (`log.cpp`) with [size] bytes of queued log lines at the start
+ * of [buffer], each record laid out as
+ * `int32 size, int32 level, int64 instanceHandle, int32 prefixLength, int32 textLength`
+ * followed by the UTF-8 prefix and text, padded to 8 bytes.
+ */
+internal fun onNativeLogBatch(buffer: ByteBuffer, size: Int) {
+    buffer.order(ByteOrder.nativeOrder())
+    var offset = 0
+    while (offset + HEADER_SIZE <= size) {
+        val recordSize = buffer.getInt(offset)
+        if (recordSize < HEADER_SIZE) break
+        val prefixLength = buffer.getInt(offset + 16)
+        val textLength = buffer.getInt(offset + 20)
+        val prefix = scratch.readString(buffer, offset + HEADER_SIZE, prefixLength)
+        val text = scratch.readString(buffer, offset + HEADER_SIZE + prefixLength, textLength)
+        // One bad line is reported and skipped.
+        try {
+            MPVLog.log(buffer.getLong(offset + 8), buffer.getInt(offset + 4), text, prefix = prefix)
+        } catch (e: Throwable) {
+            e.printStackTrace()
+        }
+        offset += recordSize
+    }
+}
+
+private const val HEADER_SIZE = 24